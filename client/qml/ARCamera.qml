@@ -10,7 +10,13 @@ Page {
     id: cameraPage
     property alias manager: qmlManager
     property string garmentId: ""
+    // Garment mesh to fit: the cache key and where to download it from
+    property string modelKey: ""
+    property url modelUrl
+    property bool tryOnStarted: false
     property string processedPreviewUrl: ""
+    // Intermediate result shown while the final image is still downloading
+    property string partialPreviewUrl: ""
     property string processedModelUrl: ""
     property string lastScanId: ""
     property string selectedCategory: ""
@@ -69,6 +75,9 @@ Page {
 
     QMLManager {
         id: qmlManager
+        // Frames for body tracking are taken from the preview's sink
+        trackingVideoSink: videoOutput.videoSink
+        garmentRenderer: garmentOverlay
     }
 
     ImageProcessor {
@@ -78,14 +87,22 @@ Page {
         onProcessedImageReceived: function(imageData) {
             // Create base64 data URL for display
             processedPreviewUrl = "data:image/jpeg;base64," + Qt.btoa(imageData)
+            partialPreviewUrl = ""
             cameraPage.state = "modelPreview"
         }
 
+        onPreviewSourceChanged: {
+            if (processedPreviewUrl !== "") return
+            partialPreviewUrl = previewSource.toString()
+            if (partialPreviewUrl !== "") cameraPage.state = "modelPreview"
+        }
+
         onProcessingProgress: function(progress) {
             progressBar.value = progress * 100
         }
 
         onProcessingError: function(errorMessage) {
+            partialPreviewUrl = ""
             errorLabel.text = errorMessage
             errorLabel.visible = true
             cameraPage.state = "initial"
@@ -140,6 +157,20 @@ Page {
         fillMode: VideoOutput.PreserveAspectCrop
     }
 
+    // Fitted garment, drawn in the same space as the (cropped) camera image
+    GarmentRenderer {
+        id: garmentOverlay
+        anchors.fill: videoOutput
+        contentRect: videoOutput.contentRect
+        visible: garmentId !== ""
+    }
+
+    // Once per rendered frame, fit the garment to the newest tracked pose
+    FrameAnimation {
+        running: garmentId !== "" && camera.cameraStatus === Camera.ActiveStatus
+        onTriggered: qmlManager.syncTrackedPose()
+    }
+
     Label {
         id: errorLabel
         visible: false
@@ -229,7 +260,7 @@ Page {
                     id: previewImage
                     anchors.fill: parent
                     anchors.margins: 10
-                    source: processedPreviewUrl
+                    source: processedPreviewUrl !== "" ? processedPreviewUrl : partialPreviewUrl
                     fillMode: Image.PreserveAspectFit
                     smooth: true
                     cache: false
@@ -238,6 +269,7 @@ Page {
                     BusyIndicator {
                         anchors.centerIn: parent
                         running: previewImage.status === Image.Loading
+                                 || (processedPreviewUrl === "" && partialPreviewUrl !== "")
                         width: 50
                         height: 50
                         visible: running
@@ -251,7 +283,8 @@ Page {
                           "Failed to load image" : "Processing...")
                     horizontalAlignment: Text.AlignHCenter
                     color: "#666"
-                    visible: processedPreviewUrl === "" || previewImage.status === Image.Error
+                    visible: (processedPreviewUrl === "" && partialPreviewUrl === "")
+                             || previewImage.status === Image.Error
                     font.pixelSize: 16
                 }
             }
@@ -266,6 +299,7 @@ Page {
                     font: Style.buttonFont
                     onClicked: {
                         processedPreviewUrl = ""
+                        partialPreviewUrl = ""
                         processedModelUrl = ""
                         garmentId = ""
                         cameraPage.state = "initial"
@@ -277,6 +311,8 @@ Page {
                     text: "Save Result"
                     font: Style.buttonFont
                     palette.button: "green"
+                    // Only the complete result can be saved
+                    enabled: processedPreviewUrl !== ""
                     onClicked: {
                         // Implementation for saving the result
                         qmlManager.saveImageResult(processedPreviewUrl)
@@ -325,6 +361,37 @@ Page {
     }
 
     // Handle permission results
+    // The fitter reads the mesh from disk, so try-on starts once the cache
+    // has a local copy of it
+    function startTryOn() {
+        var local = ModelAssetCache.localUrl(modelKey)
+        if (local.toString() !== "") {
+            tryOnStarted = true
+            qmlManager.tryOnGarment(garmentId, local)
+        } else if (modelKey !== "") {
+            ModelAssetCache.fetch(modelKey, modelUrl)
+        } else {
+            errorLabel.text = "This garment has no 3D model to try on"
+            errorLabel.visible = true
+        }
+    }
+
+    Connections {
+        target: ModelAssetCache
+        function onAssetReady(key, localUrl) {
+            if (key === modelKey && !tryOnStarted) {
+                tryOnStarted = true
+                qmlManager.tryOnGarment(garmentId, localUrl)
+            }
+        }
+        function onAssetFailed(key, error) {
+            if (key === modelKey && !tryOnStarted) {
+                errorLabel.text = "Failed to download the 3D model: " + error
+                errorLabel.visible = true
+            }
+        }
+    }
+
     Connections {
         target: qmlManager
 
@@ -336,12 +403,20 @@ Page {
             errorLabel.text = "Camera permission denied. Please enable camera access in settings."
             errorLabel.visible = true
         }
+
+        function onArSessionFailed(error) {
+            errorLabel.text = error
+            errorLabel.visible = true
+        }
     }
 
     Component.onCompleted: {
         if (camera.cameraStatus === Camera.UnloadedStatus && qmlManager.hasCameraPermission()) {
             camera.start()
         }
+        if (garmentId !== "") {
+            startTryOn()
+        }
     }
 
     Component.onDestruction: {
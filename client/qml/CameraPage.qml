@@ -18,6 +18,7 @@ Page {
     property string processedPreviewUrl: ""
     property string processedModelKey: ""
     property string processedPreviewKey: ""
+    property int burstProgress: 0
     // Generate unique garment ID
     function generateGarmentId() {
         const timestamp = Date.now();
@@ -88,6 +89,8 @@ Page {
 
     QMLManager {
         id: qmlManager
+        // Preview frames are scored for sharpness while the button is held
+        scanVideoSink: videoOutput.videoSink
 
         // Handle scan progress updates
         onScanProgressChanged: function(progress) {
@@ -111,6 +114,22 @@ Page {
             progressOverlay.visible = false
         }
 
+        onBurstProgressChanged: function(progress) {
+            burstProgress = progress
+        }
+
+        // Best frame of the burst
+        onBurstCaptured: function(frame) {
+            capturedFrame = frame
+            ScanPipeline.mark(currentGarmentId, ScanPipeline.FrameCaptured)
+            cameraPage.state = "categorySelection"
+        }
+
+        onBurstFailed: function(error) {
+            errorLabel.text = error
+            errorLabel.visible = true
+        }
+
         // Handle upload completion
         onUploadCompleted: function(garmentId) {
             console.log("Upload completed for garment:", garmentId)
@@ -199,6 +218,7 @@ Page {
         width: Style.buttonWidth
         height: Style.buttonHeight
         visible: camera.cameraStatus === Camera.ActiveStatus
+        enabled: !qmlManager.burstActive
 
         background: Rectangle {
             radius: height/2
@@ -210,12 +230,14 @@ Page {
             currentGarmentId = generateGarmentId()
             // currentGarmentId = "254858648"
             console.log("Garment id from QT: ", currentGarmentId)
-            // Capture image to memory
-            imageCapture.capture()
+            ScanPipeline.mark(currentGarmentId, ScanPipeline.Capture)
+            // Score a burst of preview frames and keep the sharpest
+            burstProgress = 0
+            qmlManager.startBurstCapture()
         }
 
         contentItem: Text {
-            text: "Capture"
+            text: qmlManager.burstActive ? "Hold still " + burstProgress + "%" : "Capture"
             font: Style.buttonFont
             color: "white"
             horizontalAlignment: Text.AlignHCenter
@@ -383,7 +405,9 @@ Page {
 
                     // Error handling for image loading
                     onStatusChanged: {
-                        if (status === Image.Error) {
+                        if (status === Image.Ready) {
+                            ScanPipeline.mark(currentGarmentId, ScanPipeline.PreviewShown)
+                        } else if (status === Image.Error) {
                             errorLabel.text = "Failed to load preview image"
                             errorLabel.visible = true
                         }
@@ -13,6 +13,9 @@ Page {
     property string garmentId
     property url previewImage
     property url modelObject
+    property string modelKey
+    // Local copy from ModelAssetCache once available; remote URL as fallback
+    property url modelSource
 
     // State variables for garment manipulation (model only)
     property real scaleValue: 1.0
@@ -23,6 +26,7 @@ Page {
     property bool isDragging: false
 
     Component.onCompleted: {
+        ScanPipeline.mark(garmentId, ScanPipeline.PreviewOpened)
         console.log("Style properties:",
             "Primary color:", Style.primaryColor,
             "Background color:", Style.backgroundColor,
@@ -37,6 +41,32 @@ Page {
         } else if (modelObject.toString().includes(".obj")) {
             console.log("Loading OBJ format")
         }
+
+        // Reopened garments load straight from disk without a network round trip
+        var cached = modelKey ? ModelAssetCache.localUrl(modelKey) : ""
+        if (cached.toString() !== "") {
+            console.log("Loading model from cache:", cached)
+            modelSource = cached
+        } else if (modelKey) {
+            ModelAssetCache.fetch(modelKey, modelObject)
+        } else {
+            modelSource = modelObject
+        }
+    }
+
+    Connections {
+        target: ModelAssetCache
+        function onAssetReady(key, localUrl) {
+            if (key === modelKey && modelSource.toString() === "") {
+                modelSource = localUrl
+            }
+        }
+        function onAssetFailed(key, error) {
+            if (key === modelKey && modelSource.toString() === "") {
+                console.log("Model cache download failed, loading remote:", error)
+                modelSource = modelObject
+            }
+        }
     }
 
     background: Rectangle { color: Style.backgroundColor }
@@ -178,7 +208,7 @@ Page {
                         },
                         SceneLoader {
                             id: sceneLoader
-                            source: modelObject
+                            source: modelSource
 
                             Component.onCompleted: {
                                 console.log("SceneLoader initialized with source:", source)
@@ -200,6 +230,7 @@ Page {
                                             break;
                                         case SceneLoader.Ready:
                                             console.log("SceneLoader: Ready - Model loaded successfully!")
+                                            ScanPipeline.mark(garmentId, ScanPipeline.ModelLoaded)
                                             console.log("Entity count:", sceneLoader.entity ? "Entity created" : "No entity")
                                             loadingIndicator.visible = false
                                             modelError.visible = false
@@ -248,7 +279,7 @@ Page {
                         },
                         Mesh {
                             id: modelMesh
-                            source: modelObject
+                            source: modelSource
 
                             Component.onCompleted: {
                                 console.log("Fallback Mesh initialized with source:", source)
@@ -762,8 +793,13 @@ Source: ${modelObject.toString().split('/').pop()}`
                 }
 
                 onPressed: {
-                    qmlManager.tryOnGarment(garmentId)
-                    stackView.push("ARCamera.qml", {"garmentId": garmentId})
+                    // ARCamera starts the try-on session on its own manager,
+                    // which owns the tracker fed by the camera preview
+                    stackView.push("ARCamera.qml", {
+                        "garmentId": garmentId,
+                        "modelKey": modelKey,
+                        "modelUrl": modelObject
+                    })
                 }
             }
         }
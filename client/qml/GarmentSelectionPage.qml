@@ -50,8 +50,7 @@ Page {
     QMLManager {
         id: qmlManager
         onGarmentsChanged: {
-            console.log("Garments changed, count: " + garments.length)
-            gridView.model = garments
+            console.log("Garments changed, count: " + garments.count)
             loadingIndicator.visible = false
         }
     }
@@ -68,6 +67,7 @@ Page {
         }
         cellWidth: width / 3 - Style.gridSpacing
         cellHeight: cellWidth + 40 // Extra space for text
+        model: qmlManager.garments
 
         delegate: Item {
             id: delegateItem
@@ -115,10 +115,12 @@ Page {
                             fill: parent
                             margins: 2
                         }
-                        source: model.modelData.previewUrl
+                        // Decoded at cell size and cached by the thumbnail provider
+                        source: model.previewUrl ? "image://thumbnail/" + Qt.btoa(model.previewUrl) : ""
                         fillMode: Image.PreserveAspectCrop
                         asynchronous: true
-                        sourceSize: Qt.size(200, 200)
+                        sourceSize: Qt.size(Math.ceil(width * Screen.devicePixelRatio),
+                                            Math.ceil(height * Screen.devicePixelRatio))
 
                         // Enhanced error handling
                         onStatusChanged: {
@@ -188,7 +190,7 @@ Page {
 
                 // Garment Name
                 Text {
-                    text: model.modelData.name
+                    text: model.name
                     color: Style.primaryColor
                     font: Style.buttonFont
                     elide: Text.ElideRight
@@ -203,17 +205,20 @@ Page {
                 hoverEnabled: true
 
                 onClicked: {
-                    console.log("Item clicked: " + model.modelData.id)
-                    if (model.modelData.isAvailable) {
-                        selectedGarmentId = model.modelData.id  // Access id
+                    console.log("Item clicked: " + model.garmentId)
+                    if (model.isAvailable) {
+                        selectedGarmentId = model.garmentId  // Access id
+                        // Warm the cache for the neighbours the user is likely to open next
+                        ModelAssetCache.prefetchAdjacent(qmlManager.garments, index)
 
                         // Create the preview page component
                         var component = Qt.createComponent("GarmentPreviewPage.qml");
                         if (component.status === Component.Ready) {
                             var page = component.createObject(null, {
-                                "garmentId": model.modelData.id,
-                                "previewImage": model.modelData.previewUrl,
-                                "modelObject": model.modelData.modelwUrl
+                                "garmentId": model.garmentId,
+                                "previewImage": model.previewUrl,
+                                "modelObject": model.modelUrl,
+                                "modelKey": model.modelKey
                             });
                             stackView.push(page);
                         } else if (component.status === Component.Error) {
@@ -222,9 +227,10 @@ Page {
                             // Fallback: Try direct push with relative path
                             try {
                                 stackView.push("GarmentPreviewPage.qml", {
-                                    "garmentId": model.modelData.id,
-                                    "previewImage": model.modelData.previewUrl,
-                                    "modelObject": model.modelData.modelwUrl
+                                    "garmentId": model.garmentId,
+                                    "previewImage": model.previewUrl,
+                                    "modelObject": model.modelUrl,
+                                    "modelKey": model.modelKey
                                 });
                             } catch (e) {
                                 console.error("Fallback navigation failed: " + e);
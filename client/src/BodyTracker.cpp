@@ -1,8 +1,12 @@
 #include "BodyTracker.h"
+#include "PoseRecording.h"
+#include <QDebug>
 // #include <opencv2/opencv.hpp>
 
 BodyTracker::BodyTracker(QObject* parent) : QObject(parent) {}
 
+BodyTracker::~BodyTracker() = default;
+
 bool BodyTracker::initCamera(int cameraID) { 
     // Add temporary implementation
     return true; 
@@ -17,6 +21,54 @@ void BodyTracker::update() {
 //     emit keypointsUpdated();
 // }
 
-std::vector<BodyKeypoint> BodyTracker::getKeypoints() const {
-    return keypoints;
+void BodyTracker::setEstimator(std::unique_ptr<PoseEstimator> estimator) {
+    QMutexLocker locker(&m_estimatorMutex);
+    m_estimator = std::move(estimator);
+}
+
+bool BodyTracker::hasEstimator() const {
+    QMutexLocker locker(&m_estimatorMutex);
+    return m_estimator != nullptr;
+}
+
+bool BodyTracker::processFrame(const QVideoFrame& frame, qint64 captureNs) {
+    QVideoFrame mapped(frame);
+    // Maps the existing buffers; CPU frames are not copied. GPU-backed
+    // frames are read back by the multimedia backend here.
+    if (!mapped.map(QVideoFrame::ReadOnly)) {
+        qWarning() << "Failed to map camera frame" << frame.pixelFormat();
+        return false;
+    }
+
+    FrameView view;
+    view.width = mapped.width();
+    view.height = mapped.height();
+    view.pixelFormat = mapped.pixelFormat();
+    view.planeCount = qMin(mapped.planeCount(), 4);
+    for (int plane = 0; plane < view.planeCount; ++plane) {
+        view.planes[plane] = mapped.bits(plane);
+        view.bytesPerLine[plane] = mapped.bytesPerLine(plane);
+    }
+
+    // The estimator writes straight into the producer slot; an unpublished
+    // slot is simply reused for the next frame.
+    PoseSnapshot& snapshot = m_poses.writeBuffer();
+    bool estimated = false;
+    {
+        // The estimator is only swapped between frames, never during one.
+        QMutexLocker locker(&m_estimatorMutex);
+        if (m_estimator) {
+            estimated = m_estimator->estimate(view, snapshot.keypoints);
+        }
+    }
+    mapped.unmap();
+
+    if (!estimated) return false;
+
+    snapshot.frameNumber = ++m_frameNumber;
+    snapshot.captureNs = captureNs;
+    if (m_recorder) m_recorder->recordPose(snapshot);
+    m_poses.publish();
+    emit keypointsUpdated();
+    return true;
 }
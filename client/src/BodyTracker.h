@@ -1,21 +1,71 @@
 #pragma once
 #include "CommonTypes.h"
+#include "TripleBuffer.h"
+#include <QMutex>
 #include <QObject>
-#include <vector>
+#include <QVideoFrame>
+#include <memory>
+class PoseRecorder;
 // #include <opencv2/core.hpp>
 
+// Read-only view of a mapped camera frame. Plane pointers reference the
+// QVideoFrame's own buffers and are only valid during processFrame().
+struct FrameView {
+    int width = 0;
+    int height = 0;
+    QVideoFrameFormat::PixelFormat pixelFormat = QVideoFrameFormat::Format_Invalid;
+    int planeCount = 0;
+    const uchar* planes[4] = {};
+    int bytesPerLine[4] = {};
+};
+
+// Pose model behind BodyTracker. Implementations run on the tracker thread
+// and fill one BodyKeypoint per BodyPart, in normalised frame coordinates.
+// The output array is published as-is, so it must be fully written when
+// estimate() returns true.
+class PoseEstimator {
+public:
+    virtual ~PoseEstimator() = default;
+    virtual bool estimate(const FrameView& frame, PoseKeypoints& keypoints) = 0;
+};
+
 class BodyTracker : public QObject {
     Q_OBJECT
 public:
     explicit BodyTracker(QObject* parent = nullptr);
+    ~BodyTracker();
     bool initCamera(int cameraID = 0);
     void update();
     // void processFrame(const cv::Mat& frame);
-    std::vector<BodyKeypoint> getKeypoints() const;
+
+    // Runs the estimator on one frame; called from the tracker thread.
+    // Returns true when new keypoints were published.
+    bool processFrame(const QVideoFrame& frame, qint64 captureNs);
+
+    void setEstimator(std::unique_ptr<PoseEstimator> estimator);
+    bool hasEstimator() const;
+
+    // Published poses also go to the recorder while it records. Set before
+    // the tracker thread starts; not owned.
+    void setRecorder(PoseRecorder* recorder) { m_recorder = recorder; }
+
+    // Consumer side, for a single thread (the GUI thread at vsync): takes
+    // the newest published pose without locking or allocating. Returns
+    // false when nothing new arrived; currentPose() is then unchanged.
+    bool acquireLatestPose() { return m_poses.update(); }
+    const PoseSnapshot& currentPose() const { return m_poses.readBuffer(); }
 
 signals:
+    // Notification only; read the pose with acquireLatestPose().
     void keypointsUpdated();
 
 private:
-    std::vector<BodyKeypoint> keypoints;
+    // Held for a whole estimate; readers never take it.
+    mutable QMutex m_estimatorMutex;
+    std::unique_ptr<PoseEstimator> m_estimator;
+
+    TripleBuffer<PoseSnapshot> m_poses;
+    PoseRecorder* m_recorder = nullptr;
+    // Only touched on the tracker thread
+    uint64_t m_frameNumber = 0;
 };
@@ -0,0 +1,266 @@
+#include "ChunkedUploader.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QTimer>
+#include <QUrl>
+#include <utility>
+
+namespace {
+// Chunks smaller than this are dominated by round-trip time and say little
+// about the link's bandwidth.
+constexpr qint64 kMinThroughputSampleBytes = 16 * 1024;
+constexpr double kThroughputSmoothing = 0.3;
+// Bounds on the server's Retry-After while it stores a finished upload
+constexpr int kMinFinalizeWaitMs = 250;
+constexpr int kMaxFinalizeWaitMs = 30000;
+}
+
+ChunkedUploader::ChunkedUploader(QNetworkAccessManager* manager, RequestFactory requestFactory,
+                                 QObject* parent)
+    : QObject(parent),
+      m_manager(manager),
+      m_requestFactory(std::move(requestFactory))
+{
+}
+
+ChunkedUploader::~ChunkedUploader() {
+    for (const UploadPtr& upload : std::as_const(m_uploads)) {
+        if (upload->reply) {
+            upload->reply->disconnect(this);
+            upload->reply->abort();
+            upload->reply->deleteLater();
+        }
+    }
+}
+
+QNetworkRequest ChunkedUploader::makeRequest(const QString& path) const {
+    QNetworkRequest request = m_requestFactory(QUrl(m_serverUrl + "/uploads" + path));
+    request.setTransferTimeout(m_transferTimeoutMs);
+    return request;
+}
+
+bool ChunkedUploader::isCurrent(const UploadPtr& upload) const {
+    return m_uploads.value(upload->garmentId) == upload;
+}
+
+void ChunkedUploader::upload(const QByteArray& data, const QString& contentType,
+                             const QString& garmentId, const QString& category) {
+    cancel(garmentId);
+
+    auto upload = std::make_shared<Upload>();
+    upload->garmentId = garmentId;
+    upload->category = category;
+    upload->contentType = contentType;
+    upload->data = data;
+    upload->sha256 = QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex();
+    m_uploads.insert(garmentId, upload);
+
+    emit progressChanged(garmentId, 0, data.size());
+    createSession(upload);
+}
+
+void ChunkedUploader::cancel(const QString& garmentId) {
+    UploadPtr upload = m_uploads.take(garmentId);
+    if (!upload) return;
+
+    if (upload->reply) {
+        upload->reply->disconnect(this);
+        upload->reply->abort();
+        upload->reply->deleteLater();
+    }
+    if (!upload->uploadId.isEmpty()) {
+        // Let the server drop the partial data now rather than at expiry
+        QNetworkReply* reply = m_manager->deleteResource(makeRequest("/" + upload->uploadId));
+        connect(reply, &QNetworkReply::finished, reply, &QObject::deleteLater);
+    }
+    qDebug() << "Cancelled chunked upload for garment" << garmentId;
+}
+
+void ChunkedUploader::createSession(const UploadPtr& upload) {
+    QJsonObject body;
+    body["garmentId"] = upload->garmentId;
+    body["category"] = upload->category;
+    body["contentType"] = upload->contentType;
+    body["size"] = upload->data.size();
+    body["sha256"] = QString::fromLatin1(upload->sha256);
+    body["chunkSize"] = m_chunkSize;
+
+    QNetworkRequest request = makeRequest(QString());
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    watch(upload, m_manager->post(request, QJsonDocument(body).toJson(QJsonDocument::Compact)), Step::Create);
+}
+
+void ChunkedUploader::sendChunk(const UploadPtr& upload) {
+    const qint64 offset = upload->offset;
+    // Empty once everything is on the server: asks it to (re)try storing
+    const QByteArray chunk = upload->data.mid(offset, upload->chunkSize);
+
+    QNetworkRequest request = makeRequest("/" + upload->uploadId);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    request.setRawHeader("Upload-Offset", QByteArray::number(offset));
+
+    upload->chunkBytes = chunk.size();
+    upload->chunkTimer.start();
+    QNetworkReply* reply = m_manager->put(request, chunk);
+    const qint64 total = upload->data.size();
+    connect(reply, &QNetworkReply::uploadProgress, this,
+            [this, upload, reply, offset, total](qint64 sent, qint64 chunkTotal) {
+                if (!isCurrent(upload)) return;
+                emit progressChanged(upload->garmentId, offset + sent, total);
+                // Timed until the chunk is sent rather than acknowledged:
+                // the reply to the last one also waits for the server to
+                // store the scan.
+                if (upload->reply == reply && sent > 0 && sent == chunkTotal) sampleThroughput(upload);
+            });
+    watch(upload, reply, Step::Chunk);
+}
+
+void ChunkedUploader::queryStatus(const UploadPtr& upload) {
+    watch(upload, m_manager->get(makeRequest("/" + upload->uploadId)), Step::Status);
+}
+
+void ChunkedUploader::watch(const UploadPtr& upload, QNetworkReply* reply, Step step) {
+    upload->reply = reply;
+    connect(reply, &QNetworkReply::finished, this, [this, upload, reply, step]() {
+        reply->deleteLater();
+        if (upload->reply == reply) upload->reply = nullptr;
+        if (isCurrent(upload)) handleReply(upload, reply, step);
+    });
+}
+
+void ChunkedUploader::handleReply(const UploadPtr& upload, QNetworkReply* reply, Step step) {
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QJsonObject body = QJsonDocument::fromJson(reply->readAll()).object();
+
+    if (status == 0) {
+        // No HTTP response at all: dropped connection, timeout, DNS...
+        retry(upload, reply->errorString());
+        return;
+    }
+
+    if (status >= 200 && status < 300) {
+        upload->failures = 0;
+        upload->backoff.reset();
+        if (step == Step::Create) {
+            upload->uploadId = body["uploadId"].toString();
+            if (upload->uploadId.isEmpty()) {
+                fail(upload, tr("Invalid server response"));
+                return;
+            }
+        }
+        if (applySession(upload, body)) {
+            finish(upload, body["result"].toObject());
+        } else if (status == 202) {
+            // Everything arrived and the server is still storing it (this
+            // was a retry of the final chunk); ask again when it says to.
+            const int delayMs = qBound(kMinFinalizeWaitMs, reply->rawHeader("Retry-After").toInt() * 1000,
+                                       kMaxFinalizeWaitMs);
+            QTimer::singleShot(delayMs, this, [this, upload]() {
+                if (isCurrent(upload)) queryStatus(upload);
+            });
+        } else {
+            sendChunk(upload);
+        }
+        return;
+    }
+
+    const QString error = body["error"].toString(reply->errorString());
+    switch (status) {
+    case 409: {
+        // Out of step with the server (e.g. a chunk arrived but its
+        // acknowledgement did not): continue from where it is. A conflict
+        // that does not move the offset would only repeat, so it backs off
+        // and counts as a failed attempt.
+        const qint64 offset = qBound<qint64>(0, body["offset"].toInteger(upload->offset), upload->data.size());
+        if (body.contains("offset") && offset != upload->offset) {
+            upload->offset = offset;
+            sendChunk(upload);
+        } else {
+            retry(upload, error);
+        }
+        return;
+    }
+    case 404:
+    case 422:
+        // Session expired, or the data did not add up: start over
+        if (step != Step::Create) {
+            qWarning() << "Upload session for garment" << upload->garmentId << "lost:" << error;
+            upload->uploadId.clear();
+            upload->offset = 0;
+            retry(upload, error);
+            return;
+        }
+        break;
+    case 408:
+    case 429:
+        retry(upload, error);
+        return;
+    default:
+        if (status >= 500) {
+            retry(upload, error);
+            return;
+        }
+        break;
+    }
+    fail(upload, error);
+}
+
+bool ChunkedUploader::applySession(const UploadPtr& upload, const QJsonObject& session) {
+    if (session.contains("chunkSize")) {
+        upload->chunkSize = qMax(1, session["chunkSize"].toInt());
+    }
+    if (upload->chunkSize <= 0) upload->chunkSize = m_chunkSize;
+    if (session.contains("offset")) {
+        upload->offset = qBound<qint64>(0, session["offset"].toInteger(), upload->data.size());
+    }
+    emit progressChanged(upload->garmentId, upload->offset, upload->data.size());
+    return session["complete"].toBool();
+}
+
+void ChunkedUploader::sampleThroughput(const UploadPtr& upload) {
+    // Once per chunk
+    const qint64 bytes = std::exchange(upload->chunkBytes, 0);
+    if (bytes < kMinThroughputSampleBytes) return;
+    const double seconds = qMax<qint64>(1, upload->chunkTimer.elapsed()) / 1000.0;
+    const double sample = bytes / seconds;
+    m_throughput = m_throughput > 0.0 ? m_throughput + kThroughputSmoothing * (sample - m_throughput)
+                                      : sample;
+    emit throughputChanged(m_throughput);
+}
+
+void ChunkedUploader::retry(const UploadPtr& upload, const QString& reason) {
+    if (++upload->failures >= m_maxAttempts) {
+        fail(upload, reason);
+        return;
+    }
+
+    const int delayMs = upload->backoff.nextDelayMs();
+    qDebug() << "Chunked upload for garment" << upload->garmentId << "interrupted at"
+             << upload->offset << "/" << upload->data.size() << "(" << reason << "), retrying in"
+             << delayMs << "ms";
+
+    QTimer::singleShot(delayMs, this, [this, upload]() {
+        if (!isCurrent(upload)) return;
+        // Without a session there is nothing to resume; otherwise ask the
+        // server how much of the data it already has.
+        if (upload->uploadId.isEmpty()) {
+            createSession(upload);
+        } else {
+            queryStatus(upload);
+        }
+    });
+}
+
+void ChunkedUploader::finish(const UploadPtr& upload, const QJsonObject& result) {
+    m_uploads.remove(upload->garmentId);
+    qDebug() << "Chunked upload complete for garment" << upload->garmentId
+             << "(" << upload->data.size() << "bytes )";
+    emit uploadFinished(upload->garmentId, result);
+}
+
+void ChunkedUploader::fail(const UploadPtr& upload, const QString& error) {
+    m_uploads.remove(upload->garmentId);
+    qWarning() << "Chunked upload failed for garment" << upload->garmentId << ":" << error;
+    emit uploadFailed(upload->garmentId, error);
+}
@@ -0,0 +1,118 @@
+#pragma once
+#ifndef CHUNKEDUPLOADER_H
+#define CHUNKEDUPLOADER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QString>
+#include <functional>
+#include <memory>
+#include "RetryBackoff.h"
+
+// Resumable uploads through the server's chunked upload sessions
+// (<server>/uploads). An upload opens a session, then PUTs fixed-size chunks
+// tagged with their Upload-Offset. When a chunk fails (dropped connection,
+// timeout, 5xx) the uploader backs off, asks the server how much it actually
+// has and resumes from there, so a flaky link costs at most one chunk rather
+// than the whole image. The server answers an out-of-step offset with 409
+// and the offset to use, which also covers chunks whose acknowledgement was
+// lost, and a finished upload it is still storing with 202. Each garment
+// has at most one upload in flight; starting another one for the same
+// garment replaces it.
+class ChunkedUploader : public QObject {
+    Q_OBJECT
+
+public:
+    // Builds an (authenticated) request for the given URL.
+    using RequestFactory = std::function<QNetworkRequest(const QUrl&)>;
+
+    ChunkedUploader(QNetworkAccessManager* manager, RequestFactory requestFactory,
+                    QObject* parent = nullptr);
+    ~ChunkedUploader();
+
+    void setServerUrl(const QString& url) { m_serverUrl = url; }
+
+    // Requested chunk size; the server may lower it per session.
+    void setChunkSize(int bytes) { m_chunkSize = qMax(16 * 1024, bytes); }
+    int chunkSize() const { return m_chunkSize; }
+
+    // Consecutive failed requests before an upload is given up.
+    void setMaxAttempts(int attempts) { m_maxAttempts = qMax(1, attempts); }
+    // A chunk that makes no progress for this long counts as failed.
+    void setTransferTimeoutMs(int timeoutMs) { m_transferTimeoutMs = qMax(1000, timeoutMs); }
+
+    void upload(const QByteArray& data, const QString& contentType,
+                const QString& garmentId, const QString& category);
+    void cancel(const QString& garmentId);
+    bool isUploading(const QString& garmentId) const { return m_uploads.contains(garmentId); }
+
+    // Smoothed send rate of whole chunks in bytes per second, each timed
+    // from its request until all of it is sent; 0 until the first chunk has
+    // gone out.
+    double throughput() const { return m_throughput; }
+
+signals:
+    void progressChanged(const QString& garmentId, qint64 bytesSent, qint64 bytesTotal);
+    // `result` is the stored scan as returned by the server.
+    void uploadFinished(const QString& garmentId, const QJsonObject& result);
+    void uploadFailed(const QString& garmentId, const QString& error);
+    void throughputChanged(double bytesPerSecond);
+
+private:
+    struct Upload {
+        QString garmentId;
+        QString category;
+        QString contentType;
+        QByteArray data;
+        QByteArray sha256;
+
+        QString uploadId;
+        qint64 offset = 0;
+        int chunkSize = 0;
+
+        QElapsedTimer chunkTimer;
+        qint64 chunkBytes = 0;
+
+        RetryBackoff backoff{500, 15000, 2.0, 0.25};
+        int failures = 0;
+        QPointer<QNetworkReply> reply;
+    };
+    using UploadPtr = std::shared_ptr<Upload>;
+
+    enum class Step { Create, Chunk, Status };
+
+    void createSession(const UploadPtr& upload);
+    void sendChunk(const UploadPtr& upload);
+    void queryStatus(const UploadPtr& upload);
+    void watch(const UploadPtr& upload, QNetworkReply* reply, Step step);
+    void handleReply(const UploadPtr& upload, QNetworkReply* reply, Step step);
+    // Updates offset / chunk size from a session object; true when complete
+    bool applySession(const UploadPtr& upload, const QJsonObject& session);
+    void sampleThroughput(const UploadPtr& upload);
+    void retry(const UploadPtr& upload, const QString& reason);
+    void finish(const UploadPtr& upload, const QJsonObject& result);
+    void fail(const UploadPtr& upload, const QString& error);
+    bool isCurrent(const UploadPtr& upload) const;
+
+    QNetworkRequest makeRequest(const QString& path) const;
+
+    QNetworkAccessManager* m_manager;
+    RequestFactory m_requestFactory;
+    QString m_serverUrl;
+
+    QHash<QString, UploadPtr> m_uploads;
+
+    int m_chunkSize = 256 * 1024;
+    int m_maxAttempts = 8;
+    int m_transferTimeoutMs = 20000;
+    double m_throughput = 0.0;
+};
+
+#endif // CHUNKEDUPLOADER_H
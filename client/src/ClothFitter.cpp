@@ -1,12 +1,493 @@
 #include "ClothFitter.h"
 #include "CommonTypes.h"
+#include "MeshCooker.h"
+#include "MeshSimplifier.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSemaphore>
+#include <algorithm>
+#include <cmath>
 
-ClothFitter::ClothFitter() = default;
+namespace {
+// Keypoints below this confidence do not move their bones.
+constexpr float kMinConfidence = 0.3f;
+// Garments smaller than this are skinned on the calling thread; above it
+// the work is split into per-core chunks of whole SIMD blocks.
+constexpr size_t kParallelVertexThreshold = 16384;
+constexpr size_t kChunkAlignment = 64;
+// Initial fit: the garment spans this multiple of the shoulder width.
+constexpr float kShoulderWidthToGarment = 1.4f;
+// LOD chain: levels stop halving below this many triangles.
+constexpr size_t kMinLodTriangles = 1000;
+constexpr int kMaxLodLevels = 4;
 
-bool ClothFitter::loadClothModel(const std::string& filePath) {
-    return true; // Temporary
+CookedMesh toCookedMesh(const MeshFile& file) {
+    CookedMesh mesh;
+    const size_t count = file.vertexCount();
+    auto copyStream = [&](MeshFormat::Stream stream, std::vector<float>& out) {
+        if (const float* data = file.stream(stream)) out.assign(data, data + count);
+    };
+    copyStream(MeshFormat::PositionX, mesh.px);
+    copyStream(MeshFormat::PositionY, mesh.py);
+    copyStream(MeshFormat::PositionZ, mesh.pz);
+    copyStream(MeshFormat::NormalX, mesh.nx);
+    copyStream(MeshFormat::NormalY, mesh.ny);
+    copyStream(MeshFormat::NormalZ, mesh.nz);
+    copyStream(MeshFormat::TexCoordU, mesh.u);
+    copyStream(MeshFormat::TexCoordV, mesh.v);
+    mesh.indices.assign(file.indices(), file.indices() + file.indexCount());
+    std::copy(file.boundsMin(), file.boundsMin() + 3, mesh.boundsMin);
+    std::copy(file.boundsMax(), file.boundsMax() + 3, mesh.boundsMax);
+    return mesh;
 }
 
-void ClothFitter::updateTransformation(const std::vector<BodyKeypoint>& keypoints) {
-    // Implementation
-}
\ No newline at end of file
+std::shared_ptr<ClothFitter::SkinnedStreams> makeSkinnedStreams(size_t count) {
+    auto skinned = std::make_shared<ClothFitter::SkinnedStreams>();
+    for (auto* stream : {&skinned->px, &skinned->py, &skinned->pz,
+                         &skinned->nx, &skinned->ny, &skinned->nz}) {
+        stream->assign(count, 0.0f);
+    }
+    return skinned;
+}
+}
+
+ClothFitter::ClothFitter()
+    : m_kernel(Skinning::bestKernel())
+{
+    m_pool.setObjectName("ClothSkinningPool");
+    m_worker.setObjectName("ClothLodWorker");
+    m_worker.setMaxThreadCount(1);
+    qDebug() << "Cloth skinning kernel:" << Skinning::kernelName(m_kernel);
+}
+
+ClothFitter::~ClothFitter() {
+    // Queued weights are of no use any more; a chain being built is still
+    // written out for the next load.
+    m_worker.clear();
+    m_worker.waitForDone();
+    m_pool.waitForDone();
+}
+
+const std::vector<ClothFitter::Bone>& ClothFitter::skeleton() {
+    static const std::vector<Bone> bones = {
+        {LeftShoulder, RightShoulder},
+        {LeftShoulder, LeftHip},
+        {RightShoulder, RightHip},
+        {LeftHip, RightHip},
+        {LeftShoulder, LeftElbow},
+        {LeftElbow, LeftWrist},
+        {RightShoulder, RightElbow},
+        {RightElbow, RightWrist},
+        {LeftHip, LeftKnee},
+        {LeftKnee, LeftAnkle},
+        {RightHip, RightKnee},
+        {RightKnee, RightAnkle},
+    };
+    return bones;
+}
+
+void ClothFitter::setSkinningKernel(Skinning::Kernel kernel) {
+    m_kernel = Skinning::isAvailable(kernel) ? kernel : Skinning::Kernel::Scalar;
+}
+
+bool ClothFitter::loadClothModel(const std::string& filePath, std::string* error) {
+    QElapsedTimer timer;
+    timer.start();
+
+    std::string cookedPath = filePath;
+    if (!MeshFile::isCookedPath(filePath)) {
+        cookedPath = MeshCooker::cookedPathFor(filePath);
+        const QFileInfo source(QString::fromStdString(filePath));
+        const QFileInfo cooked(QString::fromStdString(cookedPath));
+        if (!cooked.exists() || cooked.lastModified() < source.lastModified()) {
+            std::string cookError;
+            if (!MeshCooker::cookFile(filePath, cookedPath, &cookError)) {
+                qWarning() << "Failed to cook cloth model:" << QString::fromStdString(cookError);
+                if (error) *error = cookError;
+                return false;
+            }
+            qDebug() << "Cooked cloth model in" << timer.elapsed() << "ms";
+        }
+    }
+
+    std::vector<LodLevel> levels;
+    if (!loadLods(cookedPath, levels, error)) return false;
+
+    qDebug() << "Loaded cloth model" << QString::fromStdString(cookedPath)
+             << levels[0].mesh->vertexCount() << "vertices," << levels[0].mesh->indexCount() / 3 << "triangles,"
+             << levels.size() << "levels of detail in" << timer.elapsed() << "ms";
+    m_lods = std::move(levels);
+    m_lod = 0;
+    m_background = std::make_shared<Background>();
+    if (m_lods.size() == 1 && m_lods[0].mesh->indexCount() / 3 / 2 >= kMinLodTriangles) {
+        buildLodChain(cookedPath);
+    }
+
+    // The new mesh is fitted to the next tracked pose.
+    m_bound = false;
+    return true;
+}
+
+bool ClothFitter::openLevel(const std::string& path, std::vector<LodLevel>& levels, std::string* error) {
+    auto mesh = std::make_shared<MeshFile>();
+    std::string openError;
+    if (!mesh->open(path, &openError)) {
+        qWarning() << "Failed to load cloth model:" << QString::fromStdString(openError);
+        if (error) *error = openError;
+        return false;
+    }
+    LodLevel level;
+    level.skinned = makeSkinnedStreams(mesh->vertexCount());
+    level.mesh = std::move(mesh);
+    levels.push_back(std::move(level));
+    return true;
+}
+
+bool ClothFitter::loadLods(const std::string& cookedPath, std::vector<LodLevel>& levels, std::string* error) {
+    if (!openLevel(cookedPath, levels, error)) return false;
+
+    // Reuse levels cooked from this base file
+    const QDateTime baseModified = QFileInfo(QString::fromStdString(cookedPath)).lastModified();
+    for (int level = 1; level <= kMaxLodLevels; ++level) {
+        const std::string path = MeshSimplifier::lodPathFor(cookedPath, level);
+        const QFileInfo info(QString::fromStdString(path));
+        if (!info.exists() || info.lastModified() < baseModified || !openLevel(path, levels)) break;
+    }
+    return true;
+}
+
+// Simplifying a dense garment takes far longer than a frame, so the chain is
+// built, cooked and mapped on the worker; until then only the base level is
+// there to skin.
+void ClothFitter::buildLodChain(const std::string& cookedPath) {
+    m_worker.start([background = m_background, base = m_lods[0].mesh, cookedPath]() {
+        QElapsedTimer timer;
+        timer.start();
+        std::vector<LodLevel> levels;
+        const std::vector<CookedMesh> chain =
+            MeshSimplifier::buildLodChain(toCookedMesh(*base), kMinLodTriangles, kMaxLodLevels);
+        for (size_t i = 0; i < chain.size(); ++i) {
+            const std::string path = MeshSimplifier::lodPathFor(cookedPath, int(i + 1));
+            std::string error;
+            if (!MeshCooker::write(chain[i], path, &error)) {
+                // The base level alone is still usable
+                qWarning() << "Failed to write cloth LOD:" << QString::fromStdString(error);
+                break;
+            }
+            if (!openLevel(path, levels)) break;
+        }
+        // Drop leftovers of a longer chain cooked from an older base
+        for (int level = int(levels.size()) + 1; level <= kMaxLodLevels; ++level) {
+            QFile::remove(QString::fromStdString(MeshSimplifier::lodPathFor(cookedPath, level)));
+        }
+        qDebug() << "Built" << levels.size() << "cloth LODs in" << timer.elapsed() << "ms";
+
+        std::lock_guard<std::mutex> lock(background->mutex);
+        background->chain = std::move(levels);
+        background->ready = true;
+    });
+}
+
+// Weights every level that has none yet against a copy of the bind state,
+// finest first, publishing each level as it is done.
+void ClothFitter::weighLevels() {
+    std::vector<std::pair<size_t, std::shared_ptr<const MeshFile>>> pending;
+    for (size_t i = 0; i < m_lods.size(); ++i) {
+        if (!m_lods[i].weighted) pending.emplace_back(i, m_lods[i].mesh);
+    }
+    if (pending.empty()) return;
+
+    m_worker.start([background = m_background, bind = m_bind, pending = std::move(pending)]() {
+        for (const auto& [index, mesh] : pending) {
+            QElapsedTimer timer;
+            timer.start();
+            Weights weights;
+            computeWeights(*mesh, bind, weights);
+            qDebug() << "Weighted cloth LOD" << index << "in" << timer.elapsed() << "ms";
+
+            std::lock_guard<std::mutex> lock(background->mutex);
+            background->weights.emplace_back(index, std::move(weights));
+            background->ready = true;
+        }
+    });
+}
+
+bool ClothFitter::pollBackgroundWork() {
+    if (!m_background || !m_background->ready.exchange(false)) return false;
+
+    std::vector<LodLevel> chain;
+    std::vector<std::pair<size_t, Weights>> weights;
+    {
+        std::lock_guard<std::mutex> lock(m_background->mutex);
+        chain.swap(m_background->chain);
+        weights.swap(m_background->weights);
+    }
+    for (auto& [index, levelWeights] : weights) {
+        if (index >= m_lods.size()) continue;
+        m_lods[index].weights = std::move(levelWeights);
+        m_lods[index].weighted = true;
+    }
+    if (chain.empty()) return false;
+
+    for (LodLevel& level : chain) {
+        m_lods.push_back(std::move(level));
+    }
+    if (m_bound) weighLevels();
+    return true;
+}
+
+void ClothFitter::waitForBackgroundWork() {
+    // Taking over a chain after binding queues weights for its levels
+    do {
+        m_worker.waitForDone();
+    } while (pollBackgroundWork());
+}
+
+const MeshFile* ClothFitter::clothMesh() const {
+    return m_lods.empty() ? nullptr : m_lods[m_lod].mesh.get();
+}
+
+const ClothFitter::SkinnedStreams& ClothFitter::skinnedMesh() const {
+    static const SkinnedStreams empty;
+    return m_lods.empty() ? empty : *m_lods[m_lod].skinned;
+}
+
+std::shared_ptr<const MeshFile> ClothFitter::sharedClothMesh() const {
+    return m_lods.empty() ? nullptr : m_lods[m_lod].mesh;
+}
+
+std::shared_ptr<const ClothFitter::SkinnedStreams> ClothFitter::sharedSkinnedMesh() const {
+    return m_lods.empty() ? nullptr : m_lods[m_lod].skinned;
+}
+
+size_t ClothFitter::lodTriangleCount(size_t level) const {
+    return level < m_lods.size() ? m_lods[level].mesh->indexCount() / 3 : 0;
+}
+
+size_t ClothFitter::lodVertexCount(size_t level) const {
+    return level < m_lods.size() ? m_lods[level].mesh->vertexCount() : 0;
+}
+
+bool ClothFitter::setLod(size_t level) {
+    if (m_lods.empty()) return false;
+    level = std::min(level, m_lods.size() - 1);
+    if (level == m_lod) return false;
+
+    // Still being weighted on the worker
+    if (m_bound && !m_lods[level].weighted) return false;
+
+    m_lod = level;
+    if (m_bound) {
+        // Fill the new streams with the current pose straight away
+        runSkinning();
+    }
+    return true;
+}
+
+bool ClothFitter::skinnedBounds(float min[2], float max[2]) const {
+    if (!m_bound || m_lods.empty()) return false;
+
+    // Every 16th vertex is plenty for a screen-size estimate
+    const SkinnedStreams& skinned = *m_lods[m_lod].skinned;
+    const size_t count = skinned.px.size();
+    if (count == 0) return false;
+    const size_t step = count > 1024 ? 16 : 1;
+    min[0] = max[0] = skinned.px[0];
+    min[1] = max[1] = skinned.py[0];
+    for (size_t i = 0; i < count; i += step) {
+        min[0] = std::min(min[0], skinned.px[i]); max[0] = std::max(max[0], skinned.px[i]);
+        min[1] = std::min(min[1], skinned.py[i]); max[1] = std::max(max[1], skinned.py[i]);
+    }
+    return true;
+}
+
+bool ClothFitter::updateTransformation(const PoseKeypoints& keypoints) {
+    if (m_lods.empty()) return false;
+
+    if (!m_bound && !bind(keypoints)) return false;
+    if (!updateBones(keypoints)) return false;
+    runSkinning();
+    return true;
+}
+
+bool ClothFitter::bind(const PoseKeypoints& keypoints) {
+    for (const Bone& bone : skeleton()) {
+        if (keypoints[bone.from].confidence < kMinConfidence || keypoints[bone.to].confidence < kMinConfidence) {
+            // Wait for a pose where the whole skeleton is visible.
+            return false;
+        }
+    }
+
+    const BodyKeypoint& left = keypoints[LeftShoulder];
+    const BodyKeypoint& right = keypoints[RightShoulder];
+    const float shoulderWidth = std::hypot(left.x - right.x, left.y - right.y);
+    // Fitted on the full mesh so every level lands in the same place
+    const float* boundsMin = m_lods[0].mesh->boundsMin();
+    const float* boundsMax = m_lods[0].mesh->boundsMax();
+    const float meshWidth = boundsMax[0] - boundsMin[0];
+    if (shoulderWidth <= 0.0f || meshWidth <= 0.0f) return false;
+
+    // Uniform scale (plus a y flip into image space) so normals stay valid:
+    // centre the garment between the shoulders with its top on the
+    // shoulder line.
+    const float scale = kShoulderWidthToGarment * shoulderWidth / meshWidth;
+    const float centreX = 0.5f * (left.x + right.x);
+    const float topY = std::min(left.y, right.y);
+    m_bind.meshScale[0] = scale;
+    m_bind.meshScale[1] = -scale;
+    m_bind.meshScale[2] = scale;
+    m_bind.meshOffset[0] = centreX - scale * 0.5f * (boundsMin[0] + boundsMax[0]);
+    m_bind.meshOffset[1] = topY + scale * boundsMax[1];
+    m_bind.meshOffset[2] = -scale * 0.5f * (boundsMin[2] + boundsMax[2]);
+
+    m_bind.segments.clear();
+    for (const Bone& bone : skeleton()) {
+        m_bind.segments.push_back({keypoints[bone.from].x, keypoints[bone.from].y,
+                                   keypoints[bone.to].x, keypoints[bone.to].y});
+    }
+    m_bones.assign(skeleton().size(), Skinning::BoneMatrix{});
+
+    // The active level is needed for this very frame; the others follow on
+    // the worker.
+    for (LodLevel& level : m_lods) {
+        level.weighted = false;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    LodLevel& active = m_lods[m_lod];
+    computeWeights(*active.mesh, m_bind, active.weights);
+    active.weighted = true;
+    qDebug() << "Bound cloth mesh to" << m_bind.segments.size() << "bones in" << timer.elapsed() << "ms";
+
+    m_bound = true;
+    weighLevels();
+    return true;
+}
+
+void ClothFitter::computeWeights(const MeshFile& mesh, const BindState& bind, Weights& weights) {
+    const size_t count = mesh.vertexCount();
+    const float* px = mesh.stream(MeshFormat::PositionX);
+    const float* py = mesh.stream(MeshFormat::PositionY);
+    for (int j = 0; j < Skinning::kMaxInfluences; ++j) {
+        weights.boneIndex[j].assign(count, 0);
+        weights.boneWeight[j].assign(count, 0.0f);
+    }
+
+    // Inverse squared distance to the nearest bones, in bind space.
+    constexpr float kFalloff = 0.02f * 0.02f;
+    const size_t boneCount = bind.segments.size();
+    std::vector<std::pair<float, uint16_t>> distances(boneCount);
+    for (size_t i = 0; i < count; ++i) {
+        const float x = bind.meshScale[0] * px[i] + bind.meshOffset[0];
+        const float y = bind.meshScale[1] * py[i] + bind.meshOffset[1];
+
+        for (size_t b = 0; b < boneCount; ++b) {
+            const Segment& s = bind.segments[b];
+            const float dx = s.bx - s.ax, dy = s.by - s.ay;
+            const float lengthSq = dx * dx + dy * dy;
+            const float t = lengthSq > 0.0f
+                ? std::clamp(((x - s.ax) * dx + (y - s.ay) * dy) / lengthSq, 0.0f, 1.0f) : 0.0f;
+            const float ex = x - (s.ax + t * dx), ey = y - (s.ay + t * dy);
+            distances[b] = {ex * ex + ey * ey, uint16_t(b)};
+        }
+
+        const size_t influences = std::min<size_t>(Skinning::kMaxInfluences, boneCount);
+        std::partial_sort(distances.begin(), distances.begin() + influences, distances.end());
+
+        float total = 0.0f;
+        for (size_t j = 0; j < influences; ++j) {
+            total += 1.0f / (distances[j].first + kFalloff);
+        }
+        for (size_t j = 0; j < influences; ++j) {
+            weights.boneIndex[j][i] = distances[j].second;
+            weights.boneWeight[j][i] = (1.0f / (distances[j].first + kFalloff)) / total;
+        }
+    }
+}
+
+bool ClothFitter::updateBones(const PoseKeypoints& keypoints) {
+    const std::vector<Bone>& bones = skeleton();
+    bool moved = false;
+
+    for (size_t b = 0; b < bones.size(); ++b) {
+        const BodyKeypoint& from = keypoints[bones[b].from];
+        const BodyKeypoint& to = keypoints[bones[b].to];
+        if (from.confidence < kMinConfidence || to.confidence < kMinConfidence) {
+            // Keep the last good transform for occluded limbs.
+            continue;
+        }
+
+        // Similarity transform taking the bind segment onto the current one.
+        const Segment& bind = m_bind.segments[b];
+        const float d0x = bind.bx - bind.ax, d0y = bind.by - bind.ay;
+        const float d1x = to.x - from.x, d1y = to.y - from.y;
+        const float length0 = std::hypot(d0x, d0y);
+        const float length1 = std::hypot(d1x, d1y);
+        const float scale = length0 > 1e-6f ? length1 / length0 : 1.0f;
+        const float angle = std::atan2(d1y, d1x) - std::atan2(d0y, d0x);
+        const float r00 = scale * std::cos(angle), r01 = -scale * std::sin(angle);
+        const float r10 = -r01, r11 = r00;
+
+        // Fold in the mesh -> bind mapping so skinning reads the mapped
+        // mesh streams directly.
+        const float sx = m_bind.meshScale[0], sy = m_bind.meshScale[1], sz = m_bind.meshScale[2];
+        const float ox = m_bind.meshOffset[0] - bind.ax, oy = m_bind.meshOffset[1] - bind.ay;
+        m_bones[b] = {{r00 * sx, r01 * sy, 0.0f, r00 * ox + r01 * oy + from.x,
+                       r10 * sx, r11 * sy, 0.0f, r10 * ox + r11 * oy + from.y,
+                       0.0f, 0.0f, scale * sz, scale * m_bind.meshOffset[2]}};
+        moved = true;
+    }
+    return moved;
+}
+
+void ClothFitter::runSkinning() {
+    LodLevel& level = m_lods[m_lod];
+    const MeshFile& mesh = *level.mesh;
+    Skinning::Job job;
+    job.vertexCount = mesh.vertexCount();
+    job.px = mesh.stream(MeshFormat::PositionX);
+    job.py = mesh.stream(MeshFormat::PositionY);
+    job.pz = mesh.stream(MeshFormat::PositionZ);
+    job.nx = mesh.stream(MeshFormat::NormalX);
+    job.ny = mesh.stream(MeshFormat::NormalY);
+    job.nz = mesh.stream(MeshFormat::NormalZ);
+    for (int j = 0; j < Skinning::kMaxInfluences; ++j) {
+        job.boneIndex[j] = level.weights.boneIndex[j].data();
+        job.boneWeight[j] = level.weights.boneWeight[j].data();
+    }
+    job.bones = m_bones.data();
+    job.boneCount = m_bones.size();
+    SkinnedStreams& out = *level.skinned;
+    job.outPx = out.px.data();
+    job.outPy = out.py.data();
+    job.outPz = out.pz.data();
+    job.outNx = out.nx.data();
+    job.outNy = out.ny.data();
+    job.outNz = out.nz.data();
+
+    const size_t count = job.vertexCount;
+    const int threads = qMax(1, m_pool.maxThreadCount());
+    if (count < kParallelVertexThreshold || threads == 1) {
+        Skinning::skin(job, 0, count, m_kernel);
+        return;
+    }
+
+    // Chunks are whole SIMD blocks; the calling thread takes the last one.
+    const size_t perThread = (count + threads - 1) / threads;
+    const size_t chunk = (perThread + kChunkAlignment - 1) / kChunkAlignment * kChunkAlignment;
+    QSemaphore done;
+    int started = 0;
+    size_t begin = 0;
+    for (; begin + chunk < count; begin += chunk) {
+        m_pool.start([&job, &done, begin, chunk, this]() {
+            Skinning::skin(job, begin, begin + chunk, m_kernel);
+            done.release();
+        });
+        ++started;
+    }
+    Skinning::skin(job, begin, count, m_kernel);
+    done.acquire(started);
+}
@@ -1,14 +1,133 @@
 #pragma once
 #include "CommonTypes.h"
+#include "MeshFile.h"
+#include "SkinningKernels.h"
+#include <QThreadPool>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 
 class ClothFitter {
 public:
+    // Deformed copy of the cloth mesh, in keypoint (normalised camera) space.
+    struct SkinnedStreams {
+        std::vector<float> px, py, pz;
+        std::vector<float> nx, ny, nz;
+    };
+
     ClothFitter();
-    bool loadClothModel(const std::string &filePath);
-    void updateTransformation(const std::vector<BodyKeypoint> &keypoints);
-    
+    ~ClothFitter();
+
+    // Loads a cooked *.amesh directly, or cooks an OBJ or glTF model next to
+    // itself first (once; later loads map the cooked file). Dense meshes
+    // also get a chain of simplified levels, cooked next to the base file:
+    // levels cooked earlier load with the base, a missing chain is built on
+    // a worker and shows up through pollBackgroundWork(). On failure the
+    // previous mesh stays loaded and `error` says why.
+    bool loadClothModel(const std::string &filePath, std::string* error = nullptr);
+
+    // Takes over levels of detail and skinning weights finished on the
+    // worker. Cheap when there is nothing new; call it from the thread that
+    // drives the fitter. Returns true when levels were added.
+    bool pollBackgroundWork();
+    // Blocks until the worker is idle and takes over its results.
+    void waitForBackgroundWork();
+
+    // Skins the cloth mesh to the given pose. The first complete pose after
+    // loading becomes the bind pose the garment is fitted and weighted to.
+    // Returns true when the skinned streams were rewritten.
+    bool updateTransformation(const PoseKeypoints &keypoints);
+
+    // Active level of detail
+    const MeshFile* clothMesh() const;
+    const SkinnedStreams& skinnedMesh() const;
+
+    // Shared handles for the renderer. Each level has its own pair, so a
+    // holder always sees a topology and streams that match; the streams are
+    // rewritten in place by every updateTransformation().
+    std::shared_ptr<const MeshFile> sharedClothMesh() const;
+    std::shared_ptr<const SkinnedStreams> sharedSkinnedMesh() const;
+    bool isBound() const { return m_bound; }
+
+    // Level 0 is the full mesh; higher levels halve the triangle count.
+    size_t lodCount() const { return m_lods.size(); }
+    size_t lod() const { return m_lod; }
+    size_t lodTriangleCount(size_t level) const;
+    size_t lodVertexCount(size_t level) const;
+    // Switches the skinned level. Once bound, the other levels are weighted
+    // on the worker and a level that is not ready yet is refused, leaving
+    // the current one active. Returns true when the active level changed.
+    bool setLod(size_t level);
+
+    // Extent of the skinned garment in keypoint space, from a sample of
+    // vertices. Returns false until the garment is bound.
+    bool skinnedBounds(float min[2], float max[2]) const;
+
+    Skinning::Kernel skinningKernel() const { return m_kernel; }
+    void setSkinningKernel(Skinning::Kernel kernel);
+
 private:
-    Mesh originalMesh;
+    // A bone is the segment between two tracked keypoints.
+    struct Bone {
+        BodyPart from;
+        BodyPart to;
+    };
+    struct Segment {
+        float ax, ay, bx, by;
+    };
+    // Bind state, rebuilt for every new mesh
+    struct BindState {
+        float meshScale[3] = {1.0f, 1.0f, 1.0f};     // mesh space -> bind space
+        float meshOffset[3] = {0.0f, 0.0f, 0.0f};
+        std::vector<Segment> segments;
+    };
+    struct Weights {
+        std::array<std::vector<uint16_t>, Skinning::kMaxInfluences> boneIndex;
+        std::array<std::vector<float>, Skinning::kMaxInfluences> boneWeight;
+    };
+    // One level of detail: mapped mesh, skinning weights (valid once
+    // `weighted` is set after binding) and output streams.
+    struct LodLevel {
+        std::shared_ptr<MeshFile> mesh;
+        Weights weights;
+        bool weighted = false;
+        std::shared_ptr<SkinnedStreams> skinned;
+    };
+    // Results of the worker jobs for one loaded mesh. Every load starts a
+    // new one, so jobs still running for an older mesh publish into a
+    // result nobody reads.
+    struct Background {
+        std::mutex mutex;
+        std::atomic<bool> ready{false};
+        std::vector<LodLevel> chain;                        // levels 1..n
+        std::vector<std::pair<size_t, Weights>> weights;    // by level
+    };
+
+    bool loadLods(const std::string& cookedPath, std::vector<LodLevel>& levels, std::string* error);
+    static bool openLevel(const std::string& path, std::vector<LodLevel>& levels, std::string* error = nullptr);
+    void buildLodChain(const std::string& cookedPath);
+    void weighLevels();
+    bool bind(const PoseKeypoints& keypoints);
+    static void computeWeights(const MeshFile& mesh, const BindState& bind, Weights& weights);
+    bool updateBones(const PoseKeypoints& keypoints);
+    void runSkinning();
+
+    static const std::vector<Bone>& skeleton();
+
+    std::vector<LodLevel> m_lods;
+    size_t m_lod = 0;
+
+    bool m_bound = false;
+    BindState m_bind;
+
+    std::vector<Skinning::BoneMatrix> m_bones;
+
+    Skinning::Kernel m_kernel;
+    QThreadPool m_pool;
+    // One thread, so the chain is built before its levels are weighted
+    QThreadPool m_worker;
+    std::shared_ptr<Background> m_background;
 };
@@ -1,17 +1,264 @@
 #include "ClothScanner.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <algorithm>
 
-ClothScanner::ClothScanner(QObject* parent) : QObject(parent) {}
+namespace {
+constexpr int kMaxBurstFrames = 60;
+constexpr int kDefaultBurstTimeoutMs = 5000;
+
+// Formats whose plane 0 is a full-resolution 8-bit luma plane
+bool hasLumaPlane(QVideoFrameFormat::PixelFormat format) {
+    switch (format) {
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21:
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YUV422P:
+    case QVideoFrameFormat::Format_YV12:
+    case QVideoFrameFormat::Format_IMC1:
+    case QVideoFrameFormat::Format_IMC2:
+    case QVideoFrameFormat::Format_IMC3:
+    case QVideoFrameFormat::Format_IMC4:
+    case QVideoFrameFormat::Format_Y8:
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+ClothScanner::ClothScanner(QObject* parent) : QObject(parent) {
+    // One worker: frames that arrive while it is busy are skipped, which
+    // keeps scoring at camera rate without building a backlog.
+    m_pool.setMaxThreadCount(1);
+
+    m_timeout.setSingleShot(true);
+    m_timeout.setInterval(kDefaultBurstTimeoutMs);
+    connect(&m_timeout, &QTimer::timeout, this, [this]() {
+        if (!m_scanningActive) return;
+        qDebug() << "Burst timed out after" << m_scoredFrames << "of" << m_burstFrames << "frames";
+        finishBurst();
+    });
+}
+
+ClothScanner::~ClothScanner() {
+    if (m_sinkConnection) {
+        disconnect(m_sinkConnection);
+    }
+    m_remaining = 0;
+    ++m_burst;
+    m_pool.waitForDone();
+}
+
+void ClothScanner::setVideoSink(QVideoSink* sink) {
+    if (m_sink == sink) return;
+
+    if (m_sinkConnection) {
+        disconnect(m_sinkConnection);
+    }
+    m_sink = sink;
+    if (m_sink) {
+        // Direct: onVideoFrame() only hands the frame to the worker, there
+        // is no reason to route every camera frame through the GUI thread.
+        m_sinkConnection = connect(m_sink, &QVideoSink::videoFrameChanged, this,
+                                   [this](const QVideoFrame& frame) { onVideoFrame(frame); },
+                                   Qt::DirectConnection);
+    }
+    emit videoSinkChanged();
+}
 
 bool ClothScanner::captureFromCamera(int cameraID) {
+    Q_UNUSED(cameraID);
+    return startBurst();
+}
+
+bool ClothScanner::startBurst(int frames, int keep) {
+    if (!m_sink) {
+        qWarning() << "Cannot start a burst without a video sink";
+        emit burstFailed(tr("Camera is not ready"));
+        return false;
+    }
+    if (m_scanningActive) cancelBurst();
+
+    frames = qBound(1, frames, kMaxBurstFrames);
+    {
+        QMutexLocker locker(&m_workerMutex);
+        m_workerBurst = m_burst + 1;
+        m_keep = qBound(1, keep, frames);
+        m_best.clear();
+        m_previousView = {};
+    }
+
     m_scanningActive = true;
+    m_burstFrames = frames;
+    m_scoredFrames = 0;
+    m_nextIndex = 0;
+    ++m_burst;
+    // Opens the gate for the camera thread, so it has to come last
+    m_remaining = frames;
+    m_timeout.start();
+
+    qDebug() << "Burst started:" << frames << "frames, keeping" << m_keep
+             << "(" << FrameScoring::kernelName(FrameScoring::bestKernel()) << ")";
+    emit progressUpdated(0);
     return true;
 }
 
-// void ClothScanner::processFrame(const cv::Mat& frame) {
-//     capturedFrames.push_back(frame);
-//     emit progressUpdated(static_cast<int>((capturedFrames.size()/10.0)*100));
-// }
+void ClothScanner::cancelBurst() {
+    if (!m_scanningActive) return;
+
+    m_remaining = 0;
+    ++m_burst;
+    m_timeout.stop();
+    m_scanningActive = false;
+
+    QMutexLocker locker(&m_workerMutex);
+    m_workerBurst = 0;
+    m_best.clear();
+    m_previousView = {};
+}
 
 bool ClothScanner::isScanningActive() const {
     return m_scanningActive;
 }
+
+void ClothScanner::onVideoFrame(const QVideoFrame& frame) {
+    if (m_remaining.load() <= 0 || !frame.isValid()) return;
+
+    // Skip rather than queue while the worker is scoring a frame
+    bool idle = false;
+    if (!m_workerBusy.compare_exchange_strong(idle, true)) return;
+
+    if (m_remaining.fetch_sub(1) <= 0) {
+        m_workerBusy = false;
+        return;
+    }
+
+    const quint64 burst = m_burst.load();
+    const int index = m_nextIndex.fetch_add(1);
+    m_pool.start([this, frame, burst, index]() {
+        scoreFrame(frame, burst, index);
+        m_workerBusy = false;
+    });
+}
+
+void ClothScanner::scoreFrame(const QVideoFrame& frame, quint64 burst, int index) {
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker locker(&m_workerMutex);
+    if (burst != m_workerBurst) return;
+
+    // Score straight off the Y plane of YUV frames; anything else goes
+    // through a grayscale conversion first.
+    QVideoFrame mapped(frame);
+    QImage gray;
+    FrameScoring::LumaView luma;
+    const bool direct = hasLumaPlane(frame.pixelFormat()) && mapped.map(QVideoFrame::ReadOnly);
+    if (direct) {
+        luma.data = mapped.bits(0);
+        luma.width = mapped.width();
+        luma.height = mapped.height();
+        luma.stride = mapped.bytesPerLine(0);
+    } else {
+        gray = frame.toImage().convertToFormat(QImage::Format_Grayscale8);
+        luma.data = gray.constBits();
+        luma.width = gray.width();
+        luma.height = gray.height();
+        luma.stride = int(gray.bytesPerLine());
+    }
+    if (!luma.data) {
+        if (direct) mapped.unmap();
+        qWarning() << "Burst frame" << index << "could not be read";
+        // Let the camera thread take another one in its place
+        ++m_remaining;
+        return;
+    }
+
+    FrameScoring::Score score;
+    score.sharpness = FrameScoring::laplacianVariance(luma);
+    const FrameScoring::LumaView half = FrameScoring::downsample2x(luma, m_currentLuma);
+    score.exposure = FrameScoring::exposureScore(half);
+    score.motion = m_previousView.data ? FrameScoring::meanAbsDifference(half, m_previousView) : 0.0;
+    if (direct) mapped.unmap();
+
+    std::swap(m_currentLuma, m_previousLuma);
+    m_previousView = half;
+    m_previousView.data = m_previousLuma.data();
+
+    // Only frames that make the current top list are converted
+    const double total = score.total();
+    const bool candidate = int(m_best.size()) < m_keep || total > m_best.back().score.total();
+    if (candidate) {
+        Candidate entry;
+        entry.image = frame.toImage();
+        entry.score = score;
+        entry.index = index;
+        if (!entry.image.isNull()) {
+            auto pos = std::find_if(m_best.begin(), m_best.end(), [total](const Candidate& c) {
+                return c.score.total() < total;
+            });
+            m_best.insert(pos, std::move(entry));
+            if (int(m_best.size()) > m_keep) m_best.pop_back();
+        }
+    }
+    locker.unlock();
+
+    qDebug() << "Burst frame" << index << "sharpness" << score.sharpness << "exposure"
+             << score.exposure << "motion" << score.motion << "scored in" << timer.elapsed() << "ms";
+
+    QMetaObject::invokeMethod(this, [this, burst, index, score]() {
+        frameDone(burst, index, score);
+    }, Qt::QueuedConnection);
+}
+
+void ClothScanner::frameDone(quint64 burst, int index, const FrameScoring::Score& score) {
+    if (burst != m_burst || !m_scanningActive) return;
+
+    ++m_scoredFrames;
+    emit frameScored(index, score.sharpness, score.exposure, score.motion);
+    emit progressUpdated(qMin(100, m_scoredFrames * 100 / m_burstFrames));
+
+    if (m_scoredFrames >= m_burstFrames) finishBurst();
+}
+
+void ClothScanner::finishBurst() {
+    // Invalidate anything still in flight for this burst
+    m_remaining = 0;
+    ++m_burst;
+    m_timeout.stop();
+    m_scanningActive = false;
+
+    std::vector<Candidate> best;
+    {
+        QMutexLocker locker(&m_workerMutex);
+        m_workerBurst = 0;
+        best.swap(m_best);
+        m_previousView = {};
+    }
+
+    if (best.empty()) {
+        emit burstFailed(tr("No camera frames received"));
+        return;
+    }
+
+    const Candidate& top = best.front();
+    qDebug() << "Burst finished:" << m_scoredFrames << "frames scored, best is frame" << top.index
+             << "sharpness" << top.score.sharpness << "exposure" << top.score.exposure
+             << "motion" << top.score.motion;
+
+    if (top.score.sharpness < m_minSharpness) {
+        emit burstFailed(tr("The scan is too blurry. Hold the camera still and try again."));
+        return;
+    }
+    if (top.score.exposure < m_minExposure) {
+        emit burstFailed(tr("The garment is too dark or too bright. Adjust the lighting and try again."));
+        return;
+    }
+
+    QList<QImage> frames;
+    frames.reserve(int(best.size()));
+    for (const Candidate& c : best) frames.append(c.image);
+    emit burstCompleted(frames, top.score.sharpness);
+}
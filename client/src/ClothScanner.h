@@ -1,20 +1,107 @@
 #pragma once
+#ifndef CLOTHSCANNER_H
+#define CLOTHSCANNER_H
+
+#include "FrameScorer.h"
+#include <QImage>
+#include <QList>
+#include <QMutex>
 #include <QObject>
-// #include <opencv2/core.hpp>
-#include <vector>  
+#include <QPointer>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVideoFrame>
+#include <QVideoSink>
+#include <atomic>
+#include <vector>
 
+// Burst capture for garment scans. Instead of uploading whatever single
+// still the user happened to take, the scanner scores the next N preview
+// frames from a QVideoSink for sharpness, exposure and motion
+// (FrameScoring) and hands back only the best ones; a burst whose best
+// frame is still too blurry or badly exposed fails rather than costing a
+// server reconstruction that will not work.
+//
+// Frames are scored on a single worker thread at camera rate. While the
+// worker is busy, new frames are skipped rather than queued, so a slow
+// device simply samples the burst more sparsely. Only frames that make the
+// current top list are converted to QImage.
 class ClothScanner : public QObject {
     Q_OBJECT
 public:
     ClothScanner(QObject* parent = nullptr);
+    ~ClothScanner();
+
+    // Starts a burst with the default settings on the current video sink;
+    // the camera itself is chosen by the capture session.
     bool captureFromCamera(int cameraID);
-    // void processFrame(const cv::Mat &frame);
     bool isScanningActive() const;
 
+    QVideoSink* videoSink() const { return m_sink; }
+    void setVideoSink(QVideoSink* sink);
+
+    // Scores the next `frames` camera frames and keeps the best `keep`.
+    bool startBurst(int frames = 12, int keep = 1);
+    void cancelBurst();
+
+    // Quality gate for the best frame (Laplacian variance on full-resolution
+    // luma, and FrameScoring::exposureScore).
+    void setMinSharpness(double sharpness) { m_minSharpness = sharpness; }
+    void setMinExposure(double exposure) { m_minExposure = exposure; }
+    // A burst that has not seen enough frames by then completes with what
+    // it has.
+    void setBurstTimeoutMs(int timeoutMs) { m_timeout.setInterval(timeoutMs); }
+
 signals:
+    void videoSinkChanged();
     void progressUpdated(int percent);
+    void frameScored(int index, double sharpness, double exposure, double motion);
+    // Best first.
+    void burstCompleted(const QList<QImage>& frames, double bestSharpness);
+    void burstFailed(const QString& reason);
 
 private:
+    struct Candidate {
+        QImage image;
+        FrameScoring::Score score;
+        int index = 0;
+    };
+
+    // Camera thread
+    void onVideoFrame(const QVideoFrame& frame);
+    // Worker thread
+    void scoreFrame(const QVideoFrame& frame, quint64 burst, int index);
+    // GUI thread
+    void frameDone(quint64 burst, int index, const FrameScoring::Score& score);
+    void finishBurst();
+
+    QPointer<QVideoSink> m_sink;
+    QMetaObject::Connection m_sinkConnection;
+    QThreadPool m_pool;
+    QTimer m_timeout;
+
+    // Shared with the camera thread
+    std::atomic<quint64> m_burst{0};
+    std::atomic<int> m_remaining{0};
+    std::atomic<int> m_nextIndex{0};
+    std::atomic<bool> m_workerBusy{false};
+
+    // GUI thread
     bool m_scanningActive = false;
-    // std::vector<cv::Mat> capturedFrames;
+    int m_burstFrames = 0;
+    int m_scoredFrames = 0;
+    double m_minSharpness = 25.0;
+    double m_minExposure = 0.25;
+
+    // Worker state, guarded so a timed-out burst can be finished from the
+    // GUI thread
+    QMutex m_workerMutex;
+    quint64 m_workerBurst = 0;
+    int m_keep = 1;
+    std::vector<Candidate> m_best;
+    std::vector<uint8_t> m_previousLuma;
+    std::vector<uint8_t> m_currentLuma;
+    FrameScoring::LumaView m_previousView;
 };
+
+#endif // CLOTHSCANNER_H
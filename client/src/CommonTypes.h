@@ -1,5 +1,7 @@
 // CommonTypes.h
 #pragma once
+#include <array>
+#include <cstdint>
 #include <vector>  // Add vector include
 
 struct BodyKeypoint {
@@ -17,4 +19,36 @@ struct Vertex {
 struct Mesh {
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
-};
\ No newline at end of file
+};
+
+// Keypoint order produced by the body tracker (COCO 17-point layout).
+// Coordinates are normalised to the camera frame, y pointing down.
+enum BodyPart {
+    Nose,
+    LeftEye,
+    RightEye,
+    LeftEar,
+    RightEar,
+    LeftShoulder,
+    RightShoulder,
+    LeftElbow,
+    RightElbow,
+    LeftWrist,
+    RightWrist,
+    LeftHip,
+    RightHip,
+    LeftKnee,
+    RightKnee,
+    LeftAnkle,
+    RightAnkle,
+    BodyPartCount
+};
+
+using PoseKeypoints = std::array<BodyKeypoint, BodyPartCount>;
+
+// One tracked pose, published by BodyTracker without heap allocation.
+struct PoseSnapshot {
+    PoseKeypoints keypoints{};
+    uint64_t frameNumber = 0;   // 0 until the first pose is published
+    int64_t captureNs = 0;      // steady-clock arrival time of the source frame
+};
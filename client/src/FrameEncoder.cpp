@@ -0,0 +1,114 @@
+#include "FrameEncoder.h"
+#include <QDebug>
+#include <QElapsedTimer>
+
+namespace {
+// The budget never drops below what still gives the server a usable scan,
+// nor rises above what a full-quality capture needs anyway.
+constexpr qint64 kMinByteBudget = 96 * 1024;
+constexpr qint64 kMaxByteBudget = 2 * 1024 * 1024;
+}
+
+FrameEncoder::FrameEncoder(QObject* parent)
+    : QObject(parent)
+{
+    // Two workers keep a burst of captures moving without starving the
+    // camera and render threads on mid-range devices.
+    m_pool.setMaxThreadCount(2);
+    m_pool.setObjectName("FrameEncoderPool");
+}
+
+FrameEncoder::~FrameEncoder() {
+    // Workers post results back to this object; make sure none are still
+    // running before it goes away.
+    m_pool.waitForDone();
+}
+
+void FrameEncoder::setMaxQueueDepth(int depth) {
+    m_maxQueueDepth = qMax(1, depth);
+}
+
+void FrameEncoder::setJpegQuality(int quality) {
+    m_options.maxQuality = qBound(1, quality, 100);
+    m_options.minQuality = qMin(m_options.minQuality, m_options.maxQuality);
+}
+
+void FrameEncoder::setTargetLongEdge(int pixels) {
+    m_options.targetLongEdge = qMax(0, pixels);
+}
+
+void FrameEncoder::setUplinkThroughput(double bytesPerSecond) {
+    m_uplinkBytesPerSecond = qMax(0.0, bytesPerSecond);
+    updateByteBudget();
+}
+
+void FrameEncoder::setTargetUploadSeconds(double seconds) {
+    m_targetUploadSeconds = qMax(0.1, seconds);
+    updateByteBudget();
+}
+
+void FrameEncoder::updateByteBudget() {
+    if (m_uplinkBytesPerSecond <= 0.0) {
+        m_options.byteBudget = 0;
+        return;
+    }
+    const qint64 budget = static_cast<qint64>(m_uplinkBytesPerSecond * m_targetUploadSeconds);
+    m_options.byteBudget = qBound(kMinByteBudget, budget, kMaxByteBudget);
+}
+
+bool FrameEncoder::encode(const QImage& frame, const QString& garmentId, const QString& category) {
+    if (frame.isNull()) {
+        emit encodeFailed(garmentId, tr("Captured frame is empty"));
+        return false;
+    }
+
+    if (m_queueDepth >= m_maxQueueDepth) {
+        qWarning() << "Frame encoder queue full (" << m_queueDepth << "), dropping frame for garment" << garmentId;
+        emit encodeFailed(garmentId, tr("Encoder busy, please try again"));
+        return false;
+    }
+
+    ++m_queueDepth;
+    emit queueDepthChanged(m_queueDepth);
+
+    const ScanPreprocessor::Options options = m_options;
+
+    // QImage is implicitly shared, so capturing it by value only bumps a
+    // reference count; the worker never writes to it.
+    m_pool.start([this, frame, garmentId, category, options]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        const ScanPreprocessor::Result result = ScanPreprocessor::process(frame, options);
+        const bool ok = !result.jpeg.isEmpty();
+        const qint64 encodeMs = timer.elapsed();
+
+        QMetaObject::invokeMethod(this, [this, ok, result, category, garmentId, encodeMs]() {
+            if (ok) {
+                finishEncode(result, category, garmentId, encodeMs);
+            } else {
+                --m_queueDepth;
+                emit queueDepthChanged(m_queueDepth);
+                emit encodeFailed(garmentId, tr("JPEG encoding failed"));
+            }
+        }, Qt::QueuedConnection);
+    });
+
+    return true;
+}
+
+void FrameEncoder::finishEncode(const ScanPreprocessor::Result& result, const QString& category,
+                                const QString& garmentId, qint64 encodeMs) {
+    --m_queueDepth;
+    m_lastEncodeMs = encodeMs;
+
+    qDebug() << "Encoded frame for garment" << garmentId << "in" << encodeMs << "ms:"
+             << result.size << "from crop" << result.crop << "at quality" << result.quality
+             << "(" << result.encodes << "encodes ),"
+             << result.jpeg.size() << "bytes of budget" << m_options.byteBudget
+             << ", queue depth" << m_queueDepth;
+
+    emit queueDepthChanged(m_queueDepth);
+    emit encodeStatsChanged(encodeMs, m_queueDepth);
+    emit frameEncoded(result.jpeg, category, garmentId);
+}
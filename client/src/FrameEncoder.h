@@ -0,0 +1,73 @@
+#pragma once
+#ifndef FRAMEENCODER_H
+#define FRAMEENCODER_H
+
+#include <QObject>
+#include <QImage>
+#include <QByteArray>
+#include <QString>
+#include <QThreadPool>
+#include "ScanPreprocessor.h"
+
+// Encodes captured camera frames to JPEG on a small worker pool so the GUI
+// thread (and the camera preview) never blocks on a full-resolution encode.
+// Frames are first run through ScanPreprocessor: cropped to the garment,
+// scaled to targetLongEdge() and encoded at the highest quality (up to
+// jpegQuality()) that fits a byte budget derived from the measured uplink
+// throughput, so a capture uploads in about targetUploadSeconds().
+// All public methods and signals live on the thread that owns the encoder.
+class FrameEncoder : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FrameEncoder(QObject* parent = nullptr);
+    ~FrameEncoder();
+
+    // Queue a frame for encoding. Returns false (and drops the frame) when
+    // the queue already holds maxQueueDepth() frames.
+    bool encode(const QImage& frame, const QString& garmentId, const QString& category);
+
+    int queueDepth() const { return m_queueDepth; }
+    int maxQueueDepth() const { return m_maxQueueDepth; }
+    void setMaxQueueDepth(int depth);
+
+    // Upper bound for the quality search
+    int jpegQuality() const { return m_options.maxQuality; }
+    void setJpegQuality(int quality);
+
+    int targetLongEdge() const { return m_options.targetLongEdge; }
+    void setTargetLongEdge(int pixels);
+
+    bool cropToGarment() const { return m_options.cropToGarment; }
+    void setCropToGarment(bool crop) { m_options.cropToGarment = crop; }
+
+    // Measured uplink in bytes per second; 0 (unknown) lifts the budget.
+    void setUplinkThroughput(double bytesPerSecond);
+    void setTargetUploadSeconds(double seconds);
+    qint64 byteBudget() const { return m_options.byteBudget; }
+
+    qint64 lastEncodeMs() const { return m_lastEncodeMs; }
+
+signals:
+    // Argument order matches NetworkManager::uploadScan so the two can be
+    // connected directly.
+    void frameEncoded(const QByteArray& jpegData, const QString& category, const QString& garmentId);
+    void encodeFailed(const QString& garmentId, const QString& error);
+    void queueDepthChanged(int depth);
+    void encodeStatsChanged(qint64 encodeMs, int queueDepth);
+
+private:
+    void finishEncode(const ScanPreprocessor::Result& result, const QString& category,
+                      const QString& garmentId, qint64 encodeMs);
+    void updateByteBudget();
+
+    QThreadPool m_pool;
+    int m_queueDepth = 0;
+    int m_maxQueueDepth = 4;
+    ScanPreprocessor::Options m_options;
+    double m_uplinkBytesPerSecond = 0.0;
+    double m_targetUploadSeconds = 3.0;
+    qint64 m_lastEncodeMs = 0;
+};
+
+#endif // FRAMEENCODER_H
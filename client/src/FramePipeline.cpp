@@ -0,0 +1,153 @@
+#include "FramePipeline.h"
+#include "BodyTracker.h"
+#include "PoseRecording.h"
+#include <QDebug>
+#include <chrono>
+
+qint64 FramePipeline::timestampNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FramePipeline::FramePipeline(BodyTracker* tracker, QObject* parent)
+    : QObject(parent), m_tracker(tracker)
+{
+}
+
+FramePipeline::~FramePipeline() {
+    setVideoSink(nullptr);
+    stop();
+}
+
+void FramePipeline::setVideoSink(QVideoSink* sink) {
+    if (m_sink == sink) return;
+
+    if (m_sinkConnection) {
+        disconnect(m_sinkConnection);
+    }
+    m_sink = sink;
+    if (m_sink) {
+        // Direct: enqueue() is thread-safe and must not wait for the GUI
+        // thread, which is where the extra latency would come from.
+        m_sinkConnection = connect(m_sink, &QVideoSink::videoFrameChanged, this,
+                                   [this](const QVideoFrame& frame) { enqueue(frame); },
+                                   Qt::DirectConnection);
+    }
+    emit videoSinkChanged();
+}
+
+void FramePipeline::start() {
+    if (m_thread) return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = false;
+    }
+    m_thread.reset(QThread::create([this]() { trackerLoop(); }));
+    m_thread->setObjectName("BodyTracker");
+    m_thread->start(QThread::HighPriority);
+    qDebug() << "Frame pipeline started";
+}
+
+void FramePipeline::stop() {
+    if (!m_thread) return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_queue.clear();
+    }
+    m_frameAvailable.wakeAll();
+    m_thread->wait();
+    m_thread.reset();
+    qDebug() << "Frame pipeline stopped," << m_processed << "frames tracked," << m_dropped << "dropped";
+}
+
+bool FramePipeline::isRunning() const {
+    return m_thread != nullptr;
+}
+
+int FramePipeline::queueCapacity() const {
+    QMutexLocker locker(&m_mutex);
+    return m_capacity;
+}
+
+void FramePipeline::setQueueCapacity(int capacity) {
+    QMutexLocker locker(&m_mutex);
+    m_capacity = qMax(1, capacity);
+    while (int(m_queue.size()) > m_capacity) {
+        m_queue.pop_front();
+        ++m_dropped;
+    }
+}
+
+double FramePipeline::maxTrackingRate() const {
+    QMutexLocker locker(&m_mutex);
+    return m_minIntervalNs > 0 ? 1e9 / double(m_minIntervalNs) : 0.0;
+}
+
+void FramePipeline::setMaxTrackingRate(double hz) {
+    QMutexLocker locker(&m_mutex);
+    m_minIntervalNs = hz > 0.0 ? qint64(1e9 / hz) : 0;
+}
+
+quint64 FramePipeline::droppedFrames() const {
+    QMutexLocker locker(&m_mutex);
+    return m_dropped;
+}
+
+quint64 FramePipeline::processedFrames() const {
+    QMutexLocker locker(&m_mutex);
+    return m_processed;
+}
+
+void FramePipeline::enqueue(const QVideoFrame& frame) {
+    if (!frame.isValid()) return;
+
+    const qint64 arrivedNs = timestampNs();
+    if (m_recorder) m_recorder->recordFrame(frame, arrivedNs);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_stopping) return;
+        if (m_minIntervalNs > 0 && arrivedNs - m_lastAcceptedNs < m_minIntervalNs) return;
+        m_lastAcceptedNs = arrivedNs;
+
+        if (int(m_queue.size()) >= m_capacity) {
+            // Drop-oldest: whatever the tracker has not started on is stale.
+            m_queue.pop_front();
+            ++m_dropped;
+        }
+        m_queue.push_back({frame, arrivedNs});
+    }
+    m_frameAvailable.wakeOne();
+}
+
+void FramePipeline::trackerLoop() {
+    for (;;) {
+        PendingFrame pending;
+        int depth = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_queue.empty() && !m_stopping) {
+                m_frameAvailable.wait(&m_mutex);
+            }
+            if (m_stopping) return;
+
+            pending = std::move(m_queue.front());
+            m_queue.pop_front();
+            depth = int(m_queue.size());
+        }
+
+        if (!m_tracker->processFrame(pending.frame, pending.arrivedNs)) {
+            continue;
+        }
+
+        const qint64 latencyUs = (timestampNs() - pending.arrivedNs) / 1000;
+        {
+            QMutexLocker locker(&m_mutex);
+            ++m_processed;
+        }
+        emit frameProcessed(latencyUs, depth);
+    }
+}
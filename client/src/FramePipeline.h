@@ -0,0 +1,91 @@
+#pragma once
+#ifndef FRAMEPIPELINE_H
+#define FRAMEPIPELINE_H
+
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <QVideoFrame>
+#include <QVideoSink>
+#include <QWaitCondition>
+#include <deque>
+#include <memory>
+
+class BodyTracker;
+class PoseRecorder;
+
+// Feeds camera frames from a QVideoSink to BodyTracker on a dedicated
+// tracker thread. Frames are queued by reference (QVideoFrame is implicitly
+// shared, no pixels are copied) in a small bounded queue that drops the
+// oldest frame when full, so a slow model never falls behind the camera:
+// with the default capacity of 1 the tracker always gets the newest frame.
+// Latency is measured from frame arrival at the sink to published keypoints.
+class FramePipeline : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FramePipeline(BodyTracker* tracker, QObject* parent = nullptr);
+    ~FramePipeline();
+
+    QVideoSink* videoSink() const { return m_sink; }
+    void setVideoSink(QVideoSink* sink);
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    int queueCapacity() const;
+    void setQueueCapacity(int capacity);
+
+    // Caps how often frames are handed to the tracker; 0 = every frame.
+    // Frames skipped by the cap are not counted as dropped.
+    double maxTrackingRate() const;
+    void setMaxTrackingRate(double hz);
+
+    // Every frame arriving at the sink also goes to the recorder while it
+    // records, ahead of the rate cap and queue. Set before a sink is
+    // attached; not owned.
+    void setRecorder(PoseRecorder* recorder) { m_recorder = recorder; }
+
+    // Clock used for frame arrival (PoseSnapshot::captureNs) timestamps
+    static qint64 timestampNs();
+
+    // Thread-safe counters
+    quint64 droppedFrames() const;
+    quint64 processedFrames() const;
+
+signals:
+    // Emitted from the tracker thread for every frame that produced keypoints.
+    void frameProcessed(qint64 captureToKeypointsUs, int queueDepth);
+    void videoSinkChanged();
+
+private:
+    struct PendingFrame {
+        QVideoFrame frame;
+        qint64 arrivedNs = 0;
+    };
+
+    // Called on whichever thread the sink delivers frames on.
+    void enqueue(const QVideoFrame& frame);
+    void trackerLoop();
+
+    BodyTracker* m_tracker;
+    PoseRecorder* m_recorder = nullptr;
+    QPointer<QVideoSink> m_sink;
+    QMetaObject::Connection m_sinkConnection;
+    std::unique_ptr<QThread> m_thread;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_frameAvailable;
+    std::deque<PendingFrame> m_queue;
+    int m_capacity = 1;
+    qint64 m_minIntervalNs = 0;
+    qint64 m_lastAcceptedNs = 0;
+    // True whenever no tracker thread is consuming the queue
+    bool m_stopping = true;
+    quint64 m_dropped = 0;
+    quint64 m_processed = 0;
+};
+
+#endif // FRAMEPIPELINE_H
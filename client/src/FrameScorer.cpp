@@ -0,0 +1,264 @@
+#include "FrameScorer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SCORING_SSE 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define SCORING_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace FrameScoring {
+namespace {
+
+// Mean absolute difference at which the motion penalty halves the score
+constexpr double kMotionScale = 6.0;
+// Luma levels counted as clipped shadows / highlights
+constexpr int kClipLow = 8;
+constexpr int kClipHigh = 247;
+constexpr double kTargetMean = 118.0;
+// SIMD lanes accumulate squares in 32 bits; each step adds at most
+// 2 * 1020^2 per lane, so flush to 64 bits well before that can overflow.
+constexpr int kFlushSteps = 256;
+
+struct Moments {
+    int64_t sum = 0;
+    int64_t sumSq = 0;
+};
+
+inline void laplacianScalar(const uint8_t* up, const uint8_t* row, const uint8_t* down,
+                            int begin, int end, Moments& m) {
+    for (int x = begin; x < end; ++x) {
+        const int l = 4 * row[x] - row[x - 1] - row[x + 1] - up[x] - down[x];
+        m.sum += l;
+        m.sumSq += int64_t(l) * l;
+    }
+}
+
+#ifdef SCORING_SSE
+// Returns the first column not processed
+int laplacianSse(const uint8_t* up, const uint8_t* row, const uint8_t* down, int width, Moments& m) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = zero, sumSq = zero;
+    int steps = 0;
+
+    auto flush = [&]() {
+        alignas(16) int32_t s[4], q[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(s), sum);
+        _mm_store_si128(reinterpret_cast<__m128i*>(q), sumSq);
+        m.sum += int64_t(s[0]) + s[1] + s[2] + s[3];
+        m.sumSq += int64_t(q[0]) + q[1] + q[2] + q[3];
+        sum = sumSq = zero;
+        steps = 0;
+    };
+
+    int x = 1;
+    // Loads reach x + 16, which must stay inside the row
+    for (; x + 17 <= width; x += 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x - 1));
+        const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 1));
+        const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + x));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + x));
+
+        for (int half = 0; half < 2; ++half) {
+            auto widen = [half, zero](__m128i v) {
+                return half == 0 ? _mm_unpacklo_epi8(v, zero) : _mm_unpackhi_epi8(v, zero);
+            };
+            __m128i lap = _mm_slli_epi16(widen(c), 2);
+            lap = _mm_sub_epi16(lap, widen(l));
+            lap = _mm_sub_epi16(lap, widen(r));
+            lap = _mm_sub_epi16(lap, widen(u));
+            lap = _mm_sub_epi16(lap, widen(d));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(lap, ones));
+            sumSq = _mm_add_epi32(sumSq, _mm_madd_epi16(lap, lap));
+        }
+        if (++steps == kFlushSteps) flush();
+    }
+    flush();
+    return x;
+}
+#endif
+
+#ifdef SCORING_NEON
+int laplacianNeon(const uint8_t* up, const uint8_t* row, const uint8_t* down, int width, Moments& m) {
+    int32x4_t sum = vdupq_n_s32(0), sumSq = vdupq_n_s32(0);
+    int steps = 0;
+
+    auto flush = [&]() {
+        m.sum += vaddlvq_s32(sum);
+        m.sumSq += vaddlvq_s32(sumSq);
+        sum = sumSq = vdupq_n_s32(0);
+        steps = 0;
+    };
+
+    int x = 1;
+    for (; x + 17 <= width; x += 16) {
+        const uint8x16_t c = vld1q_u8(row + x);
+        const uint8x16_t l = vld1q_u8(row + x - 1);
+        const uint8x16_t r = vld1q_u8(row + x + 1);
+        const uint8x16_t u = vld1q_u8(up + x);
+        const uint8x16_t d = vld1q_u8(down + x);
+
+        auto lap = [](uint8x8_t c, uint8x8_t l, uint8x8_t r, uint8x8_t u, uint8x8_t d) {
+            int16x8_t v = vreinterpretq_s16_u16(vshll_n_u8(c, 2));
+            v = vsubq_s16(v, vreinterpretq_s16_u16(vmovl_u8(l)));
+            v = vsubq_s16(v, vreinterpretq_s16_u16(vmovl_u8(r)));
+            v = vsubq_s16(v, vreinterpretq_s16_u16(vmovl_u8(u)));
+            v = vsubq_s16(v, vreinterpretq_s16_u16(vmovl_u8(d)));
+            return v;
+        };
+        const int16x8_t lo = lap(vget_low_u8(c), vget_low_u8(l), vget_low_u8(r), vget_low_u8(u), vget_low_u8(d));
+        const int16x8_t hi = lap(vget_high_u8(c), vget_high_u8(l), vget_high_u8(r), vget_high_u8(u), vget_high_u8(d));
+
+        sum = vpadalq_s16(sum, lo);
+        sum = vpadalq_s16(sum, hi);
+        sumSq = vmlal_s16(sumSq, vget_low_s16(lo), vget_low_s16(lo));
+        sumSq = vmlal_s16(sumSq, vget_high_s16(lo), vget_high_s16(lo));
+        sumSq = vmlal_s16(sumSq, vget_low_s16(hi), vget_low_s16(hi));
+        sumSq = vmlal_s16(sumSq, vget_high_s16(hi), vget_high_s16(hi));
+        if (++steps == kFlushSteps / 2) flush();
+    }
+    flush();
+    return x;
+}
+#endif
+
+} // namespace
+
+double Score::total() const {
+    return sharpness * exposure / (1.0 + motion / kMotionScale);
+}
+
+const char* kernelName(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Scalar: return "scalar";
+    case Kernel::SSE: return "sse2";
+    case Kernel::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+bool isAvailable(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Scalar:
+        return true;
+#ifdef SCORING_SSE
+    case Kernel::SSE:
+        return true;
+#endif
+#ifdef SCORING_NEON
+    case Kernel::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+Kernel bestKernel() {
+    if (isAvailable(Kernel::NEON)) return Kernel::NEON;
+    if (isAvailable(Kernel::SSE)) return Kernel::SSE;
+    return Kernel::Scalar;
+}
+
+double laplacianVariance(const LumaView& luma, Kernel kernel) {
+    if (!luma.data || luma.width < 3 || luma.height < 3) return 0.0;
+
+    Moments m;
+    for (int y = 1; y + 1 < luma.height; ++y) {
+        const uint8_t* up = luma.data + size_t(y - 1) * luma.stride;
+        const uint8_t* row = up + luma.stride;
+        const uint8_t* down = row + luma.stride;
+
+        int x = 1;
+        switch (kernel) {
+#ifdef SCORING_SSE
+        case Kernel::SSE:
+            x = laplacianSse(up, row, down, luma.width, m);
+            break;
+#endif
+#ifdef SCORING_NEON
+        case Kernel::NEON:
+            x = laplacianNeon(up, row, down, luma.width, m);
+            break;
+#endif
+        default:
+            break;
+        }
+        laplacianScalar(up, row, down, x, luma.width - 1, m);
+    }
+
+    const double n = double(luma.width - 2) * double(luma.height - 2);
+    const double mean = m.sum / n;
+    return std::max(0.0, m.sumSq / n - mean * mean);
+}
+
+double exposureScore(const LumaView& luma) {
+    if (!luma.data || luma.width <= 0 || luma.height <= 0) return 0.0;
+
+    uint64_t total = 0;
+    uint64_t clipped = 0;
+    for (int y = 0; y < luma.height; ++y) {
+        const uint8_t* row = luma.data + size_t(y) * luma.stride;
+        uint32_t rowTotal = 0, rowClipped = 0;
+        for (int x = 0; x < luma.width; ++x) {
+            rowTotal += row[x];
+            rowClipped += (row[x] <= kClipLow) | (row[x] >= kClipHigh);
+        }
+        total += rowTotal;
+        clipped += rowClipped;
+    }
+
+    const double n = double(luma.width) * luma.height;
+    const double mean = total / n;
+    const double clippedShare = clipped / n;
+    const double level = std::max(0.0, 1.0 - std::fabs(mean - kTargetMean) / kTargetMean);
+    return std::sqrt(level) * std::max(0.0, 1.0 - 4.0 * clippedShare);
+}
+
+double meanAbsDifference(const LumaView& a, const LumaView& b) {
+    const int width = std::min(a.width, b.width);
+    const int height = std::min(a.height, b.height);
+    if (!a.data || !b.data || width <= 0 || height <= 0) return 0.0;
+
+    uint64_t total = 0;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* ra = a.data + size_t(y) * a.stride;
+        const uint8_t* rb = b.data + size_t(y) * b.stride;
+        uint32_t rowTotal = 0;
+        for (int x = 0; x < width; ++x) {
+            rowTotal += uint32_t(std::abs(int(ra[x]) - int(rb[x])));
+        }
+        total += rowTotal;
+    }
+    return double(total) / (double(width) * height);
+}
+
+LumaView downsample2x(const LumaView& luma, std::vector<uint8_t>& out) {
+    LumaView half;
+    half.width = luma.width / 2;
+    half.height = luma.height / 2;
+    half.stride = half.width;
+    out.resize(size_t(half.width) * half.height);
+    half.data = out.data();
+    if (!luma.data) return half;
+
+    for (int y = 0; y < half.height; ++y) {
+        const uint8_t* r0 = luma.data + size_t(2 * y) * luma.stride;
+        const uint8_t* r1 = r0 + luma.stride;
+        uint8_t* dst = out.data() + size_t(y) * half.width;
+        for (int x = 0; x < half.width; ++x) {
+            dst[x] = uint8_t((r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1] + 2) >> 2);
+        }
+    }
+    return half;
+}
+
+} // namespace FrameScoring
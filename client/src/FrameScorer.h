@@ -0,0 +1,55 @@
+// FrameScorer.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-frame quality measures for burst scans, computed on an 8-bit luma
+// plane (the Y plane of the camera's YUV frames, no conversion needed):
+//  - sharpness: variance of the 4-neighbour Laplacian. Blur removes high
+//    frequencies, so a blurred frame has a much lower variance than a sharp
+//    one of the same scene;
+//  - exposure: 1 for a well exposed frame, falling towards 0 with a mean far
+//    from mid-grey or many clipped pixels;
+//  - motion: mean absolute difference to the previous frame of the burst.
+// The Laplacian runs per row with SSE2 (x86-64) or NEON (AArch64).
+namespace FrameScoring {
+
+struct LumaView {
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;     // bytes per row
+};
+
+struct Score {
+    double sharpness = 0.0;
+    double exposure = 0.0;
+    double motion = 0.0;    // 0..255, 0 for the first frame
+
+    // Combined rank: sharpness damped by bad exposure and by motion
+    // (motion also shows as blur, but fast pans can look crisp while the
+    // garment is half out of frame).
+    double total() const;
+};
+
+enum class Kernel {
+    Scalar,
+    SSE,
+    NEON
+};
+
+const char* kernelName(Kernel kernel);
+bool isAvailable(Kernel kernel);
+Kernel bestKernel();
+
+double laplacianVariance(const LumaView& luma, Kernel kernel = bestKernel());
+double exposureScore(const LumaView& luma);
+double meanAbsDifference(const LumaView& a, const LumaView& b);
+
+// 2x2 box average into `out` (resized). Exposure and motion do not need
+// full resolution; sharpness does, since a few pixels of blur mostly
+// vanish at half size.
+LumaView downsample2x(const LumaView& luma, std::vector<uint8_t>& out);
+
+} // namespace FrameScoring
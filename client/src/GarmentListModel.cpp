@@ -0,0 +1,270 @@
+#include "GarmentListModel.h"
+#include <QDebug>
+#include <QSet>
+
+GarmentListModel::Garment GarmentListModel::Garment::fromJson(const QJsonObject& garmentObj) {
+    Garment garment;
+    garment.garmentId = garmentObj["garmentId"].toString();
+    garment.name = garmentObj["name"].toString();
+    garment.previewUrl = garmentObj["previewUrl"].toString();
+    garment.modelUrl = garmentObj["modelUrl"].toString();
+    garment.modelKey = garmentObj["modelKey"].toString();
+    garment.previewKey = garmentObj["previewKey"].toString();
+    garment.category = garmentObj["category"].toString();
+    garment.createdBy = garmentObj["createdBy"].toString();
+    // Not sent by the server yet; every listed garment can be tried on
+    garment.isAvailable = garmentObj["isAvailable"].toBool(true);
+    return garment;
+}
+
+GarmentListModel::GarmentListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int GarmentListModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_garments.size();
+}
+
+QVariant GarmentListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_garments.size()) {
+        return QVariant();
+    }
+
+    const Garment& garment = m_garments.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:        return garment.name;
+    case GarmentIdRole:   return garment.garmentId;
+    case PreviewUrlRole:  return garment.previewUrl;
+    case ModelUrlRole:    return garment.modelUrl;
+    case ModelKeyRole:    return garment.modelKey;
+    case PreviewKeyRole:  return garment.previewKey;
+    case CategoryRole:    return garment.category;
+    case CreatedByRole:   return garment.createdBy;
+    case IsAvailableRole: return garment.isAvailable;
+    default:              return QVariant();
+    }
+}
+
+QHash<int, QByteArray> GarmentListModel::roleNames() const {
+    return {
+        {GarmentIdRole, "garmentId"},
+        {NameRole, "name"},
+        {PreviewUrlRole, "previewUrl"},
+        {ModelUrlRole, "modelUrl"},
+        {ModelKeyRole, "modelKey"},
+        {PreviewKeyRole, "previewKey"},
+        {CategoryRole, "category"},
+        {CreatedByRole, "createdBy"},
+        {IsAvailableRole, "isAvailable"}
+    };
+}
+
+QVariantMap GarmentListModel::get(int row) const {
+    QVariantMap entry;
+    if (row < 0 || row >= m_garments.size()) return entry;
+
+    const QHash<int, QByteArray> roles = roleNames();
+    const QModelIndex idx = index(row);
+    for (auto it = roles.cbegin(); it != roles.cend(); ++it) {
+        entry.insert(QString::fromUtf8(it.value()), data(idx, it.key()));
+    }
+    return entry;
+}
+
+int GarmentListModel::indexOf(const QString& garmentId) const {
+    for (int row = 0; row < m_garments.size(); ++row) {
+        if (m_garments.at(row).garmentId == garmentId) return row;
+    }
+    return -1;
+}
+
+const GarmentListModel::Garment* GarmentListModel::garmentAt(int row) const {
+    return (row >= 0 && row < m_garments.size()) ? &m_garments.at(row) : nullptr;
+}
+
+bool GarmentListModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !m_nextCursor.isEmpty() && !m_fetchingMore;
+}
+
+void GarmentListModel::fetchMore(const QModelIndex& parent) {
+    if (!canFetchMore(parent)) return;
+
+    qDebug() << "Requesting next garments page";
+    setFetchingMore(true);
+    emit fetchMoreRequested(m_nextCursor);
+}
+
+void GarmentListModel::setFetchingMore(bool fetching) {
+    if (m_fetchingMore == fetching) return;
+    m_fetchingMore = fetching;
+    emit fetchingMoreChanged();
+}
+
+void GarmentListModel::applyCatalog(const QJsonArray& garments) {
+    QList<Garment> incoming;
+    incoming.reserve(garments.size());
+    for (const QJsonValue& value : garments) {
+        incoming.append(Garment::fromJson(value.toObject()));
+    }
+
+    m_loadedCursors = {QString()};
+    m_nextCursor.clear();
+    setFetchingMore(false);
+    applySegment(0, m_garments.size(), std::move(incoming));
+}
+
+void GarmentListModel::applyPage(const QString& cursor, const QJsonArray& garments, const QString& nextCursor) {
+    QList<Garment> incoming;
+    incoming.reserve(garments.size());
+    for (const QJsonValue& value : garments) {
+        Garment garment = Garment::fromJson(value.toObject());
+        garment.pageCursor = cursor;
+        incoming.append(std::move(garment));
+    }
+
+    // Rows of one page are always contiguous; find where this page lives,
+    // or append it after everything loaded so far.
+    int first = m_garments.size();
+    int pageCount = 0;
+    for (int row = 0; row < m_garments.size(); ++row) {
+        if (m_garments.at(row).pageCursor == cursor) {
+            if (pageCount == 0) first = row;
+            ++pageCount;
+        } else if (pageCount > 0) {
+            break;
+        }
+    }
+
+    if (!m_loadedCursors.contains(cursor)) {
+        m_loadedCursors.append(cursor);
+    }
+    // Only the newest page decides whether more can be fetched; refreshing
+    // an earlier page leaves the continuation alone.
+    if (m_loadedCursors.constLast() == cursor) {
+        m_nextCursor = nextCursor;
+        setFetchingMore(false);
+    }
+
+    applySegment(first, pageCount, std::move(incoming));
+}
+
+void GarmentListModel::pageFailed(const QString& cursor) {
+    Q_UNUSED(cursor)
+    // Let the view retry on its next scroll to the end.
+    setFetchingMore(false);
+}
+
+QList<int> GarmentListModel::changedRoles(const Garment& before, const Garment& after) {
+    QList<int> roles;
+    if (before.name != after.name)               roles << NameRole << Qt::DisplayRole;
+    if (before.previewUrl != after.previewUrl)   roles << PreviewUrlRole;
+    if (before.modelUrl != after.modelUrl)       roles << ModelUrlRole;
+    if (before.modelKey != after.modelKey)       roles << ModelKeyRole;
+    if (before.previewKey != after.previewKey)   roles << PreviewKeyRole;
+    if (before.category != after.category)       roles << CategoryRole;
+    if (before.createdBy != after.createdBy)     roles << CreatedByRole;
+    if (before.isAvailable != after.isAvailable) roles << IsAvailableRole;
+    return roles;
+}
+
+int GarmentListModel::removeRowsWhere(int first, int last, const QSet<QString>& ids, bool keepMatches) {
+    int removed = 0;
+    // Walk backwards so indices of rows still to visit stay valid, and
+    // remove contiguous runs with a single signal pair.
+    int row = last;
+    while (row >= first) {
+        if (ids.contains(m_garments.at(row).garmentId) == keepMatches) {
+            --row;
+            continue;
+        }
+        int runStart = row;
+        while (runStart - 1 >= first && ids.contains(m_garments.at(runStart - 1).garmentId) != keepMatches) {
+            --runStart;
+        }
+        beginRemoveRows(QModelIndex(), runStart, row);
+        m_garments.remove(runStart, row - runStart + 1);
+        endRemoveRows();
+        removed += row - runStart + 1;
+        row = runStart - 1;
+    }
+    return removed;
+}
+
+void GarmentListModel::applySegment(int first, int oldCount, QList<Garment> incoming) {
+    const int previousCount = m_garments.size();
+
+    // Drop entries without an id and duplicates; ids are the model's keys.
+    QSet<QString> incomingIds;
+    QList<Garment> unique;
+    unique.reserve(incoming.size());
+    for (Garment& garment : incoming) {
+        if (garment.garmentId.isEmpty() || incomingIds.contains(garment.garmentId)) continue;
+        incomingIds.insert(garment.garmentId);
+        unique.append(std::move(garment));
+    }
+
+    first = qBound(0, first, m_garments.size());
+    oldCount = qBound(0, oldCount, m_garments.size() - first);
+
+    // 1. Garments that moved into this segment from elsewhere leave their old rows.
+    removeRowsWhere(first + oldCount, m_garments.size() - 1, incomingIds, false);
+    const int removedBefore = removeRowsWhere(0, first - 1, incomingIds, false);
+    first -= removedBefore;
+
+    // 2. Garments no longer in this segment go away.
+    oldCount -= removeRowsWhere(first, first + oldCount - 1, incomingIds, true);
+
+    // 3. Every surviving row is now in `unique`; walk it in order, moving,
+    //    updating or inserting rows so the segment matches.
+    QSet<QString> segmentIds;
+    for (int row = first; row < first + oldCount; ++row) {
+        segmentIds.insert(m_garments.at(row).garmentId);
+    }
+
+    int segmentEnd = first + oldCount;
+    for (int i = 0; i < unique.size(); ++i) {
+        const int row = first + i;
+        const Garment& wanted = unique.at(i);
+
+        if (!segmentIds.contains(wanted.garmentId)) {
+            int run = 1;
+            while (i + run < unique.size() && !segmentIds.contains(unique.at(i + run).garmentId)) {
+                ++run;
+            }
+            beginInsertRows(QModelIndex(), row, row + run - 1);
+            for (int k = 0; k < run; ++k) {
+                m_garments.insert(row + k, unique.at(i + k));
+            }
+            endInsertRows();
+            segmentEnd += run;
+            i += run - 1;
+            continue;
+        }
+
+        if (m_garments.at(row).garmentId != wanted.garmentId) {
+            int from = row + 1;
+            while (from < segmentEnd && m_garments.at(from).garmentId != wanted.garmentId) {
+                ++from;
+            }
+            Q_ASSERT(from < segmentEnd);
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            m_garments.move(from, row);
+            endMoveRows();
+        }
+
+        const QList<int> roles = changedRoles(m_garments.at(row), wanted);
+        // Always take the new record: its page membership may have changed
+        // even when nothing visible did.
+        m_garments[row] = wanted;
+        if (!roles.isEmpty()) {
+            const QModelIndex idx = index(row);
+            emit dataChanged(idx, idx, roles);
+        }
+    }
+
+    if (m_garments.size() != previousCount) {
+        emit countChanged();
+    }
+}
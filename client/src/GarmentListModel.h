@@ -0,0 +1,109 @@
+#pragma once
+#ifndef GARMENTLISTMODEL_H
+#define GARMENTLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+// Garment catalog exposed to QML as a list model keyed by garmentId.
+// applyCatalog()/applyPage() diff the incoming garments against the current
+// rows and emit only the row insert/remove/move/dataChanged signals needed,
+// so views keep their delegates (and already loaded preview images) across
+// refreshes.
+//
+// The catalog is loaded lazily one page at a time: views call fetchMore()
+// when they scroll near the end, which asks for the next cursor through
+// fetchMoreRequested(). Rows remember which page they came from so that
+// refreshing a page only diffs that page's rows.
+class GarmentListModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(bool fetchingMore READ isFetchingMore NOTIFY fetchingMoreChanged)
+
+public:
+    enum Roles {
+        GarmentIdRole = Qt::UserRole + 1,
+        NameRole,
+        PreviewUrlRole,
+        ModelUrlRole,
+        ModelKeyRole,
+        PreviewKeyRole,
+        CategoryRole,
+        CreatedByRole,
+        IsAvailableRole
+    };
+    Q_ENUM(Roles)
+
+    struct Garment {
+        QString garmentId;
+        QString name;
+        QString previewUrl;
+        QString modelUrl;
+        QString modelKey;
+        QString previewKey;
+        QString category;
+        QString createdBy;
+        bool isAvailable = true;
+        // Cursor of the page this row was loaded from (not exposed as a role)
+        QString pageCursor;
+
+        static Garment fromJson(const QJsonObject& garmentObj);
+    };
+
+    explicit GarmentListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    int count() const { return m_garments.size(); }
+    bool isFetchingMore() const { return m_fetchingMore; }
+
+    // Replace the catalog contents with a complete (unpaged) catalog.
+    void applyCatalog(const QJsonArray& garments);
+
+    // Apply one page. An empty cursor is the first page; nextCursor is empty
+    // when no further pages exist.
+    void applyPage(const QString& cursor, const QJsonArray& garments, const QString& nextCursor);
+    void pageFailed(const QString& cursor);
+    // Cursors of the pages applied so far, in order; refreshing the catalog
+    // re-applies each of them
+    QStringList loadedCursors() const { return m_loadedCursors; }
+
+    Q_INVOKABLE QVariantMap get(int row) const;
+    Q_INVOKABLE int indexOf(const QString& garmentId) const;
+    const Garment* garmentAt(int row) const;
+
+signals:
+    void countChanged();
+    void fetchingMoreChanged();
+    void fetchMoreRequested(const QString& cursor);
+
+protected:
+    // Diff rows [first, first + oldCount) against `incoming`, which ends up
+    // occupying that segment. Rows outside the segment whose ids also appear
+    // in `incoming` are dropped so ids stay unique.
+    void applySegment(int first, int oldCount, QList<Garment> incoming);
+
+private:
+    static QList<int> changedRoles(const Garment& before, const Garment& after);
+    int removeRowsWhere(int first, int last, const QSet<QString>& ids, bool keepMatches);
+    void setFetchingMore(bool fetching);
+
+    QList<Garment> m_garments;
+    // Cursors of the pages loaded so far, in order, and the one to load next
+    QStringList m_loadedCursors;
+    QString m_nextCursor;
+    bool m_fetchingMore = false;
+};
+
+#endif // GARMENTLISTMODEL_H
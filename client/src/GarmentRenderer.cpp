@@ -0,0 +1,301 @@
+#include "GarmentRenderer.h"
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGRenderNode>
+#include <QSGRendererInterface>
+#include <QSGVertexColorMaterial>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// Where vertex data comes from this sync: the fitter's SoA streams or a
+// static AoS Mesh (stride 3, no normals).
+struct VertexSource {
+    size_t vertexCount = 0;
+    const float* x = nullptr;
+    const float* y = nullptr;
+    size_t stride = 1;
+    const float* nx = nullptr;
+    const float* ny = nullptr;
+    const float* nz = nullptr;
+    const uint32_t* indices = nullptr;
+    size_t indexCount = 0;
+};
+
+// Premultiplied RGBA for one vertex: base colour darkened by how far the
+// surface turns away from the camera, so folds stay readable without a
+// lighting shader.
+struct Shader {
+    float r, g, b, a;
+
+    explicit Shader(const QColor& color)
+        : r(color.redF()), g(color.greenF()), b(color.blueF()), a(color.alphaF()) {}
+
+    void shade(const VertexSource& source, size_t i, uchar rgba[4]) const {
+        float facing = 1.0f;
+        if (source.nz) {
+            const float x = source.nx[i], y = source.ny[i], z = source.nz[i];
+            const float length = std::sqrt(x * x + y * y + z * z);
+            facing = length > 0.0f ? std::fabs(z) / length : 1.0f;
+        }
+        const float light = (0.45f + 0.55f * facing) * a * 255.0f;
+        rgba[0] = uchar(r * light);
+        rgba[1] = uchar(g * light);
+        rgba[2] = uchar(b * light);
+        rgba[3] = uchar(a * 255.0f);
+    }
+};
+
+class GarmentGeometryNode : public QSGGeometryNode {
+public:
+    GarmentGeometryNode() {
+        auto* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0, 0,
+                                         QSGGeometry::UnsignedIntType);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        // Indices change once per garment, vertices every frame: lets the
+        // renderer keep a dedicated buffer per stream and only refill the
+        // vertex one.
+        geometry->setIndexDataPattern(QSGGeometry::StaticPattern);
+        geometry->setVertexDataPattern(QSGGeometry::StreamPattern);
+        setGeometry(geometry);
+
+        auto* material = new QSGVertexColorMaterial;
+        material->setFlag(QSGMaterial::Blending);
+        setMaterial(material);
+        setFlags(OwnsGeometry | OwnsMaterial);
+    }
+
+    void uploadTopology(const VertexSource& source) {
+        QSGGeometry* g = geometry();
+        g->allocate(int(source.vertexCount), int(source.indexCount));
+        if (source.indexCount > 0) {
+            std::copy(source.indices, source.indices + source.indexCount, g->indexDataAsUInt());
+        }
+        g->markIndexDataDirty();
+    }
+
+    void uploadVertices(const VertexSource& source, const QRectF& rect, const Shader& shader) {
+        QSGGeometry* g = geometry();
+        QSGGeometry::ColoredPoint2D* v = g->vertexDataAsColoredPoint2D();
+        const float ox = float(rect.x()), oy = float(rect.y());
+        const float sx = float(rect.width()), sy = float(rect.height());
+        for (size_t i = 0; i < source.vertexCount; ++i) {
+            uchar rgba[4];
+            shader.shade(source, i, rgba);
+            v[i].set(ox + sx * source.x[i * source.stride], oy + sy * source.y[i * source.stride],
+                     rgba[0], rgba[1], rgba[2], rgba[3]);
+        }
+        g->markVertexDataDirty();
+        markDirty(QSGNode::DirtyGeometry);
+    }
+
+    quint64 topologyVersion = 0;
+    quint64 vertexVersion = 0;
+};
+
+// Software backend: QSGGeometryNode is not rendered there, so paint the
+// triangles with the backend's QPainter.
+class GarmentPainterNode : public QSGRenderNode {
+public:
+    explicit GarmentPainterNode(QQuickWindow* window) : m_window(window) {}
+
+    void uploadTopology(const VertexSource& source) {
+        m_indices.clear();
+        m_indices.reserve(source.indexCount);
+        for (size_t i = 0; i + 2 < source.indexCount; i += 3) {
+            const uint32_t a = source.indices[i], b = source.indices[i + 1], c = source.indices[i + 2];
+            if (a < source.vertexCount && b < source.vertexCount && c < source.vertexCount) {
+                m_indices.insert(m_indices.end(), {a, b, c});
+            }
+        }
+        m_points.resize(source.vertexCount);
+        m_colors.resize(source.vertexCount);
+    }
+
+    void uploadVertices(const VertexSource& source, const QRectF& rect, const Shader& shader) {
+        QRectF bounds;
+        for (size_t i = 0; i < source.vertexCount; ++i) {
+            uchar rgba[4];
+            shader.shade(source, i, rgba);
+            m_points[i] = QPointF(rect.x() + rect.width() * source.x[i * source.stride],
+                                  rect.y() + rect.height() * source.y[i * source.stride]);
+            m_colors[i] = qRgba(rgba[0], rgba[1], rgba[2], rgba[3]);
+        }
+        if (!m_points.empty()) {
+            qreal minX = m_points[0].x(), maxX = minX, minY = m_points[0].y(), maxY = minY;
+            for (const QPointF& p : m_points) {
+                minX = qMin(minX, p.x()); maxX = qMax(maxX, p.x());
+                minY = qMin(minY, p.y()); maxY = qMax(maxY, p.y());
+            }
+            bounds = QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+        }
+        m_bounds = bounds;
+        markDirty(QSGNode::DirtyMaterial);
+    }
+
+    void render(const RenderState*) override {
+        auto* painter = static_cast<QPainter*>(
+            m_window->rendererInterface()->getResource(m_window, QSGRendererInterface::PainterResource));
+        if (!painter) return;
+
+        painter->setTransform(matrix()->toTransform());
+        painter->setOpacity(inheritedOpacity());
+        painter->setPen(Qt::NoPen);
+        for (size_t i = 0; i < m_indices.size(); i += 3) {
+            const QPointF triangle[3] = {m_points[m_indices[i]], m_points[m_indices[i + 1]],
+                                         m_points[m_indices[i + 2]]};
+            // Colours are premultiplied; the first corner's is good enough here.
+            painter->setBrush(QColor::fromRgba(qUnpremultiply(m_colors[m_indices[i]])));
+            painter->drawConvexPolygon(triangle, 3);
+        }
+    }
+
+    StateFlags changedStates() const override { return {}; }
+    RenderingFlags flags() const override { return BoundedRectRendering; }
+    QRectF rect() const override { return m_bounds; }
+
+    quint64 topologyVersion = 0;
+    quint64 vertexVersion = 0;
+
+private:
+    QQuickWindow* m_window;
+    std::vector<QPointF> m_points;
+    std::vector<QRgb> m_colors;
+    std::vector<uint32_t> m_indices;
+    QRectF m_bounds;
+};
+
+template <typename Node>
+void syncNode(Node* node, const VertexSource& source, quint64 topologyVersion, quint64 vertexVersion,
+              const QRectF& rect, const QColor& color) {
+    if (node->topologyVersion != topologyVersion) {
+        node->uploadTopology(source);
+        node->topologyVersion = topologyVersion;
+        // allocate() dropped the old vertex data
+        node->vertexVersion = 0;
+    }
+    if (node->vertexVersion != vertexVersion) {
+        node->uploadVertices(source, rect, Shader(color));
+        node->vertexVersion = vertexVersion;
+    }
+}
+
+} // namespace
+
+GarmentRenderer::GarmentRenderer(QQuickItem* parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+}
+
+GarmentRenderer::~GarmentRenderer() = default;
+
+QRectF GarmentRenderer::contentRect() const {
+    return m_contentRect.isValid() ? m_contentRect : boundingRect();
+}
+
+void GarmentRenderer::setContentRect(const QRectF& rect) {
+    if (m_contentRect == rect) return;
+    m_contentRect = rect;
+    ++m_vertexVersion;
+    update();
+    emit contentRectChanged();
+}
+
+void GarmentRenderer::setColor(const QColor& color) {
+    if (m_color == color) return;
+    m_color = color;
+    ++m_vertexVersion;
+    update();
+    emit colorChanged();
+}
+
+void GarmentRenderer::updateMesh(Mesh&& mesh) {
+    m_mesh = std::move(mesh);
+    m_topology.reset();
+    m_streams.reset();
+    m_hasVertices = !m_mesh.vertices.empty();
+    ++m_topologyVersion;
+    ++m_vertexVersion;
+    update();
+}
+
+void GarmentRenderer::setSkinnedMesh(std::shared_ptr<const MeshFile> topology,
+                                     std::shared_ptr<const ClothFitter::SkinnedStreams> streams) {
+    if (m_topology == topology && m_streams == streams) return;
+    m_topology = std::move(topology);
+    m_streams = std::move(streams);
+    m_mesh = Mesh();
+    // Nothing to show until the fitter has skinned the new mesh once
+    m_hasVertices = false;
+    ++m_topologyVersion;
+    update();
+}
+
+void GarmentRenderer::skinnedMeshChanged() {
+    if (!m_topology || !m_streams) return;
+    m_hasVertices = true;
+    ++m_vertexVersion;
+    update();
+}
+
+void GarmentRenderer::clear() {
+    m_topology.reset();
+    m_streams.reset();
+    m_mesh = Mesh();
+    m_hasVertices = false;
+    ++m_topologyVersion;
+    update();
+}
+
+void GarmentRenderer::geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) {
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (!m_contentRect.isValid() && newGeometry.size() != oldGeometry.size()) {
+        ++m_vertexVersion;
+        update();
+    }
+}
+
+QSGNode* GarmentRenderer::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*) {
+    // Runs on the render thread with the GUI thread blocked, so the shared
+    // fitter buffers cannot change underneath us.
+    VertexSource source;
+    if (m_topology && m_streams) {
+        source.vertexCount = qMin<size_t>(m_topology->vertexCount(), m_streams->px.size());
+        source.x = m_streams->px.data();
+        source.y = m_streams->py.data();
+        source.nx = m_streams->nx.data();
+        source.ny = m_streams->ny.data();
+        source.nz = m_streams->nz.data();
+        source.indices = m_topology->indices();
+        source.indexCount = m_topology->indexCount();
+    } else if (!m_mesh.vertices.empty()) {
+        source.vertexCount = m_mesh.vertices.size();
+        source.x = &m_mesh.vertices[0].x;
+        source.y = &m_mesh.vertices[0].y;
+        source.stride = sizeof(Vertex) / sizeof(float);
+        source.indices = m_mesh.indices.data();
+        source.indexCount = m_mesh.indices.size();
+    }
+
+    if (!m_hasVertices || source.vertexCount == 0 || source.indexCount < 3) {
+        delete oldNode;
+        return nullptr;
+    }
+
+    const QRectF rect = contentRect();
+    const bool software = window()->rendererInterface()->graphicsApi() == QSGRendererInterface::Software;
+    if (software) {
+        auto* node = static_cast<GarmentPainterNode*>(oldNode);
+        if (!node) node = new GarmentPainterNode(window());
+        syncNode(node, source, m_topologyVersion, m_vertexVersion, rect, m_color);
+        return node;
+    }
+
+    auto* node = static_cast<GarmentGeometryNode*>(oldNode);
+    if (!node) node = new GarmentGeometryNode;
+    syncNode(node, source, m_topologyVersion, m_vertexVersion, rect, m_color);
+    return node;
+}
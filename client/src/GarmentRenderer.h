@@ -1,18 +1,76 @@
+#pragma once
+#ifndef GARMENTRENDERER_H
+#define GARMENTRENDERER_H
+
+#include <QColor>
 #include <QQuickItem>
-#include <QOpenGLShaderProgram>
+#include <QRectF>
+#include <QtQml/qqmlregistration.h>
+#include <memory>
+#include "ClothFitter.h"
+#include "CommonTypes.h"
 
+// Draws the fitted garment over the camera preview.
+//
+// Geometry lives in a scene-graph node that is kept across frames: the
+// index buffer is uploaded once per garment, and each frame only the
+// vertex stream (position and shade) is rewritten. Skinned meshes are not
+// copied on the GUI thread; the item holds shared handles to the fitter's
+// buffers and reads them in updatePaintNode(), while the GUI thread is
+// blocked for the sync. RHI backends (including offscreen/null used in CI)
+// get a QSGGeometryNode; the software backend falls back to a QPainter
+// render node.
 class GarmentRenderer : public QQuickItem {
     Q_OBJECT
+    QML_ELEMENT
+
+    // Where the camera frame lands in item coordinates, e.g.
+    // VideoOutput.contentRect; keypoint space [0,1]^2 maps onto it.
+    // Defaults to the item's own bounds.
+    Q_PROPERTY(QRectF contentRect READ contentRect WRITE setContentRect NOTIFY contentRectChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+
 public:
-    GarmentRenderer();
-    
-public slots:
-    void updateMesh(const Mesh& mesh);
+    explicit GarmentRenderer(QQuickItem* parent = nullptr);
+    ~GarmentRenderer() override;
+
+    QRectF contentRect() const;
+    void setContentRect(const QRectF& rect);
+    QColor color() const { return m_color; }
+    void setColor(const QColor& color);
+
+    // Static mesh in keypoint space, taken over without copying.
+    void updateMesh(Mesh&& mesh);
+
+    // Shares the fitter's buffers; call skinnedMeshChanged() after each
+    // skinning pass. Passing nulls clears the garment.
+    void setSkinnedMesh(std::shared_ptr<const MeshFile> topology,
+                        std::shared_ptr<const ClothFitter::SkinnedStreams> streams);
+    void skinnedMeshChanged();
+
+    Q_INVOKABLE void clear();
+
+signals:
+    void contentRectChanged();
+    void colorChanged();
 
 protected:
-    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*);
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*) override;
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
 
 private:
-    Mesh m_currentMesh;
-    QOpenGLShaderProgram m_shaderProgram;
-};
\ No newline at end of file
+    // Bumped on the GUI thread, compared against what the node last
+    // uploaded on the render thread.
+    quint64 m_topologyVersion = 0;
+    quint64 m_vertexVersion = 0;
+
+    std::shared_ptr<const MeshFile> m_topology;
+    std::shared_ptr<const ClothFitter::SkinnedStreams> m_streams;
+    Mesh m_mesh;
+    bool m_hasVertices = false;
+
+    QRectF m_contentRect;
+    QColor m_color = QColor(70, 130, 220, 200);
+};
+
+#endif // GARMENTRENDERER_H
@@ -0,0 +1,123 @@
+#include "HttpCache.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+HttpCache::HttpCache(const QString& directory)
+    : m_directory(directory.isEmpty()
+                      ? QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/http"
+                      : directory)
+{
+    QDir().mkpath(m_directory);
+}
+
+QString HttpCache::pathFor(const QString& key, const char* suffix) const {
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_directory + "/" + QString::fromLatin1(hash) + suffix;
+}
+
+bool HttpCache::addValidators(const QString& key, QNetworkRequest& request) {
+    const Entry* entry = lookup(key);
+    if (!entry) return false;
+
+    if (!entry->etag.isEmpty()) {
+        request.setRawHeader("If-None-Match", entry->etag);
+    }
+    if (!entry->lastModified.isEmpty()) {
+        request.setRawHeader("If-Modified-Since", entry->lastModified);
+    }
+    return !entry->etag.isEmpty() || !entry->lastModified.isEmpty();
+}
+
+const HttpCache::Entry* HttpCache::lookup(const QString& key) {
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.cend()) {
+        if (!loadFromDisk(key)) return nullptr;
+        it = m_entries.constFind(key);
+    }
+    return &it.value();
+}
+
+bool HttpCache::loadFromDisk(const QString& key) {
+    QFile metaFile(pathFor(key, ".meta"));
+    QFile bodyFile(pathFor(key, ".body"));
+    if (!metaFile.open(QIODevice::ReadOnly) || !bodyFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonObject meta = QJsonDocument::fromJson(metaFile.readAll()).object();
+    if (meta["key"].toString() != key) {
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(bodyFile.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        qWarning() << "Discarding corrupt cache entry for" << key;
+        remove(key);
+        return false;
+    }
+
+    Entry entry;
+    entry.etag = meta["etag"].toString().toUtf8();
+    entry.lastModified = meta["lastModified"].toString().toUtf8();
+    entry.storedAt = QDateTime::fromString(meta["storedAt"].toString(), Qt::ISODate);
+    entry.document = document;
+    m_entries.insert(key, entry);
+    return true;
+}
+
+void HttpCache::store(const QString& key, const QByteArray& etag, const QByteArray& lastModified,
+                      const QByteArray& body, const QJsonDocument& document) {
+    if (etag.isEmpty() && lastModified.isEmpty()) {
+        // Nothing to revalidate with; caching would only serve stale data.
+        remove(key);
+        return;
+    }
+
+    Entry entry;
+    entry.etag = etag;
+    entry.lastModified = lastModified;
+    entry.storedAt = QDateTime::currentDateTimeUtc();
+    entry.document = document;
+    m_entries.insert(key, entry);
+
+    // Body first, then metadata: a crash in between leaves a stale .meta
+    // pointing at a newer body, which the next 200 simply overwrites.
+    QSaveFile bodyFile(pathFor(key, ".body"));
+    if (bodyFile.open(QIODevice::WriteOnly)) {
+        bodyFile.write(body);
+        bodyFile.commit();
+    }
+
+    const QJsonObject meta{
+        {"key", key},
+        {"etag", QString::fromUtf8(etag)},
+        {"lastModified", QString::fromUtf8(lastModified)},
+        {"storedAt", entry.storedAt.toString(Qt::ISODate)}
+    };
+    QSaveFile metaFile(pathFor(key, ".meta"));
+    if (metaFile.open(QIODevice::WriteOnly)) {
+        metaFile.write(QJsonDocument(meta).toJson(QJsonDocument::Compact));
+        metaFile.commit();
+    }
+}
+
+void HttpCache::remove(const QString& key) {
+    m_entries.remove(key);
+    QFile::remove(pathFor(key, ".meta"));
+    QFile::remove(pathFor(key, ".body"));
+}
+
+void HttpCache::clear() {
+    m_entries.clear();
+    QDir dir(m_directory);
+    const QStringList files = dir.entryList({"*.meta", "*.body"}, QDir::Files);
+    for (const QString& file : files) {
+        dir.remove(file);
+    }
+}
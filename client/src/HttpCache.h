@@ -0,0 +1,46 @@
+#pragma once
+#ifndef HTTPCACHE_H
+#define HTTPCACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonDocument>
+#include <QNetworkRequest>
+#include <QString>
+
+// Small on-disk cache for JSON GET responses that are revalidated with
+// If-None-Match / If-Modified-Since. Entries keep the parsed document in
+// memory, so a 304 hands back the previous result without touching the JSON
+// parser again. Bodies are only parsed when an entry is first loaded from
+// disk in a new process.
+class HttpCache {
+public:
+    struct Entry {
+        QByteArray etag;
+        QByteArray lastModified;
+        QDateTime storedAt;
+        QJsonDocument document;
+    };
+
+    explicit HttpCache(const QString& directory = QString());
+
+    // Adds conditional headers for a cached entry; returns false when there
+    // is nothing to revalidate against.
+    bool addValidators(const QString& key, QNetworkRequest& request);
+
+    const Entry* lookup(const QString& key);
+    void store(const QString& key, const QByteArray& etag, const QByteArray& lastModified,
+               const QByteArray& body, const QJsonDocument& document);
+    void remove(const QString& key);
+    void clear();
+
+private:
+    QString pathFor(const QString& key, const char* suffix) const;
+    bool loadFromDisk(const QString& key);
+
+    QString m_directory;
+    QHash<QString, Entry> m_entries;
+};
+
+#endif // HTTPCACHE_H
@@ -1,6 +1,10 @@
 // ImageProcessor.cpp
 #include "ImageProcessor.h"
+#include "NetworkClient.h"
+#include "TryOnPreviewProvider.h"
+#include <QBuffer>
 #include <QDebug>
+#include <QImageReader>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QNetworkRequest>
@@ -9,12 +13,20 @@
 
 ImageProcessor::ImageProcessor(QObject *parent) 
     : QObject(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
+    , m_networkManager(NetworkClient::instance()->manager())
+    , m_previewKey(QString::number(reinterpret_cast<quintptr>(this), 16))
 {
+    // One decoder is enough: intermediate results that arrive while it is
+    // busy are skipped in favour of the newest one.
+    m_decodePool.setMaxThreadCount(1);
+    m_decodePool.setObjectName("ImageProcessorDecode");
 }
 
 ImageProcessor::~ImageProcessor() {
     cleanupRequest();
+    // The decoder posts results back to this object
+    m_decodePool.waitForDone();
+    TryOnPreviewProvider::remove(m_previewKey);
 }
 
 QUrl ImageProcessor::serverUrl() const {
@@ -27,15 +39,36 @@ void ImageProcessor::setServerUrl(const QUrl &url) {
     emit serverUrlChanged();
 }
 
+QUrl ImageProcessor::previewSource() const {
+    if (!m_hasPreview) return QUrl();
+    return QUrl(QString("image://tryon/%1/%2").arg(m_previewKey).arg(m_previewRevision));
+}
+
 void ImageProcessor::cleanupRequest() {
     if (m_currentReply) {
+        // A superseded request must not feed the next one's stream
+        m_currentReply->disconnect(this);
+        if (m_currentReply->isRunning()) {
+            m_currentReply->abort();
+        }
         m_currentReply->deleteLater();
         m_currentReply = nullptr;
     }
+    m_stream.reset();
+    m_streaming = false;
+    ++m_generation;
+}
+
+void ImageProcessor::clearPreview() {
+    if (!m_hasPreview) return;
+    m_hasPreview = false;
+    TryOnPreviewProvider::remove(m_previewKey);
+    emit previewSourceChanged();
 }
 
 void ImageProcessor::handleCapturedImage(const QByteArray &jpgData, const QString &garmentId) {
     cleanupRequest();
+    clearPreview();
 
     if (m_serverUrl.isEmpty()) {
         emit processingError("Server URL not set");
@@ -64,10 +97,13 @@ void ImageProcessor::handleCapturedImage(const QByteArray &jpgData, const QStrin
 
     // Create request
     QNetworkRequest request(m_serverUrl);
+    NetworkClient::instance()->prepare(request);
     request.setHeader(QNetworkRequest::UserAgentHeader, "ARClothTryOn/1.0");
 
     emit processingProgress(0.3);
 
+    m_requestTimer.start();
+
     // Send POST request
     m_currentReply = m_networkManager->post(request, multiPart);
     multiPart->setParent(m_currentReply); // Delete multiPart with reply
@@ -77,8 +113,13 @@ void ImageProcessor::handleCapturedImage(const QByteArray &jpgData, const QStrin
             this, &ImageProcessor::onReplyFinished);
     connect(m_currentReply, &QNetworkReply::uploadProgress, 
             this, &ImageProcessor::onUploadProgress);
+    connect(m_currentReply, &QNetworkReply::downloadProgress,
+            this, &ImageProcessor::onDownloadProgress);
+    connect(m_currentReply, &QNetworkReply::readyRead,
+            this, &ImageProcessor::onReadyRead);
 
-    qDebug() << "Sending image to server:" << m_serverUrl.toString();
+    qDebug() << "Sending image to server:" << m_serverUrl.toString()
+             << "request" << m_currentReply->request().rawHeader("X-Request-Id");
 }
 
 void ImageProcessor::onUploadProgress(qint64 bytesSent, qint64 bytesTotal) {
@@ -89,11 +130,84 @@ void ImageProcessor::onUploadProgress(qint64 bytesSent, qint64 bytesTotal) {
     }
 }
 
+void ImageProcessor::onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal) {
+    if (bytesTotal > 0) {
+        // Map download progress to 60-100% of total progress
+        qreal downloadProgress = static_cast<qreal>(bytesReceived) / bytesTotal;
+        emit processingProgress(0.6 + (downloadProgress * 0.4));
+    }
+}
+
+bool ImageProcessor::startStreaming() {
+    if (m_streaming) return true;
+
+    int httpStatus = m_currentReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus != 200) return false;
+
+    QString contentType = m_currentReply->header(QNetworkRequest::ContentTypeHeader).toString();
+    if (!contentType.startsWith("image/") && !contentType.startsWith("multipart/x-mixed-replace")) {
+        return false;
+    }
+
+    m_stream.reset(contentType.toLatin1());
+    m_streaming = true;
+    return true;
+}
+
+void ImageProcessor::onReadyRead() {
+    if (!m_currentReply || !startStreaming()) return;
+
+    m_stream.append(m_currentReply->readAll());
+    scheduleDecode();
+}
+
+void ImageProcessor::scheduleDecode() {
+    // A finishing decode calls back in here and picks up whatever became
+    // decodable meanwhile, so only the newest prefix or part is decoded.
+    if (m_decodeInFlight) return;
+
+    QByteArray data;
+    if (!m_stream.takeDecodable(&data)) return;
+
+    m_decodeInFlight = true;
+    const quint64 generation = m_generation;
+    m_decodePool.start([this, data, generation]() {
+        QBuffer buffer;
+        buffer.setData(data);
+        buffer.open(QIODevice::ReadOnly);
+        // A truncated JPEG decodes with the missing scans (or rows) left
+        // coarse, which is exactly the intermediate image we want.
+        QImageReader reader(&buffer);
+        QImage image = reader.read();
+        QMetaObject::invokeMethod(this, [this, image, generation]() {
+            finishDecode(image, generation);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ImageProcessor::finishDecode(const QImage &image, quint64 generation) {
+    m_decodeInFlight = false;
+
+    if (generation == m_generation && !image.isNull()) {
+        if (!m_hasPreview) {
+            qDebug() << "Try-on result: first pixels after" << m_requestTimer.elapsed() << "ms,"
+                     << m_stream.bytesReceived() << "bytes received";
+        }
+        TryOnPreviewProvider::publish(m_previewKey, image);
+        m_hasPreview = true;
+        ++m_previewRevision;
+        emit partialImageDecoded(image);
+        emit previewSourceChanged();
+    }
+
+    if (m_streaming) {
+        scheduleDecode();
+    }
+}
+
 void ImageProcessor::onReplyFinished() {
     if (!m_currentReply) return;
 
-    emit processingProgress(0.8);
-
     QNetworkReply::NetworkError error = m_currentReply->error();
     
     if (error == QNetworkReply::NoError) {
@@ -101,18 +215,25 @@ void ImageProcessor::onReplyFinished() {
         int httpStatus = m_currentReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
         
         if (httpStatus == 200) {
-            // Success - get response data
-            QByteArray responseData = m_currentReply->readAll();
-            
-            // Check content type to determine if it's an image or error message
-            QString contentType = m_currentReply->header(QNetworkRequest::ContentTypeHeader).toString();
-            
-            if (contentType.startsWith("image/")) {
+            // Image results have been streamed into m_stream; anything else
+            // is still in the reply
+            QByteArray responseData;
+            if (startStreaming()) {
+                m_stream.append(m_currentReply->readAll());
+                responseData = m_stream.finalImage();
+            }
+
+            if (!responseData.isEmpty()) {
+                qDebug() << "Try-on result complete after" << m_requestTimer.elapsed() << "ms,"
+                         << m_stream.bytesReceived() << "bytes, request"
+                         << m_currentReply->request().rawHeader("X-Request-Id");
                 emit processingProgress(1.0);
                 emit processedImageReceived(responseData);
+            } else if (m_streaming) {
+                emit processingError("Server error: empty image response");
             } else {
                 // Assume it's an error message
-                QString errorMsg = QString::fromUtf8(responseData);
+                QString errorMsg = QString::fromUtf8(m_currentReply->readAll());
                 emit processingError("Server error: " + errorMsg);
             }
         } else {
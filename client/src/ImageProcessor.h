@@ -6,12 +6,24 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QByteArray>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QThreadPool>
 #include <QUrl>
+#include "ProgressiveImageStream.h"
 
+// Sends a captured frame to the try-on server and streams the result back.
+// The response body is read as it arrives: progressive JPEG scans and the
+// parts of a multipart/x-mixed-replace response are decoded on a worker
+// while the rest is still downloading, and each decoded image is published
+// through previewSource ("image://tryon/...") so the preview can fill in
+// long before the last byte. processedImageReceived still carries the
+// complete encoded result.
 class ImageProcessor : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QUrl serverUrl READ serverUrl WRITE setServerUrl NOTIFY serverUrlChanged)
+    Q_PROPERTY(QUrl previewSource READ previewSource NOTIFY previewSourceChanged)
 
 public:
     explicit ImageProcessor(QObject *parent = nullptr);
@@ -20,24 +32,50 @@ public:
     QUrl serverUrl() const;
     void setServerUrl(const QUrl &url);
 
+    // Latest partially decoded result of the current request, or empty
+    QUrl previewSource() const;
+
     Q_INVOKABLE void handleCapturedImage(const QByteArray &jpgData, const QString &garmentId);
 
 signals:
     void processedImageReceived(const QByteArray &imageData);
+    // An intermediate result decoded while the response is still arriving
+    void partialImageDecoded(const QImage &image);
+    void previewSourceChanged();
     void processingProgress(qreal progress);
     void processingError(const QString &errorMessage);
     void serverUrlChanged();
 
 private slots:
+    void onReadyRead();
     void onReplyFinished();
     void onUploadProgress(qint64 bytesSent, qint64 bytesTotal);
+    void onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
 
 private:
     void cleanupRequest();
+    void clearPreview();
+    // Starts streaming once the headers show an image result; false for
+    // error responses, whose body is left in the reply for onReplyFinished.
+    bool startStreaming();
+    void scheduleDecode();
+    void finishDecode(const QImage &image, quint64 generation);
 
     QNetworkAccessManager *m_networkManager = nullptr;
     QNetworkReply *m_currentReply = nullptr;
     QUrl m_serverUrl;
+
+    ProgressiveImageStream m_stream;
+    bool m_streaming = false;
+    QThreadPool m_decodePool;
+    bool m_decodeInFlight = false;
+    // Bumped per request so decodes of an older response are dropped
+    quint64 m_generation = 0;
+
+    QString m_previewKey;
+    quint64 m_previewRevision = 0;
+    bool m_hasPreview = false;
+    QElapsedTimer m_requestTimer;
 };
 
 #endif // IMAGEPROCESSOR_H
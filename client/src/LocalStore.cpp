@@ -0,0 +1,366 @@
+#include "LocalStore.h"
+#include <QCborArray>
+#include <QCborValue>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+const QByteArray kMagic("ARSTORE\x01", 8);
+// Superseded entries tolerated on top of the live ones before a rewrite
+constexpr int kCompactSlack = 256;
+
+// Names of the kinds in /api/sync responses
+const char* const kKindKeys[LocalStore::KindCount] = {"garments", "scans", "models"};
+
+enum Op : int {
+    Put = 1,        // [Put, kind, garmentId, record]
+    Remove = 2,     // [Remove, kind, garmentId]
+    Cursor = 3,     // [Cursor, cursor, userId]
+};
+
+int kindFromKey(const QString& key) {
+    for (int kind = 0; kind < LocalStore::KindCount; ++kind) {
+        if (key == QLatin1String(kKindKeys[kind])) return kind;
+    }
+    return -1;
+}
+
+// One log entry: little-endian byte count, then the CBOR array
+QByteArray frame(const QCborArray& entry) {
+    const QByteArray cbor = QCborValue(entry).toCbor();
+    QByteArray framed(sizeof(quint32), Qt::Uninitialized);
+    qToLittleEndian<quint32>(quint32(cbor.size()), framed.data());
+    return framed + cbor;
+}
+
+QByteArray putEntry(int kind, const QString& garmentId, const QJsonObject& record) {
+    return frame({qint64(Put), kind, garmentId, QCborValue::fromJsonValue(record)});
+}
+
+QByteArray removeEntry(int kind, const QString& garmentId) {
+    return frame({qint64(Remove), kind, garmentId});
+}
+
+QByteArray cursorEntry(const QString& cursor, const QString& userId) {
+    return frame({qint64(Cursor), cursor, userId});
+}
+
+QDateTime timestamp(const QJsonValue& value) {
+    return QDateTime::fromString(value.toString(), Qt::ISODateWithMs);
+}
+}
+
+LocalStore* LocalStore::instance() {
+    static QPointer<LocalStore> store;
+    if (!store) {
+        Q_ASSERT(QCoreApplication::instance());
+        Q_ASSERT(QThread::currentThread() == QCoreApplication::instance()->thread());
+        store = new LocalStore(QString(), QCoreApplication::instance());
+    }
+    return store;
+}
+
+LocalStore::LocalStore(const QString& path, QObject* parent)
+    : QObject(parent),
+      m_path(path.isEmpty()
+                 ? QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/store/catalog.arstore"
+                 : path)
+{
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    load();
+}
+
+void LocalStore::load() {
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QElapsedTimer timer;
+    timer.start();
+    const QByteArray data = file.readAll();
+    file.close();
+    if (!data.startsWith(kMagic)) {
+        qWarning() << "Local store" << m_path << "is not a store file, starting empty";
+        QFile::remove(m_path);
+        return;
+    }
+
+    // Entries are replayed up to the first one that is cut short or does
+    // not parse; that is where the last write was torn.
+    qsizetype offset = kMagic.size();
+    while (data.size() - offset >= qsizetype(sizeof(quint32))) {
+        const qsizetype length = qFromLittleEndian<quint32>(data.constData() + offset);
+        if (length == 0 || length > data.size() - offset - qsizetype(sizeof(quint32))) break;
+        if (!replay(data.mid(offset + sizeof(quint32), length))) break;
+        offset += sizeof(quint32) + length;
+        ++m_logEntries;
+    }
+    if (offset < data.size()) {
+        qWarning() << "Local store: dropping" << data.size() - offset << "bytes after the last complete entry";
+        if (!QFile::resize(m_path, offset)) {
+            m_needsSnapshot = true;
+        }
+    }
+
+    qDebug() << "Local store loaded" << count(Garments) << "garments," << count(Scans) << "scans,"
+             << count(Models) << "models in" << timer.elapsed() << "ms";
+    compactIfNeeded();
+}
+
+bool LocalStore::replay(const QByteArray& entry) {
+    QCborParserError error;
+    const QCborArray fields = QCborValue::fromCbor(entry, &error).toArray();
+    if (error.error != QCborError::NoError || fields.isEmpty()) return false;
+
+    switch (fields.at(0).toInteger()) {
+    case Put:
+    case Remove: {
+        const qint64 kind = fields.at(1).toInteger(-1);
+        const QString garmentId = fields.at(2).toString();
+        if (kind < 0 || kind >= KindCount || garmentId.isEmpty()) return false;
+        if (fields.at(0).toInteger() == Put) {
+            m_records[kind].insert(garmentId, fields.at(3).toJsonValue().toObject());
+        } else {
+            m_records[kind].remove(garmentId);
+        }
+        return true;
+    }
+    case Cursor:
+        m_cursor = fields.at(1).toString();
+        m_userId = fields.at(2).toString();
+        return true;
+    default:
+        return false;
+    }
+}
+
+const QStringList& LocalStore::garmentOrder() const {
+    if (m_garmentOrderValid) return m_garmentOrder;
+
+    const QHash<QString, QJsonObject>& garments = m_records[Garments];
+    m_garmentOrder = garments.keys();
+    std::sort(m_garmentOrder.begin(), m_garmentOrder.end(), [&garments](const QString& a, const QString& b) {
+        // ISO 8601 timestamps and ObjectId hex strings both sort as text
+        const QJsonObject& first = *garments.constFind(a);
+        const QJsonObject& second = *garments.constFind(b);
+        const QString aCreated = first["createdAt"].toString();
+        const QString bCreated = second["createdAt"].toString();
+        if (aCreated != bCreated) return aCreated > bCreated;
+        return first["_id"].toString() > second["_id"].toString();
+    });
+    m_garmentOrderValid = true;
+    return m_garmentOrder;
+}
+
+QJsonArray LocalStore::garments(int first, int count) const {
+    const QStringList& order = garmentOrder();
+    first = qBound(0, first, int(order.size()));
+    const int last = count < 0 ? int(order.size()) : qMin(int(order.size()), first + count);
+
+    QJsonArray garments;
+    for (int i = first; i < last; ++i) {
+        garments.append(m_records[Garments].value(order.at(i)));
+    }
+    return garments;
+}
+
+bool LocalStore::applySyncPage(const QJsonObject& page) {
+    if (page["reset"].toBool()) {
+        m_resetting = true;
+        for (QSet<QString>& seen : m_resetSeen) seen.clear();
+    }
+
+    bool modified = false;
+    QByteArray frames;
+    int entries = 0;
+
+    for (int kind = 0; kind < KindCount; ++kind) {
+        for (const QJsonValue& value : page[kKindKeys[kind]].toArray()) {
+            const QJsonObject record = value.toObject();
+            const QString garmentId = record["garmentId"].toString();
+            if (garmentId.isEmpty()) continue;
+            if (m_resetting) m_resetSeen[kind].insert(garmentId);
+
+            // Sync windows overlap; records that did not change cost nothing
+            const auto it = m_records[kind].constFind(garmentId);
+            if (it != m_records[kind].constEnd() && *it == record) continue;
+
+            m_records[kind].insert(garmentId, record);
+            frames += putEntry(kind, garmentId, record);
+            ++entries;
+            modified = true;
+        }
+    }
+
+    for (const QJsonValue& value : page["deleted"].toArray()) {
+        const QJsonObject tombstone = value.toObject();
+        const int kind = kindFromKey(tombstone["kind"].toString());
+        const QString garmentId = tombstone["garmentId"].toString();
+        if (kind < 0) continue;
+        const auto it = m_records[kind].constFind(garmentId);
+        if (it == m_records[kind].constEnd()) continue;
+
+        // Deleted and created again under the same id: the newer one wins
+        const QDateTime updatedAt = timestamp(it->value("updatedAt"));
+        if (updatedAt.isValid() && updatedAt > timestamp(tombstone["deletedAt"])) continue;
+
+        m_records[kind].erase(it);
+        frames += removeEntry(kind, garmentId);
+        ++entries;
+        modified = true;
+    }
+
+    if (m_resetting && !page["hasMore"].toBool()) {
+        // The snapshot is complete; whatever it did not bring is gone
+        for (int kind = 0; kind < KindCount; ++kind) {
+            for (auto it = m_records[kind].begin(); it != m_records[kind].end();) {
+                if (m_resetSeen[kind].contains(it.key())) {
+                    ++it;
+                    continue;
+                }
+                frames += removeEntry(kind, it.key());
+                ++entries;
+                modified = true;
+                it = m_records[kind].erase(it);
+            }
+            m_resetSeen[kind].clear();
+        }
+        m_resetting = false;
+    }
+
+    m_cursor = page["cursor"].toString();
+    m_userId = page["userId"].toString();
+    // Mid-snapshot cursors are not persisted: a snapshot cut short is
+    // started again rather than continued without its final cleanup.
+    if (!m_resetting) {
+        frames += cursorEntry(m_cursor, m_userId);
+        ++entries;
+    }
+
+    append(frames, entries);
+    compactIfNeeded();
+
+    if (modified) {
+        m_garmentOrderValid = false;
+        emit changed();
+    }
+    return modified;
+}
+
+bool LocalStore::putGarments(const QJsonArray& garments) {
+    QByteArray frames;
+    int entries = 0;
+    for (const QJsonValue& value : garments) {
+        const QJsonObject record = value.toObject();
+        const QString garmentId = record["garmentId"].toString();
+        if (garmentId.isEmpty()) continue;
+        // Usually a page the last sync already brought
+        const auto it = m_records[Garments].constFind(garmentId);
+        if (it != m_records[Garments].constEnd() && *it == record) continue;
+
+        m_records[Garments].insert(garmentId, record);
+        frames += putEntry(Garments, garmentId, record);
+        ++entries;
+    }
+    if (entries == 0) return false;
+
+    append(frames, entries);
+    compactIfNeeded();
+    m_garmentOrderValid = false;
+    emit changed();
+    return true;
+}
+
+void LocalStore::setSyncing(bool syncing) {
+    if (m_syncing == syncing) return;
+    m_syncing = syncing;
+    if (!syncing && m_resetting) {
+        m_resetting = false;
+        for (QSet<QString>& seen : m_resetSeen) seen.clear();
+        m_cursor.clear();
+    }
+    emit syncingChanged(syncing);
+}
+
+void LocalStore::clear() {
+    const bool hadRecords = liveCount() > 0;
+    for (int kind = 0; kind < KindCount; ++kind) {
+        m_records[kind].clear();
+        m_resetSeen[kind].clear();
+    }
+    m_garmentOrderValid = false;
+    m_resetting = false;
+    m_cursor.clear();
+    m_userId.clear();
+    m_logEntries = 0;
+    m_needsSnapshot = false;
+    QFile::remove(m_path);
+
+    if (hadRecords) emit changed();
+}
+
+int LocalStore::liveCount() const {
+    int live = 0;
+    for (const QHash<QString, QJsonObject>& records : m_records) {
+        live += records.size();
+    }
+    return live;
+}
+
+void LocalStore::append(const QByteArray& frames, int entries) {
+    if (frames.isEmpty()) return;
+    if (m_needsSnapshot) return;    // compactIfNeeded() writes everything
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Local store: cannot write" << m_path << ":" << file.errorString();
+        m_needsSnapshot = true;
+        return;
+    }
+    const QByteArray data = file.size() == 0 ? kMagic + frames : frames;
+    if (file.write(data) != data.size() || !file.flush()) {
+        qWarning() << "Local store: write to" << m_path << "failed:" << file.errorString();
+        m_needsSnapshot = true;
+        return;
+    }
+    m_logEntries += entries;
+}
+
+void LocalStore::compactIfNeeded() {
+    const int live = liveCount() + 1;
+    if (!m_needsSnapshot && m_logEntries <= 2 * live + kCompactSlack) return;
+    // Mid-snapshot the store has nothing consistent to write; the snapshot's
+    // last page brings it back here.
+    if (m_resetting) return;
+
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Local store: cannot rewrite" << m_path << ":" << file.errorString();
+        return;
+    }
+    file.write(kMagic);
+    for (int kind = 0; kind < KindCount; ++kind) {
+        for (auto it = m_records[kind].cbegin(); it != m_records[kind].cend(); ++it) {
+            file.write(putEntry(kind, it.key(), it.value()));
+        }
+    }
+    file.write(cursorEntry(m_cursor, m_userId));
+    if (!file.commit()) {
+        qWarning() << "Local store: rewrite of" << m_path << "failed:" << file.errorString();
+        return;
+    }
+
+    qDebug() << "Local store compacted from" << m_logEntries << "to" << live << "entries";
+    m_logEntries = live;
+    m_needsSnapshot = false;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#ifndef LOCALSTORE_H
+#define LOCALSTORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+// Offline copy of the user's garments, scans and processed 3D models, shared
+// by every NetworkManager and QMLManager in the process. It is read from
+// disk when first used, so the catalog can be shown at startup before any
+// request goes out; NetworkManager::syncUserData() then brings it up to date
+// with GET /api/sync, which only sends what changed since the stored cursor.
+//
+// On disk (<app data>/store/catalog.arstore) the store is an append-only log
+// of length-prefixed CBOR entries after an 8-byte magic: puts and removals of
+// records, and the sync cursor. Each sync page is appended as one write with its cursor
+// last, so a write torn by a crash is dropped on the next load and the page
+// is simply fetched again. The log is rewritten as a snapshot once
+// superseded entries outnumber the live ones.
+class LocalStore : public QObject {
+    Q_OBJECT
+
+public:
+    enum Kind {
+        Garments,
+        Scans,
+        Models,
+        KindCount
+    };
+
+    static LocalStore* instance();
+
+    explicit LocalStore(const QString& path = QString(), QObject* parent = nullptr);
+
+    // Value to pass as `since` to /api/sync; empty until the first sync
+    QString cursor() const { return m_cursor; }
+    // Server id of the user the records belong to
+    QString userId() const { return m_userId; }
+
+    int count(Kind kind) const { return m_records[kind].size(); }
+    QJsonObject record(Kind kind, const QString& garmentId) const { return m_records[kind].value(garmentId); }
+    // `count` garments from position `first` in the server's catalog order
+    // (createdAt desc, _id desc); the catalog grid pages through these
+    QJsonArray garments(int first = 0, int count = -1) const;
+
+    // Applies one /api/sync response. Returns true when any record changed;
+    // changed() is emitted as well. A response with `reset` starts a full
+    // snapshot: records it does not bring are dropped when its last page
+    // (no `hasMore`) arrives, so a refresh never empties the catalog midway.
+    bool applySyncPage(const QJsonObject& page);
+    // Merges garments from a GET /garments page (NetworkManager::
+    // fetchGarments()) and leaves the cursor alone: the next sync still
+    // sends everything since the last one, deletions included. Returns true
+    // when any record changed.
+    bool putGarments(const QJsonArray& garments);
+    // Drops every record and the cursor, in memory and on disk.
+    void clear();
+
+    // Set by the NetworkManager running a sync so others do not start one.
+    // A snapshot left unfinished is started over by the next sync.
+    bool isSyncing() const { return m_syncing; }
+    void setSyncing(bool syncing);
+
+signals:
+    void changed();
+    void syncingChanged(bool syncing);
+
+private:
+    void load();
+    bool replay(const QByteArray& entry);
+    void append(const QByteArray& frames, int entries);
+    void compactIfNeeded();
+    int liveCount() const;
+    const QStringList& garmentOrder() const;
+
+    QString m_path;
+    QHash<QString, QJsonObject> m_records[KindCount];
+    // Garment ids in catalog order, rebuilt after the records change
+    mutable QStringList m_garmentOrder;
+    mutable bool m_garmentOrderValid = false;
+    QString m_cursor;
+    QString m_userId;
+    // Entries in the log file, live or superseded
+    int m_logEntries = 0;
+    // Set when an append failed; the next write is a full snapshot
+    bool m_needsSnapshot = false;
+    bool m_syncing = false;
+    // Snapshot in progress and the ids it has brought so far
+    bool m_resetting = false;
+    QSet<QString> m_resetSeen[KindCount];
+};
+
+#endif // LOCALSTORE_H
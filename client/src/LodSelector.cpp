@@ -0,0 +1,77 @@
+#include "LodSelector.h"
+#include <algorithm>
+
+namespace {
+// Exponential smoothing of the timing inputs
+constexpr double kSmoothing = 0.1;
+// Frames count as late when the average runs this far over budget
+constexpr double kLateFactor = 1.15;
+// Vsync caps frame times at the budget, so pressure is released after a
+// run of on-time frames rather than by frames getting faster
+constexpr int kRelaxFrames = 120;
+}
+
+void LodSelector::setLevels(std::vector<size_t> vertexCounts, std::vector<size_t> triangleCounts) {
+    m_vertexCounts = std::move(vertexCounts);
+    m_triangleCounts = std::move(triangleCounts);
+    m_level = 0;
+    m_refineFrames = 0;
+    m_msPerVertex = 0.0;
+    m_frameMs = 0.0;
+    m_pressure = 0;
+    m_onTimeFrames = 0;
+}
+
+size_t LodSelector::screenLevel(float projectedAreaPx) const {
+    if (projectedAreaPx <= 0.0f) return 0;
+    const double maxTriangles = projectedAreaPx / m_params.pixelsPerTriangle;
+    for (size_t level = 0; level < m_triangleCounts.size(); ++level) {
+        if (m_triangleCounts[level] <= maxTriangles) return level;
+    }
+    return m_triangleCounts.size() - 1;
+}
+
+size_t LodSelector::budgetLevel() const {
+    if (m_msPerVertex <= 0.0) return 0;
+    for (size_t level = 0; level < m_vertexCounts.size(); ++level) {
+        if (m_vertexCounts[level] * m_msPerVertex <= m_params.skinningBudgetMs) return level;
+    }
+    return m_vertexCounts.size() - 1;
+}
+
+size_t LodSelector::select(float projectedAreaPx, double skinningMs, double frameMs) {
+    if (m_vertexCounts.size() < 2) return 0;
+
+    if (skinningMs > 0.0 && m_vertexCounts[m_level] > 0) {
+        const double msPerVertex = skinningMs / double(m_vertexCounts[m_level]);
+        m_msPerVertex = m_msPerVertex > 0.0 ? m_msPerVertex + kSmoothing * (msPerVertex - m_msPerVertex)
+                                            : msPerVertex;
+    }
+    if (frameMs > 0.0) {
+        m_frameMs = m_frameMs > 0.0 ? m_frameMs + kSmoothing * (frameMs - m_frameMs) : frameMs;
+        if (m_frameMs > m_params.frameBudgetMs * kLateFactor) {
+            m_pressure = std::min(m_pressure + 1, m_vertexCounts.size() - 1);
+            // Let the average settle on the new level before pushing again
+            m_frameMs = m_params.frameBudgetMs;
+            m_onTimeFrames = 0;
+        } else if (m_pressure > 0 && ++m_onTimeFrames >= kRelaxFrames) {
+            --m_pressure;
+            m_onTimeFrames = 0;
+        }
+    }
+
+    const size_t last = m_vertexCounts.size() - 1;
+    const size_t wanted = std::min(last, std::max(screenLevel(projectedAreaPx), budgetLevel() + m_pressure));
+    if (wanted > m_level) {
+        m_level = wanted;
+        m_refineFrames = 0;
+    } else if (wanted < m_level) {
+        if (++m_refineFrames >= m_params.refineDelayFrames) {
+            m_level = wanted;
+            m_refineFrames = 0;
+        }
+    } else {
+        m_refineFrames = 0;
+    }
+    return m_level;
+}
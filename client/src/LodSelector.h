@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Picks the garment level of detail each frame.
+//
+// Two limits apply and the coarser one wins:
+//  - screen size: no more triangles than the garment's projected area can
+//    show (about pixelsPerTriangle pixels each);
+//  - time: the predicted skinning cost of a level, from the measured cost
+//    per vertex, must fit skinningBudgetMs. When whole frames run over
+//    frameBudgetMs the time limit tightens by one level, and relaxes again
+//    after a run of on-time frames.
+//
+// Moving to a coarser level happens at once; moving back to a finer one
+// waits for refineDelayFrames consistent frames so the mesh does not flicker
+// between levels.
+class LodSelector {
+public:
+    struct Params {
+        float pixelsPerTriangle = 24.0f;
+        double skinningBudgetMs = 3.0;
+        double frameBudgetMs = 1000.0 / 60.0;
+        int refineDelayFrames = 30;
+    };
+
+    LodSelector() = default;
+    explicit LodSelector(const Params& params) : m_params(params) {}
+
+    const Params& params() const { return m_params; }
+    void setParams(const Params& params) { m_params = params; }
+
+    // Vertex counts per level, finest first. Resets to level 0.
+    void setLevels(std::vector<size_t> vertexCounts, std::vector<size_t> triangleCounts);
+
+    // Feeds the last frame's measurements and returns the level to use.
+    // skinningMs is the cost of skinning `currentLevel()`; either time may
+    // be 0 when unknown.
+    size_t select(float projectedAreaPx, double skinningMs, double frameMs);
+
+    size_t currentLevel() const { return m_level; }
+
+private:
+    size_t screenLevel(float projectedAreaPx) const;
+    size_t budgetLevel() const;
+
+    Params m_params;
+    std::vector<size_t> m_vertexCounts;
+    std::vector<size_t> m_triangleCounts;
+    size_t m_level = 0;
+    int m_refineFrames = 0;
+
+    double m_msPerVertex = 0.0;   // smoothed skinning cost
+    double m_frameMs = 0.0;       // smoothed frame time
+    size_t m_pressure = 0;        // extra levels while frames run late
+    int m_onTimeFrames = 0;
+};
@@ -0,0 +1,796 @@
+#include "MeshCooker.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+struct ObjCorner {
+    int position = -1;
+    int texCoord = -1;
+    int normal = -1;
+
+    bool operator==(const ObjCorner& other) const {
+        return position == other.position && texCoord == other.texCoord && normal == other.normal;
+    }
+};
+
+struct ObjCornerHash {
+    size_t operator()(const ObjCorner& c) const {
+        size_t h = std::hash<int>()(c.position);
+        h ^= std::hash<int>()(c.texCoord) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<int>()(c.normal) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+// OBJ indices are 1-based; negative values count back from the end.
+int resolveIndex(const char* text, size_t count) {
+    if (!*text) return -1;
+    const long value = std::strtol(text, nullptr, 10);
+    if (value > 0) return value <= long(count) ? int(value - 1) : -2;
+    if (value < 0) return -value <= long(count) ? int(long(count) + value) : -2;
+    return -2;
+}
+
+bool setError(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+bool hasSuffix(const std::string& path, const char* suffix) {
+    const size_t length = std::strlen(suffix);
+    if (path.size() < length) return false;
+    for (size_t i = 0; i < length; ++i) {
+        if (std::tolower(static_cast<unsigned char>(path[path.size() - length + i])) != suffix[i]) return false;
+    }
+    return true;
+}
+
+bool readWholeFile(const std::string& path, std::string& bytes) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+// Just enough JSON for a glTF scene description.
+struct JsonValue {
+    enum Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    // Missing keys and indices read as null
+    const JsonValue& operator[](const std::string& key) const {
+        for (const auto& member : members) {
+            if (member.first == key) return member.second;
+        }
+        return null();
+    }
+    const JsonValue& operator[](long index) const {
+        return index >= 0 && size_t(index) < items.size() ? items[size_t(index)] : null();
+    }
+    bool isNull() const { return type == Null; }
+    double numberOr(double fallback) const { return type == Number ? number : fallback; }
+    // -1 when missing or not a non-negative integer
+    long index() const {
+        return type == Number && number >= 0.0 && number == std::floor(number)
+                   && number <= double(std::numeric_limits<int32_t>::max())
+                   ? long(number) : -1;
+    }
+
+    static const JsonValue& null() {
+        static const JsonValue value;
+        return value;
+    }
+};
+
+class JsonParser {
+public:
+    JsonParser(const char* begin, const char* end) : m_p(begin), m_end(end) {}
+
+    bool parse(JsonValue& value) {
+        if (!parseValue(value, 0)) return false;
+        skipSpace();
+        return m_p == m_end;
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    void skipSpace() {
+        while (m_p != m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r')) ++m_p;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (m_p == m_end || *m_p != c) return false;
+        ++m_p;
+        return true;
+    }
+
+    bool literal(const char* text) {
+        const size_t length = std::strlen(text);
+        if (size_t(m_end - m_p) < length || std::strncmp(m_p, text, length) != 0) return false;
+        m_p += length;
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, int depth) {
+        skipSpace();
+        if (m_p == m_end || depth > kMaxDepth) return false;
+        switch (*m_p) {
+        case '{':
+            value.type = JsonValue::Object;
+            ++m_p;
+            if (consume('}')) return true;
+            do {
+                std::pair<std::string, JsonValue> member;
+                skipSpace();
+                if (!parseString(member.first) || !consume(':') || !parseValue(member.second, depth + 1)) return false;
+                value.members.push_back(std::move(member));
+            } while (consume(','));
+            return consume('}');
+        case '[':
+            value.type = JsonValue::Array;
+            ++m_p;
+            if (consume(']')) return true;
+            do {
+                value.items.emplace_back();
+                if (!parseValue(value.items.back(), depth + 1)) return false;
+            } while (consume(','));
+            return consume(']');
+        case '"':
+            value.type = JsonValue::String;
+            return parseString(value.string);
+        case 't':
+            value.type = JsonValue::Bool;
+            value.boolean = true;
+            return literal("true");
+        case 'f':
+            value.type = JsonValue::Bool;
+            return literal("false");
+        case 'n':
+            return literal("null");
+        default:
+            return parseNumber(value);
+        }
+    }
+
+    bool parseNumber(JsonValue& value) {
+        const char* start = m_p;
+        while (m_p != m_end && (std::isdigit(static_cast<unsigned char>(*m_p)) || std::strchr("+-.eE", *m_p))) ++m_p;
+        const std::string text(start, m_p);
+        char* end = nullptr;
+        value.type = JsonValue::Number;
+        value.number = std::strtod(text.c_str(), &end);
+        return !text.empty() && end == text.c_str() + text.size();
+    }
+
+    bool parseString(std::string& out) {
+        if (m_p == m_end || *m_p != '"') return false;
+        ++m_p;
+        while (m_p != m_end && *m_p != '"') {
+            if (*m_p != '\\') {
+                out += *m_p++;
+                continue;
+            }
+            if (++m_p == m_end) return false;
+            const char escape = *m_p++;
+            switch (escape) {
+            case '"': case '\\': case '/': out += escape; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t code = 0;
+                if (!parseHex(code)) return false;
+                if (code >= 0xD800 && code < 0xDC00) {
+                    uint32_t low = 0;
+                    if (!literal("\\u") || !parseHex(low) || low < 0xDC00 || low >= 0xE000) return false;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        if (m_p == m_end) return false;
+        ++m_p;
+        return true;
+    }
+
+    bool parseHex(uint32_t& code) {
+        if (m_end - m_p < 4) return false;
+        for (int i = 0; i < 4; ++i, ++m_p) {
+            const char c = *m_p;
+            const int digit = c >= '0' && c <= '9' ? c - '0'
+                            : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                            : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+            if (digit < 0) return false;
+            code = code * 16 + uint32_t(digit);
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += char(code);
+        } else if (code < 0x800) {
+            out += char(0xC0 | (code >> 6));
+            out += char(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += char(0xE0 | (code >> 12));
+            out += char(0x80 | ((code >> 6) & 0x3F));
+            out += char(0x80 | (code & 0x3F));
+        } else {
+            out += char(0xF0 | (code >> 18));
+            out += char(0x80 | ((code >> 12) & 0x3F));
+            out += char(0x80 | ((code >> 6) & 0x3F));
+            out += char(0x80 | (code & 0x3F));
+        }
+    }
+
+    const char* m_p;
+    const char* m_end;
+};
+
+bool decodeBase64(const char* begin, const char* end, std::string& out) {
+    uint32_t bits = 0;
+    int count = 0;
+    for (const char* p = begin; p != end; ++p) {
+        const char c = *p;
+        if (c == '=') break;
+        const int value = c >= 'A' && c <= 'Z' ? c - 'A'
+                        : c >= 'a' && c <= 'z' ? c - 'a' + 26
+                        : c >= '0' && c <= '9' ? c - '0' + 52
+                        : c == '+' ? 62 : c == '/' ? 63 : -1;
+        if (value < 0) return false;
+        bits = (bits << 6) | uint32_t(value);
+        count += 6;
+        if (count >= 8) {
+            count -= 8;
+            out += char((bits >> count) & 0xFF);
+        }
+    }
+    return true;
+}
+
+// glTF 2.0 constants
+constexpr uint32_t kGlbMagic = 0x46546C67;      // "glTF"
+constexpr uint32_t kGlbChunkJson = 0x4E4F534A;  // "JSON"
+constexpr uint32_t kGlbChunkBin = 0x004E4942;   // "BIN\0"
+constexpr long kModeTriangles = 4;
+enum ComponentType : long {
+    Byte = 5120, UnsignedByte = 5121, Short = 5122, UnsignedShort = 5123, UnsignedInt = 5125, Float = 5126
+};
+
+uint32_t readLe32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));   // cooked files assume a little-endian host as well
+    return value;
+}
+
+struct GltfAsset {
+    std::string path;
+    JsonValue json;
+    std::vector<std::string> buffers;
+};
+
+bool loadGltf(const std::string& path, GltfAsset& asset, std::string* error) {
+    std::string bytes;
+    if (!readWholeFile(path, bytes)) return setError(error, "Cannot open " + path);
+    asset.path = path;
+
+    // A .glb is a JSON chunk followed by an optional binary chunk that
+    // stands in for the first buffer; a .gltf is the JSON alone.
+    const char* jsonBegin = bytes.data();
+    const char* jsonEnd = bytes.data() + bytes.size();
+    std::string binChunk;
+    bool hasBinChunk = false;
+    if (bytes.size() >= 12 && readLe32(bytes.data()) == kGlbMagic) {
+        if (readLe32(bytes.data() + 4) != 2) return setError(error, path + ": only glTF 2.0 is supported");
+        const size_t length = std::min<size_t>(readLe32(bytes.data() + 8), bytes.size());
+        size_t offset = 12;
+        bool hasJson = false;
+        while (offset + 8 <= length) {
+            const size_t chunkLength = readLe32(bytes.data() + offset);
+            const uint32_t chunkType = readLe32(bytes.data() + offset + 4);
+            offset += 8;
+            if (chunkLength > length - offset) return setError(error, path + ": truncated GLB chunk");
+            if (!hasJson) {
+                if (chunkType != kGlbChunkJson) return setError(error, path + ": GLB does not start with JSON");
+                jsonBegin = bytes.data() + offset;
+                jsonEnd = jsonBegin + chunkLength;
+                hasJson = true;
+            } else if (chunkType == kGlbChunkBin && !hasBinChunk) {
+                binChunk.assign(bytes.data() + offset, chunkLength);
+                hasBinChunk = true;
+            }
+            offset += (chunkLength + 3) & ~size_t(3);
+        }
+        if (!hasJson) return setError(error, path + ": GLB has no JSON chunk");
+    }
+
+    if (!JsonParser(jsonBegin, jsonEnd).parse(asset.json) || asset.json.type != JsonValue::Object) {
+        return setError(error, path + ": malformed glTF JSON");
+    }
+    if (asset.json["asset"]["version"].string.compare(0, 2, "2.") != 0) {
+        return setError(error, path + ": only glTF 2.0 is supported");
+    }
+    // Compressed geometry (Draco, meshopt) cannot be read here. Quantized
+    // attributes are plain accessors and are handled.
+    for (const JsonValue& extension : asset.json["extensionsRequired"].items) {
+        if (extension.string != "KHR_mesh_quantization") {
+            return setError(error, path + ": needs unsupported glTF extension " + extension.string);
+        }
+    }
+
+    const std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+    for (size_t i = 0; i < asset.json["buffers"].items.size(); ++i) {
+        const JsonValue& buffer = asset.json["buffers"].items[i];
+        const std::string& uri = buffer["uri"].string;
+        std::string data;
+        if (uri.empty()) {
+            if (i != 0 || !hasBinChunk) return setError(error, path + ": buffer " + std::to_string(i) + " has no data");
+            data = std::move(binChunk);
+        } else if (uri.compare(0, 5, "data:") == 0) {
+            const size_t comma = uri.find(',');
+            if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos
+                || !decodeBase64(uri.data() + comma + 1, uri.data() + uri.size(), data)) {
+                return setError(error, path + ": buffer " + std::to_string(i) + " has an unsupported data URI");
+            }
+        } else if (!readWholeFile(directory + uri, data)) {
+            return setError(error, "Cannot open " + directory + uri);
+        }
+        const double byteLength = buffer["byteLength"].numberOr(-1.0);
+        if (byteLength < 0.0 || byteLength > double(data.size())) {
+            return setError(error, path + ": buffer " + std::to_string(i) + " is shorter than its byteLength");
+        }
+        data.resize(size_t(byteLength));
+        asset.buffers.push_back(std::move(data));
+    }
+    return true;
+}
+
+int componentCount(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    return 0;
+}
+
+size_t componentSize(long componentType) {
+    switch (componentType) {
+    case Byte: case UnsignedByte: return 1;
+    case Short: case UnsignedShort: return 2;
+    case UnsignedInt: case Float: return 4;
+    default: return 0;
+    }
+}
+
+// One component as float; normalized integers map to [0, 1] / [-1, 1].
+float readComponent(const char* p, long componentType, bool normalized) {
+    switch (componentType) {
+    case Byte: {
+        const auto value = static_cast<int8_t>(*p);
+        return normalized ? std::max(value / 127.0f, -1.0f) : float(value);
+    }
+    case UnsignedByte: {
+        const auto value = static_cast<uint8_t>(*p);
+        return normalized ? value / 255.0f : float(value);
+    }
+    case Short: {
+        int16_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return normalized ? std::max(value / 32767.0f, -1.0f) : float(value);
+    }
+    case UnsignedShort: {
+        uint16_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return normalized ? value / 65535.0f : float(value);
+    }
+    default: {
+        float value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    }
+}
+
+// Locates the elements of an accessor: `data` points at the first one,
+// consecutive elements are `stride` bytes apart.
+struct AccessorView {
+    const char* data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    long componentType = 0;
+    bool normalized = false;
+};
+
+bool viewAccessor(const GltfAsset& asset, long index, int components, const char* name,
+                  AccessorView& view, std::string* error) {
+    const std::string where = asset.path + ": " + name;
+    const JsonValue& accessor = asset.json["accessors"][index];
+    if (accessor.isNull()) return setError(error, where + " refers to a missing accessor");
+    if (!accessor["sparse"].isNull()) return setError(error, where + " uses a sparse accessor");
+    if (componentCount(accessor["type"].string) != components) {
+        return setError(error, where + " has type " + accessor["type"].string);
+    }
+    view.componentType = long(accessor["componentType"].numberOr(0));
+    view.normalized = accessor["normalized"].boolean;
+    view.count = size_t(std::max(0L, accessor["count"].index()));
+    const size_t elementSize = componentSize(view.componentType) * size_t(components);
+    if (elementSize == 0) return setError(error, where + " has an unknown component type");
+
+    const JsonValue& bufferView = asset.json["bufferViews"][accessor["bufferView"].index()];
+    const long buffer = bufferView["buffer"].index();
+    if (bufferView.isNull() || buffer < 0 || size_t(buffer) >= asset.buffers.size()) {
+        return setError(error, where + " has no buffer data");
+    }
+    const std::string& bytes = asset.buffers[size_t(buffer)];
+    const size_t viewOffset = size_t(std::max(0L, bufferView["byteOffset"].index()));
+    const size_t viewLength = size_t(std::max(0L, bufferView["byteLength"].index()));
+    const size_t accessorOffset = size_t(std::max(0L, accessor["byteOffset"].index()));
+    view.stride = size_t(std::max(0L, bufferView["byteStride"].index()));
+    if (view.stride == 0) view.stride = elementSize;
+    if (viewOffset > bytes.size() || viewLength > bytes.size() - viewOffset || view.stride < elementSize
+        || (view.count > 0 && accessorOffset + view.stride * (view.count - 1) + elementSize > viewLength)) {
+        return setError(error, where + " reaches past its buffer");
+    }
+    view.data = bytes.data() + viewOffset + accessorOffset;
+    return true;
+}
+
+// Reads an attribute of the first primitive into one stream per component.
+bool readAttribute(const GltfAsset& asset, const char* name, int components,
+                   std::initializer_list<std::vector<float>*> streams, std::string* error) {
+    AccessorView view;
+    if (!viewAccessor(asset, asset.json["meshes"][0]["primitives"][0]["attributes"][name].index(),
+                      components, name, view, error)) {
+        return false;
+    }
+    if (view.componentType == UnsignedInt) return setError(error, asset.path + ": " + name + " is not float data");
+    const size_t size = componentSize(view.componentType);
+    size_t c = 0;
+    for (std::vector<float>* stream : streams) {
+        stream->resize(view.count);
+        for (size_t i = 0; i < view.count; ++i) {
+            (*stream)[i] = readComponent(view.data + i * view.stride + c * size, view.componentType, view.normalized);
+        }
+        ++c;
+    }
+    return true;
+}
+
+} // namespace
+
+namespace MeshCooker {
+
+std::string cookedPathFor(const std::string& sourcePath) {
+    const size_t slash = sourcePath.find_last_of("/\\");
+    const size_t dot = sourcePath.find_last_of('.');
+    const bool hasSuffix = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    return (hasSuffix ? sourcePath.substr(0, dot) : sourcePath) + MeshFormat::kFileSuffix;
+}
+
+bool parseFile(const std::string& path, CookedMesh& mesh, std::string* error) {
+    if (hasSuffix(path, ".glb") || hasSuffix(path, ".gltf")) return parseGltf(path, mesh, error);
+    return parseObj(path, mesh, error);
+}
+
+bool parseObj(const std::string& path, CookedMesh& mesh, std::string* error) {
+    std::ifstream in(path);
+    if (!in) return setError(error, "Cannot open " + path);
+
+    std::vector<float> positions, texCoords, normals;   // packed xyz / uv / xyz
+    std::unordered_map<ObjCorner, uint32_t, ObjCornerHash> welded;
+    std::vector<ObjCorner> corners;
+    std::vector<uint32_t> face;
+    bool missingNormals = false;
+    bool anyTexCoords = false;
+
+    mesh = CookedMesh();
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        const char* p = line.c_str();
+        while (*p == ' ' || *p == '\t') ++p;
+
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            char* end = nullptr;
+            const float x = std::strtof(p + 2, &end);
+            const float y = std::strtof(end, &end);
+            const float z = std::strtof(end, &end);
+            positions.insert(positions.end(), {x, y, z});
+        } else if (p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+            char* end = nullptr;
+            const float u = std::strtof(p + 3, &end);
+            const float v = std::strtof(end, &end);
+            texCoords.insert(texCoords.end(), {u, v});
+        } else if (p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')) {
+            char* end = nullptr;
+            const float x = std::strtof(p + 3, &end);
+            const float y = std::strtof(end, &end);
+            const float z = std::strtof(end, &end);
+            normals.insert(normals.end(), {x, y, z});
+        } else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            face.clear();
+            std::istringstream tokens(p + 2);
+            std::string token;
+            while (tokens >> token) {
+                ObjCorner corner;
+                const size_t firstSlash = token.find('/');
+                const size_t secondSlash = firstSlash == std::string::npos
+                                               ? std::string::npos : token.find('/', firstSlash + 1);
+                corner.position = resolveIndex(token.substr(0, firstSlash).c_str(), positions.size() / 3);
+                if (firstSlash != std::string::npos) {
+                    corner.texCoord = resolveIndex(token.substr(firstSlash + 1, secondSlash - firstSlash - 1).c_str(),
+                                                   texCoords.size() / 2);
+                }
+                if (secondSlash != std::string::npos) {
+                    corner.normal = resolveIndex(token.substr(secondSlash + 1).c_str(), normals.size() / 3);
+                }
+                if (corner.position < 0 || corner.texCoord < -1 || corner.normal < -1) {
+                    return setError(error, path + ":" + std::to_string(lineNumber) + ": bad face index");
+                }
+
+                auto found = welded.find(corner);
+                if (found == welded.end()) {
+                    found = welded.emplace(corner, uint32_t(corners.size())).first;
+                    corners.push_back(corner);
+                }
+                face.push_back(found->second);
+            }
+            if (face.size() < 3) {
+                return setError(error, path + ":" + std::to_string(lineNumber) + ": face with fewer than 3 corners");
+            }
+            for (size_t i = 2; i < face.size(); ++i) {
+                mesh.indices.insert(mesh.indices.end(), {face[0], face[i - 1], face[i]});
+            }
+        }
+        // Groups, materials and smoothing groups do not affect geometry.
+    }
+
+    if (corners.empty() || mesh.indices.empty()) {
+        return setError(error, path + " has no triangles");
+    }
+
+    const size_t count = corners.size();
+    mesh.px.resize(count); mesh.py.resize(count); mesh.pz.resize(count);
+    mesh.nx.resize(count); mesh.ny.resize(count); mesh.nz.resize(count);
+    for (const ObjCorner& corner : corners) {
+        anyTexCoords = anyTexCoords || corner.texCoord >= 0;
+    }
+    if (anyTexCoords) {
+        mesh.u.resize(count); mesh.v.resize(count);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const ObjCorner& corner = corners[i];
+        mesh.px[i] = positions[3 * corner.position];
+        mesh.py[i] = positions[3 * corner.position + 1];
+        mesh.pz[i] = positions[3 * corner.position + 2];
+        if (corner.normal >= 0) {
+            mesh.nx[i] = normals[3 * corner.normal];
+            mesh.ny[i] = normals[3 * corner.normal + 1];
+            mesh.nz[i] = normals[3 * corner.normal + 2];
+        } else {
+            missingNormals = true;
+        }
+        if (anyTexCoords && corner.texCoord >= 0) {
+            mesh.u[i] = texCoords[2 * corner.texCoord];
+            mesh.v[i] = texCoords[2 * corner.texCoord + 1];
+        }
+    }
+
+    if (missingNormals) {
+        computeNormals(mesh);
+    }
+    computeBounds(mesh);
+    return true;
+}
+
+bool parseGltf(const std::string& path, CookedMesh& mesh, std::string* error) {
+    GltfAsset asset;
+    if (!loadGltf(path, asset, error)) return false;
+
+    mesh = CookedMesh();
+    const JsonValue& primitive = asset.json["meshes"][0]["primitives"][0];
+    if (primitive.isNull()) return setError(error, path + " has no mesh primitive");
+    if (long(primitive["mode"].numberOr(double(kModeTriangles))) != kModeTriangles) {
+        return setError(error, path + ": first primitive is not a triangle list");
+    }
+    const JsonValue& attributes = primitive["attributes"];
+
+    if (!readAttribute(asset, "POSITION", 3, {&mesh.px, &mesh.py, &mesh.pz}, error)) return false;
+    const size_t count = mesh.vertexCount();
+    const bool missingNormals = attributes["NORMAL"].isNull();
+    if (!missingNormals && !readAttribute(asset, "NORMAL", 3, {&mesh.nx, &mesh.ny, &mesh.nz}, error)) return false;
+    if (!attributes["TEXCOORD_0"].isNull()) {
+        if (!readAttribute(asset, "TEXCOORD_0", 2, {&mesh.u, &mesh.v}, error)) return false;
+        // glTF puts the texture origin top left, OBJ (and so the cooked
+        // format) bottom left.
+        for (float& v : mesh.v) {
+            v = 1.0f - v;
+        }
+    }
+    if ((!missingNormals && mesh.nx.size() != count) || (!mesh.u.empty() && mesh.u.size() != count)) {
+        return setError(error, path + ": attributes differ in vertex count");
+    }
+
+    if (primitive["indices"].isNull()) {
+        mesh.indices.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            mesh.indices[i] = uint32_t(i);
+        }
+    } else {
+        AccessorView indices;
+        if (!viewAccessor(asset, primitive["indices"].index(), 1, "indices", indices, error)) return false;
+        if (indices.componentType != UnsignedByte && indices.componentType != UnsignedShort
+            && indices.componentType != UnsignedInt) {
+            return setError(error, path + ": indices are not unsigned integers");
+        }
+        mesh.indices.resize(indices.count);
+        for (size_t i = 0; i < indices.count; ++i) {
+            const char* p = indices.data + i * indices.stride;
+            const uint32_t index = indices.componentType == UnsignedInt
+                                       ? readLe32(p) : uint32_t(readComponent(p, indices.componentType, false));
+            if (index >= count) return setError(error, path + ": index out of range");
+            mesh.indices[i] = index;
+        }
+    }
+    if (count == 0 || mesh.indices.empty() || mesh.indices.size() % 3 != 0) {
+        return setError(error, path + " has no triangles");
+    }
+
+    if (missingNormals) {
+        computeNormals(mesh);
+    }
+    computeBounds(mesh);
+    return true;
+}
+
+void computeNormals(CookedMesh& mesh) {
+    const size_t count = mesh.vertexCount();
+    mesh.nx.assign(count, 0.0f);
+    mesh.ny.assign(count, 0.0f);
+    mesh.nz.assign(count, 0.0f);
+
+    for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3) {
+        const uint32_t a = mesh.indices[t], b = mesh.indices[t + 1], c = mesh.indices[t + 2];
+        const float e1x = mesh.px[b] - mesh.px[a], e1y = mesh.py[b] - mesh.py[a], e1z = mesh.pz[b] - mesh.pz[a];
+        const float e2x = mesh.px[c] - mesh.px[a], e2y = mesh.py[c] - mesh.py[a], e2z = mesh.pz[c] - mesh.pz[a];
+        // Unnormalised cross product: longer for larger triangles.
+        const float fx = e1y * e2z - e1z * e2y;
+        const float fy = e1z * e2x - e1x * e2z;
+        const float fz = e1x * e2y - e1y * e2x;
+        for (uint32_t i : {a, b, c}) {
+            mesh.nx[i] += fx; mesh.ny[i] += fy; mesh.nz[i] += fz;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const float length = std::sqrt(mesh.nx[i] * mesh.nx[i] + mesh.ny[i] * mesh.ny[i] + mesh.nz[i] * mesh.nz[i]);
+        if (length > 0.0f) {
+            mesh.nx[i] /= length; mesh.ny[i] /= length; mesh.nz[i] /= length;
+        } else {
+            mesh.nx[i] = 0.0f; mesh.ny[i] = 1.0f; mesh.nz[i] = 0.0f;
+        }
+    }
+}
+
+void computeBounds(CookedMesh& mesh) {
+    if (mesh.px.empty()) {
+        std::fill(std::begin(mesh.boundsMin), std::end(mesh.boundsMin), 0.0f);
+        std::fill(std::begin(mesh.boundsMax), std::end(mesh.boundsMax), 0.0f);
+        return;
+    }
+    const std::vector<float>* axes[3] = {&mesh.px, &mesh.py, &mesh.pz};
+    for (int axis = 0; axis < 3; ++axis) {
+        const auto range = std::minmax_element(axes[axis]->begin(), axes[axis]->end());
+        mesh.boundsMin[axis] = *range.first;
+        mesh.boundsMax[axis] = *range.second;
+    }
+}
+
+bool write(const CookedMesh& mesh, const std::string& path, std::string* error) {
+    using namespace MeshFormat;
+
+    const size_t count = mesh.vertexCount();
+    const bool hasNormals = mesh.nx.size() == count && mesh.ny.size() == count && mesh.nz.size() == count;
+    const bool hasTexCoords = !mesh.u.empty() && mesh.u.size() == count && mesh.v.size() == count;
+    if (count == 0 || count > std::numeric_limits<uint32_t>::max() || mesh.indices.size() % 3 != 0
+        || mesh.py.size() != count || mesh.pz.size() != count) {
+        return setError(error, "Mesh streams are inconsistent");
+    }
+    for (uint32_t index : mesh.indices) {
+        if (index >= count) return setError(error, "Mesh index out of range");
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.headerSize = sizeof(Header);
+    header.flags = (hasNormals ? HasNormals : 0u) | (hasTexCoords ? HasTexCoords : 0u);
+    header.vertexCount = uint32_t(count);
+    header.indexCount = uint32_t(mesh.indices.size());
+    std::copy(std::begin(mesh.boundsMin), std::end(mesh.boundsMin), header.boundsMin);
+    std::copy(std::begin(mesh.boundsMax), std::end(mesh.boundsMax), header.boundsMax);
+
+    const void* data[StreamCount] = {
+        mesh.px.data(), mesh.py.data(), mesh.pz.data(),
+        hasNormals ? mesh.nx.data() : nullptr, hasNormals ? mesh.ny.data() : nullptr,
+        hasNormals ? mesh.nz.data() : nullptr,
+        hasTexCoords ? mesh.u.data() : nullptr, hasTexCoords ? mesh.v.data() : nullptr,
+        mesh.indices.data()
+    };
+
+    uint64_t cursor = alignUp(sizeof(Header));
+    for (uint32_t i = 0; i < StreamCount; ++i) {
+        const uint64_t size = !data[i] ? 0
+                            : (i == Indices ? mesh.indices.size() * sizeof(uint32_t) : count * sizeof(float));
+        header.streams[i].offset = size ? cursor : 0;
+        header.streams[i].size = size;
+        cursor = alignUp(cursor + size);
+    }
+
+    // Write next to the target and swap it in, so a reader never maps a
+    // half-written file.
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) return setError(error, "Cannot write " + tempPath);
+
+        static const char padding[kStreamAlignment] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        uint64_t written = sizeof(header);
+        for (uint32_t i = 0; i < StreamCount; ++i) {
+            const StreamRange& range = header.streams[i];
+            if (!range.size) continue;
+            out.write(padding, std::streamsize(range.offset - written));
+            out.write(static_cast<const char*>(data[i]), std::streamsize(range.size));
+            written = range.offset + range.size;
+        }
+        out.flush();
+        if (!out) {
+            std::remove(tempPath.c_str());
+            return setError(error, "Failed writing " + tempPath);
+        }
+    }
+
+    std::remove(path.c_str());   // rename() does not replace on Windows
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return setError(error, "Cannot replace " + path);
+    }
+    return true;
+}
+
+bool cookFile(const std::string& sourcePath, const std::string& outputPath, std::string* error) {
+    CookedMesh mesh;
+    return parseFile(sourcePath, mesh, error) && write(mesh, outputPath, error);
+}
+
+} // namespace MeshCooker
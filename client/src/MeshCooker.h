@@ -0,0 +1,48 @@
+// MeshCooker.h
+#pragma once
+#include "MeshFormat.h"
+#include <string>
+#include <vector>
+
+// In-memory mesh in the cooked (structure of arrays) layout.
+struct CookedMesh {
+    std::vector<float> px, py, pz;
+    std::vector<float> nx, ny, nz;
+    std::vector<float> u, v;          // empty when the source has no UVs
+    std::vector<uint32_t> indices;
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+
+    size_t vertexCount() const { return px.size(); }
+};
+
+// Turns source assets into *.amesh files (see MeshFormat.h). Used offline by
+// the meshcook tool and by ClothFitter to cook a downloaded model once before
+// mapping it.
+namespace MeshCooker {
+    // parseGltf for *.glb / *.gltf, parseObj for anything else.
+    bool parseFile(const std::string& path, CookedMesh& mesh, std::string* error = nullptr);
+
+    // Wavefront OBJ: v/vt/vn/f, polygons are fan triangulated and identical
+    // position/uv/normal triples are welded into one vertex.
+    bool parseObj(const std::string& path, CookedMesh& mesh, std::string* error = nullptr);
+
+    // glTF 2.0, binary (.glb) or JSON with embedded or side-by-side
+    // buffers: positions, normals, UVs and indices of the first primitive of
+    // the first mesh, in the mesh's own space (node transforms are not
+    // applied). UVs are flipped to the OBJ convention. Compressed geometry
+    // (Draco, meshopt) is refused.
+    bool parseGltf(const std::string& path, CookedMesh& mesh, std::string* error = nullptr);
+
+    // Area-weighted vertex normals from the triangle list.
+    void computeNormals(CookedMesh& mesh);
+    void computeBounds(CookedMesh& mesh);
+
+    bool write(const CookedMesh& mesh, const std::string& path, std::string* error = nullptr);
+
+    // parseFile + write; the output replaces `outputPath` atomically.
+    bool cookFile(const std::string& sourcePath, const std::string& outputPath, std::string* error = nullptr);
+
+    // "<dir>/model.obj" -> "<dir>/model.amesh"
+    std::string cookedPathFor(const std::string& sourcePath);
+}
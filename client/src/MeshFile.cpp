@@ -0,0 +1,124 @@
+#include "MeshFile.h"
+#include <QDebug>
+#include <QFile>
+#include <algorithm>
+#include <new>
+
+namespace {
+void freeAligned(unsigned char* buffer) {
+    ::operator delete(buffer, std::align_val_t(MeshFormat::kStreamAlignment));
+}
+}
+
+MeshFile::MeshFile()
+    : m_buffer(nullptr, freeAligned)
+{
+}
+
+MeshFile::~MeshFile() {
+    close();
+}
+
+bool MeshFile::isCookedPath(const std::string& path) {
+    const std::string suffix = MeshFormat::kFileSuffix;
+    return path.size() >= suffix.size()
+        && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool MeshFile::fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    close();
+    return false;
+}
+
+void MeshFile::close() {
+    m_header = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+    m_buffer.reset();
+    // Destroying the QFile releases the mapping.
+    m_file.reset();
+}
+
+bool MeshFile::open(const std::string& path, std::string* error) {
+    using namespace MeshFormat;
+    close();
+
+    m_file = std::make_unique<QFile>(QString::fromStdString(path));
+    if (!m_file->open(QIODevice::ReadOnly)) {
+        return fail(error, "Cannot open " + path + ": " + m_file->errorString().toStdString());
+    }
+
+    m_size = uint64_t(m_file->size());
+    if (m_size < sizeof(Header)) {
+        return fail(error, path + " is too small to be a cooked mesh");
+    }
+
+    m_data = m_file->map(0, qint64(m_size));
+    if (!m_data) {
+        // Mapping is not available everywhere; one aligned read keeps the
+        // stream pointers valid in that case.
+        qDebug() << "Mesh file not mappable, reading:" << QString::fromStdString(path);
+        m_buffer.reset(static_cast<unsigned char*>(::operator new(m_size, std::align_val_t(kStreamAlignment))));
+        if (m_file->read(reinterpret_cast<char*>(m_buffer.get()), qint64(m_size)) != qint64(m_size)) {
+            return fail(error, "Short read on " + path);
+        }
+        m_data = m_buffer.get();
+    }
+
+    const auto* header = reinterpret_cast<const Header*>(m_data);
+    if (header->magic != kMagic) {
+        return fail(error, path + " is not a cooked mesh");
+    }
+    if (header->version != kVersion || header->headerSize != sizeof(Header)) {
+        return fail(error, path + " has unsupported mesh version " + std::to_string(header->version));
+    }
+    if (header->indexCount % 3 != 0) {
+        return fail(error, path + " index count is not a triangle list");
+    }
+
+    const uint64_t vertexBytes = uint64_t(header->vertexCount) * sizeof(float);
+    for (uint32_t i = 0; i < StreamCount; ++i) {
+        const StreamRange& range = header->streams[i];
+        const bool optional = (i >= NormalX && i <= NormalZ && !(header->flags & HasNormals))
+                           || (i >= TexCoordU && i <= TexCoordV && !(header->flags & HasTexCoords));
+        const uint64_t expected = (i == Indices) ? uint64_t(header->indexCount) * sizeof(uint32_t)
+                                : optional ? 0 : vertexBytes;
+
+        if (range.size != expected) {
+            return fail(error, path + " stream " + std::to_string(i) + " has the wrong size");
+        }
+        if (range.size == 0) continue;
+        if (range.offset % kStreamAlignment != 0 || range.offset < sizeof(Header)
+            || range.offset > m_size || range.size > m_size - range.offset) {
+            return fail(error, path + " stream " + std::to_string(i) + " is out of bounds");
+        }
+    }
+
+    // Skinning and the renderer index the vertex streams without checks, so
+    // an index past the vertices must not get through (cache corruption, or
+    // a file that was not written by MeshCooker).
+    if (header->indexCount > 0) {
+        const auto* indices = reinterpret_cast<const uint32_t*>(m_data + header->streams[Indices].offset);
+        const uint32_t maxIndex = *std::max_element(indices, indices + header->indexCount);
+        if (maxIndex >= header->vertexCount) {
+            return fail(error, path + " references vertex " + std::to_string(maxIndex) + " of "
+                                   + std::to_string(header->vertexCount));
+        }
+    }
+
+    m_header = header;
+    return true;
+}
+
+const float* MeshFile::stream(MeshFormat::Stream stream) const {
+    if (!m_header || stream >= MeshFormat::Indices) return nullptr;
+    const MeshFormat::StreamRange& range = m_header->streams[stream];
+    return range.size ? reinterpret_cast<const float*>(m_data + range.offset) : nullptr;
+}
+
+const uint32_t* MeshFile::indices() const {
+    if (!m_header) return nullptr;
+    const MeshFormat::StreamRange& range = m_header->streams[MeshFormat::Indices];
+    return range.size ? reinterpret_cast<const uint32_t*>(m_data + range.offset) : nullptr;
+}
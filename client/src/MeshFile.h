@@ -0,0 +1,47 @@
+// MeshFile.h
+#pragma once
+#include "MeshFormat.h"
+#include <memory>
+#include <string>
+
+class QFile;
+
+// Read-only view of a cooked mesh. open() maps the file, validates the
+// header and checks that every index is in range; the stream accessors then
+// point straight into the mapping, so loading costs no copies, only one
+// pass over the indices.
+class MeshFile {
+public:
+    MeshFile();
+    ~MeshFile();
+    MeshFile(const MeshFile&) = delete;
+    MeshFile& operator=(const MeshFile&) = delete;
+
+    bool open(const std::string& path, std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    uint32_t vertexCount() const { return m_header ? m_header->vertexCount : 0; }
+    uint32_t indexCount() const { return m_header ? m_header->indexCount : 0; }
+    bool hasNormals() const { return m_header && (m_header->flags & MeshFormat::HasNormals); }
+    bool hasTexCoords() const { return m_header && (m_header->flags & MeshFormat::HasTexCoords); }
+
+    const float* boundsMin() const { return m_header ? m_header->boundsMin : nullptr; }
+    const float* boundsMax() const { return m_header ? m_header->boundsMax : nullptr; }
+
+    // Float vertex stream, or nullptr when the stream is absent.
+    const float* stream(MeshFormat::Stream stream) const;
+    const uint32_t* indices() const;
+
+    static bool isCookedPath(const std::string& path);
+
+private:
+    bool fail(std::string* error, const std::string& message);
+
+    std::unique_ptr<QFile> m_file;
+    // Only used when the file cannot be mapped (e.g. compressed resources).
+    std::unique_ptr<unsigned char, void (*)(unsigned char*)> m_buffer;
+    const unsigned char* m_data = nullptr;
+    uint64_t m_size = 0;
+    const MeshFormat::Header* m_header = nullptr;
+};
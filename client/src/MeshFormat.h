@@ -0,0 +1,60 @@
+// MeshFormat.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// On-disk layout of cooked garment meshes (*.amesh).
+//
+// A fixed 192-byte header is followed by one tightly packed array per
+// stream. Vertex attributes are stored as separate float streams (x[], y[],
+// z[], ...) so they can be fed to SIMD code and uploaded without
+// re-arranging. Every stream starts on a 64-byte boundary, so a mapped file
+// is used in place without copying. All values are little-endian.
+namespace MeshFormat {
+
+constexpr uint32_t kMagic = 0x48534D41;   // "AMSH"
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kStreamAlignment = 64;
+constexpr const char* kFileSuffix = ".amesh";
+
+enum Stream : uint32_t {
+    PositionX,
+    PositionY,
+    PositionZ,
+    NormalX,
+    NormalY,
+    NormalZ,
+    TexCoordU,
+    TexCoordV,
+    Indices,        // uint32 triangle list
+    StreamCount
+};
+
+enum Flags : uint32_t {
+    HasNormals   = 1u << 0,
+    HasTexCoords = 1u << 1
+};
+
+struct StreamRange {
+    uint64_t offset;   // from start of file, multiple of kStreamAlignment
+    uint64_t size;     // in bytes; 0 when the stream is absent
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t flags;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    StreamRange streams[StreamCount];
+};
+static_assert(sizeof(Header) == 192, "MeshFormat::Header layout changed");
+
+inline uint64_t alignUp(uint64_t value) {
+    return (value + kStreamAlignment - 1) & ~uint64_t(kStreamAlignment - 1);
+}
+
+} // namespace MeshFormat
@@ -0,0 +1,451 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+// Boundary-plane quadrics are scaled up so open edges keep their shape.
+constexpr double kBoundaryWeight = 10.0;
+// A collapse may not turn a neighbouring triangle by more than ~75 degrees.
+constexpr double kMinNormalCosine = 0.25;
+
+enum VertexKind : uint8_t {
+    Interior,
+    Border,     // on an open boundary; collapses only along it
+    Locked,     // UV seam or non-manifold
+};
+
+// Symmetric 4x4 quadric plus the total weight, so the error can be
+// reported as a squared distance.
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0, c = 0;
+    double w = 0;
+
+    void addPlane(double nx, double ny, double nz, double d, double weight) {
+        a00 += weight * nx * nx; a01 += weight * nx * ny; a02 += weight * nx * nz;
+        a11 += weight * ny * ny; a12 += weight * ny * nz; a22 += weight * nz * nz;
+        b0 += weight * nx * d; b1 += weight * ny * d; b2 += weight * nz * d;
+        c += weight * d * d;
+        w += weight;
+    }
+
+    void add(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2; c += q.c; w += q.w;
+    }
+
+    double error(double x, double y, double z) const {
+        const double e = a00 * x * x + a11 * y * y + a22 * z * z
+                       + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                       + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return w > 0.0 ? std::fabs(e) / w : 0.0;
+    }
+};
+
+struct Vec3 {
+    double x, y, z;
+};
+
+Vec3 sub(const Vec3& a, const Vec3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+Vec3 cross(const Vec3& a, const Vec3& b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+double dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+double length(const Vec3& a) { return std::sqrt(dot(a, a)); }
+
+uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+struct WeldKey {
+    uint32_t bits[5];
+    bool operator==(const WeldKey& other) const { return std::memcmp(bits, other.bits, sizeof(bits)) == 0; }
+};
+
+struct WeldKeyHash {
+    size_t operator()(const WeldKey& key) const {
+        size_t h = 0;
+        for (uint32_t b : key.bits) h ^= std::hash<uint32_t>()(b) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+WeldKey weldKey(const CookedMesh& mesh, size_t i, bool withUv) {
+    WeldKey key = {};
+    const float values[5] = {mesh.px[i], mesh.py[i], mesh.pz[i],
+                             withUv ? mesh.u[i] : 0.0f, withUv ? mesh.v[i] : 0.0f};
+    std::memcpy(key.bits, values, sizeof(values));
+    return key;
+}
+
+// Working state for one simplification run. Vertices are welded on
+// position + UV; the cooker also splits on normals, but cloth is smooth, so
+// normals are recomputed for the result instead of being kept as seams.
+class Simplifier {
+public:
+    explicit Simplifier(const CookedMesh& mesh) : m_source(mesh) {}
+
+    CookedMesh run(const MeshSimplifier::Options& options, float* resultError);
+
+private:
+    void weld();
+    void classify();
+    void countEdges();
+    uint32_t edgeUse(uint32_t pa, uint32_t pb) const {
+        const auto it = m_edgeUse.find(edgeKey(pa, pb));
+        return it != m_edgeUse.end() ? it->second : 0;
+    }
+    void buildQuadrics();
+    void buildAdjacency();
+    bool canCollapse(uint32_t u, uint32_t v) const;
+    size_t collapse(uint32_t u, uint32_t v);
+    void compactTriangles();
+    CookedMesh extract() const;
+
+    Vec3 position(uint32_t vertex) const {
+        return {m_source.px[vertex], m_source.py[vertex], m_source.pz[vertex]};
+    }
+
+    const CookedMesh& m_source;
+    bool m_hasUv = false;
+
+    std::vector<uint32_t> m_indices;      // into source vertices, welded
+    std::vector<uint32_t> m_positionId;   // vertex -> first vertex at that position
+    std::vector<uint8_t> m_kind;
+    std::vector<Quadric> m_quadrics;
+    std::unordered_map<uint64_t, uint32_t> m_edgeUse;   // by position id, recounted every pass
+
+    // Position id -> triangles, rebuilt every pass
+    std::vector<uint32_t> m_adjacencyOffset;
+    std::vector<uint32_t> m_adjacency;
+    std::vector<uint8_t> m_touched;
+};
+
+void Simplifier::weld() {
+    const size_t count = m_source.vertexCount();
+    m_hasUv = m_source.u.size() == count && m_source.v.size() == count;
+
+    std::unordered_map<WeldKey, uint32_t, WeldKeyHash> byAttributes;
+    std::unordered_map<WeldKey, uint32_t, WeldKeyHash> byPosition;
+    byAttributes.reserve(count);
+    byPosition.reserve(count);
+    std::vector<uint32_t> remap(count);
+    m_positionId.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        remap[i] = byAttributes.emplace(weldKey(m_source, i, m_hasUv), uint32_t(i)).first->second;
+        m_positionId[i] = byPosition.emplace(weldKey(m_source, i, false), uint32_t(i)).first->second;
+    }
+
+    m_indices.resize(m_source.indices.size());
+    for (size_t i = 0; i < m_indices.size(); ++i) {
+        m_indices[i] = remap[m_source.indices[i]];
+    }
+    compactTriangles();
+}
+
+void Simplifier::classify() {
+    const size_t count = m_source.vertexCount();
+
+    // Welded vertices sharing a position differ in UV: a seam.
+    std::vector<uint32_t> wedges(count, 0);
+    std::vector<uint8_t> used(count, 0);
+    for (uint32_t index : m_indices) used[index] = 1;
+    for (size_t i = 0; i < count; ++i) {
+        if (used[i]) ++wedges[m_positionId[i]];
+    }
+
+    countEdges();
+    m_kind.assign(count, Interior);
+    for (size_t t = 0; t < m_indices.size(); t += 3) {
+        for (int e = 0; e < 3; ++e) {
+            const uint32_t a = m_indices[t + e], b = m_indices[t + (e + 1) % 3];
+            const uint32_t use = edgeUse(m_positionId[a], m_positionId[b]);
+            const uint8_t kind = use == 1 ? Border : use > 2 ? Locked : Interior;
+            m_kind[a] = std::max(m_kind[a], kind);
+            m_kind[b] = std::max(m_kind[b], kind);
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (wedges[m_positionId[i]] > 1) m_kind[i] = Locked;
+    }
+}
+
+void Simplifier::countEdges() {
+    m_edgeUse.clear();
+    m_edgeUse.reserve(m_indices.size());
+    for (size_t t = 0; t < m_indices.size(); t += 3) {
+        for (int e = 0; e < 3; ++e) {
+            ++m_edgeUse[edgeKey(m_positionId[m_indices[t + e]], m_positionId[m_indices[t + (e + 1) % 3]])];
+        }
+    }
+}
+
+void Simplifier::buildQuadrics() {
+    m_quadrics.assign(m_source.vertexCount(), Quadric{});
+    for (size_t t = 0; t < m_indices.size(); t += 3) {
+        const uint32_t corner[3] = {m_indices[t], m_indices[t + 1], m_indices[t + 2]};
+        const Vec3 p[3] = {position(corner[0]), position(corner[1]), position(corner[2])};
+        Vec3 n = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+        const double doubleArea = length(n);
+        if (doubleArea <= 0.0) continue;
+        n = {n.x / doubleArea, n.y / doubleArea, n.z / doubleArea};
+        const double d = -dot(n, p[0]);
+        for (uint32_t vertex : corner) {
+            m_quadrics[vertex].addPlane(n.x, n.y, n.z, d, 0.5 * doubleArea);
+        }
+
+        // Boundary edges: a plane through the edge, perpendicular to the face.
+        for (int e = 0; e < 3; ++e) {
+            const uint32_t a = corner[e], b = corner[(e + 1) % 3];
+            if (edgeUse(m_positionId[a], m_positionId[b]) != 1) continue;
+            const Vec3 edge = sub(p[(e + 1) % 3], p[e]);
+            Vec3 m = cross(edge, n);
+            const double mLength = length(m);
+            if (mLength <= 0.0) continue;
+            m = {m.x / mLength, m.y / mLength, m.z / mLength};
+            const double md = -dot(m, p[e]);
+            const double weight = kBoundaryWeight * dot(edge, edge);
+            m_quadrics[a].addPlane(m.x, m.y, m.z, md, weight);
+            m_quadrics[b].addPlane(m.x, m.y, m.z, md, weight);
+        }
+    }
+}
+
+void Simplifier::buildAdjacency() {
+    const size_t count = m_source.vertexCount();
+    m_adjacencyOffset.assign(count + 1, 0);
+    for (uint32_t index : m_indices) ++m_adjacencyOffset[m_positionId[index] + 1];
+    for (size_t i = 0; i < count; ++i) m_adjacencyOffset[i + 1] += m_adjacencyOffset[i];
+
+    m_adjacency.resize(m_indices.size());
+    std::vector<uint32_t> fill(m_adjacencyOffset.begin(), m_adjacencyOffset.end() - 1);
+    for (size_t i = 0; i < m_indices.size(); ++i) {
+        m_adjacency[fill[m_positionId[m_indices[i]]]++] = uint32_t(i / 3);
+    }
+}
+
+bool Simplifier::canCollapse(uint32_t u, uint32_t v) const {
+    const uint32_t pu = m_positionId[u], pv = m_positionId[v];
+
+    // Link condition: u and v may only share the vertices opposite the
+    // collapsed edge, or the collapse pinches the surface.
+    std::vector<uint32_t> ringU, ringV;
+    for (uint32_t k = m_adjacencyOffset[pu]; k < m_adjacencyOffset[pu + 1]; ++k) {
+        const uint32_t* tri = &m_indices[size_t(m_adjacency[k]) * 3];
+        for (int c = 0; c < 3; ++c) ringU.push_back(m_positionId[tri[c]]);
+    }
+    for (uint32_t k = m_adjacencyOffset[pv]; k < m_adjacencyOffset[pv + 1]; ++k) {
+        const uint32_t* tri = &m_indices[size_t(m_adjacency[k]) * 3];
+        for (int c = 0; c < 3; ++c) ringV.push_back(m_positionId[tri[c]]);
+    }
+    std::sort(ringU.begin(), ringU.end());
+    ringU.erase(std::unique(ringU.begin(), ringU.end()), ringU.end());
+    std::sort(ringV.begin(), ringV.end());
+    ringV.erase(std::unique(ringV.begin(), ringV.end()), ringV.end());
+    size_t shared = 0;
+    for (size_t i = 0, j = 0; i < ringU.size() && j < ringV.size();) {
+        if (ringU[i] < ringV[j]) ++i;
+        else if (ringV[j] < ringU[i]) ++j;
+        else {
+            if (ringU[i] != pu && ringU[i] != pv) ++shared;
+            ++i; ++j;
+        }
+    }
+    const bool borderEdge = edgeUse(pu, pv) == 1;
+    if (shared > (borderEdge ? 1u : 2u)) return false;
+
+    // No surviving triangle around u may flip or collapse to a sliver.
+    const Vec3 target = position(v);
+    for (uint32_t k = m_adjacencyOffset[pu]; k < m_adjacencyOffset[pu + 1]; ++k) {
+        const uint32_t* tri = &m_indices[size_t(m_adjacency[k]) * 3];
+        Vec3 before[3], after[3];
+        bool removed = false;
+        for (int c = 0; c < 3; ++c) {
+            const uint32_t p = m_positionId[tri[c]];
+            if (p == pv) removed = true;
+            before[c] = position(tri[c]);
+            after[c] = p == pu ? target : before[c];
+        }
+        if (removed) continue;
+
+        const Vec3 n0 = cross(sub(before[1], before[0]), sub(before[2], before[0]));
+        const Vec3 n1 = cross(sub(after[1], after[0]), sub(after[2], after[0]));
+        if (dot(n0, n1) <= kMinNormalCosine * length(n0) * length(n1)) return false;
+    }
+    return true;
+}
+
+// Moves u onto v. Returns the number of triangles that became degenerate.
+size_t Simplifier::collapse(uint32_t u, uint32_t v) {
+    const uint32_t pu = m_positionId[u], pv = m_positionId[v];
+    size_t removed = 0;
+    for (uint32_t k = m_adjacencyOffset[pu]; k < m_adjacencyOffset[pu + 1]; ++k) {
+        uint32_t* tri = &m_indices[size_t(m_adjacency[k]) * 3];
+        bool degenerate = false;
+        for (int c = 0; c < 3; ++c) {
+            if (m_positionId[tri[c]] == pv) degenerate = true;
+        }
+        for (int c = 0; c < 3; ++c) {
+            if (tri[c] == u) tri[c] = v;
+            m_touched[m_positionId[tri[c]]] = 1;
+        }
+        removed += degenerate;
+    }
+    m_quadrics[v].add(m_quadrics[u]);
+    m_touched[pu] = 1;
+    m_touched[pv] = 1;
+    return removed;
+}
+
+void Simplifier::compactTriangles() {
+    size_t out = 0;
+    for (size_t t = 0; t < m_indices.size(); t += 3) {
+        const uint32_t a = m_indices[t], b = m_indices[t + 1], c = m_indices[t + 2];
+        const uint32_t pa = m_positionId[a], pb = m_positionId[b], pc = m_positionId[c];
+        if (pa == pb || pb == pc || pa == pc) continue;
+        m_indices[out++] = a;
+        m_indices[out++] = b;
+        m_indices[out++] = c;
+    }
+    m_indices.resize(out);
+}
+
+CookedMesh Simplifier::extract() const {
+    CookedMesh result;
+    std::vector<uint32_t> remap(m_source.vertexCount(), UINT32_MAX);
+    result.indices.reserve(m_indices.size());
+    for (uint32_t index : m_indices) {
+        if (remap[index] == UINT32_MAX) {
+            remap[index] = uint32_t(result.px.size());
+            result.px.push_back(m_source.px[index]);
+            result.py.push_back(m_source.py[index]);
+            result.pz.push_back(m_source.pz[index]);
+            if (m_hasUv) {
+                result.u.push_back(m_source.u[index]);
+                result.v.push_back(m_source.v[index]);
+            }
+        }
+        result.indices.push_back(remap[index]);
+    }
+    MeshCooker::computeNormals(result);
+    MeshCooker::computeBounds(result);
+    return result;
+}
+
+CookedMesh Simplifier::run(const MeshSimplifier::Options& options, float* resultError) {
+    weld();
+    classify();
+    buildQuadrics();
+
+    const double extent = std::sqrt(
+        double(m_source.boundsMax[0] - m_source.boundsMin[0]) * (m_source.boundsMax[0] - m_source.boundsMin[0]) +
+        double(m_source.boundsMax[1] - m_source.boundsMin[1]) * (m_source.boundsMax[1] - m_source.boundsMin[1]) +
+        double(m_source.boundsMax[2] - m_source.boundsMin[2]) * (m_source.boundsMax[2] - m_source.boundsMin[2]));
+    const double maxError = double(options.maxError) * extent;
+    const double maxErrorSq = maxError * maxError;
+    double worstError = 0.0;
+
+    struct Candidate {
+        double cost;
+        uint32_t u, v;
+        bool operator<(const Candidate& other) const { return cost < other.cost; }
+    };
+    std::vector<Candidate> candidates;
+
+    size_t triangles = m_indices.size() / 3;
+    bool firstPass = true;
+    while (triangles > options.targetTriangles) {
+        if (!firstPass) countEdges();
+        firstPass = false;
+        buildAdjacency();
+
+        // Cheapest admissible target for every collapsible vertex
+        candidates.clear();
+        const size_t count = m_source.vertexCount();
+        for (uint32_t u = 0; u < count; ++u) {
+            const uint32_t pu = m_positionId[u];
+            if (m_kind[u] == Locked || pu != u || m_adjacencyOffset[pu] == m_adjacencyOffset[pu + 1]) continue;
+
+            Candidate best = {maxErrorSq, 0, 0};
+            bool found = false;
+            for (uint32_t k = m_adjacencyOffset[pu]; k < m_adjacencyOffset[pu + 1]; ++k) {
+                const uint32_t* tri = &m_indices[size_t(m_adjacency[k]) * 3];
+                for (int c = 0; c < 3; ++c) {
+                    const uint32_t v = tri[c];
+                    if (v == u) continue;
+                    if (m_kind[u] == Border && edgeUse(pu, m_positionId[v]) != 1) continue;
+                    const Vec3 p = position(v);
+                    const double cost = m_quadrics[u].error(p.x, p.y, p.z);
+                    if (cost <= best.cost) {
+                        best = {cost, u, v};
+                        found = true;
+                    }
+                }
+            }
+            if (found) candidates.push_back(best);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        // One collapse per neighbourhood per pass, cheapest first
+        m_touched.assign(count, 0);
+        size_t collapsed = 0;
+        for (const Candidate& candidate : candidates) {
+            if (triangles <= options.targetTriangles) break;
+            const uint32_t pu = m_positionId[candidate.u], pv = m_positionId[candidate.v];
+            if (m_touched[pu] || m_touched[pv]) continue;
+            if (!canCollapse(candidate.u, candidate.v)) continue;
+
+            triangles -= collapse(candidate.u, candidate.v);
+            worstError = std::max(worstError, candidate.cost);
+            ++collapsed;
+        }
+
+        compactTriangles();
+        triangles = m_indices.size() / 3;
+        if (collapsed == 0) break;
+    }
+
+    if (resultError) {
+        *resultError = extent > 0.0 ? float(std::sqrt(worstError) / extent) : 0.0f;
+    }
+    return extract();
+}
+
+} // namespace
+
+namespace MeshSimplifier {
+
+CookedMesh simplify(const CookedMesh& mesh, const Options& options, float* resultError) {
+    return Simplifier(mesh).run(options, resultError);
+}
+
+std::vector<CookedMesh> buildLodChain(const CookedMesh& base, size_t minTriangles, int maxLevels) {
+    std::vector<CookedMesh> levels;
+    const CookedMesh* previous = &base;
+    for (int level = 1; level <= maxLevels; ++level) {
+        const size_t previousTriangles = previous->indices.size() / 3;
+        if (previousTriangles / 2 < minTriangles) break;
+
+        Options options;
+        options.targetTriangles = previousTriangles / 2;
+        // Coarser levels are only used when the garment is small on screen
+        options.maxError = 0.005f * float(1 << level);
+        CookedMesh simplified = simplify(*previous, options);
+
+        // Locked seams and boundaries can stall the reduction
+        if (simplified.indices.size() / 3 > previousTriangles * 4 / 5) break;
+        levels.push_back(std::move(simplified));
+        previous = &levels.back();
+    }
+    return levels;
+}
+
+std::string lodPathFor(const std::string& cookedPath, int level) {
+    if (level == 0) return cookedPath;
+    const std::string base = MeshCooker::cookedPathFor(cookedPath);
+    const std::string stem = base.substr(0, base.size() - std::string(MeshFormat::kFileSuffix).size());
+    return stem + ".lod" + std::to_string(level) + MeshFormat::kFileSuffix;
+}
+
+}
@@ -0,0 +1,34 @@
+// MeshSimplifier.h
+#pragma once
+#include "MeshCooker.h"
+#include <string>
+#include <vector>
+
+// Quadric error metric (Garland-Heckbert) simplification for cooked
+// garment meshes, and the LOD chains built from it.
+//
+// Collapses are half-edge collapses onto existing vertices, so UVs are
+// never interpolated. Vertices are welded on position and UV only: splits
+// the cooker made for normals are merged and the result gets recomputed
+// smooth normals, which suits cloth. Vertices on a UV seam (the same
+// position welded into several vertices) are locked, and open boundaries
+// (neck, sleeves, hem) only collapse along themselves, held in place by a
+// boundary-plane quadric.
+namespace MeshSimplifier {
+    struct Options {
+        size_t targetTriangles = 0;
+        // Largest allowed deviation, relative to the bounding box diagonal.
+        float maxError = 0.01f;
+    };
+
+    // Returns the simplified mesh; stops early when no collapse below
+    // maxError remains. `resultError` receives the relative error reached.
+    CookedMesh simplify(const CookedMesh& mesh, const Options& options, float* resultError = nullptr);
+
+    // Successively halved levels (not including the base mesh) until a level
+    // would fall below minTriangles, stops shrinking, or maxLevels is reached.
+    std::vector<CookedMesh> buildLodChain(const CookedMesh& base, size_t minTriangles = 1000, int maxLevels = 4);
+
+    // "<dir>/model.amesh", 2 -> "<dir>/model.lod2.amesh"; level 0 is the path itself.
+    std::string lodPathFor(const std::string& cookedPath, int level);
+}
@@ -0,0 +1,456 @@
+#include "ModelAssetCache.h"
+#include "NetworkClient.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+
+namespace {
+constexpr int kIndexSaveDelayMs = 2000;
+const char* const kIndexFile = "index.json";
+}
+
+ModelAssetCache::ModelAssetCache(const QString& directory, QObject* parent)
+    : QObject(parent),
+      m_directory(directory.isEmpty()
+                      ? QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/models"
+                      : directory),
+      m_network(NetworkClient::instance()->manager())
+{
+    QDir().mkpath(m_directory);
+
+    m_indexSaveTimer.setSingleShot(true);
+    m_indexSaveTimer.setInterval(kIndexSaveDelayMs);
+    connect(&m_indexSaveTimer, &QTimer::timeout, this, &ModelAssetCache::saveIndex);
+
+    loadIndex();
+}
+
+ModelAssetCache::~ModelAssetCache() {
+    for (auto& [modelKey, download] : m_downloads) {
+        if (download->reply) {
+            download->reply->disconnect(this);
+            download->reply->abort();
+            download->reply->deleteLater();
+        }
+        if (download->file) {
+            download->file->remove();
+        }
+    }
+    if (m_indexSaveTimer.isActive()) {
+        saveIndex();
+    }
+}
+
+void ModelAssetCache::setBudgetBytes(qint64 bytes) {
+    m_budgetBytes = qMax<qint64>(0, bytes);
+    evict(QString());
+}
+
+void ModelAssetCache::setMaxConcurrentDownloads(int count) {
+    m_maxConcurrent = qMax(1, count);
+    startQueued();
+}
+
+QString ModelAssetCache::blobPath(const Entry& entry) const {
+    return m_directory + "/" + entry.sha256 + (entry.suffix.isEmpty() ? QString() : "." + entry.suffix);
+}
+
+QFileInfoList ModelAssetCache::blobFiles(const QString& sha256) const {
+    return QDir(m_directory).entryInfoList({sha256 + ".*"}, QDir::Files);
+}
+
+void ModelAssetCache::removeBlob(const QString& sha256) {
+    for (const QFileInfo& file : blobFiles(sha256)) {
+        QFile::remove(file.filePath());
+    }
+}
+
+QString ModelAssetCache::partPath(const QString& modelKey) const {
+    const QByteArray hash = QCryptographicHash::hash(modelKey.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_directory + "/" + QString::fromLatin1(hash) + ".part";
+}
+
+bool ModelAssetCache::contains(const QString& modelKey) const {
+    return m_entries.contains(modelKey);
+}
+
+QUrl ModelAssetCache::localUrl(const QString& modelKey) {
+    auto it = m_entries.find(modelKey);
+    if (it == m_entries.end()) return QUrl();
+
+    const QString path = blobPath(it.value());
+    if (QFileInfo(path).size() != it->size) {
+        // Removed or truncated behind our back; forget it and re-download.
+        qWarning() << "Cached model missing or truncated:" << modelKey;
+        const QString sha256 = it->sha256;
+        m_entries.erase(it);
+        if (!blobInUse(sha256, QString())) {
+            removeBlob(sha256);
+        }
+        updateTotalBytes();
+        scheduleIndexSave();
+        return QUrl();
+    }
+
+    it->lastUsed = QDateTime::currentDateTimeUtc();
+    scheduleIndexSave();
+    // Picks up files cooked from blobs since the last count
+    updateTotalBytes();
+    evict(modelKey);
+    return QUrl::fromLocalFile(path);
+}
+
+void ModelAssetCache::fetch(const QString& modelKey, const QUrl& remoteUrl) {
+    if (modelKey.isEmpty()) {
+        emit assetFailed(modelKey, tr("Model has no key"));
+        return;
+    }
+
+    const QUrl local = localUrl(modelKey);
+    if (!local.isEmpty()) {
+        // Keep the signal asynchronous so callers can connect after calling.
+        QMetaObject::invokeMethod(this, [this, modelKey, local]() {
+            emit assetReady(modelKey, local);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    enqueue(modelKey, remoteUrl, false);
+}
+
+void ModelAssetCache::prefetchAdjacent(GarmentListModel* garments, int row, int radius) {
+    if (!garments) return;
+
+    for (int offset = 1; offset <= radius; ++offset) {
+        for (int candidate : {row + offset, row - offset}) {
+            const GarmentListModel::Garment* garment = garments->garmentAt(candidate);
+            if (!garment || garment->modelKey.isEmpty() || garment->modelUrl.isEmpty()) continue;
+            if (m_entries.contains(garment->modelKey)) continue;
+            enqueue(garment->modelKey, QUrl(garment->modelUrl), true);
+        }
+    }
+}
+
+void ModelAssetCache::cancel(const QString& modelKey) {
+    auto it = m_downloads.find(modelKey);
+    if (it == m_downloads.end()) return;
+
+    m_queue.removeAll(modelKey);
+    if (it->second->reply) {
+        // finished() fires with OperationCanceledError and cleans up.
+        it->second->reply->abort();
+    } else {
+        m_downloads.erase(it);
+    }
+}
+
+void ModelAssetCache::clear() {
+    const QStringList pending = m_queue;
+    for (const QString& modelKey : pending) {
+        cancel(modelKey);
+    }
+
+    QDir dir(m_directory);
+    const QStringList files = dir.entryList(QDir::Files);
+    for (const QString& file : files) {
+        if (!file.endsWith(".part")) {
+            dir.remove(file);
+        }
+    }
+    m_entries.clear();
+    updateTotalBytes();
+    saveIndex();
+}
+
+void ModelAssetCache::enqueue(const QString& modelKey, const QUrl& remoteUrl, bool prefetch) {
+    if (!remoteUrl.isValid() || remoteUrl.isEmpty()) {
+        emit assetFailed(modelKey, tr("Invalid model URL"));
+        return;
+    }
+
+    auto it = m_downloads.find(modelKey);
+    if (it != m_downloads.end()) {
+        Download* download = it->second.get();
+        if (!prefetch && download->prefetch) {
+            // The user is waiting on it now: promote it to the front.
+            download->prefetch = false;
+            if (m_queue.removeAll(modelKey) > 0) {
+                startDownload(download);
+            }
+        }
+        return;
+    }
+
+    auto download = std::make_unique<Download>();
+    download->modelKey = modelKey;
+    download->url = remoteUrl;
+    download->prefetch = prefetch;
+    Download* raw = download.get();
+    m_downloads.emplace(modelKey, std::move(download));
+
+    if (!prefetch) {
+        // Foreground requests never wait behind prefetches.
+        startDownload(raw);
+    } else {
+        m_queue.append(modelKey);
+        startQueued();
+    }
+}
+
+int ModelAssetCache::activeDownloads() const {
+    int active = 0;
+    for (const auto& [modelKey, download] : m_downloads) {
+        if (download->reply) ++active;
+    }
+    return active;
+}
+
+void ModelAssetCache::startQueued() {
+    while (!m_queue.isEmpty() && activeDownloads() < m_maxConcurrent) {
+        auto it = m_downloads.find(m_queue.takeFirst());
+        if (it != m_downloads.end()) {
+            startDownload(it->second.get());
+        }
+    }
+}
+
+void ModelAssetCache::startDownload(Download* download) {
+    download->file = std::make_unique<QFile>(partPath(download->modelKey));
+    if (!download->file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        failDownload(download, download->file->errorString());
+        return;
+    }
+    download->hash.reset();
+
+    qDebug() << (download->prefetch ? "Prefetching" : "Downloading") << "model" << download->modelKey;
+
+    QNetworkRequest request(download->url);
+    NetworkClient::instance()->prepare(request);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    if (download->prefetch) {
+        request.setPriority(QNetworkRequest::LowPriority);
+    }
+    QNetworkReply* reply = m_network->get(request);
+    download->reply = reply;
+
+    const QString modelKey = download->modelKey;
+    // Stream to disk as data arrives instead of buffering whole models.
+    connect(reply, &QNetworkReply::readyRead, this, [download, reply]() {
+        if (!download->writeError.isEmpty()) return;
+        const QByteArray chunk = reply->readAll();
+        download->hash.addData(chunk);
+        if (download->file->write(chunk) != chunk.size()) {
+            // finishDownload() reports it; `download` may be gone after abort()
+            download->writeError = download->file->errorString();
+            reply->abort();
+            return;
+        }
+        download->written += chunk.size();
+    });
+    connect(reply, &QNetworkReply::downloadProgress, this, [this, modelKey](qint64 received, qint64 total) {
+        emit downloadProgress(modelKey, received, total);
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, download]() {
+        finishDownload(download);
+    });
+}
+
+void ModelAssetCache::failDownload(Download* download, const QString& error) {
+    const QString modelKey = download->modelKey;
+    if (download->file) {
+        download->file->close();
+        download->file->remove();
+    }
+    if (download->reply) {
+        download->reply->deleteLater();
+    }
+    m_queue.removeAll(modelKey);
+    m_downloads.erase(modelKey);
+
+    qWarning() << "Model download failed:" << modelKey << error;
+    emit assetFailed(modelKey, error);
+    startQueued();
+}
+
+void ModelAssetCache::finishDownload(Download* download) {
+    QNetworkReply* reply = download->reply;
+    if (!download->writeError.isEmpty()) {
+        failDownload(download, tr("Could not write model file: %1").arg(download->writeError));
+        return;
+    }
+    if (reply->error() != QNetworkReply::NoError) {
+        failDownload(download, reply->errorString());
+        return;
+    }
+
+    const QByteArray tail = reply->readAll();
+    download->hash.addData(tail);
+    const bool written = download->file->write(tail) == tail.size() && download->file->flush();
+    download->written += tail.size();
+    download->file->close();
+    if (!written || download->file->size() != download->written) {
+        // A short file must not be indexed as a valid copy
+        failDownload(download, tr("Could not write model file: %1").arg(download->file->errorString()));
+        return;
+    }
+
+    const QString sha256 = QString::fromLatin1(download->hash.result().toHex());
+    const QString expected = QString::fromLatin1(reply->rawHeader("x-amz-meta-sha256")).trimmed().toLower();
+    if (!expected.isEmpty() && expected != sha256) {
+        failDownload(download, tr("Checksum mismatch for downloaded model"));
+        return;
+    }
+    if (expected.isEmpty()) {
+        qDebug() << "No checksum published for" << download->modelKey << "- trusting transfer";
+    }
+
+    Entry entry;
+    entry.sha256 = sha256;
+    entry.suffix = QFileInfo(download->url.path()).suffix().toLower();
+    entry.size = download->file->size();
+    entry.lastUsed = QDateTime::currentDateTimeUtc();
+
+    const QString path = blobPath(entry);
+    if (QFileInfo::exists(path)) {
+        // Same bytes already cached under another key.
+        download->file->remove();
+    } else if (!download->file->rename(path)) {
+        failDownload(download, download->file->errorString());
+        return;
+    }
+
+    const QString modelKey = download->modelKey;
+    m_entries.insert(modelKey, entry);
+    reply->deleteLater();
+    m_downloads.erase(modelKey);
+
+    updateTotalBytes();
+    evict(modelKey);
+    scheduleIndexSave();
+
+    qDebug() << "Cached model" << modelKey << "(" << entry.size << "bytes)";
+    emit assetReady(modelKey, QUrl::fromLocalFile(path));
+    startQueued();
+}
+
+bool ModelAssetCache::blobInUse(const QString& sha256, const QString& exceptKey) const {
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        if (it.key() != exceptKey && it->sha256 == sha256) return true;
+    }
+    return false;
+}
+
+void ModelAssetCache::updateTotalBytes() {
+    // Blob plus derived files, by content hash
+    QHash<QString, qint64> blobBytes;
+    for (const QFileInfo& file : QDir(m_directory).entryInfoList(QDir::Files)) {
+        blobBytes[file.fileName().section('.', 0, 0)] += file.size();
+    }
+
+    QSet<QString> seen;
+    qint64 total = 0;
+    for (const Entry& entry : std::as_const(m_entries)) {
+        if (!seen.contains(entry.sha256)) {
+            seen.insert(entry.sha256);
+            total += blobBytes.value(entry.sha256);
+        }
+    }
+    if (total != m_totalBytes) {
+        m_totalBytes = total;
+        emit sizeChanged();
+    }
+}
+
+void ModelAssetCache::evict(const QString& keepKey) {
+    while (m_totalBytes > m_budgetBytes) {
+        // Oldest entry that is not the one just used.
+        auto victim = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it.key() == keepKey) continue;
+            if (victim == m_entries.end() || it->lastUsed < victim->lastUsed) {
+                victim = it;
+            }
+        }
+        if (victim == m_entries.end()) break;
+
+        qDebug() << "Evicting cached model" << victim.key();
+        const QString sha256 = victim->sha256;
+        const QString key = victim.key();
+        m_entries.erase(victim);
+        if (!blobInUse(sha256, key)) {
+            removeBlob(sha256);
+        }
+        updateTotalBytes();
+        scheduleIndexSave();
+    }
+}
+
+void ModelAssetCache::loadIndex() {
+    QFile file(m_directory + "/" + kIndexFile);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    const QJsonObject index = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+        const QJsonObject obj = it.value().toObject();
+        Entry entry;
+        entry.sha256 = obj["sha256"].toString();
+        entry.suffix = obj["suffix"].toString();
+        entry.size = obj["size"].toInteger();
+        entry.lastUsed = QDateTime::fromString(obj["lastUsed"].toString(), Qt::ISODate);
+
+        if (entry.sha256.isEmpty() || QFileInfo(blobPath(entry)).size() != entry.size) {
+            continue;
+        }
+        m_entries.insert(it.key(), entry);
+    }
+
+    // Leftovers from downloads interrupted by the app being killed, and
+    // blobs (or files cooked from them) no entry refers to any more.
+    QSet<QString> live;
+    for (const Entry& entry : std::as_const(m_entries)) {
+        live.insert(entry.sha256);
+    }
+    QDir dir(m_directory);
+    const QStringList files = dir.entryList(QDir::Files);
+    for (const QString& name : files) {
+        if (name == kIndexFile) continue;
+        if (name.endsWith(".part") || !live.contains(name.section('.', 0, 0))) {
+            dir.remove(name);
+        }
+    }
+
+    updateTotalBytes();
+    qDebug() << "Model cache holds" << m_entries.size() << "models," << m_totalBytes << "bytes";
+}
+
+void ModelAssetCache::saveIndex() {
+    m_indexSaveTimer.stop();
+
+    QJsonObject index;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        index.insert(it.key(), QJsonObject{
+            {"sha256", it->sha256},
+            {"suffix", it->suffix},
+            {"size", it->size},
+            {"lastUsed", it->lastUsed.toString(Qt::ISODate)}
+        });
+    }
+
+    QSaveFile file(m_directory + "/" + kIndexFile);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(index).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
+
+void ModelAssetCache::scheduleIndexSave() {
+    if (!m_indexSaveTimer.isActive()) {
+        m_indexSaveTimer.start();
+    }
+}
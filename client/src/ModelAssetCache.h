@@ -0,0 +1,115 @@
+#pragma once
+#ifndef MODELASSETCACHE_H
+#define MODELASSETCACHE_H
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+#include <QUrl>
+#include <map>
+#include <memory>
+#include "GarmentListModel.h"
+
+// Local cache for garment 3D model files, exposed to QML as the
+// ModelAssetCache singleton. Entries are keyed by the server's modelKey;
+// files on disk are content addressed (<sha256>.<ext>), so two keys with the
+// same bytes share one file. Downloads stream straight to disk while being
+// hashed and are checked against the x-amz-meta-sha256 header before they are
+// published. Files derived from a blob and kept next to it, such as the
+// meshes ClothFitter cooks (<sha256>.amesh, <sha256>.lodN.amesh), count
+// toward the size budget from the next lookup on and go with the blob. Least
+// recently used files are evicted once the cache grows past its size budget.
+class ModelAssetCache : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(qint64 sizeBytes READ sizeBytes NOTIFY sizeChanged)
+
+public:
+    explicit ModelAssetCache(const QString& directory = QString(), QObject* parent = nullptr);
+    ~ModelAssetCache();
+
+    // File URL of a cached model, or an empty URL when it is not on disk.
+    Q_INVOKABLE QUrl localUrl(const QString& modelKey);
+    Q_INVOKABLE bool contains(const QString& modelKey) const;
+
+    // Download a model in the foreground. assetReady() follows right away
+    // when it is already cached.
+    Q_INVOKABLE void fetch(const QString& modelKey, const QUrl& remoteUrl);
+    // Queue background downloads for the garments around `row`.
+    Q_INVOKABLE void prefetchAdjacent(GarmentListModel* garments, int row, int radius = 1);
+    Q_INVOKABLE void cancel(const QString& modelKey);
+    Q_INVOKABLE void clear();
+
+    qint64 sizeBytes() const { return m_totalBytes; }
+    qint64 budgetBytes() const { return m_budgetBytes; }
+    void setBudgetBytes(qint64 bytes);
+    void setMaxConcurrentDownloads(int count);
+
+signals:
+    void assetReady(const QString& modelKey, const QUrl& localUrl);
+    void assetFailed(const QString& modelKey, const QString& error);
+    void downloadProgress(const QString& modelKey, qint64 received, qint64 total);
+    void sizeChanged();
+
+private:
+    struct Entry {
+        QString sha256;
+        QString suffix;
+        qint64 size = 0;
+        QDateTime lastUsed;
+    };
+
+    struct Download {
+        QString modelKey;
+        QUrl url;
+        bool prefetch = false;
+        QPointer<QNetworkReply> reply;
+        std::unique_ptr<QFile> file;
+        qint64 written = 0;
+        // Set when the file could not take a chunk (e.g. disk full)
+        QString writeError;
+        QCryptographicHash hash{QCryptographicHash::Sha256};
+    };
+
+    QString blobPath(const Entry& entry) const;
+    // The blob and every file derived from it: <sha256>.*
+    QFileInfoList blobFiles(const QString& sha256) const;
+    void removeBlob(const QString& sha256);
+    QString partPath(const QString& modelKey) const;
+
+    void enqueue(const QString& modelKey, const QUrl& remoteUrl, bool prefetch);
+    void startQueued();
+    void startDownload(Download* download);
+    void finishDownload(Download* download);
+    void failDownload(Download* download, const QString& error);
+    int activeDownloads() const;
+
+    void loadIndex();
+    void saveIndex();
+    void scheduleIndexSave();
+    void evict(const QString& keepKey);
+    bool blobInUse(const QString& sha256, const QString& exceptKey) const;
+    void updateTotalBytes();
+
+    QString m_directory;
+    // Shared, see NetworkClient
+    QNetworkAccessManager* m_network;
+    QHash<QString, Entry> m_entries;
+    // Pending and running downloads by modelKey; m_queue orders the pending ones.
+    std::map<QString, std::unique_ptr<Download>> m_downloads;
+    QStringList m_queue;
+    QTimer m_indexSaveTimer;
+
+    qint64 m_totalBytes = 0;
+    qint64 m_budgetBytes = 256ll * 1024 * 1024;
+    int m_maxConcurrent = 2;
+};
+
+#endif // MODELASSETCACHE_H
@@ -0,0 +1,184 @@
+#include "ModelEventChannel.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QThread>
+
+namespace {
+constexpr int kHeartbeatIntervalMs = 20000;
+// No pong for this long means the socket is dead even if TCP has not noticed.
+constexpr qint64 kPongTimeoutMs = 45000;
+}
+
+ModelEventChannel* ModelEventChannel::instance() {
+    static QPointer<ModelEventChannel> channel;
+    if (!channel) {
+        Q_ASSERT(QCoreApplication::instance());
+        Q_ASSERT(QThread::currentThread() == QCoreApplication::instance()->thread());
+        channel = new ModelEventChannel(QCoreApplication::instance());
+    }
+    return channel;
+}
+
+ModelEventChannel::ModelEventChannel(QObject* parent)
+    : QObject(parent)
+{
+    m_reconnectTimer.setSingleShot(true);
+    connect(&m_reconnectTimer, &QTimer::timeout, this, &ModelEventChannel::connectSocket);
+
+    m_heartbeatTimer.setInterval(kHeartbeatIntervalMs);
+    connect(&m_heartbeatTimer, &QTimer::timeout, this, &ModelEventChannel::sendHeartbeat);
+
+    connect(&m_socket, &QWebSocket::connected, this, &ModelEventChannel::onConnected);
+    connect(&m_socket, &QWebSocket::disconnected, this, &ModelEventChannel::onDisconnected);
+    connect(&m_socket, &QWebSocket::textMessageReceived, this, &ModelEventChannel::onTextMessageReceived);
+    connect(&m_socket, &QWebSocket::pong, this, [this](quint64 elapsedTime, const QByteArray&) {
+        Q_UNUSED(elapsedTime)
+        m_sinceLastPong.restart();
+    });
+    connect(&m_socket, &QWebSocket::errorOccurred, this, [this](QAbstractSocket::SocketError error) {
+        qDebug() << "Event channel socket error:" << error << m_socket.errorString();
+        if (m_socket.state() == QAbstractSocket::UnconnectedState) {
+            scheduleReconnect();
+        }
+    });
+}
+
+ModelEventChannel::~ModelEventChannel() {
+    m_wanted = false;
+    m_socket.disconnect(this);
+    m_socket.abort();
+}
+
+void ModelEventChannel::open(const QUrl& url, const QString& authToken) {
+    if (m_wanted && url == m_url && authToken == m_authToken) return;
+
+    m_url = url;
+    m_authToken = authToken;
+    m_wanted = true;
+    m_backoff.reset();
+
+    if (m_socket.state() != QAbstractSocket::UnconnectedState) {
+        // onDisconnected() reconnects to the new endpoint.
+        m_socket.abort();
+        return;
+    }
+    connectSocket();
+}
+
+void ModelEventChannel::close() {
+    m_wanted = false;
+    m_reconnectTimer.stop();
+    m_heartbeatTimer.stop();
+    m_subscriptions.clear();
+    if (m_socket.state() != QAbstractSocket::UnconnectedState) {
+        m_socket.close();
+    }
+}
+
+void ModelEventChannel::subscribe(const QStringList& garmentIds) {
+    QStringList added;
+    for (const QString& garmentId : garmentIds) {
+        if (garmentId.isEmpty()) continue;
+        if (m_subscriptions[garmentId]++ == 0) {
+            added.append(garmentId);
+        }
+    }
+    if (m_connected && !added.isEmpty()) {
+        sendSubscribe(added);
+    }
+}
+
+void ModelEventChannel::unsubscribe(const QString& garmentId) {
+    auto it = m_subscriptions.find(garmentId);
+    if (it != m_subscriptions.end() && --it.value() <= 0) {
+        m_subscriptions.erase(it);
+    }
+}
+
+void ModelEventChannel::connectSocket() {
+    if (!m_wanted || !m_url.isValid()) return;
+
+    qDebug() << "Connecting event channel to" << m_url.toString();
+
+    QNetworkRequest request(m_url);
+    request.setRawHeader("Authorization", "Bearer " + m_authToken.toUtf8());
+    m_socket.open(request);
+}
+
+void ModelEventChannel::scheduleReconnect() {
+    if (!m_wanted || m_reconnectTimer.isActive()) return;
+
+    const int delay = m_backoff.nextDelayMs();
+    qDebug() << "Event channel reconnecting in" << delay << "ms";
+    m_reconnectTimer.start(delay);
+}
+
+void ModelEventChannel::onConnected() {
+    qDebug() << "Event channel connected";
+    m_backoff.reset();
+    m_sinceLastPong.start();
+    m_heartbeatTimer.start();
+    setConnected(true);
+
+    if (!m_subscriptions.isEmpty()) {
+        sendSubscribe(m_subscriptions.keys());
+    }
+}
+
+void ModelEventChannel::onDisconnected() {
+    qDebug() << "Event channel disconnected:" << m_socket.closeReason();
+    m_heartbeatTimer.stop();
+    setConnected(false);
+    scheduleReconnect();
+}
+
+void ModelEventChannel::onTextMessageReceived(const QString& message) {
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        qWarning() << "Ignoring malformed event:" << message.left(200);
+        return;
+    }
+
+    const QJsonObject event = doc.object();
+    const QString type = event["type"].toString();
+
+    if (type == "model.status") {
+        const QString status = event["status"].toString();
+        if (status == "completed" || status == "failed") {
+            m_subscriptions.remove(event["garmentId"].toString());
+        }
+        emit modelStatusReceived(event);
+    } else if (type == "scan.status") {
+        emit scanStatusReceived(event);
+    } else {
+        qDebug() << "Unhandled event type:" << type;
+    }
+}
+
+void ModelEventChannel::sendHeartbeat() {
+    if (m_sinceLastPong.elapsed() > kPongTimeoutMs) {
+        qWarning() << "Event channel heartbeat lost, dropping connection";
+        m_socket.abort();
+        return;
+    }
+    m_socket.ping();
+}
+
+void ModelEventChannel::sendSubscribe(const QStringList& garmentIds) {
+    QJsonObject request{
+        {"type", "subscribe"},
+        {"garmentIds", QJsonArray::fromStringList(garmentIds)}
+    };
+    m_socket.sendTextMessage(QString::fromUtf8(QJsonDocument(request).toJson(QJsonDocument::Compact)));
+}
+
+void ModelEventChannel::setConnected(bool connected) {
+    if (m_connected == connected) return;
+    m_connected = connected;
+    emit connectedChanged(connected);
+}
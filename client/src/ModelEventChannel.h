@@ -0,0 +1,77 @@
+#pragma once
+#ifndef MODELEVENTCHANNEL_H
+#define MODELEVENTCHANNEL_H
+
+#include <QObject>
+#include <QWebSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QStringList>
+#include <QUrl>
+#include "RetryBackoff.h"
+
+// Persistent WebSocket connection to <server>/events that receives scan and
+// model status pushes. Reconnects on its own with jittered backoff for as
+// long as it is open()ed; a ping/pong heartbeat detects half-dead sockets
+// that mobile networks like to leave behind.
+//
+// The process holds one connection, shared by every NetworkManager (QML
+// creates several) through instance(). Subscriptions are counted per
+// garment, so one manager unsubscribing does not drop another's.
+class ModelEventChannel : public QObject {
+    Q_OBJECT
+
+public:
+    // Created on first use, owned by the application object.
+    static ModelEventChannel* instance();
+
+    explicit ModelEventChannel(QObject* parent = nullptr);
+    ~ModelEventChannel();
+
+    void open(const QUrl& url, const QString& authToken);
+    void close();
+
+    bool isConnected() const { return m_connected; }
+
+    // Ask the server for the current status of these garments (and to keep
+    // us posted). Safe to call while disconnected - the subscription is
+    // replayed on every reconnect. Each subscribe() of a garment needs its
+    // own unsubscribe(); a final status for it drops them all.
+    void subscribe(const QStringList& garmentIds);
+    void unsubscribe(const QString& garmentId);
+    QStringList subscriptions() const { return m_subscriptions.keys(); }
+
+signals:
+    void connectedChanged(bool connected);
+    void modelStatusReceived(const QJsonObject& status);
+    void scanStatusReceived(const QJsonObject& status);
+
+private slots:
+    void onConnected();
+    void onDisconnected();
+    void onTextMessageReceived(const QString& message);
+
+private:
+    void connectSocket();
+    void scheduleReconnect();
+    void sendHeartbeat();
+    void sendSubscribe(const QStringList& garmentIds);
+    void setConnected(bool connected);
+
+    QWebSocket m_socket;
+    QUrl m_url;
+    QString m_authToken;
+    // Subscribers per garment
+    QHash<QString, int> m_subscriptions;
+    bool m_wanted = false;
+    bool m_connected = false;
+
+    RetryBackoff m_backoff{1000, 60000, 2.0, 0.3};
+    QTimer m_reconnectTimer;
+    QTimer m_heartbeatTimer;
+    QElapsedTimer m_sinceLastPong;
+};
+
+#endif // MODELEVENTCHANNEL_H
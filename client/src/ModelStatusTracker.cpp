@@ -0,0 +1,232 @@
+#include "ModelStatusTracker.h"
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QUrlQuery>
+#include <algorithm>
+#include <limits>
+
+namespace {
+// Garments that become due within this window ride along with the current
+// batch instead of triggering a second request moments later.
+constexpr qint64 kBatchCoalesceMs = 300;
+}
+
+ModelStatusTracker::ModelStatusTracker(QNetworkAccessManager* manager, RequestFactory requestFactory,
+                                       QObject* parent)
+    : QObject(parent),
+      m_manager(manager),
+      m_requestFactory(std::move(requestFactory))
+{
+    m_clock.start();
+    m_pollTimer.setSingleShot(true);
+    connect(&m_pollTimer, &QTimer::timeout, this, &ModelStatusTracker::pollDue);
+}
+
+ModelStatusTracker::~ModelStatusTracker() {
+    if (m_inFlight) {
+        m_inFlight->disconnect(this);
+        m_inFlight->abort();
+        m_inFlight->deleteLater();
+    }
+}
+
+void ModelStatusTracker::track(const QString& garmentId) {
+    if (garmentId.isEmpty()) return;
+
+    if (m_pending.contains(garmentId)) {
+        qDebug() << "Already tracking processed model for garment" << garmentId;
+        return;
+    }
+
+    PendingModel pending;
+    pending.startedAt = m_clock.elapsed();
+    // Processing never finishes instantly; the first poll waits one backoff step.
+    pending.nextPollAt = pending.startedAt + pending.backoff.nextDelayMs();
+    m_pending.insert(garmentId, pending);
+
+    qDebug() << "Tracking processed model for garment" << garmentId
+             << "(" << m_pending.size() << "pending )";
+    scheduleNextPoll();
+}
+
+void ModelStatusTracker::cancel(const QString& garmentId) {
+    if (m_pending.remove(garmentId) == 0) return;
+
+    qDebug() << "Cancelled processed model tracking for garment" << garmentId;
+    if (m_pending.isEmpty() && m_inFlight) {
+        m_inFlight->abort();
+    }
+    scheduleNextPoll();
+}
+
+void ModelStatusTracker::cancelAll() {
+    m_pending.clear();
+    if (m_inFlight) {
+        m_inFlight->abort();
+    }
+    m_pollTimer.stop();
+}
+
+void ModelStatusTracker::setSuspended(bool suspended) {
+    if (m_suspended == suspended) return;
+    m_suspended = suspended;
+
+    if (!m_suspended) {
+        // Coming back to polling: check everything promptly, since whatever
+        // was covering for us may have missed updates.
+        const qint64 now = m_clock.elapsed();
+        for (auto it = m_pending.begin(); it != m_pending.end(); ++it) {
+            it->nextPollAt = qMin(it->nextPollAt, now);
+        }
+    }
+    scheduleNextPoll();
+}
+
+bool ModelStatusTracker::applyStatus(const QJsonObject& status) {
+    const QString garmentId = status["garmentId"].toString();
+    if (!m_pending.contains(garmentId)) return false;
+
+    const QString state = status["status"].toString();
+    const bool completed = (state == "completed" || state.isEmpty()) && status.contains("modelUrl");
+
+    if (completed) {
+        const QString modelUrl = status["modelUrl"].toString();
+        qDebug() << "3D model ready for garment" << garmentId << ":" << modelUrl;
+        finish(garmentId);
+        emit modelReady(garmentId, modelUrl,
+                        status["previewUrl"].toString(),
+                        status["modelKey"].toString(),
+                        status["previewKey"].toString());
+        return true;
+    }
+
+    if (state == "failed") {
+        const QString error = status["error"].toString("Processing failed");
+        qWarning() << "3D model processing failed for garment" << garmentId << ":" << error;
+        finish(garmentId);
+        emit modelFailed(garmentId, error);
+        return true;
+    }
+
+    return false;
+}
+
+void ModelStatusTracker::finish(const QString& garmentId) {
+    m_pending.remove(garmentId);
+    scheduleNextPoll();
+}
+
+void ModelStatusTracker::expireTimedOut() {
+    const qint64 now = m_clock.elapsed();
+    QStringList expired;
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        if (now - it->startedAt >= m_timeoutMs) {
+            expired.append(it.key());
+        }
+    }
+
+    for (const QString& garmentId : expired) {
+        qWarning() << "Timed out waiting for 3D model of garment" << garmentId;
+        m_pending.remove(garmentId);
+        emit modelFailed(garmentId, tr("Timed out waiting for processed model"));
+    }
+}
+
+void ModelStatusTracker::scheduleNextPoll() {
+    if (m_pending.isEmpty()) {
+        m_pollTimer.stop();
+        return;
+    }
+
+    // A reply is outstanding; its handler reschedules.
+    if (m_inFlight) return;
+
+    qint64 wakeAt = std::numeric_limits<qint64>::max();
+    for (const PendingModel& pending : std::as_const(m_pending)) {
+        wakeAt = qMin(wakeAt, pending.startedAt + m_timeoutMs);
+        if (!m_suspended) {
+            wakeAt = qMin(wakeAt, pending.nextPollAt);
+        }
+    }
+
+    const qint64 delay = qMax<qint64>(0, wakeAt - m_clock.elapsed());
+    m_pollTimer.start(static_cast<int>(qMin<qint64>(delay, std::numeric_limits<int>::max())));
+}
+
+void ModelStatusTracker::pollDue() {
+    if (m_inFlight) return;
+
+    expireTimedOut();
+    if (m_pending.isEmpty() || m_suspended) {
+        scheduleNextPoll();
+        return;
+    }
+
+    const qint64 now = m_clock.elapsed();
+
+    QList<QPair<qint64, QString>> due;
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        if (it->nextPollAt <= now + kBatchCoalesceMs) {
+            due.append({it->nextPollAt, it.key()});
+        }
+    }
+
+    if (due.isEmpty()) {
+        scheduleNextPoll();
+        return;
+    }
+
+    // Most overdue first, so a huge backlog is worked through fairly.
+    std::sort(due.begin(), due.end());
+    QStringList batch;
+    for (int i = 0; i < due.size() && batch.size() < m_maxBatchSize; ++i) {
+        batch.append(due[i].second);
+    }
+
+    QUrl url(m_serverUrl + "/3d-models/status");
+    QUrlQuery query;
+    query.addQueryItem("garmentIds", batch.join(','));
+    url.setQuery(query);
+
+    qDebug() << "Polling processing status for" << batch.size() << "garment(s)";
+
+    QNetworkReply* reply = m_manager->get(m_requestFactory(url));
+    m_inFlight = reply;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, batch]() {
+        handlePollReply(reply, batch);
+    });
+}
+
+void ModelStatusTracker::handlePollReply(QNetworkReply* reply, const QStringList& batch) {
+    if (m_inFlight == reply) {
+        m_inFlight = nullptr;
+    }
+
+    const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &parseError);
+
+    if (reply->error() == QNetworkReply::NoError && parseError.error == QJsonParseError::NoError) {
+        const QJsonArray statuses = doc.isArray() ? doc.array() : doc.object()["models"].toArray();
+        for (const QJsonValue& value : statuses) {
+            applyStatus(value.toObject());
+        }
+    } else if (reply->error() != QNetworkReply::OperationCanceledError) {
+        qWarning() << "Processing status poll failed (HTTP" << httpStatus << "):" << reply->errorString();
+    }
+
+    // Anything in the batch that is still pending backs off independently.
+    const qint64 now = m_clock.elapsed();
+    for (const QString& garmentId : batch) {
+        auto it = m_pending.find(garmentId);
+        if (it == m_pending.end()) continue;
+        const int delay = it->backoff.nextDelayMs();
+        it->nextPollAt = now + delay;
+        qDebug() << "Model not ready yet for garment" << garmentId
+                 << ". Next check in" << delay << "ms";
+    }
+
+    reply->deleteLater();
+    scheduleNextPoll();
+}
@@ -0,0 +1,88 @@
+#pragma once
+#ifndef MODELSTATUSTRACKER_H
+#define MODELSTATUSTRACKER_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QJsonObject>
+#include <functional>
+#include "RetryBackoff.h"
+
+// Tracks server-side 3D processing for any number of scanned garments.
+// Pending garments are polled together through one batched request to
+// GET <server>/3d-models/status?garmentIds=a,b,c; each garment keeps its own
+// exponential backoff so freshly uploaded scans are polled eagerly while
+// slow ones back off. Everything is timer driven - nothing here blocks.
+class ModelStatusTracker : public QObject {
+    Q_OBJECT
+
+public:
+    // Builds an (authenticated) request for the given URL.
+    using RequestFactory = std::function<QNetworkRequest(const QUrl&)>;
+
+    ModelStatusTracker(QNetworkAccessManager* manager, RequestFactory requestFactory,
+                       QObject* parent = nullptr);
+    ~ModelStatusTracker();
+
+    void setServerUrl(const QString& url) { m_serverUrl = url; }
+
+    // Give up on a garment after this long without a terminal status.
+    void setTimeoutMs(qint64 timeoutMs) { m_timeoutMs = timeoutMs; }
+    void setMaxBatchSize(int size) { m_maxBatchSize = qMax(1, size); }
+
+    void track(const QString& garmentId);
+    void cancel(const QString& garmentId);
+    void cancelAll();
+
+    // Apply a status object received from elsewhere (for example a push
+    // notification). Returns true when it resolved a tracked garment.
+    bool applyStatus(const QJsonObject& status);
+
+    // While suspended no polls are sent, but garments stay tracked and their
+    // timeouts keep running.
+    void setSuspended(bool suspended);
+    bool isSuspended() const { return m_suspended; }
+
+    bool isTracking(const QString& garmentId) const { return m_pending.contains(garmentId); }
+    QStringList pendingGarments() const { return m_pending.keys(); }
+
+signals:
+    void modelReady(const QString& garmentId, const QString& modelUrl, const QString& previewUrl,
+                    const QString& modelKey, const QString& previewKey);
+    void modelFailed(const QString& garmentId, const QString& error);
+
+private:
+    struct PendingModel {
+        RetryBackoff backoff{1000, 15000, 1.6, 0.25};
+        qint64 startedAt = 0;
+        qint64 nextPollAt = 0;
+    };
+
+    void scheduleNextPoll();
+    void pollDue();
+    void handlePollReply(QNetworkReply* reply, const QStringList& batch);
+    void expireTimedOut();
+    void finish(const QString& garmentId);
+
+    QNetworkAccessManager* m_manager;
+    RequestFactory m_requestFactory;
+    QString m_serverUrl;
+
+    QHash<QString, PendingModel> m_pending;
+    QTimer m_pollTimer;
+    QElapsedTimer m_clock;
+    QNetworkReply* m_inFlight = nullptr;
+
+    qint64 m_timeoutMs = 3 * 60 * 1000;
+    int m_maxBatchSize = 25;
+    bool m_suspended = false;
+};
+
+#endif // MODELSTATUSTRACKER_H
@@ -0,0 +1,167 @@
+#include "NetworkClient.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QThread>
+#include <algorithm>
+
+NetworkClient* NetworkClient::instance() {
+    static QPointer<NetworkClient> client;
+    if (!client) {
+        Q_ASSERT(QCoreApplication::instance());
+        Q_ASSERT(QThread::currentThread() == QCoreApplication::instance()->thread());
+        client = new NetworkClient(QCoreApplication::instance());
+    }
+    return client;
+}
+
+NetworkClient::NetworkClient(QObject* parent)
+    : QObject(parent)
+{
+#ifndef QT_NO_SSL
+    m_sslConfig = QSslConfiguration::defaultConfiguration();
+    m_sslConfig.setProtocol(QSsl::TlsV1_2OrLater);
+    // Keep session tickets and make them readable, so they can be handed to
+    // the next connection for an abbreviated handshake.
+    m_sslConfig.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+    m_sslConfig.setSslOption(QSsl::SslOptionDisableSessionSharing, false);
+    m_sslConfig.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+
+    // A ticket resumes the TLS session it came from, so tickets stay in
+    // memory (see rememberSession()).
+    connect(&m_manager, &QNetworkAccessManager::finished, this, &NetworkClient::rememberSession);
+#endif
+}
+
+NetworkClient::~NetworkClient() {
+    for (const Pending& pending : std::as_const(m_pending)) {
+        pending.reply->disconnect(this);
+        pending.reply->abort();
+    }
+}
+
+QByteArray NetworkClient::Response::rawHeader(const QByteArray& name) const {
+    for (const QNetworkReply::RawHeaderPair& header : headers) {
+        if (header.first.compare(name, Qt::CaseInsensitive) == 0) return header.second;
+    }
+    return QByteArray();
+}
+
+void NetworkClient::prepare(QNetworkRequest& request) const {
+    // Multiplexes concurrent requests over one connection where the server
+    // negotiates h2; HTTP/1.1 servers are unaffected.
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+#ifndef QT_NO_SSL
+    if (request.url().scheme() == "https") {
+        QSslConfiguration config = m_sslConfig;
+        const QByteArray ticket = m_sessionTickets.value(request.url().host());
+        if (!ticket.isEmpty()) {
+            config.setSessionTicket(ticket);
+        }
+        request.setSslConfiguration(config);
+    }
+#endif
+}
+
+QByteArray NetworkClient::requestKey(const QNetworkRequest& request) {
+    // Requests only coalesce when they would be answered the same way, so
+    // the headers (auth token, cache validators...) are part of the key.
+    QList<QByteArray> headers = request.rawHeaderList();
+    std::sort(headers.begin(), headers.end());
+
+    QByteArray key = "GET " + request.url().toEncoded();
+    for (const QByteArray& name : std::as_const(headers)) {
+        key += '\n' + name.toLower() + ": " + request.rawHeader(name);
+    }
+    return key;
+}
+
+void NetworkClient::get(QNetworkRequest request, QObject* context, Handler handler) {
+    Q_ASSERT(context);
+    prepare(request);
+    const QByteArray key = requestKey(request);
+
+    auto it = m_pending.find(key);
+    if (it == m_pending.end()) {
+        QNetworkReply* reply = m_manager.get(request);
+        it = m_pending.insert(key, Pending{reply, {}});
+        connect(reply, &QNetworkReply::finished, this, [this, key, reply]() { finish(key, reply); });
+    } else {
+        ++m_coalesced;
+        qDebug() << "Joined in-flight request for" << request.url().toString();
+    }
+
+    // Lets requests go when nobody is left to read the answer
+    connect(context, &QObject::destroyed, this, &NetworkClient::dropDeadWaiters, Qt::UniqueConnection);
+    it->waiters.push_back({context, std::move(handler)});
+}
+
+void NetworkClient::dropDeadWaiters() {
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        auto& waiters = it->waiters;
+        waiters.erase(std::remove_if(waiters.begin(), waiters.end(),
+                                     [](const Waiter& w) { return w.context.isNull(); }),
+                      waiters.end());
+        if (!waiters.empty()) {
+            ++it;
+            continue;
+        }
+
+        QNetworkReply* reply = it->reply;
+        it = m_pending.erase(it);
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+void NetworkClient::finish(const QByteArray& key, QNetworkReply* reply) {
+    reply->deleteLater();
+
+    auto it = m_pending.find(key);
+    if (it == m_pending.end() || it->reply != reply) return;
+    // Out of the table before the handlers run: they may issue the same
+    // request again (e.g. a refetch after a 304), which must not join this one.
+    const std::vector<Waiter> waiters = std::move(it->waiters);
+    m_pending.erase(it);
+
+    Response response;
+    response.url = reply->request().url();
+    response.status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    response.error = reply->error();
+    response.errorString = reply->errorString();
+    response.body = reply->readAll();
+    response.headers = reply->rawHeaderPairs();
+
+    for (const Waiter& waiter : waiters) {
+        if (!waiter.context) continue;
+        waiter.handler(response);
+        response.shared = true;
+    }
+}
+
+#ifndef QT_NO_SSL
+void NetworkClient::rememberSession(QNetworkReply* reply) {
+    if (reply->url().scheme() != "https") return;
+
+    const QByteArray ticket = reply->sslConfiguration().sessionTicket();
+    const QString host = reply->url().host();
+    if (ticket.isEmpty() || m_sessionTickets.value(host) == ticket) return;
+
+    m_sessionTickets.insert(host, ticket);
+}
+#endif
+
+void NetworkClient::preconnect(const QUrl& url) {
+    if (!url.isValid() || url.host().isEmpty()) return;
+
+#ifndef QT_NO_SSL
+    if (url.scheme() == "https") {
+        QNetworkRequest request(url);
+        prepare(request);
+        m_manager.connectToHostEncrypted(url.host(), quint16(url.port(443)), request.sslConfiguration());
+        return;
+    }
+#endif
+    m_manager.connectToHost(url.host(), quint16(url.port(80)));
+}
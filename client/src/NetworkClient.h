@@ -0,0 +1,112 @@
+#pragma once
+#ifndef NETWORKCLIENT_H
+#define NETWORKCLIENT_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QPointer>
+#include <QUrl>
+#include "NetworkTracer.h"
+#include <functional>
+#include <vector>
+#ifndef QT_NO_SSL
+#include <QSslConfiguration>
+#endif
+
+// The one QNetworkAccessManager of the app. NetworkManager (including the
+// instances QML creates), ImageProcessor, ThumbnailProvider and
+// ModelAssetCache all send through it, so they share its per-host
+// connection pool, HTTP/2 sessions and TLS session cache instead of each
+// opening and handshaking their own connections.
+//
+// On top of the plain manager:
+//  - prepare() enables HTTP/2 and attaches the TLS configuration, including
+//    the last session ticket seen for the host, so a new connection (after
+//    the pool dropped an idle one, or a network change) resumes the TLS
+//    session instead of a full handshake. Tickets are kept for the life of
+//    the process only;
+//  - get() coalesces identical GETs: while one is in flight, another
+//    request for the same URL with the same headers joins it and every
+//    caller gets the same response;
+//  - preconnect() opens a connection ahead of the first request;
+//  - every request is timed by tracer() (see NetworkTracer).
+//
+// Lives on the GUI thread, like everything that uses it.
+class NetworkClient : public QObject {
+    Q_OBJECT
+
+public:
+    // Response to a GET that may have been shared between several callers
+    struct Response {
+        QUrl url;
+        int status = 0;
+        QNetworkReply::NetworkError error = QNetworkReply::NoError;
+        QString errorString;
+        QByteArray body;
+        QList<QNetworkReply::RawHeaderPair> headers;
+        // True for callers that joined a request already in flight
+        bool shared = false;
+
+        bool ok() const { return error == QNetworkReply::NoError; }
+        QByteArray rawHeader(const QByteArray& name) const;
+    };
+    using Handler = std::function<void(const Response&)>;
+
+    // Created on first use, owned by the application object.
+    static NetworkClient* instance();
+
+    explicit NetworkClient(QObject* parent = nullptr);
+    ~NetworkClient();
+
+    QNetworkAccessManager* manager() { return &m_manager; }
+    NetworkTracer* tracer() { return &m_tracer; }
+
+    // Allows HTTP/2 and sets up TLS (resumable sessions) for the request.
+    void prepare(QNetworkRequest& request) const;
+
+    // GETs `request`, or joins an identical GET already in flight.
+    // `handler` runs once the reply has finished, unless `context` has been
+    // destroyed by then; when every caller is gone the request is aborted.
+    void get(QNetworkRequest request, QObject* context, Handler handler);
+
+    // Opens (and for https, handshakes) a connection to the URL's host.
+    void preconnect(const QUrl& url);
+
+    // Requests that joined one already in flight, since startup
+    quint64 coalescedRequests() const { return m_coalesced; }
+
+private:
+    struct Waiter {
+        QPointer<QObject> context;
+        Handler handler;
+    };
+    struct Pending {
+        QNetworkReply* reply = nullptr;
+        std::vector<Waiter> waiters;
+    };
+
+    static QByteArray requestKey(const QNetworkRequest& request);
+    void finish(const QByteArray& key, QNetworkReply* reply);
+    // Called when a caller's context is destroyed
+    void dropDeadWaiters();
+#ifndef QT_NO_SSL
+    void rememberSession(QNetworkReply* reply);
+#endif
+
+    NetworkTracer m_tracer;
+    TracingNetworkAccessManager m_manager{&m_tracer};
+    QHash<QByteArray, Pending> m_pending;
+    quint64 m_coalesced = 0;
+#ifndef QT_NO_SSL
+    QSslConfiguration m_sslConfig;
+    // Session tickets by host, never written to disk
+    QHash<QString, QByteArray> m_sessionTickets;
+#endif
+};
+
+#endif // NETWORKCLIENT_H
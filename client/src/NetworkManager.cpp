@@ -1,22 +1,40 @@
 #include "NetworkManager.h"
+#include "ModelStatusTracker.h"
+#include "ModelEventChannel.h"
+#include "ChunkedUploader.h"
+#include "LocalStore.h"
+#include "ScanPipelineTracer.h"
 #include <QAuthenticator>
 #include <QDebug>
 #include <QFile>
 #include <QHttpMultiPart>
 #include <QMimeDatabase>
 #include <QStandardPaths>
-#include <QEventLoop>
+#include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkReply>
 #include <QSslSocket>
 #include <QSslConfiguration>
 #include <memory>
-#include <QThread>
+
+namespace {
+// Records per collection in one GET /sync page
+constexpr int kSyncPageSize = 200;
+}
 
 NetworkManager::NetworkManager(QObject* parent)
     : QObject(parent),
-      m_networkManager(new QNetworkAccessManager(this))
+      m_client(NetworkClient::instance()),
+      m_networkManager(m_client->manager()),
+      m_localStore(LocalStore::instance()),
+      m_statusTracker(new ModelStatusTracker(m_networkManager,
+                                             [this](const QUrl& url) { return createAuthenticatedRequest(url); },
+                                             this)),
+      m_eventChannel(ModelEventChannel::instance()),
+      m_scanUploader(new ChunkedUploader(m_networkManager,
+                                         [this](const QUrl& url) { return createAuthenticatedRequest(url); },
+                                         this))
 {
     #ifdef Q_OS_ANDROID
         //eduroam
@@ -28,13 +46,71 @@ NetworkManager::NetworkManager(QObject* parent)
         m_serverUrl = "http://localhost:5000/api";
     #endif
 
+    m_statusTracker->setServerUrl(m_serverUrl);
+    m_scanUploader->setServerUrl(m_serverUrl);
+    connect(m_statusTracker, &ModelStatusTracker::modelReady,
+            this, [](const QString& garmentId) {
+                ScanPipelineTracer::instance()->mark(garmentId, ScanPipelineTracer::ModelReady);
+            });
+    connect(m_statusTracker, &ModelStatusTracker::modelReady,
+            this, &NetworkManager::processedModelReady);
+    // Resolved or given up on: no more pushes wanted for it
+    connect(m_statusTracker, &ModelStatusTracker::modelReady,
+            this, [this](const QString& garmentId) { m_eventChannel->unsubscribe(garmentId); });
+    connect(m_statusTracker, &ModelStatusTracker::modelFailed,
+            this, [this](const QString& garmentId) { m_eventChannel->unsubscribe(garmentId); });
+    connect(m_statusTracker, &ModelStatusTracker::modelFailed,
+            this, [this](const QString& garmentId, const QString& error) {
+                ScanPipelineTracer::instance()->fail(garmentId, "processing: " + error);
+                emit processedModelFailed(garmentId, error);
+                emit networkError("3D model processing failed for garment " + garmentId + ": " + error);
+            });
+
+    // Push notifications replace polling whenever the socket is up; the
+    // tracker only polls while the channel is down.
+    m_statusTracker->setSuspended(m_eventChannel->isConnected());
+    connect(m_eventChannel, &ModelEventChannel::connectedChanged,
+            this, [this](bool connected) {
+                m_statusTracker->setSuspended(connected);
+                emit pushConnectionChanged(connected);
+            });
+    connect(m_eventChannel, &ModelEventChannel::modelStatusReceived,
+            this, [this](const QJsonObject& status) {
+                m_statusTracker->applyStatus(status);
+            });
+    connect(m_eventChannel, &ModelEventChannel::scanStatusReceived,
+            this, [this](const QJsonObject& status) {
+                emit scanStatusChanged(status["garmentId"].toString(), status["status"].toString());
+            });
+
+    connect(m_scanUploader, &ChunkedUploader::progressChanged,
+            this, [this](const QString&, qint64 sent, qint64 total) {
+                if (total > 0) {
+                    emit scanProgressChanged(static_cast<int>((sent * 100) / total));
+                }
+            });
+    connect(m_scanUploader, &ChunkedUploader::throughputChanged,
+            this, &NetworkManager::uplinkThroughputChanged);
+    connect(m_scanUploader, &ChunkedUploader::uploadFinished,
+            this, &NetworkManager::handleScanUploaded);
+    connect(m_scanUploader, &ChunkedUploader::uploadFailed,
+            this, [this](const QString& garmentId, const QString& error) {
+                ScanPipelineTracer::instance()->fail(garmentId, "upload: " + error);
+                emit networkError("Scan upload failed: " + error);
+            });
+
+    // Anything this client changes on the server is pulled back into the
+    // local store; the sync only transfers what changed.
+    connect(this, &NetworkManager::userLoggedIn, this, [this]() { syncUserData(); });
+    connect(this, &NetworkManager::garmentUploadSucceeded, this, [this]() { syncUserData(); });
+    connect(this, &NetworkManager::garmentDeleteSucceeded, this, [this]() { syncUserData(); });
+    connect(this, &NetworkManager::scanUploaded, this, [this]() { syncUserData(); });
+    connect(this, &NetworkManager::processedModelReady, this, [this]() { syncUserData(); });
+
     connect(m_networkManager, &QNetworkAccessManager::authenticationRequired,
             this, &NetworkManager::onAuthenticationRequired);
 
 #ifndef QT_NO_SSL
-    m_sslConfig = QSslConfiguration::defaultConfiguration();
-    m_sslConfig.setProtocol(QSsl::TlsV1_2OrLater);
-
     connect(m_networkManager, &QNetworkAccessManager::sslErrors,
             this, &NetworkManager::onSslErrors);
 
@@ -44,19 +120,27 @@ NetworkManager::NetworkManager(QObject* parent)
 #endif
 
     m_authToken = loadAuthToken();
+    // Have a connection ready by the time the first request goes out
+    m_client->preconnect(QUrl(m_serverUrl));
     verifyAuthToken();
+    updateEventChannel();
     
 }
 
 // Destructor
 NetworkManager::~NetworkManager() {
-
+    // Let another manager sync; replies to this one are dropped
+    if (m_syncing) {
+        m_localStore->setSyncing(false);
+    }
+    // The event channel outlives us
+    for (const QString& garmentId : m_statusTracker->pendingGarments()) {
+        m_eventChannel->unsubscribe(garmentId);
+    }
 }
 void NetworkManager::verifyServerConnectivity() {
     QNetworkRequest request(QUrl(m_serverUrl + "/api/status"));
-    QNetworkReply* reply = m_networkManager->get(request);
-    
-    connect(reply, &QNetworkReply::finished, [this, reply]() {
+    m_client->get(request, this, [this](const NetworkClient::Response& reply) {
         bool ok;
         QJsonDocument response = parseJsonReply(reply, ok);
         if (ok && response.object().value("online").toBool()) {
@@ -64,36 +148,30 @@ void NetworkManager::verifyServerConnectivity() {
         } else {
             emit connectionStatusChanged(false);
         }
-        reply->deleteLater();
     });
 }
 void NetworkManager::verifyAuthToken() {
     if (m_authToken.isEmpty()) return;
 
+    // Shares the request with fetchUserData() and with other
+    // NetworkManager instances checking the same token
     QNetworkRequest request = createAuthenticatedRequest(QUrl(m_serverUrl + "/auth/verify"));
-    QNetworkReply* reply = m_networkManager->get(request);
-    
-    connect(reply, &QNetworkReply::finished, [this, reply]() {
+    m_client->get(request, this, [this](const NetworkClient::Response& reply) {
         bool ok;
         QJsonDocument response = parseJsonReply(reply, ok);
         if (ok && response.object()["valid"].toBool()) {
             emit connectionStatusChanged(true);
+            syncUserData();
         } else {
             clearAuthToken();
             emit connectionStatusChanged(false);
         }
-        reply->deleteLater();
     });
 }
 
 QNetworkRequest NetworkManager::createAuthenticatedRequest(const QUrl& url) {
     QNetworkRequest request(url);
-
-#ifndef QT_NO_SSL
-    if (url.scheme() == "https") {
-        request.setSslConfiguration(m_sslConfig);
-    }
-#endif
+    m_client->prepare(request);
 
     if (!m_authToken.isEmpty()) {
         request.setRawHeader("Authorization", "Bearer " + m_authToken.toUtf8());
@@ -104,6 +182,9 @@ QNetworkRequest NetworkManager::createAuthenticatedRequest(const QUrl& url) {
 
 #ifndef QT_NO_SSL
 void NetworkManager::onSslErrors(QNetworkReply* reply, const QList<QSslError>& errors) {
+    // The access manager is shared; other components report their own hosts
+    if (!reply->url().toString().startsWith(QUrl(m_serverUrl).adjusted(QUrl::RemovePath).toString())) return;
+
     QString errorString;
     for (const QSslError& error : errors) {
         errorString += error.errorString() + ", ";
@@ -126,205 +207,158 @@ QString NetworkManager::serverUrl() const {
 void NetworkManager::setServerUrl(const QString& url) {
     if (m_serverUrl != url) {
         m_serverUrl = url;
+        m_statusTracker->setServerUrl(m_serverUrl);
+        m_scanUploader->setServerUrl(m_serverUrl);
+        m_client->preconnect(QUrl(m_serverUrl));
+        updateEventChannel();
         emit serverUrlChanged();
     }
 }
 
 // Fetch all garments
-// ---- Fetch All Garments (GET /garments) ----
+// ---- Fetch Garments (GET /garments?limit=N&cursor=C) ----
+// The catalog is paged; fetchGarments() loads the first page and views pull
+// the rest through fetchGarmentsPage() as they scroll. Each page URL is
+// revalidated with ETag / Last-Modified against the on-disk HttpCache; only
+// forceRefresh skips the conditional request.
 void NetworkManager::fetchGarments(bool forceRefresh) {
+    fetchGarmentsPage(QString(), 30, forceRefresh);
+}
+
+void NetworkManager::fetchGarmentsPage(const QString& cursor, int limit, bool forceRefresh) {
     QUrl url(m_serverUrl + "/garments");
-    qDebug() << "Starting garments fetch from:" << url.toString();
+    QUrlQuery query;
+    query.addQueryItem("limit", QString::number(limit));
+    if (!cursor.isEmpty()) {
+        query.addQueryItem("cursor", cursor);
+    }
+    url.setQuery(query);
+    qDebug() << "Starting garments fetch from:" << url.toString() << (forceRefresh ? "(forced)" : "");
     
     QNetworkRequest request = createAuthenticatedRequest(url);
-    QNetworkReply *reply = m_networkManager->get(request);
-    
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        handleGarmentsResponse(reply);
-    });
-    
-    connect(reply, &QNetworkReply::errorOccurred, this, [this, reply](QNetworkReply::NetworkError error) {
-        qDebug() << "Network error occurred during fetch";
-        processNetworkError(error);
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    if (!forceRefresh) {
+        m_httpCache.addValidators(url.toString(), request);
+    }
+    // QMLManager and the QML pages all load the first page at startup;
+    // identical requests share one reply.
+    m_client->get(request, this, [this, cursor, limit](const NetworkClient::Response& reply) {
+        if (!reply.ok() && reply.status != 304) {
+            // handleNetworkError() reports it; one error per failed fetch
+            qDebug() << "Network error occurred during fetch";
+            handleNetworkError(reply);
+            emit garmentsPageFailed(cursor);
+            return;
+        }
+        handleGarmentsResponse(reply, cursor, limit);
     });
 }
 
-void NetworkManager::handleGarmentsResponse(QNetworkReply* reply) {
-    bool ok;
-    QJsonDocument doc = parseJsonReply(reply, ok);
+void NetworkManager::handleGarmentsResponse(const NetworkClient::Response& reply, const QString& cursor, int limit) {
+    const QString cacheKey = reply.url.toString();
+    const int httpStatus = reply.status;
+
+    // Pages arrive as { items, nextCursor }; older servers send a bare array.
+    auto emitPage = [this, &cursor](const QJsonDocument& doc) {
+        if (doc.isArray()) {
+            emit garmentsPageReceived(doc.array(), cursor, QString());
+        } else {
+            const QJsonObject page = doc.object();
+            emit garmentsPageReceived(page["items"].toArray(), cursor, page["nextCursor"].toString());
+        }
+    };
+
+    if (httpStatus == 304) {
+        const HttpCache::Entry* cached = m_httpCache.lookup(cacheKey);
+        if (cached) {
+            qDebug() << "Garments page not modified, serving cached copy";
+            emitPage(cached->document);
+        } else {
+            // Validators were sent but the entry is gone; fetch it in full.
+            fetchGarmentsPage(cursor, limit, true);
+        }
+        return;
+    }
+
+    const QByteArray& body = reply.body;
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
     
-    if(ok && doc.isArray()) {
-        QJsonArray garmentsArray = doc.array();
-        QString jsonString = QString::fromUtf8(doc.toJson());
-        qDebug().noquote() << "Fetched garments data:\n" << jsonString;
-        emit garmentsReceived(garmentsArray);
+    if(reply.ok() && parseError.error == QJsonParseError::NoError
+        && (doc.isArray() || doc.object().contains("items"))) {
+        qDebug() << "Fetched garments page (" << body.size() << "bytes)" << (reply.shared ? "(shared)" : "");
+        m_httpCache.store(cacheKey, reply.rawHeader("ETag"), reply.rawHeader("Last-Modified"), body, doc);
+        emitPage(doc);
     } else {
         qDebug() << "Failed to parse garments response. Raw response:"
-                 << QString::fromUtf8(reply->readAll());
+                 << QString::fromUtf8(body.left(512));
+        emit garmentsPageFailed(cursor);
         emit networkError(tr("Failed to fetch garments."));
     }
-    
-    reply->deleteLater();
 }
 
+// Scans go up in chunks through a resumable upload session (see
+// ChunkedUploader), so a dropped connection only costs the chunk in flight.
 void NetworkManager::uploadScan(const QByteArray& imageData, const QString& category, const QString& garmentId) {
     qDebug() << "Uploading scan with:";
     qDebug() << " - Category:" << category;
     qDebug() << " - Garment ID:" << garmentId;
     qDebug() << " - Image size:" << imageData.size() << "bytes";
 
-    QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
-    
-    // Add garment ID part
-    QHttpPart garmentIdPart;
-    garmentIdPart.setHeader(QNetworkRequest::ContentDispositionHeader,
-                        QVariant("form-data; name=\"garmentId\""));
-    garmentIdPart.setBody(garmentId.toUtf8());  
-    multiPart->append(garmentIdPart);
-    
-    // Add category part
-    QHttpPart categoryPart;
-    categoryPart.setHeader(QNetworkRequest::ContentDispositionHeader,
-                          QVariant("form-data; name=\"category\""));
-    categoryPart.setBody(category.toUtf8());
-    multiPart->append(categoryPart);
-
-    // Add image part
-    QHttpPart imagePart;
-    imagePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("image/jpeg"));
-    imagePart.setHeader(QNetworkRequest::ContentDispositionHeader,
-                       QVariant("form-data; name=\"image\"; filename=\"scan.jpg\""));
-    imagePart.setBody(imageData);
-    multiPart->append(imagePart);
-
-    QUrl url(m_serverUrl + "/scans");
-    QNetworkRequest request = createAuthenticatedRequest(url);
-    
-    QNetworkReply* reply = m_networkManager->post(request, multiPart);
-    multiPart->setParent(reply);
+    m_scanUploader->upload(imageData, "image/jpeg", garmentId, category);
+}
 
-    connect(reply, &QNetworkReply::uploadProgress, [this](qint64 sent, qint64 total) {
-        if (total > 0) {
-            emit scanProgressChanged(static_cast<int>((sent * 100) / total));
-        }
-    });
+void NetworkManager::handleScanUploaded(const QString& garmentId, const QJsonObject& scan) {
+    if (scan.contains("garmentId") || scan.contains("imageUrl")) {
+        QString returnedGarmentId = scan.contains("garmentId") ?
+                                scan["garmentId"].toString() : garmentId;
 
-    connect(reply, &QNetworkReply::finished, [this, reply, garmentId]() {
-        bool ok;
-        QJsonDocument response = parseJsonReply(reply, ok);
-        
-        if (ok && response.isObject()) {
-            QJsonObject responseObj = response.object();
-            
-            if ((responseObj.contains("success") && responseObj["success"].toBool()) ||
-                responseObj.contains("garmentId") || 
-                responseObj.contains("imageUrl")) {
-                
-                QString returnedGarmentId = responseObj.contains("garmentId") ? 
-                                        responseObj["garmentId"].toString() : garmentId;
-                
-                QString imageUrl = responseObj.contains("imageUrl") ? 
-                                responseObj["imageUrl"].toString() : "";
-                
-                qDebug() << "Scan upload successful for garment:" << returnedGarmentId;
-                emit scanUploaded(returnedGarmentId, imageUrl);
-            } else {
-                QString errorMsg = responseObj.contains("error") ? 
-                                 responseObj["error"].toString() : "Unknown upload error";
-                qWarning() << "Scan upload failed:" << errorMsg;
-                emit networkError("Scan upload failed: " + errorMsg);
-            }
-        } else {
-            qWarning() << "Invalid response from scan upload";
-            emit networkError("Scan upload failed: Invalid server response");
-        }
-        
-        reply->deleteLater();
-    });
+        QString imageUrl = scan.contains("imageUrl") ?
+                        scan["imageUrl"].toString() : "";
+
+        qDebug() << "Scan upload successful for garment:" << returnedGarmentId;
+        ScanPipelineTracer::instance()->mark(garmentId, ScanPipelineTracer::Uploaded);
+        emit scanUploaded(returnedGarmentId, imageUrl);
+    } else {
+        qWarning() << "Invalid response from scan upload";
+        emit networkError("Scan upload failed: Invalid server response");
+    }
 }
 
+// Processing status is polled asynchronously by ModelStatusTracker; any
+// number of garments can be pending at once and share batched requests.
 void NetworkManager::getProcessedModel(const QString& garmentId) {
     qDebug() << "Requesting processed model for garment:" << garmentId;
-    
-    const int maxRetries = 10;
-    const int retryDelayMs = 2000;
-
-    // Build URL with garmentId as query parameter
-    QUrl url(m_serverUrl + "/3d-models");
-    QUrlQuery query;
-    query.addQueryItem("garmentId", garmentId);
-    url.setQuery(query);
-    
-    QNetworkRequest request = createAuthenticatedRequest(url);
-
-    for (int attempt = 0; attempt < maxRetries; ++attempt) {
-        qDebug() << "Requesting processed model for garment" << garmentId 
-                 << "(attempt" << (attempt + 1) << "of" << maxRetries << ")";
-
-        QNetworkReply* reply = m_networkManager->get(request);
+    ScanPipelineTracer::instance()->mark(garmentId, ScanPipelineTracer::ProcessingRequested);
+    if (m_statusTracker->isTracking(garmentId)) return;
+    m_statusTracker->track(garmentId);
+    m_eventChannel->subscribe({garmentId});
+}
 
-        QEventLoop loop;
-        connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-        loop.exec();  // BLOCKS until the reply is finished
+void NetworkManager::cancelProcessedModel(const QString& garmentId) {
+    m_statusTracker->cancel(garmentId);
+    m_eventChannel->unsubscribe(garmentId);
+}
 
-        bool ok;
-        QJsonDocument response = parseJsonReply(reply, ok);
+bool NetworkManager::isPushConnected() const {
+    return m_eventChannel->isConnected();
+}
 
-        if (ok && response.isObject()) {
-            QJsonObject obj = response.object();
-            
-            // Check if processing is complete
-            if (obj.contains("status")) {
-                QString status = obj["status"].toString();
-                qDebug() << "Processing status for garment" << garmentId << ":" << status;
-                
-                if (status == "completed" && obj.contains("modelUrl")) {
-                    QString modelUrl = obj["modelUrl"].toString();
-                    QString previewUrl = obj["previewUrl"].toString();
-                    QString modelKey = obj["modelKey"].toString();
-                    QString previewKey = obj["previewKey"].toString();
-                    qDebug() << "3D model ready for garment" << garmentId << ":" << modelUrl;
-                    emit processedModelReady(modelUrl, previewUrl, modelKey, previewKey);
-                    reply->deleteLater();
-                    return;
-                } else if (status == "failed") {
-                    QString errorMsg = obj.contains("error") ? 
-                                     obj["error"].toString() : "Processing failed";
-                    qWarning() << "3D model processing failed for garment" << garmentId << ":" << errorMsg;
-                    emit networkError("3D model processing failed: " + errorMsg);
-                    reply->deleteLater();
-                    return;
-                } else if (status == "processing") {
-                    qDebug() << "Model still processing for garment" << garmentId << "...";
-                    // Continue to retry
-                }
-            } else if (obj.contains("modelUrl")) {
-                // Fallback: direct modelUrl without status field
-                QString modelUrl = obj["modelUrl"].toString();
-                QString previewUrl = obj["previewUrl"].toString();
-                QString modelKey = obj["modelKey"].toString();
-                QString previewKey = obj["previewKey"].toString();
-                qDebug() << "3D model ready for garment" << garmentId << ":" << modelUrl;
-                emit processedModelReady(modelUrl, previewUrl, modelKey, previewKey);
-                reply->deleteLater();
-                return;
-            }
-        } else {
-            qWarning() << "Invalid response when requesting model for garment" << garmentId;
-        }
+double NetworkManager::uplinkThroughput() const {
+    return m_scanUploader->throughput();
+}
 
-        reply->deleteLater();
-        
-        // Don't sleep on the last attempt
-        if (attempt < maxRetries - 1) {
-            qDebug() << "Model not ready yet for garment" << garmentId 
-                     << ". Retrying in" << retryDelayMs << "ms...";
-            QThread::msleep(retryDelayMs);
-        }
+// Keep the push channel pointed at <server>/events while we hold a token.
+// The channel is shared, so the most recent server URL and token win.
+void NetworkManager::updateEventChannel() {
+    if (m_authToken.isEmpty()) {
+        m_eventChannel->close();
+        return;
     }
 
-    qWarning() << "Failed to get 3D model for garment" << garmentId << ": Max retries reached";
-    emit networkError("Failed to get 3D model for garment " + garmentId + ": Max retries reached");
+    QUrl url(m_serverUrl + "/events");
+    url.setScheme(url.scheme() == "https" ? "wss" : "ws");
+    m_eventChannel->open(url, m_authToken);
 }
 
 
@@ -486,6 +520,7 @@ void NetworkManager::handleUploadFinished(QNetworkReply* reply)
 void NetworkManager::registerUser(const QString& username, const QString& email, const QString& password) {
     QUrl url(m_serverUrl + "/auth/register");
     QNetworkRequest request(url);
+    m_client->prepare(request);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 
     QJsonObject userData{
@@ -496,7 +531,7 @@ void NetworkManager::registerUser(const QString& username, const QString& email,
 
     QNetworkReply* reply = m_networkManager->post(request, QJsonDocument(userData).toJson());
 
-    connect(reply, &QNetworkReply::finished, [this, reply]() {
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
         handleAuthResponse(reply, true);
         reply->deleteLater();
     });
@@ -505,6 +540,7 @@ void NetworkManager::registerUser(const QString& username, const QString& email,
 void NetworkManager::loginUser(const QString& email, const QString& password) {
     QUrl url(m_serverUrl + "/auth/login");
     QNetworkRequest request(url);
+    m_client->prepare(request);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 
     QJsonObject credentials{
@@ -513,7 +549,7 @@ void NetworkManager::loginUser(const QString& email, const QString& password) {
     };
 
     QNetworkReply* reply = m_networkManager->post(request, QJsonDocument(credentials).toJson());
-    connect(reply, &QNetworkReply::finished, [this, reply]() {
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
         handleAuthResponse(reply, false);
         reply->deleteLater();
     });
@@ -521,6 +557,8 @@ void NetworkManager::loginUser(const QString& email, const QString& password) {
 
 void NetworkManager::logoutUser() {
     clearAuthToken();
+    m_httpCache.clear();
+    m_localStore->clear();
     m_userId = QString();
     m_username = QString();
     emit userLoggedOut();
@@ -543,6 +581,7 @@ void NetworkManager::handleAuthResponse(QNetworkReply* reply, bool isRegistratio
             m_authToken = responseObj["token"].toString();
             qDebug() << "Token received and saved:" << m_authToken.left(20) + "...";
             saveAuthToken(m_authToken);
+            updateEventChannel();
             
             // Extract user data from login response
             if(responseObj.contains("user")) {
@@ -597,17 +636,15 @@ void NetworkManager::handleAuthResponse(QNetworkReply* reply, bool isRegistratio
 
 void NetworkManager::fetchUserData() {
     QNetworkRequest request = createAuthenticatedRequest(QUrl(m_serverUrl + "/auth/verify"));
-    QNetworkReply* reply = m_networkManager->get(request);
-    
-    connect(reply, &QNetworkReply::finished, [this, reply]() {
+    m_client->get(request, this, [this](const NetworkClient::Response& reply) {
         bool ok;
         QJsonDocument response = parseJsonReply(reply, ok);
         
-        qDebug() << "Fetch user data - HTTP Status:" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        qDebug() << "Fetch user data - HTTP Status:" << reply.status;
         qDebug() << "Fetch user data - Parse OK:" << ok;
         qDebug() << "Fetch user data response:" << response.object();
         
-        if(reply->error() == QNetworkReply::NoError && ok) {
+        if(reply.ok() && ok) {
             QJsonObject responseObj = response.object();
             if(responseObj.contains("user")) {
                 QJsonObject user = responseObj["user"].toObject();
@@ -622,10 +659,9 @@ void NetworkManager::fetchUserData() {
             }
         }
         else {
-            qDebug() << "Failed to fetch user data:" << reply->errorString();
-            emit authenticationFailed("Failed to fetch user data: " + reply->errorString());
+            qDebug() << "Failed to fetch user data:" << reply.errorString;
+            emit authenticationFailed("Failed to fetch user data: " + reply.errorString);
         }
-        reply->deleteLater();
     });
 }
 
@@ -636,64 +672,124 @@ bool NetworkManager::isUserLoggedIn() const {
 }
 
 // Sync user data
-void NetworkManager::syncUserData() {
+void NetworkManager::syncUserData(bool fullResync) {
     if (!isUserLoggedIn()) {
         emit networkError("Cannot sync data: User not logged in");
         return;
     }
+    if (m_localStore->isSyncing()) {
+        // Changes made while our sync runs may be past its cursor already
+        if (m_syncing) m_syncQueued = true;
+        return;
+    }
 
-    QNetworkRequest request = createAuthenticatedRequest(QUrl(m_serverUrl + "/user/sync"));
-
+    m_localStore->setSyncing(true);
+    m_syncing = true;
+    m_syncQueued = false;
     emit networkRequestStarted();
-    QNetworkReply* reply = m_networkManager->get(request);
+    requestSyncPage(fullResync ? QString() : m_localStore->cursor());
+}
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+void NetworkManager::requestSyncPage(const QString& since) {
+    QUrl url(m_serverUrl + "/sync");
+    QUrlQuery query;
+    query.addQueryItem("limit", QString::number(kSyncPageSize));
+    if (!since.isEmpty()) {
+        query.addQueryItem("since", since);
+    }
+    url.setQuery(query);
+
+    QNetworkRequest request = createAuthenticatedRequest(url);
+    m_client->get(request, this, [this](const NetworkClient::Response& reply) {
         bool ok;
         QJsonDocument response = parseJsonReply(reply, ok);
 
-        if (ok && reply->error() == QNetworkReply::NoError) {
-            // Handle sync response
-            // This could trigger updating local data
-            qDebug() << "User data synced successfully";
-        } else {
-            QString errorMsg = "Sync failed: " + reply->errorString();
+        if (!ok || !reply.ok()) {
+            QString errorMsg = "Sync failed: " + reply.errorString;
             if (ok) {
                 errorMsg = response.object().value("error").toString(errorMsg);
             }
+            finishSync(false);
             emit networkError(errorMsg);
+            return;
         }
 
-        reply->deleteLater();
-        emit networkRequestFinished();
+        const QJsonObject page = response.object();
+        const QString storeUserId = m_localStore->userId();
+        if (!page["reset"].toBool() && !storeUserId.isEmpty() && page["userId"].toString() != storeUserId) {
+            // The store holds another account's records; its cursor means
+            // nothing for this one
+            qDebug() << "Local store belongs to another user, fetching a full snapshot";
+            m_localStore->clear();
+            requestSyncPage(QString());
+            return;
+        }
+
+        m_localStore->applySyncPage(page);
+        if (page["hasMore"].toBool()) {
+            requestSyncPage(page["cursor"].toString());
+            return;
+        }
+        finishSync(true);
     });
 }
 
+void NetworkManager::finishSync(bool ok) {
+    m_syncing = false;
+    m_localStore->setSyncing(false);
+    if (ok) {
+        qDebug() << "Local store synced:" << m_localStore->count(LocalStore::Garments) << "garments,"
+                 << m_localStore->count(LocalStore::Scans) << "scans,"
+                 << m_localStore->count(LocalStore::Models) << "models";
+    }
+    emit syncFinished(ok);
+    emit networkRequestFinished();
+
+    const bool again = ok && m_syncQueued;
+    m_syncQueued = false;
+    if (again) {
+        syncUserData();
+    }
+}
+
 // Check server status
 void NetworkManager::checkServerStatus() {
     QNetworkRequest request(QUrl(m_serverUrl + "/api/status"));
 
     emit networkRequestStarted();
-    QNetworkReply* reply = m_networkManager->get(request);
-
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+    m_client->get(request, this, [this](const NetworkClient::Response& reply) {
         bool ok;
         QJsonDocument response = parseJsonReply(reply, ok);
 
-        if (ok && reply->error() == QNetworkReply::NoError) {
+        if (ok && reply.ok()) {
             bool serverOnline = response.object().value("online").toBool(false);
             QString version = response.object().value("version").toString("unknown");
 
             qDebug() << "Server status: " << (serverOnline ? "Online" : "Offline")
                      << ", Version: " << version;
         } else {
-            emit networkError("Server status check failed: " + reply->errorString());
+            emit networkError("Server status check failed: " + reply.errorString);
         }
 
-        reply->deleteLater();
         emit networkRequestFinished();
     });
 }
 
+QString NetworkManager::exportNetworkTrace(const QString& path) {
+    QString target = path;
+    if (target.isEmpty()) {
+        target = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+                 + "/traces/network-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".json";
+    }
+
+    QString error;
+    if (!m_client->tracer()->exportChromeTrace(target, &error)) {
+        emit networkError("Could not write network trace: " + error);
+        return QString();
+    }
+    return target;
+}
+
 // Handle authentication required
 void NetworkManager::onAuthenticationRequired(QNetworkReply* reply, QAuthenticator* authenticator) {
     // This could be used for HTTP Basic Auth if needed
@@ -735,6 +831,7 @@ void NetworkManager::clearAuthToken() {
     settings.remove("token");
     settings.endGroup();
     m_authToken = QString();
+    updateEventChannel();
 }
 
 QJsonDocument NetworkManager::parseJsonReply(QNetworkReply* reply, bool& ok) {
@@ -752,13 +849,34 @@ QJsonDocument NetworkManager::parseJsonReply(QNetworkReply* reply, bool& ok) {
     return doc;
 }
 
+QJsonDocument NetworkManager::parseJsonReply(const NetworkClient::Response& reply, bool& ok) {
+    ok = false;
+    if(reply.body.isEmpty()) {
+        return QJsonDocument();
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(reply.body, &parseError);
+    ok = (parseError.error == QJsonParseError::NoError);
+
+    return doc;
+}
+
 // Handle network errors
 void NetworkManager::handleNetworkError(QNetworkReply* reply) {
-    QString errorString = reply->errorString();
-    QNetworkReply::NetworkError errorCode = reply->error();
+    NetworkClient::Response response;
+    response.error = reply->error();
+    response.errorString = reply->errorString();
+    response.body = reply->readAll();
+    handleNetworkError(response);
+}
+
+void NetworkManager::handleNetworkError(const NetworkClient::Response& reply) {
+    QString errorString = reply.errorString;
+    QNetworkReply::NetworkError errorCode = reply.error;
 
     // Check if the error response contains JSON data
-    QByteArray errorData = reply->readAll();
+    const QByteArray& errorData = reply.body;
     if (!errorData.isEmpty()) {
         QJsonParseError parseError;
         QJsonDocument errorJson = QJsonDocument::fromJson(errorData, &parseError);
@@ -16,6 +16,13 @@
 #include <QtQml/qqmlregistration.h>
 #include <QAuthenticator>
 #include <QFileInfo>
+#include "HttpCache.h"
+#include "NetworkClient.h"
+
+class LocalStore;
+class ModelStatusTracker;
+class ModelEventChannel;
+class ChunkedUploader;
 
 class NetworkManager : public QObject {
     Q_OBJECT
@@ -23,6 +30,8 @@ class NetworkManager : public QObject {
 
     Q_PROPERTY(bool isConnected READ isConnected NOTIFY connectionStatusChanged)
     Q_PROPERTY(QString serverUrl READ serverUrl WRITE setServerUrl NOTIFY serverUrlChanged)
+    Q_PROPERTY(bool isPushConnected READ isPushConnected NOTIFY pushConnectionChanged)
+    Q_PROPERTY(double uplinkThroughput READ uplinkThroughput NOTIFY uplinkThroughputChanged)
     
 
 public:
@@ -38,13 +47,18 @@ public:
     // Properties
     QString serverUrl() const;
     void setServerUrl(const QString& url);
+    bool isPushConnected() const;
+    // Bytes per second measured on scan uploads, 0 while unknown
+    double uplinkThroughput() const;
 
     // CRUD operations
     Q_INVOKABLE void fetchGarments(bool forceRefresh = false);
+    Q_INVOKABLE void fetchGarmentsPage(const QString& cursor, int limit = 30, bool forceRefresh = false);
     Q_INVOKABLE void uploadGarment(const QJsonObject& garmentData);
     Q_INVOKABLE void deleteGarment(const QString& garmentId);
     Q_INVOKABLE void uploadScan(const QByteArray& imageData, const QString& category, const QString& garmentId);
-    Q_INVOKABLE void getProcessedModel(const QString& imageId);
+    Q_INVOKABLE void getProcessedModel(const QString& garmentId);
+    Q_INVOKABLE void cancelProcessedModel(const QString& garmentId);
 
     // User management
     Q_INVOKABLE void registerUser(const QString& username, const QString& email, const QString& password);
@@ -53,9 +67,16 @@ public:
     Q_INVOKABLE bool isUserLoggedIn() const;
 
     // Utility methods
-    Q_INVOKABLE void syncUserData();
+    // Brings LocalStore up to date with GET /sync, one page at a time from
+    // the stored cursor; fullResync fetches a fresh snapshot instead. Runs
+    // on its own after login and whenever this client changed something.
+    Q_INVOKABLE void syncUserData(bool fullResync = false);
     Q_INVOKABLE void checkServerStatus();
 
+    // Writes the recent request timings (Chrome trace_event JSON) to `path`,
+    // or to <app data>/traces when empty; returns the file written.
+    Q_INVOKABLE QString exportNetworkTrace(const QString& path = QString());
+
 signals:
     // Connection status
     void connectionStatusChanged(bool connected);
@@ -65,7 +86,10 @@ signals:
     void connectionError(const QString& error);
 
     // CRUD responses
-    void garmentsReceived(const QJsonArray& garments);
+    // One page of the catalog; `cursor` is empty for the first page and
+    // `nextCursor` is empty once the last page has been delivered.
+    void garmentsPageReceived(const QJsonArray& garments, const QString& cursor, const QString& nextCursor);
+    void garmentsPageFailed(const QString& cursor);
     void garmentDetailsReceived(const QString& garmentId, const QJsonObject& details);
     void garmentUploadSucceeded(const QString& garmentId);
     void garmentUploadFailed(const QString& errorMessage);
@@ -75,7 +99,11 @@ signals:
     // Scan upload signals - ADDED MISSING SIGNAL
     void scanUploaded(const QString& imageId, const QString& imageUrl);
     void scanProgressChanged(int progress);
-    void processedModelReady(const QString& modelUrl, const QString& previewUrl, const QString& modelKey, const QString& previewKey);
+    void uplinkThroughputChanged(double bytesPerSecond);
+    void processedModelReady(const QString& garmentId, const QString& modelUrl, const QString& previewUrl, const QString& modelKey, const QString& previewKey);
+    void processedModelFailed(const QString& garmentId, const QString& error);
+    void scanStatusChanged(const QString& garmentId, const QString& status);
+    void pushConnectionChanged(bool connected);
 
 
 
@@ -90,13 +118,14 @@ signals:
     void networkRequestStarted();
     void networkRequestFinished();
     void networkError(const QString& errorMessage);
+    void syncFinished(bool ok);
 
 private slots:
     void onAuthenticationRequired(QNetworkReply* reply, QAuthenticator* authenticator);
-    void handleGarmentsResponse(QNetworkReply* reply);
     void handleAuthResponse(QNetworkReply* reply, bool isRegistration);
     void processNetworkError(QNetworkReply::NetworkError error);
     void handleUploadFinished(QNetworkReply* reply);
+    void handleScanUploaded(const QString& garmentId, const QJsonObject& scan);
     void fetchUserData();
     bool isConnected() const { return !m_authToken.isEmpty(); }
     void verifyAuthToken();
@@ -106,11 +135,14 @@ private slots:
 #endif
 
 private:
-    // Network components
+    // Network components; the access manager and event channel are shared
+    NetworkClient* m_client;
     QNetworkAccessManager* m_networkManager;
-#ifndef QT_NO_SSL
-    QSslConfiguration m_sslConfig;
-#endif
+    LocalStore* m_localStore;
+    ModelStatusTracker* m_statusTracker;
+    ModelEventChannel* m_eventChannel;
+    ChunkedUploader* m_scanUploader;
+    HttpCache m_httpCache;
 
     // Configuration
     QString m_serverUrl;
@@ -122,13 +154,23 @@ private:
     QString m_userId;
     QString m_username;
 
+    // This manager runs the process's sync; another one was asked for meanwhile
+    bool m_syncing = false;
+    bool m_syncQueued = false;
+
     // Helper methods
     QNetworkRequest createAuthenticatedRequest(const QUrl& url);
+    void handleGarmentsResponse(const NetworkClient::Response& reply, const QString& cursor, int limit);
+    void requestSyncPage(const QString& since);
+    void finishSync(bool ok);
     void saveAuthToken(const QString& token);
     void clearAuthToken();
     QString loadAuthToken();
     QJsonDocument parseJsonReply(QNetworkReply* reply, bool& ok);
+    QJsonDocument parseJsonReply(const NetworkClient::Response& reply, bool& ok);
     void handleNetworkError(QNetworkReply* reply);
+    void handleNetworkError(const NetworkClient::Response& reply);
+    void updateEventChannel();
 
 
 };
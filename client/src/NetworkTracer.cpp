@@ -0,0 +1,327 @@
+#include "NetworkTracer.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkRequest>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QUrl>
+#include <cmath>
+
+namespace {
+constexpr double kSlowRequestMs = 1000.0;
+
+QString operationName(QNetworkAccessManager::Operation operation, QNetworkReply* reply) {
+    switch (operation) {
+    case QNetworkAccessManager::HeadOperation: return QStringLiteral("HEAD");
+    case QNetworkAccessManager::GetOperation: return QStringLiteral("GET");
+    case QNetworkAccessManager::PutOperation: return QStringLiteral("PUT");
+    case QNetworkAccessManager::PostOperation: return QStringLiteral("POST");
+    case QNetworkAccessManager::DeleteOperation: return QStringLiteral("DELETE");
+    default:
+        return QString::fromLatin1(reply->request().attribute(QNetworkRequest::CustomVerbAttribute).toByteArray());
+    }
+}
+
+// "app;dur=12.5, db;dur=3" -> 12.5; the first entry when there is no "app"
+double serverTimingMs(const QByteArray& header) {
+    double first = -1.0;
+    for (const QByteArray& entry : header.split(',')) {
+        const QList<QByteArray> params = entry.split(';');
+        double duration = -1.0;
+        for (const QByteArray& param : params) {
+            const QByteArray p = param.trimmed();
+            if (p.startsWith("dur=")) {
+                bool ok = false;
+                const double value = p.mid(4).toDouble(&ok);
+                if (ok) duration = value;
+            }
+        }
+        if (duration < 0.0) continue;
+        if (params.first().trimmed() == "app") return duration;
+        if (first < 0.0) first = duration;
+    }
+    return first;
+}
+
+bool looksLikeId(const QString& segment) {
+    int digits = 0;
+    bool hex = true;
+    for (const QChar c : segment) {
+        const char16_t u = c.unicode();
+        if (u >= '0' && u <= '9') ++digits;
+        else if (!((u >= 'a' && u <= 'f') || (u >= 'A' && u <= 'F'))) hex = false;
+    }
+    return digits >= 4 || (hex && segment.size() >= 8);
+}
+}
+
+void NetworkTracer::Histogram::add(double ms, bool failed) {
+    const int bucket = ms < 1.0 ? 0 : qMin(kBuckets - 1, int(std::floor(std::log2(ms))) + 1);
+    ++buckets[bucket];
+    ++count;
+    if (failed) ++failures;
+    sumMs += ms;
+    maxMs = qMax(maxMs, ms);
+}
+
+double NetworkTracer::Histogram::quantileMs(double q) const {
+    if (count == 0) return 0.0;
+    const double target = qBound(0.0, q, 1.0) * count;
+    quint64 seen = 0;
+    for (int i = 0; i < kBuckets - 1; ++i) {
+        seen += buckets[i];
+        if (seen >= target && seen > 0) return qMin(maxMs, std::ldexp(1.0, i));
+    }
+    return maxMs;
+}
+
+NetworkTracer::NetworkTracer(QObject* parent)
+    : QObject(parent),
+      m_sessionTag(QByteArray::number(QRandomGenerator::global()->generate() & 0xffffff, 16))
+{
+    m_clock.start();
+}
+
+void NetworkTracer::setCapacity(int capacity) {
+    capacity = qMax(1, capacity);
+    std::vector<Trace> kept = traces();
+    if (int(kept.size()) > capacity) {
+        kept.erase(kept.begin(), kept.end() - capacity);
+    }
+    m_ring = std::move(kept);
+    m_capacity = capacity;
+    m_next = 0;
+}
+
+QByteArray NetworkTracer::nextRequestId() {
+    return m_sessionTag + '-' + QByteArray::number(++m_sequence);
+}
+
+void NetworkTracer::track(QNetworkReply* reply, QNetworkAccessManager::Operation operation,
+                          const QByteArray& requestId) {
+    QUrl url = reply->request().url();
+
+    Trace trace;
+    trace.requestId = requestId;
+    trace.method = operationName(operation, reply);
+    trace.endpoint = endpointFor(url);
+    url.setQuery(QString());
+    trace.url = url.toString();
+    trace.queuedUs = nowUs();
+    m_active.insert(reply, trace);
+
+    // Replies are usually deleted later, but an aborted one can go at once
+    connect(reply, &QObject::destroyed, this, [this, reply]() { m_active.remove(reply); });
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [this, reply]() {
+        auto it = m_active.find(reply);
+        if (it != m_active.end() && it->connectingUs < 0) it->connectingUs = nowUs();
+    });
+#ifndef QT_NO_SSL
+    connect(reply, &QNetworkReply::encrypted, this, [this, reply]() {
+        auto it = m_active.find(reply);
+        if (it != m_active.end() && it->encryptedUs < 0) it->encryptedUs = nowUs();
+    });
+#endif
+    connect(reply, &QNetworkReply::requestSent, this, [this, reply]() {
+        auto it = m_active.find(reply);
+        if (it != m_active.end()) it->sentUs = nowUs();
+    });
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply]() {
+        auto it = m_active.find(reply);
+        if (it != m_active.end() && it->firstByteUs < 0) it->firstByteUs = nowUs();
+    });
+    connect(reply, &QNetworkReply::uploadProgress, this, [this, reply](qint64 sent, qint64) {
+        auto it = m_active.find(reply);
+        if (it != m_active.end()) it->bytesSent = sent;
+    });
+    connect(reply, &QNetworkReply::downloadProgress, this, [this, reply](qint64 received, qint64) {
+        auto it = m_active.find(reply);
+        if (it != m_active.end()) it->bytesReceived = received;
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() { finish(reply); });
+}
+
+void NetworkTracer::finish(QNetworkReply* reply) {
+    auto it = m_active.find(reply);
+    if (it == m_active.end()) return;
+    Trace trace = *it;
+    m_active.erase(it);
+
+    trace.finishedUs = nowUs();
+    trace.status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError) {
+        trace.error = reply->errorString();
+    }
+    trace.http2 = reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+    trace.serverMs = serverTimingMs(reply->rawHeader("Server-Timing"));
+
+    const double totalMs = trace.totalMs();
+    m_histograms[trace.method + ' ' + trace.endpoint].add(totalMs, !trace.error.isEmpty());
+
+    if (totalMs >= kSlowRequestMs) {
+        const double ttfbMs = trace.firstByteUs >= 0 ? (trace.firstByteUs - trace.queuedUs) / 1000.0 : -1.0;
+        qDebug() << "Slow request" << trace.requestId << trace.method << trace.url << trace.status
+                 << "in" << qRound(totalMs) << "ms ( first byte" << qRound(ttfbMs) << "ms, server"
+                 << qRound(trace.serverMs) << "ms, new connection" << (trace.connectingUs >= 0) << ")";
+    }
+
+    if (int(m_ring.size()) < m_capacity) {
+        m_ring.push_back(trace);
+    } else {
+        m_ring[m_next] = trace;
+        m_next = (m_next + 1) % m_ring.size();
+    }
+    emit traceFinished(trace);
+}
+
+std::vector<NetworkTracer::Trace> NetworkTracer::traces() const {
+    if (int(m_ring.size()) < m_capacity) return m_ring;
+
+    std::vector<Trace> ordered;
+    ordered.reserve(m_ring.size());
+    ordered.insert(ordered.end(), m_ring.begin() + m_next, m_ring.end());
+    ordered.insert(ordered.end(), m_ring.begin(), m_ring.begin() + m_next);
+    return ordered;
+}
+
+void NetworkTracer::clear() {
+    m_ring.clear();
+    m_next = 0;
+    m_histograms.clear();
+}
+
+QString NetworkTracer::endpointFor(const QUrl& url) {
+    QStringList segments = url.path().split('/');
+    for (QString& segment : segments) {
+        if (looksLikeId(segment)) segment = QStringLiteral(":id");
+    }
+    return url.host() + segments.join('/');
+}
+
+QJsonObject NetworkTracer::histogramsJson() const {
+    QJsonArray bounds;
+    for (int i = 0; i < Histogram::kBuckets - 1; ++i) {
+        bounds.append(std::ldexp(1.0, i));
+    }
+
+    QJsonObject result;
+    for (const auto& [endpoint, histogram] : m_histograms) {
+        QJsonArray buckets;
+        for (quint32 n : histogram.buckets) buckets.append(qint64(n));
+
+        QJsonObject entry;
+        entry["count"] = qint64(histogram.count);
+        entry["failures"] = qint64(histogram.failures);
+        entry["meanMs"] = histogram.count ? histogram.sumMs / histogram.count : 0.0;
+        entry["maxMs"] = histogram.maxMs;
+        entry["p50Ms"] = histogram.quantileMs(0.5);
+        entry["p90Ms"] = histogram.quantileMs(0.9);
+        entry["p99Ms"] = histogram.quantileMs(0.99);
+        entry["buckets"] = buckets;
+        entry["bucketUpperMs"] = bounds;
+        result[endpoint] = entry;
+    }
+    return result;
+}
+
+QByteArray NetworkTracer::chromeTraceJson() const {
+    QJsonArray events;
+    events.append(QJsonObject{
+        {"name", "process_name"}, {"ph", "M"}, {"pid", 1},
+        {"args", QJsonObject{{"name", "ARClothTryOn network"}}},
+    });
+
+    for (const Trace& trace : traces()) {
+        const QString id = QString::fromLatin1(trace.requestId);
+        auto event = [&id](const QString& name, const char* phase, qint64 ts) {
+            return QJsonObject{
+                {"name", name}, {"cat", "network"}, {"ph", phase}, {"id", id},
+                {"ts", ts}, {"pid", 1}, {"tid", 1},
+            };
+        };
+
+        QJsonObject begin = event(trace.method + ' ' + trace.endpoint, "b", trace.queuedUs);
+        QJsonObject args{
+            {"requestId", id}, {"url", trace.url}, {"status", trace.status},
+            {"http2", trace.http2}, {"newConnection", trace.connectingUs >= 0},
+            {"bytesSent", trace.bytesSent}, {"bytesReceived", trace.bytesReceived},
+        };
+        if (trace.serverMs >= 0.0) args["serverMs"] = trace.serverMs;
+        if (!trace.error.isEmpty()) args["error"] = trace.error;
+        begin["args"] = args;
+        events.append(begin);
+
+        // One slice per phase, between consecutive timestamps
+        enum Point { Queued, Connecting, Encrypted, Sent, FirstByte, Finished };
+        const std::pair<Point, qint64> points[] = {
+            {Queued, trace.queuedUs}, {Connecting, trace.connectingUs}, {Encrypted, trace.encryptedUs},
+            {Sent, trace.sentUs}, {FirstByte, trace.firstByteUs}, {Finished, trace.finishedUs},
+        };
+        Point from = Queued;
+        qint64 fromUs = trace.queuedUs;
+        for (const auto& [point, us] : points) {
+            if (point == Queued || us < fromUs) continue;
+
+            QString name;
+            switch (point) {
+            case Connecting: name = "queue"; break;
+            case Encrypted: name = "connect + TLS"; break;
+            case Sent: name = from == Connecting ? "connect + send" : "send"; break;
+            case FirstByte: name = "wait"; break;
+            default: name = from == FirstByte ? "download" : "wait"; break;
+            }
+            QJsonObject slice = event(name, "b", fromUs);
+            if (point == FirstByte && trace.serverMs >= 0.0) {
+                slice["args"] = QJsonObject{{"serverMs", trace.serverMs}};
+            }
+            events.append(slice);
+            events.append(event(name, "e", us));
+            from = point;
+            fromUs = us;
+        }
+
+        events.append(event(trace.method + ' ' + trace.endpoint, "e", trace.finishedUs));
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    root["otherData"] = QJsonObject{{"histograms", histogramsJson()}};
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool NetworkTracer::exportChromeTrace(const QString& path, QString* error) const {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(chromeTraceJson());
+    if (!file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    qDebug() << "Network trace with" << traces().size() << "requests written to" << path;
+    return true;
+}
+
+QNetworkReply* TracingNetworkAccessManager::createRequest(Operation operation, const QNetworkRequest& request,
+                                                          QIODevice* outgoingData) {
+    if (!m_tracer || !m_tracer->isEnabled()) {
+        return QNetworkAccessManager::createRequest(operation, request, outgoingData);
+    }
+
+    QNetworkRequest traced(request);
+    QByteArray requestId = request.rawHeader("X-Request-Id");
+    if (requestId.isEmpty()) {
+        requestId = m_tracer->nextRequestId();
+        traced.setRawHeader("X-Request-Id", requestId);
+    }
+    QNetworkReply* reply = QNetworkAccessManager::createRequest(operation, traced, outgoingData);
+    m_tracer->track(reply, operation, requestId);
+    return reply;
+}
@@ -0,0 +1,140 @@
+#pragma once
+#ifndef NETWORKTRACER_H
+#define NETWORKTRACER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QObject>
+#include <QString>
+#include <array>
+#include <map>
+#include <vector>
+
+// Phase timing for every request sent through the shared access manager
+// (see NetworkClient). Each request gets a correlation id, sent as
+// X-Request-Id so it can be found in the server log, and timestamps for:
+//  - queued:      handed to the access manager
+//  - connecting:  a new socket starts connecting (DNS + TCP); absent when
+//                 the request reuses an open connection
+//  - encrypted:   TLS handshake done (https on a new connection only)
+//  - sent:        request headers and body written
+//  - first byte:  response headers received
+//  - finished
+// The server's own processing time comes from its Server-Timing header.
+//
+// Finished requests go into a fixed-size ring buffer that can be exported
+// as Chrome trace_event JSON (chrome://tracing, Perfetto) and into per-
+// endpoint latency histograms kept for the whole session. Lives on the
+// access manager's thread.
+class NetworkTracer : public QObject {
+    Q_OBJECT
+
+public:
+    struct Trace {
+        QByteArray requestId;
+        QString method;
+        QString endpoint;       // host + path with ids collapsed
+        QString url;            // without query
+        int status = 0;
+        QString error;
+        bool http2 = false;
+        qint64 bytesSent = 0;
+        qint64 bytesReceived = 0;
+        double serverMs = -1.0;
+
+        // Microseconds on the tracer's clock, -1 when the phase did not occur
+        qint64 queuedUs = -1;
+        qint64 connectingUs = -1;
+        qint64 encryptedUs = -1;
+        qint64 sentUs = -1;
+        qint64 firstByteUs = -1;
+        qint64 finishedUs = -1;
+
+        double totalMs() const { return finishedUs < 0 ? -1.0 : (finishedUs - queuedUs) / 1000.0; }
+    };
+
+    // Log2 buckets of total request time: <1 ms, <2 ms, ... >= 32 s
+    struct Histogram {
+        static constexpr int kBuckets = 17;
+        std::array<quint32, kBuckets> buckets{};
+        quint64 count = 0;
+        quint64 failures = 0;
+        double sumMs = 0.0;
+        double maxMs = 0.0;
+
+        void add(double ms, bool failed);
+        // Upper bound of the bucket holding the given quantile (0..1)
+        double quantileMs(double q) const;
+    };
+
+    explicit NetworkTracer(QObject* parent = nullptr);
+
+    // Keeps the last `capacity` finished requests.
+    void setCapacity(int capacity);
+    int capacity() const { return m_capacity; }
+
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+
+    // Id for the next request; goes out as its X-Request-Id header.
+    QByteArray nextRequestId();
+    // Starts timing a reply that was just created for `requestId`.
+    void track(QNetworkReply* reply, QNetworkAccessManager::Operation operation,
+               const QByteArray& requestId);
+
+    // Finished requests, oldest first
+    std::vector<Trace> traces() const;
+    const std::map<QString, Histogram>& histograms() const { return m_histograms; }
+    QJsonObject histogramsJson() const;
+
+    // {"traceEvents": [...]} with one async track per request and a slice
+    // per phase; the histograms go under "otherData".
+    QByteArray chromeTraceJson() const;
+    bool exportChromeTrace(const QString& path, QString* error = nullptr) const;
+
+    void clear();
+
+    // http://host/api/garments/garment_1700_42/status -> "host/api/garments/:id/status"
+    static QString endpointFor(const QUrl& url);
+
+signals:
+    void traceFinished(const NetworkTracer::Trace& trace);
+
+private:
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+    void finish(QNetworkReply* reply);
+
+    QElapsedTimer m_clock;
+    bool m_enabled = true;
+    quint64 m_sequence = 0;
+    QByteArray m_sessionTag;
+
+    QHash<QNetworkReply*, Trace> m_active;
+    std::vector<Trace> m_ring;
+    int m_capacity = 512;
+    size_t m_next = 0;
+
+    std::map<QString, Histogram> m_histograms;
+};
+
+// Access manager that puts every request it creates through a NetworkTracer.
+// createRequest() is the one place all operations (get, post, put, custom)
+// pass through, including requests from code that never sees the tracer.
+class TracingNetworkAccessManager : public QNetworkAccessManager {
+public:
+    explicit TracingNetworkAccessManager(NetworkTracer* tracer, QObject* parent = nullptr)
+        : QNetworkAccessManager(parent), m_tracer(tracer) {}
+
+protected:
+    QNetworkReply* createRequest(Operation operation, const QNetworkRequest& request,
+                                 QIODevice* outgoingData) override;
+
+private:
+    NetworkTracer* m_tracer;
+};
+
+#endif // NETWORKTRACER_H
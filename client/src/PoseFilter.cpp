@@ -0,0 +1,82 @@
+#include "PoseFilter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr float kPi = 3.14159265358979f;
+
+// Exponential smoothing factor for a first-order low-pass at cutoffHz.
+float smoothingFactor(float dt, float cutoffHz) {
+    const float tau = 1.0f / (2.0f * kPi * cutoffHz);
+    return 1.0f / (1.0f + tau / dt);
+}
+}
+
+void PoseFilter::reset() {
+    m_state = {};
+    m_hasPose = false;
+}
+
+void PoseFilter::filter(Channel& channel, float sample, float dt, float weight) const {
+    const float rawVelocity = (sample - channel.value) / dt;
+    const float velocityAlpha = weight * smoothingFactor(dt, m_params.derivativeCutoffHz);
+    channel.velocity += velocityAlpha * (rawVelocity - channel.velocity);
+
+    const float cutoff = m_params.minCutoffHz + m_params.beta * std::fabs(channel.velocity);
+    const float alpha = weight * smoothingFactor(dt, cutoff);
+    channel.value += alpha * (sample - channel.value);
+}
+
+void PoseFilter::addObservation(const PoseKeypoints& keypoints, int64_t timeNs) {
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+        const BodyKeypoint& sample = keypoints[i];
+        KeypointState& state = m_state[i];
+
+        if (sample.confidence < m_params.minConfidence) {
+            // Occluded or lost: keep coasting on the previous estimate.
+            continue;
+        }
+
+        if (!state.initialised) {
+            state.x = {sample.x, 0.0f};
+            state.y = {sample.y, 0.0f};
+            state.confidence = sample.confidence;
+            state.lastNs = timeNs;
+            state.initialised = true;
+            continue;
+        }
+
+        const float dt = float(timeNs - state.lastNs) * 1e-9f;
+        if (dt <= 0.0f) continue;
+
+        // A doubtful detection moves the estimate proportionally less.
+        const float weight = std::clamp(sample.confidence, 0.0f, 1.0f);
+        filter(state.x, sample.x, dt, weight);
+        filter(state.y, sample.y, dt, weight);
+        state.confidence = sample.confidence;
+        state.lastNs = timeNs;
+    }
+    m_hasPose = true;
+}
+
+bool PoseFilter::predict(int64_t timeNs, PoseKeypoints& out) const {
+    if (!m_hasPose) return false;
+
+    for (size_t i = 0; i < out.size(); ++i) {
+        const KeypointState& state = m_state[i];
+        if (!state.initialised) {
+            out[i] = {0.0f, 0.0f, 0.0f};
+            continue;
+        }
+
+        const float elapsed = float(timeNs - state.lastNs) * 1e-9f;
+        const float dt = std::clamp(elapsed, 0.0f, m_params.maxPredictionSec);
+        // Past the horizon the keypoint is stale; report it as lost so the
+        // fitter holds the limb instead of trusting a guess.
+        const float confidence = elapsed > 2.0f * m_params.maxPredictionSec ? 0.0f : state.confidence;
+        out[i] = {state.x.value + state.x.velocity * dt,
+                  state.y.value + state.y.velocity * dt,
+                  confidence};
+    }
+    return true;
+}
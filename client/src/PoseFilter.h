@@ -0,0 +1,56 @@
+#pragma once
+#include "CommonTypes.h"
+#include <array>
+#include <cstdint>
+
+// Smooths tracked poses and extrapolates them to the render time, so the
+// garment can be drawn every display frame from a slower tracker.
+//
+// Each keypoint coordinate runs through a One-Euro filter (an adaptive
+// low-pass whose cutoff rises with speed: heavy smoothing when still, little
+// lag when moving). Observations are weighted by their confidence, and
+// keypoints below the confidence floor are held and coasted on their last
+// velocity for at most maxPredictionSec.
+class PoseFilter {
+public:
+    struct Params {
+        float minCutoffHz = 1.0f;       // cutoff at rest; lower = less jitter
+        float beta = 20.0f;             // cutoff gain per unit/s of speed (normalised coords)
+        float derivativeCutoffHz = 1.0f;
+        float minConfidence = 0.3f;
+        float maxPredictionSec = 0.1f;  // extrapolation horizon
+    };
+
+    PoseFilter() = default;
+    explicit PoseFilter(const Params& params) : m_params(params) {}
+
+    const Params& params() const { return m_params; }
+    void setParams(const Params& params) { m_params = params; }
+
+    void reset();
+
+    // Feeds one tracked pose; timestamps must be monotonic (steady clock).
+    void addObservation(const PoseKeypoints& keypoints, int64_t timeNs);
+
+    // Writes the filtered pose extrapolated to timeNs. Returns false until
+    // the first observation.
+    bool predict(int64_t timeNs, PoseKeypoints& out) const;
+
+private:
+    struct Channel {
+        float value = 0.0f;
+        float velocity = 0.0f;   // filtered derivative, units/s
+    };
+    struct KeypointState {
+        Channel x, y;
+        float confidence = 0.0f;
+        int64_t lastNs = 0;
+        bool initialised = false;
+    };
+
+    void filter(Channel& channel, float sample, float dt, float weight) const;
+
+    Params m_params;
+    std::array<KeypointState, BodyPartCount> m_state{};
+    bool m_hasPose = false;
+};
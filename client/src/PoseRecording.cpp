@@ -0,0 +1,264 @@
+#include "PoseRecording.h"
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <chrono>
+#include <cstring>
+
+namespace {
+const char kMagic[8] = {'A', 'R', 'R', 'E', 'C', '\0', '\0', '\1'};
+
+// Same clock as FramePipeline::timestampNs()
+qint64 steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void setUp(QDataStream& stream) {
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+bool isYuv(QVideoFrameFormat::PixelFormat format) {
+    switch (format) {
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21:
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YUV422P:
+    case QVideoFrameFormat::Format_YV12:
+    case QVideoFrameFormat::Format_IMC1:
+    case QVideoFrameFormat::Format_IMC2:
+    case QVideoFrameFormat::Format_IMC3:
+    case QVideoFrameFormat::Format_IMC4:
+    case QVideoFrameFormat::Format_P010:
+    case QVideoFrameFormat::Format_P016:
+    case QVideoFrameFormat::Format_UYVY:
+    case QVideoFrameFormat::Format_YUYV:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// BT.601 limited range, the usual camera encoding; chroma is the mean of
+// each 2x2 block.
+QVideoFrame toSemiPlanar(const QImage& source, bool vu) {
+    const QImage image = source.convertToFormat(QImage::Format_RGB32);
+    const int width = image.width() & ~1;
+    const int height = image.height() & ~1;
+    QVideoFrame frame(QVideoFrameFormat(QSize(width, height),
+                                        vu ? QVideoFrameFormat::Format_NV21 : QVideoFrameFormat::Format_NV12));
+    if (!frame.map(QVideoFrame::WriteOnly)) return QVideoFrame();
+
+    uchar* yPlane = frame.bits(0);
+    uchar* uvPlane = frame.bits(1);
+    const int yStride = frame.bytesPerLine(0);
+    const int uvStride = frame.bytesPerLine(1);
+    for (int y = 0; y < height; y += 2) {
+        const QRgb* rows[2] = {reinterpret_cast<const QRgb*>(image.constScanLine(y)),
+                               reinterpret_cast<const QRgb*>(image.constScanLine(y + 1))};
+        uchar* uv = uvPlane + (y / 2) * uvStride;
+        for (int x = 0; x < width; x += 2) {
+            int r = 0, g = 0, b = 0;
+            for (int dy = 0; dy < 2; ++dy) {
+                for (int dx = 0; dx < 2; ++dx) {
+                    const QRgb p = rows[dy][x + dx];
+                    yPlane[(y + dy) * yStride + x + dx] =
+                        uchar(16 + ((66 * qRed(p) + 129 * qGreen(p) + 25 * qBlue(p) + 128) >> 8));
+                    r += qRed(p);
+                    g += qGreen(p);
+                    b += qBlue(p);
+                }
+            }
+            r /= 4; g /= 4; b /= 4;
+            const uchar u = uchar(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+            const uchar v = uchar(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+            uv[x] = vu ? v : u;
+            uv[x + 1] = vu ? u : v;
+        }
+    }
+    frame.unmap();
+    return frame;
+}
+}
+
+PoseRecorder::PoseRecorder() {
+    // One writer keeps records in call order
+    m_writer.setMaxThreadCount(1);
+    m_writer.setObjectName("PoseRecorder");
+}
+
+PoseRecorder::~PoseRecorder() {
+    stop();
+}
+
+bool PoseRecorder::start(const QString& path, QString* error) {
+    stop();
+
+    QMutexLocker locker(&m_fileMutex);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = m_file.errorString();
+        qWarning() << "Could not start pose recording:" << m_file.errorString();
+        return false;
+    }
+
+    m_originNs = steadyNowNs();
+    QDataStream stream(&m_file);
+    setUp(stream);
+    stream.writeRawData(kMagic, sizeof(kMagic));
+    stream << m_originNs;
+
+    m_framesWritten = 0;
+    m_posesWritten = 0;
+    m_droppedFrames = 0;
+    m_recording.store(true, std::memory_order_release);
+    qDebug() << "Recording camera frames and poses to" << path;
+    return true;
+}
+
+void PoseRecorder::stop() {
+    if (!m_recording.exchange(false)) return;
+    m_writer.waitForDone();
+
+    QMutexLocker locker(&m_fileMutex);
+    m_file.close();
+    qDebug() << "Pose recording stopped:" << m_framesWritten.load() << "frames," << m_posesWritten.load()
+             << "poses," << m_droppedFrames.load() << "frames dropped";
+}
+
+QString PoseRecorder::path() const {
+    QMutexLocker locker(&m_fileMutex);
+    return m_file.fileName();
+}
+
+void PoseRecorder::write(const QByteArray& record) {
+    QMutexLocker locker(&m_fileMutex);
+    if (m_file.isOpen()) m_file.write(record);
+}
+
+void PoseRecorder::recordFrame(const QVideoFrame& frame, qint64 arrivedNs) {
+    if (!isRecording() || !frame.isValid()) return;
+    if (m_pendingFrames.load() >= m_maxPendingFrames) {
+        ++m_droppedFrames;
+        return;
+    }
+    ++m_pendingFrames;
+
+    const qint64 timeNs = arrivedNs - m_originNs;
+    const int quality = m_jpegQuality;
+    // QVideoFrame is implicitly shared; the camera buffer is only read here
+    m_writer.start([this, frame, timeNs, quality]() {
+        // Stored as delivered: the estimator sees frames before display rotation
+        QVideoFrame raw(frame);
+        raw.setRotation(QtVideo::Rotation::None);
+        raw.setMirrored(false);
+        const QImage image = raw.toImage();
+
+        QByteArray jpeg;
+        QBuffer buffer(&jpeg);
+        if (!image.isNull() && buffer.open(QIODevice::WriteOnly) && image.save(&buffer, "JPG", quality)) {
+            QByteArray record;
+            QDataStream stream(&record, QIODevice::WriteOnly);
+            setUp(stream);
+            stream << quint8(PoseRecording::FrameRecord) << timeNs << quint32(frame.pixelFormat())
+                   << quint16(image.width()) << quint16(image.height()) << jpeg;
+            write(record);
+            ++m_framesWritten;
+        } else {
+            ++m_droppedFrames;
+        }
+        --m_pendingFrames;
+    });
+}
+
+void PoseRecorder::recordPose(const PoseSnapshot& pose) {
+    if (!isRecording()) return;
+
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    setUp(stream);
+    stream << quint8(PoseRecording::PoseRecord) << qint64(pose.captureNs - m_originNs) << quint64(pose.frameNumber);
+    for (const BodyKeypoint& keypoint : pose.keypoints) {
+        stream << keypoint.x << keypoint.y << keypoint.confidence;
+    }
+    // Through the writer as well, so a pose lands after its frame
+    m_writer.start([this, record]() {
+        write(record);
+        ++m_posesWritten;
+    });
+}
+
+bool PoseRecordingReader::open(const QString& path, QString* error) {
+    m_file.close();
+    m_file.setFileName(path);
+    m_error.clear();
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+    } else {
+        char magic[sizeof(kMagic)];
+        if (m_file.read(magic, sizeof(magic)) != qint64(sizeof(magic))
+            || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+            m_error = QStringLiteral("not a pose recording");
+        } else {
+            // The origin only matters on the recording device
+            m_file.skip(sizeof(qint64));
+            m_dataStart = m_file.pos();
+        }
+    }
+    if (error) *error = m_error;
+    return m_error.isEmpty();
+}
+
+bool PoseRecordingReader::rewind() {
+    m_error.clear();
+    return m_file.isOpen() && m_file.seek(m_dataStart);
+}
+
+bool PoseRecordingReader::next(Record& record) {
+    if (!m_file.isOpen() || m_file.atEnd()) return false;
+
+    QDataStream stream(&m_file);
+    setUp(stream);
+    quint8 type = 0;
+    stream >> type >> record.timeNs;
+    record.type = PoseRecording::RecordType(type);
+
+    if (type == PoseRecording::FrameRecord) {
+        quint32 format = 0;
+        quint16 width = 0, height = 0;
+        stream >> format >> width >> height >> record.jpeg;
+        record.sourceFormat = QVideoFrameFormat::PixelFormat(format);
+        record.size = QSize(width, height);
+    } else if (type == PoseRecording::PoseRecord) {
+        stream >> record.frameNumber;
+        for (BodyKeypoint& keypoint : record.keypoints) {
+            stream >> keypoint.x >> keypoint.y >> keypoint.confidence;
+        }
+    } else {
+        m_error = QStringLiteral("unknown record type %1 at offset %2").arg(type).arg(m_file.pos());
+        return false;
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        // A recording cut off by a crash ends in a partial record
+        m_error = QStringLiteral("truncated record at offset %1").arg(m_file.pos());
+        return false;
+    }
+    return true;
+}
+
+QVideoFrame PoseRecordingReader::toVideoFrame(const Record& record) {
+    QImage image;
+    if (record.type != PoseRecording::FrameRecord || !image.loadFromData(record.jpeg, "JPG")) {
+        return QVideoFrame();
+    }
+    if (isYuv(record.sourceFormat)) {
+        return toSemiPlanar(image, record.sourceFormat == QVideoFrameFormat::Format_NV21);
+    }
+    return QVideoFrame(image);
+}
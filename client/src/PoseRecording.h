@@ -0,0 +1,111 @@
+#pragma once
+#ifndef POSERECORDING_H
+#define POSERECORDING_H
+
+#include "CommonTypes.h"
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
+#include <atomic>
+
+// Camera frames and the keypoints tracked from them, recorded on the device
+// so tracker and fitter work can be replayed without one (see PoseReplay).
+//
+// File layout (*.arrec), little endian:
+//   header:  "ARREC\0\0\1", qint64 clock origin (FramePipeline::timestampNs)
+//   records: quint8 type, qint64 time in ns since the origin, then
+//     Frame: quint32 source pixel format, quint16 width, quint16 height,
+//            quint32 size + JPEG bytes
+//     Pose:  quint64 tracker frame number, BodyPartCount x (x, y,
+//            confidence) as float32
+// A frame's time is its arrival at the video sink; a pose carries the time
+// of the frame it came from, so the two are matched by time.
+namespace PoseRecording {
+    enum RecordType : quint8 {
+        FrameRecord = 1,
+        PoseRecord = 2,
+    };
+}
+
+// Writes a recording while the pipeline runs. recordFrame() and recordPose()
+// are thread-safe and return at once: frames are JPEG-encoded and written
+// in call order on one worker, and dropped while maxPendingFrames() are
+// still waiting, so recording never stalls the camera.
+class PoseRecorder {
+public:
+    PoseRecorder();
+    ~PoseRecorder();
+
+    bool start(const QString& path, QString* error = nullptr);
+    // Waits for queued records and closes the file.
+    void stop();
+    bool isRecording() const { return m_recording.load(std::memory_order_acquire); }
+    QString path() const;
+
+    void recordFrame(const QVideoFrame& frame, qint64 arrivedNs);
+    void recordPose(const PoseSnapshot& pose);
+
+    int jpegQuality() const { return m_jpegQuality; }
+    void setJpegQuality(int quality) { m_jpegQuality = qBound(1, quality, 100); }
+    int maxPendingFrames() const { return m_maxPendingFrames; }
+    void setMaxPendingFrames(int frames) { m_maxPendingFrames = qMax(1, frames); }
+
+    quint64 framesWritten() const { return m_framesWritten.load(); }
+    quint64 posesWritten() const { return m_posesWritten.load(); }
+    quint64 droppedFrames() const { return m_droppedFrames.load(); }
+
+private:
+    void write(const QByteArray& record);
+
+    QThreadPool m_writer;
+    mutable QMutex m_fileMutex;
+    QFile m_file;
+    qint64 m_originNs = 0;
+    std::atomic<bool> m_recording{false};
+    std::atomic<int> m_pendingFrames{0};
+    int m_jpegQuality = 85;
+    int m_maxPendingFrames = 3;
+    std::atomic<quint64> m_framesWritten{0};
+    std::atomic<quint64> m_posesWritten{0};
+    std::atomic<quint64> m_droppedFrames{0};
+};
+
+// Sequential reader for recordings written by PoseRecorder.
+class PoseRecordingReader {
+public:
+    struct Record {
+        PoseRecording::RecordType type = PoseRecording::FrameRecord;
+        qint64 timeNs = 0;      // since the recording's origin
+        // FrameRecord
+        QVideoFrameFormat::PixelFormat sourceFormat = QVideoFrameFormat::Format_Invalid;
+        QSize size;
+        QByteArray jpeg;
+        // PoseRecord
+        quint64 frameNumber = 0;
+        PoseKeypoints keypoints{};
+    };
+
+    bool open(const QString& path, QString* error = nullptr);
+    // Back to the first record
+    bool rewind();
+    // False at the end of the file, or on a damaged record (see error())
+    bool next(Record& record);
+    QString error() const { return m_error; }
+
+    // Decodes a frame record into a memory-backed video frame close to its
+    // source layout, so pose estimators read what they read from the camera:
+    // NV21 stays NV21, other YUV layouts become NV12, RGB stays RGB.
+    static QVideoFrame toVideoFrame(const Record& record);
+
+private:
+    QFile m_file;
+    qint64 m_dataStart = 0;
+    QString m_error;
+};
+
+#endif // POSERECORDING_H
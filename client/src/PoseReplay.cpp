@@ -0,0 +1,148 @@
+#include "PoseReplay.h"
+#include "BodyTracker.h"
+#include "ClothFitter.h"
+#include "PoseRecording.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Stands in for the pose model: answers each frame with the keypoints
+// recorded for it.
+class RecordedPoseEstimator : public PoseEstimator {
+public:
+    explicit RecordedPoseEstimator(const QHash<qint64, PoseKeypoints>* poses) : m_poses(poses) {}
+
+    void setFrameTime(qint64 timeNs) { m_frameTimeNs = timeNs; }
+
+    bool estimate(const FrameView&, PoseKeypoints& keypoints) override {
+        const auto it = m_poses->constFind(m_frameTimeNs);
+        if (it == m_poses->constEnd()) return false;
+        keypoints = *it;
+        return true;
+    }
+
+private:
+    const QHash<qint64, PoseKeypoints>* m_poses;
+    qint64 m_frameTimeNs = 0;
+};
+
+constexpr float kMinCompareConfidence = 0.3f;
+}
+
+double PoseReplay::Stats::percentile(std::vector<double> samples, double q) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    const size_t rank = size_t(std::ceil(q * samples.size()));
+    return samples[std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+PoseReplay::PoseReplay(BodyTracker* tracker, ClothFitter* fitter)
+    : m_tracker(tracker), m_fitter(fitter)
+{
+}
+
+bool PoseReplay::run(const QString& path, const Options& options, Stats* stats, QString* error) {
+    PoseRecordingReader reader;
+    if (!reader.open(path, error)) return false;
+
+    // First pass: the recorded poses, keyed by the time of their frame
+    QHash<qint64, PoseKeypoints> recordedPoses;
+    qint64 firstFrameNs = -1, lastFrameNs = -1;
+    PoseRecordingReader::Record record;
+    while (reader.next(record)) {
+        if (record.type == PoseRecording::PoseRecord) {
+            recordedPoses.insert(record.timeNs, record.keypoints);
+        } else {
+            if (firstFrameNs < 0) firstFrameNs = record.timeNs;
+            lastFrameNs = record.timeNs;
+        }
+    }
+    if (!reader.error().isEmpty()) {
+        qWarning() << "Replaying" << path << "up to the damaged part:" << reader.error();
+    }
+    if (firstFrameNs < 0) {
+        if (error) *error = QStringLiteral("recording has no frames");
+        return false;
+    }
+
+    RecordedPoseEstimator* replayedEstimator = nullptr;
+    if (!m_tracker->hasEstimator()) {
+        auto estimator = std::make_unique<RecordedPoseEstimator>(&recordedPoses);
+        replayedEstimator = estimator.get();
+        m_tracker->setEstimator(std::move(estimator));
+    }
+
+    Stats result;
+    result.recordedMs = (lastFrameNs - firstFrameNs) / 1e6;
+    if (!replayedEstimator) result.maxKeypointError = 0.0;
+    const qint64 renderLeadNs = qint64(options.renderLeadMs * 1e6);
+    m_filter.reset();
+
+    reader.rewind();
+    QElapsedTimer wall;
+    wall.start();
+    QElapsedTimer timer;
+    while (reader.next(record)) {
+        if (record.type != PoseRecording::FrameRecord) continue;
+        if (options.maxFrames > 0 && result.frames >= options.maxFrames) break;
+
+        const QVideoFrame frame = PoseRecordingReader::toVideoFrame(record);
+        if (!frame.isValid()) {
+            qWarning() << "Skipping undecodable frame at" << record.timeNs / 1e6 << "ms";
+            continue;
+        }
+
+        if (options.pacing == Pacing::RealTime) {
+            const qint64 dueNs = record.timeNs - firstFrameNs;
+            const qint64 aheadNs = dueNs - wall.nsecsElapsed();
+            if (aheadNs > 0) QThread::usleep(quint64(aheadNs / 1000));
+            result.lagMs.push_back(std::max<qint64>(0, wall.nsecsElapsed() - dueNs) / 1e6);
+        }
+        ++result.frames;
+
+        // Recorded times stand in for the clock, so filtering and
+        // prediction do not depend on how fast the replay runs.
+        if (replayedEstimator) replayedEstimator->setFrameTime(record.timeNs);
+        timer.start();
+        const bool tracked = m_tracker->processFrame(frame, record.timeNs);
+        result.trackMs.push_back(timer.nsecsElapsed() / 1e6);
+        result.frameMs.push_back(result.trackMs.back());
+        if (!tracked || !m_tracker->acquireLatestPose()) continue;
+        ++result.trackedFrames;
+
+        const PoseSnapshot& pose = m_tracker->currentPose();
+        if (!replayedEstimator) {
+            const auto recorded = recordedPoses.constFind(record.timeNs);
+            for (int part = 0; recorded != recordedPoses.constEnd() && part < BodyPartCount; ++part) {
+                const BodyKeypoint& expected = (*recorded)[part];
+                const BodyKeypoint& actual = pose.keypoints[part];
+                if (expected.confidence < kMinCompareConfidence) continue;
+                result.maxKeypointError = std::max(result.maxKeypointError,
+                                                   double(std::hypot(actual.x - expected.x, actual.y - expected.y)));
+            }
+        }
+
+        if (!m_fitter) continue;
+        m_filter.addObservation(pose.keypoints, pose.captureNs);
+        PoseKeypoints predicted;
+        if (!m_filter.predict(record.timeNs + renderLeadNs, predicted)) continue;
+        timer.start();
+        if (m_fitter->updateTransformation(predicted)) {
+            result.skinMs.push_back(timer.nsecsElapsed() / 1e6);
+            result.frameMs.back() += result.skinMs.back();
+            ++result.skinnedFrames;
+        }
+    }
+    result.wallMs = wall.nsecsElapsed() / 1e6;
+
+    if (replayedEstimator) m_tracker->setEstimator(nullptr);
+    if (!reader.error().isEmpty()) {
+        qWarning() << "Replay stopped early:" << reader.error();
+    }
+    if (stats) *stats = std::move(result);
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#ifndef POSEREPLAY_H
+#define POSEREPLAY_H
+
+#include "PoseFilter.h"
+#include <QString>
+#include <vector>
+
+class BodyTracker;
+class ClothFitter;
+
+// Plays a PoseRecorder recording through BodyTracker and, when given one,
+// ClothFitter, the way the app does live: every frame goes to
+// BodyTracker::processFrame(), and every tracked pose through PoseFilter
+// into ClothFitter::updateTransformation() (QMLManager::syncTrackedPose).
+// Frames are fed one at a time on the calling thread, so a replay never
+// drops frames and always produces the same poses.
+//
+// A tracker without an estimator gets one that replays the recorded
+// keypoints; with a real estimator its output is compared against them.
+class PoseReplay {
+public:
+    enum class Pacing {
+        MaxSpeed,   // next frame as soon as the last one is done
+        RealTime,   // frames at their recorded times
+    };
+
+    struct Options {
+        Pacing pacing = Pacing::MaxSpeed;
+        // How far ahead of the tracked frame the fitter's pose is predicted
+        double renderLeadMs = 16.7;
+        // Stop after this many frames; 0 plays the whole recording
+        int maxFrames = 0;
+    };
+
+    struct Stats {
+        int frames = 0;
+        int trackedFrames = 0;
+        int skinnedFrames = 0;
+        double recordedMs = 0.0;    // first to last frame in the recording
+        double wallMs = 0.0;
+        std::vector<double> trackMs;    // processFrame() per frame
+        std::vector<double> skinMs;     // updateTransformation() per tracked frame
+        std::vector<double> frameMs;    // tracking plus skinning per frame
+        std::vector<double> lagMs;      // RealTime: how late each frame started
+        // Largest keypoint distance from the recorded pose; -1 when the
+        // recorded keypoints were replayed
+        double maxKeypointError = -1.0;
+
+        double framesPerSecond() const { return wallMs > 0.0 ? frames * 1000.0 / wallMs : 0.0; }
+        static double percentile(std::vector<double> samples, double q);
+    };
+
+    PoseReplay(BodyTracker* tracker, ClothFitter* fitter = nullptr);
+
+    void setFilterParams(const PoseFilter::Params& params) { m_filter.setParams(params); }
+
+    bool run(const QString& path, const Options& options, Stats* stats, QString* error = nullptr);
+
+private:
+    BodyTracker* m_tracker;
+    ClothFitter* m_fitter;
+    PoseFilter m_filter;
+};
+
+#endif // POSEREPLAY_H
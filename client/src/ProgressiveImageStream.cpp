@@ -0,0 +1,165 @@
+#include "ProgressiveImageStream.h"
+
+namespace {
+// Baseline JPEGs have no scan boundaries to wait for; redecode after this
+// much new data so slow links still see the image fill in.
+constexpr qsizetype kBaselineStep = 64 * 1024;
+
+constexpr uchar kMarker = 0xFF;
+constexpr uchar kSoi = 0xD8;
+constexpr uchar kEoi = 0xD9;
+constexpr uchar kSos = 0xDA;
+
+uchar byteAt(const QByteArray& data, qsizetype i) {
+    return uchar(data.at(i));
+}
+
+QByteArray boundaryFrom(const QByteArray& contentType) {
+    if (!contentType.trimmed().toLower().startsWith("multipart/")) return QByteArray();
+    for (const QByteArray& param : contentType.split(';')) {
+        const QByteArray trimmed = param.trimmed();
+        if (!trimmed.toLower().startsWith("boundary=")) continue;
+        QByteArray value = trimmed.mid(int(sizeof("boundary=") - 1)).trimmed();
+        if (value.size() >= 2 && value.startsWith('"') && value.endsWith('"')) {
+            value = value.mid(1, value.size() - 2);
+        }
+        return value.isEmpty() ? QByteArray() : "--" + value;
+    }
+    return QByteArray();
+}
+}
+
+void ProgressiveImageStream::reset(const QByteArray& contentType) {
+    *this = ProgressiveImageStream();
+    setContentType(contentType);
+}
+
+void ProgressiveImageStream::setContentType(const QByteArray& contentType) {
+    // Only before the first byte: the body cannot change type midway
+    if (m_bytesReceived > 0) return;
+    m_boundary = boundaryFrom(contentType);
+}
+
+void ProgressiveImageStream::append(const QByteArray& chunk) {
+    if (chunk.isEmpty()) return;
+    m_bytesReceived += chunk.size();
+    m_buffer.append(chunk);
+    if (isMultipart()) {
+        scanMultipart();
+    } else {
+        scanJpeg();
+    }
+}
+
+void ProgressiveImageStream::scanJpeg() {
+    if (m_scanOffset < 0) return;   // not a JPEG, decode only at the end
+    if (m_scanOffset == 0) {
+        if (m_buffer.size() < 2) return;
+        if (byteAt(m_buffer, 0) != kMarker || byteAt(m_buffer, 1) != kSoi) {
+            m_scanOffset = -1;
+            return;
+        }
+        m_scanOffset = 2;
+    }
+
+    // Walk marker segments by their length fields, so tables and embedded
+    // EXIF thumbnails are skipped; inside entropy-coded data a marker is any
+    // 0xFF not followed by a stuffed 0x00 or a restart marker.
+    const qsizetype size = m_buffer.size();
+    qsizetype pos = m_scanOffset;
+    while (pos < size) {
+        if (!m_inEntropy) {
+            if (pos + 2 > size) break;
+            if (byteAt(m_buffer, pos) != kMarker) {
+                // Lost sync; fall back to decoding the finished body only
+                m_scanOffset = -1;
+                return;
+            }
+            const uchar marker = byteAt(m_buffer, pos + 1);
+            if (marker == kMarker) { ++pos; continue; }   // fill byte
+            if (marker == kEoi) { pos = size; break; }
+            if (pos + 4 > size) break;
+            const qsizetype length = (qsizetype(byteAt(m_buffer, pos + 2)) << 8) | byteAt(m_buffer, pos + 3);
+            if (marker == kSos) {
+                // Everything before a second or later scan decodes on its own
+                if (m_scans > 0) m_decodableLength = pos;
+                ++m_scans;
+                m_inEntropy = true;
+            }
+            pos += 2 + length;
+        } else {
+            const qsizetype next = m_buffer.indexOf(char(kMarker), pos);
+            if (next < 0) { pos = size; break; }
+            if (next + 1 >= size) { pos = next; break; }
+            const uchar marker = byteAt(m_buffer, next + 1);
+            if (marker == 0x00 || (marker >= 0xD0 && marker <= 0xD7)) {
+                pos = next + 2;
+                continue;
+            }
+            m_inEntropy = false;
+            pos = next;
+        }
+    }
+    m_scanOffset = pos;
+
+    if (m_scans == 1 && size - m_takenLength >= kBaselineStep) {
+        m_decodableLength = size;
+    }
+}
+
+void ProgressiveImageStream::scanMultipart() {
+    while (!m_ended) {
+        if (!m_inPart) {
+            const qsizetype start = m_buffer.indexOf(m_boundary);
+            if (start < 0) {
+                // Preamble: only a partial delimiter at the end can matter
+                if (m_buffer.size() > m_boundary.size()) {
+                    m_buffer.remove(0, m_buffer.size() - m_boundary.size());
+                }
+                return;
+            }
+            const qsizetype afterDelimiter = start + m_boundary.size();
+            if (m_buffer.size() < afterDelimiter + 2) return;
+            if (m_buffer.mid(afterDelimiter, 2) == "--") {
+                m_ended = true;
+                m_buffer.clear();
+                return;
+            }
+            const qsizetype headersEnd = m_buffer.indexOf("\r\n\r\n", afterDelimiter);
+            if (headersEnd < 0) return;
+            m_buffer.remove(0, headersEnd + 4);
+            m_inPart = true;
+        } else {
+            const qsizetype end = m_buffer.indexOf("\r\n" + m_boundary);
+            if (end < 0) return;
+            m_lastPart = m_buffer.left(end);
+            m_newPart = true;
+            ++m_parts;
+            m_buffer.remove(0, end + 2);
+            m_inPart = false;
+        }
+    }
+}
+
+bool ProgressiveImageStream::takeDecodable(QByteArray* data) {
+    if (isMultipart()) {
+        if (!m_newPart) return false;
+        *data = m_lastPart;
+        m_newPart = false;
+        return true;
+    }
+    if (m_decodableLength <= m_takenLength) return false;
+    *data = m_buffer.left(m_decodableLength);
+    m_takenLength = m_decodableLength;
+    return true;
+}
+
+QByteArray ProgressiveImageStream::finalImage() const {
+    if (!isMultipart()) return m_buffer;
+    if (m_inPart && !m_buffer.isEmpty()) {
+        QByteArray part = m_buffer;
+        if (part.endsWith("\r\n")) part.chop(2);
+        return part;
+    }
+    return m_lastPart;
+}
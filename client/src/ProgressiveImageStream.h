@@ -0,0 +1,59 @@
+#pragma once
+#ifndef PROGRESSIVEIMAGESTREAM_H
+#define PROGRESSIVEIMAGESTREAM_H
+
+#include <QByteArray>
+
+// Incremental parser for an image response body that arrives in chunks.
+// It decides when the bytes received so far are worth decoding:
+//  - image/jpeg: every time a new progressive scan starts, the scans before
+//    it are complete and the prefix decodes to a full-size (coarser) image.
+//    Baseline JPEGs have a single scan and are decoded every kBaselineStep
+//    bytes instead, filling in from the top.
+//  - multipart/x-mixed-replace: every complete part is an image on its own;
+//    the server sends quick previews first and the final result last.
+// Any other image type is only decoded once the body is complete.
+class ProgressiveImageStream {
+public:
+    void reset(const QByteArray& contentType = QByteArray());
+
+    // Content-Type may only become known after the stream started
+    void setContentType(const QByteArray& contentType);
+
+    void append(const QByteArray& chunk);
+
+    // Bytes to decode if something new became decodable since the last call
+    bool takeDecodable(QByteArray* data);
+
+    // The complete image once the body has ended: the whole body, or the last
+    // part of a multipart stream (including an unterminated final part).
+    QByteArray finalImage() const;
+
+    bool isMultipart() const { return !m_boundary.isEmpty(); }
+    qint64 bytesReceived() const { return m_bytesReceived; }
+    int partsReceived() const { return m_parts; }
+
+private:
+    void scanJpeg();
+    void scanMultipart();
+
+    QByteArray m_boundary;      // "--" + boundary parameter, empty for single images
+    QByteArray m_buffer;        // whole body, or the unparsed multipart tail
+    qint64 m_bytesReceived = 0;
+
+    // Single image
+    qsizetype m_scanOffset = 0;     // -1 once the body is known not to be a JPEG
+    bool m_inEntropy = false;
+    int m_scans = 0;
+    qsizetype m_decodableLength = 0;
+    qsizetype m_takenLength = 0;
+
+    // Multipart
+    bool m_inPart = false;
+    bool m_ended = false;
+    int m_parts = 0;
+    QByteArray m_lastPart;
+    bool m_newPart = false;
+};
+
+#endif // PROGRESSIVEIMAGESTREAM_H
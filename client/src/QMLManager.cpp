@@ -2,23 +2,59 @@
 #include <QGuiApplication>
 #include "ClothFitter.h"
 #include "ImageConverter.h"
+#include "LocalStore.h"
+#include "ScanPipelineTracer.h"
 #include <QUrl>
 #include <QLocale>
 #include <QStandardPaths>  // Added missing include
 #include <QDir>            // Added missing include
 #include <QFileInfo>
-#include <QBuffer>
+#include <QScreen>
+#include <QElapsedTimer>
+#include <QQuickWindow>
+
+namespace {
+// Garments per catalog page the grid pulls from the local store
+constexpr int kCatalogPageSize = 30;
+}
 
 QMLManager::QMLManager(QObject* parent)
     : QObject(parent),
+    m_poseRecorder(std::make_unique<PoseRecorder>()),
     m_clothScanner(std::make_unique<ClothScanner>()),
     m_clothFitter(std::make_unique<ClothFitter>()),
     m_bodyTracker(std::make_unique<BodyTracker>()),
-    m_networkManager(std::make_unique<NetworkManager>()) // Initialize NetworkManager
+    m_framePipeline(std::make_unique<FramePipeline>(m_bodyTracker.get())),
+    m_networkManager(std::make_unique<NetworkManager>()), // Initialize NetworkManager
+    m_frameEncoder(std::make_unique<FrameEncoder>()),
+    m_garments(new GarmentListModel(this))
 {
+    // Fed from the sink and tracker threads; idle until a recording starts
+    m_framePipeline->setRecorder(m_poseRecorder.get());
+    m_bodyTracker->setRecorder(m_poseRecorder.get());
+
+    // The catalog is served from the local store right away, one page at a
+    // time as the grid scrolls, and the loaded pages follow the store as
+    // syncs bring in changes
+    LocalStore* store = LocalStore::instance();
+    loadCatalogPage(QString());
+    connect(m_garments, &GarmentListModel::fetchMoreRequested,
+            this, &QMLManager::loadCatalogPage);
+    connect(store, &LocalStore::changed, this, [this]() {
+        for (const QString& cursor : m_garments->loadedCursors()) {
+            loadCatalogPage(cursor);
+        }
+    });
+    // A sync that changed nothing still ends the page's loading state
+    connect(store, &LocalStore::syncingChanged, this, [this](bool syncing) {
+        if (!syncing) emit garmentsChanged();
+    });
+
+    // Catalog pages fetched directly go through the store like sync pages
+    connect(m_networkManager.get(), &NetworkManager::garmentsPageReceived,
+            store, [store](const QJsonArray& garments) { store->putGarments(garments); });
+
     // Connect NetworkManager signals to QMLManager slots - Fixed connections
-    connect(m_networkManager.get(), &NetworkManager::garmentsReceived,
-            this, &QMLManager::handleGarmentsReceived);
     connect(m_networkManager.get(), &NetworkManager::connectionStatusChanged,
             this, &QMLManager::networkStatusChanged);
     
@@ -28,6 +64,56 @@ QMLManager::QMLManager(QObject* parent)
                 qWarning() << "Network error:" << error;
                 // You can emit a signal to QML if needed
             });
+    // Encoded frames go straight to the uploader; encoding runs off the GUI thread
+    connect(m_frameEncoder.get(), &FrameEncoder::frameEncoded,
+            m_networkManager.get(), &NetworkManager::uploadScan);
+    connect(m_frameEncoder.get(), &FrameEncoder::frameEncoded,
+            this, [](const QByteArray&, const QString&, const QString& garmentId) {
+                ScanPipelineTracer::instance()->mark(garmentId, ScanPipelineTracer::Encoded);
+            });
+    connect(m_frameEncoder.get(), &FrameEncoder::encodeFailed,
+            this, [this](const QString& garmentId, const QString& error) {
+                qWarning() << "Frame encoding failed for garment" << garmentId << ":" << error;
+                ScanPipelineTracer::instance()->fail(garmentId, "encode: " + error);
+                emit scanProcessingFailed(error);
+            });
+    connect(m_frameEncoder.get(), &FrameEncoder::queueDepthChanged,
+            this, &QMLManager::encodeStatsChanged);
+    connect(m_frameEncoder.get(), &FrameEncoder::encodeStatsChanged,
+            this, &QMLManager::encodeStatsChanged);
+    // Scans are sized so one uploads in a few seconds on the measured link
+    connect(m_networkManager.get(), &NetworkManager::uplinkThroughputChanged,
+            this, [this](double bytesPerSecond) {
+                m_frameEncoder->setUplinkThroughput(bytesPerSecond);
+            });
+
+    // Burst capture: the scanner scores preview frames off the GUI thread
+    // and only the best one goes on to the encoder and uploader
+    connect(m_clothScanner.get(), &ClothScanner::videoSinkChanged,
+            this, &QMLManager::scanVideoSinkChanged);
+    connect(m_clothScanner.get(), &ClothScanner::progressUpdated,
+            this, &QMLManager::burstProgressChanged);
+    connect(m_clothScanner.get(), &ClothScanner::burstCompleted,
+            this, [this](const QList<QImage>& frames, double) {
+                emit burstActiveChanged();
+                emit burstCaptured(frames.first());
+            });
+    connect(m_clothScanner.get(), &ClothScanner::burstFailed,
+            this, [this](const QString& error) {
+                qWarning() << "Burst capture failed:" << error;
+                emit burstActiveChanged();
+                emit burstFailed(error);
+            });
+
+    // Per-frame capture-to-keypoints latency, reported from the tracker thread
+    connect(m_framePipeline.get(), &FramePipeline::frameProcessed,
+            this, [this](qint64 latencyUs, int) {
+                m_trackingLatencyMs = latencyUs / 1000.0;
+                emit trackingStatsChanged();
+            });
+    connect(m_framePipeline.get(), &FramePipeline::videoSinkChanged,
+            this, &QMLManager::trackingVideoSinkChanged);
+
     connect(m_networkManager.get(), &NetworkManager::scanUploaded,
             this, [this](const QString& garmentId, const QString& imageUrl) {
         qDebug() << "Scan uploaded. Image ID:" << garmentId;
@@ -35,15 +121,21 @@ QMLManager::QMLManager(QObject* parent)
     });
 
     connect(m_networkManager.get(), &NetworkManager::processedModelReady,
-        this, [this](const QString& modelUrl, const QString& previewUrl, const QString& modelKey, const QString& previewKey) {
+        this, [this](const QString& garmentId, const QString& modelUrl, const QString& previewUrl, const QString& modelKey, const QString& previewKey) {
+            qDebug() << "Processed model ready for garment:" << garmentId;
             emit processedModelUrlReady(modelUrl, previewUrl, modelKey, previewKey);
     });
 
+    connect(m_networkManager.get(), &NetworkManager::processedModelFailed,
+        this, [this](const QString& garmentId, const QString& error) {
+            qWarning() << "Processing failed for garment" << garmentId << ":" << error;
+            emit scanProcessingFailed(error);
+    });
+
     connect(m_networkManager.get(), &NetworkManager::garmentUploadSucceeded,
             this, [this](const QString& garmentId) {
                 qDebug() << "Upload succeeded for garment:" << garmentId;
-                // Refresh garments after successful upload
-                m_networkManager->fetchGarments(true);
+                // NetworkManager syncs the new garment into the local store
             });
     
     connect(m_networkManager.get(), &NetworkManager::garmentUploadFailed,
@@ -75,18 +167,102 @@ void QMLManager::handleUploadProgress(int percent) {
 void QMLManager::handleCapturedFrame(const QImage& frame, const QString& garmentId) {
     if(frame.isNull()) return;
 
-    QByteArray imageData;
-    QBuffer buffer(&imageData);
-    buffer.open(QIODevice::WriteOnly);
-    frame.save(&buffer, "JPEG", 85);
-    
-    if(m_networkManager) {
-        if(m_currentCategory.isEmpty()) {
-            qWarning() << "Category not selected";
-            emit scanProcessingFailed("Please select a category");
-        }
-        m_networkManager->uploadScan(imageData, m_currentCategory, garmentId);
+    if(m_currentCategory.isEmpty()) {
+        qWarning() << "Category not selected";
+        emit scanProcessingFailed("Please select a category");
+        return;
+    }
+
+    // Cropping, scaling and JPEG encoding happen on the encoder's worker
+    // pool; the result is handed to NetworkManager::uploadScan via
+    // FrameEncoder::frameEncoded.
+    ScanPipelineTracer::instance()->mark(garmentId, ScanPipelineTracer::EncodeQueued);
+    m_frameEncoder->encode(frame, garmentId, m_currentCategory);
+}
+
+int QMLManager::encodeQueueDepth() const {
+    return m_frameEncoder ? m_frameEncoder->queueDepth() : 0;
+}
+
+qint64 QMLManager::lastEncodeMs() const {
+    return m_frameEncoder ? m_frameEncoder->lastEncodeMs() : 0;
+}
+
+int QMLManager::scanTargetLongEdge() const {
+    return m_frameEncoder->targetLongEdge();
+}
+
+// 0 uploads scans at the camera resolution
+void QMLManager::setScanTargetLongEdge(int pixels) {
+    if (m_frameEncoder->targetLongEdge() == qMax(0, pixels)) return;
+    m_frameEncoder->setTargetLongEdge(pixels);
+    emit scanPreprocessingChanged();
+}
+
+bool QMLManager::cropScansToGarment() const {
+    return m_frameEncoder->cropToGarment();
+}
+
+void QMLManager::setCropScansToGarment(bool crop) {
+    if (m_frameEncoder->cropToGarment() == crop) return;
+    m_frameEncoder->setCropToGarment(crop);
+    emit scanPreprocessingChanged();
+}
+
+QVideoSink* QMLManager::scanVideoSink() const {
+    return m_clothScanner->videoSink();
+}
+
+void QMLManager::setScanVideoSink(QVideoSink* sink) {
+    m_clothScanner->setVideoSink(sink);
+}
+
+bool QMLManager::burstActive() const {
+    return m_clothScanner->isScanningActive();
+}
+
+QVideoSink* QMLManager::trackingVideoSink() const {
+    return m_framePipeline->videoSink();
+}
+
+// Camera frames reach BodyTracker straight from the sink, off the GUI thread
+void QMLManager::setTrackingVideoSink(QVideoSink* sink) {
+    m_framePipeline->setVideoSink(sink);
+}
+
+int QMLManager::droppedTrackingFrames() const {
+    return int(m_framePipeline->droppedFrames());
+}
+
+double QMLManager::trackingRate() const {
+    return m_framePipeline->maxTrackingRate();
+}
+
+// The pose filter extrapolates between tracked frames, so the tracker can
+// run well below the display rate (e.g. 15 Hz) to save power.
+void QMLManager::setTrackingRate(double hz) {
+    if (qFuzzyCompare(trackingRate() + 1.0, qMax(0.0, hz) + 1.0)) return;
+    m_framePipeline->setMaxTrackingRate(hz);
+    emit trackingRateChanged();
+}
+
+// Recordings replay headless through tools/posereplay; they go to
+// <app data>/recordings unless a path is given.
+QString QMLManager::startPoseRecording(const QString& path) {
+    QString target = path;
+    if (target.isEmpty()) {
+        target = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+                 + "/recordings/pose-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".arrec";
     }
+    if (!m_poseRecorder->start(target)) return QString();
+    emit poseRecordingChanged();
+    return target;
+}
+
+void QMLManager::stopPoseRecording() {
+    if (!m_poseRecorder->isRecording()) return;
+    m_poseRecorder->stop();
+    emit poseRecordingChanged();
 }
 
 // Add category setter
@@ -94,27 +270,14 @@ void QMLManager::setScanCategory(const QString& category) {
     m_currentCategory = category;
 }
 
-// Handle received garments from network
-void QMLManager::handleGarmentsReceived(const QJsonArray& garments) {
-    m_garments.clear();
-    
-    for (const QJsonValue& garmentValue : garments) {
-        QJsonObject garmentObj = garmentValue.toObject();
-        QVariantMap entry;
-        
-        // Corrected key: "id" instead of "garmentId"
-        entry["id"] = garmentObj["garmentId"].toString(); // Match QML's model.modelData.id
-        entry["name"] = garmentObj["name"].toString();
-        entry["previewUrl"] = garmentObj["previewUrl"].toString();
-        entry["modelUrl"] = garmentObj["modelUrl"].toString();
-        entry["createdBy"] = garmentObj["createdBy"].toString();
-        
-        // Add "isAvailable" with a default value if missing in the data
-        entry["isAvailable"] = true; // Ensure QML's model.modelData.isAvailable exists
-        
-        m_garments.append(entry);
-    }
-    
+// The model diffs against that page's current rows, so unchanged garments
+// keep their delegates and loaded previews.
+void QMLManager::loadCatalogPage(const QString& cursor) {
+    const LocalStore* store = LocalStore::instance();
+    const int first = cursor.toInt();
+    const QJsonArray garments = store->garments(first, kCatalogPageSize);
+    const int next = first + kCatalogPageSize;
+    m_garments->applyPage(cursor, garments, next < store->count(LocalStore::Garments) ? QString::number(next) : QString());
     emit garmentsChanged();
 }
 
@@ -141,25 +304,26 @@ bool QMLManager::hasCameraPermission() const {
 
 // Start cloth scanning process
 void QMLManager::startScanning() {
-    // Implementation example
-    if (!m_clothScanner) {
-        m_clothScanner = std::make_unique<ClothScanner>();
-    }
-    
-    // Check camera permission before starting
+    startBurstCapture();
+}
+
+void QMLManager::startBurstCapture(int frames) {
     if (!hasCameraPermission()) {
         requestCameraPermission();
         return;
     }
-    
-    try {
-        m_clothScanner->captureFromCamera(0);  // Assuming this method exists
-        emit scanProgressChanged(10);  // Example progress update
-    } catch (const std::exception& e) {
-        qWarning() << "Failed to start scanning:" << e.what();
+
+    if (m_clothScanner->startBurst(frames)) {
+        emit burstActiveChanged();
     }
 }
 
+void QMLManager::cancelBurstCapture() {
+    if (!m_clothScanner->isScanningActive()) return;
+    m_clothScanner->cancelBurst();
+    emit burstActiveChanged();
+}
+
 // Update scan progress
 void QMLManager::updateScanProgress(int percent) {
     if (m_scanProgress != percent) {
@@ -189,24 +353,8 @@ int QMLManager::scanProgress() const {
     return m_scanProgress;
 }
 
-// Handle camera frame processing
-void QMLManager::handleFrame(const QImage& frame) {
-    // Process the camera frame
-    if (frame.isNull()) {
-        return;
-    }
-    
-    try {
-        // cv::Mat cvFrame = ImageConverter::qImageToCvMat(frame);
-        // Process frame with computer vision
-        // This is where you'd implement your image processing logic
-    } catch (const std::exception& e) {
-        qWarning() << "Frame processing error:" << e.what();
-    }
-}
-
-// Get garments list
-QVariantList QMLManager::garments() const {
+// Get garments model
+GarmentListModel* QMLManager::garments() const {
     return m_garments;
 }
 
@@ -245,9 +393,13 @@ QVariantList QMLManager::garments() const {
 // }
 
 // Fetch garments from network - Fixed to properly delegate to NetworkManager
+// The first catalog page also comes straight from GET /garments, usually a
+// 304 against the HTTP cache. It lands in the store, so an empty store shows
+// it without waiting for a whole sync snapshot.
 void QMLManager::fetchGarments(bool forceRefresh) {
     if (m_networkManager) {
         m_networkManager->fetchGarments(forceRefresh);
+        m_networkManager->syncUserData(forceRefresh);
     } else {
         qWarning() << "NetworkManager not initialized";
        
@@ -362,40 +514,135 @@ void QMLManager::saveGarment(const QString& garmentId,
 // }
 
 
+// Called at vsync on the GUI thread: folds in the newest tracked pose, if
+// one arrived since the last frame, and skins the garment to the filtered
+// pose predicted for when this frame reaches the display. No locks or
+// allocations, except on the frame that takes over the cloth worker's results.
+void QMLManager::syncTrackedPose() {
+    const qint64 now = FramePipeline::timestampNs();
+    double frameMs = m_lastSyncNs > 0 ? (now - m_lastSyncNs) / 1e6 : 0.0;
+    m_lastSyncNs = now;
+    if (frameMs > 250.0) {
+        // Paused or stalled, not a measure of rendering cost
+        frameMs = 0.0;
+    }
+
+    if (m_bodyTracker->acquireLatestPose()) {
+        const PoseSnapshot& pose = m_bodyTracker->currentPose();
+        m_poseFilter.addObservation(pose.keypoints, pose.captureNs);
+    }
+
+    PoseKeypoints predicted;
+    if (!m_poseFilter.predict(now + m_renderLeadNs, predicted)) return;
+
+    // Levels of detail built since the load
+    if (m_clothFitter->pollBackgroundWork()) {
+        updateGarmentLods();
+    }
+    selectGarmentLod(frameMs);
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool skinned = m_clothFitter->updateTransformation(predicted);
+    // Only a measure of the selector's level once the fitter has switched
+    const bool selected = m_clothFitter->lod() == m_lodSelector.currentLevel();
+    m_lastSkinningMs = skinned && selected ? timer.nsecsElapsed() / 1e6 : 0.0;
+    if (skinned && m_garmentRenderer) {
+        m_garmentRenderer->skinnedMeshChanged();
+    }
+}
+
+// Level of detail from the garment's on-screen size and the time budget
+void QMLManager::selectGarmentLod(double frameMs) {
+    if (m_clothFitter->lodCount() < 2) return;
+
+    float areaPx = 0.0f;
+    float boundsMin[2], boundsMax[2];
+    if (m_garmentRenderer && m_clothFitter->skinnedBounds(boundsMin, boundsMax)) {
+        const QRectF rect = m_garmentRenderer->contentRect();
+        const qreal dpr = m_garmentRenderer->window() ? m_garmentRenderer->window()->effectiveDevicePixelRatio() : 1.0;
+        areaPx = float((boundsMax[0] - boundsMin[0]) * rect.width() * dpr *
+                       (boundsMax[1] - boundsMin[1]) * rect.height() * dpr);
+    }
+
+    const size_t level = m_lodSelector.select(areaPx, m_lastSkinningMs, frameMs);
+    if (m_clothFitter->setLod(level)) {
+        qDebug() << "Garment LOD" << level << "(" << m_clothFitter->lodTriangleCount(level) << "triangles)";
+        if (m_garmentRenderer) {
+            m_garmentRenderer->setSkinnedMesh(m_clothFitter->sharedClothMesh(), m_clothFitter->sharedSkinnedMesh());
+            if (m_clothFitter->isBound()) {
+                m_garmentRenderer->skinnedMeshChanged();
+            }
+        }
+        // The measured cost belonged to the previous level
+        m_lastSkinningMs = 0.0;
+    }
+}
+
+void QMLManager::updateGarmentLods() {
+    std::vector<size_t> vertices, triangles;
+    for (size_t level = 0; level < m_clothFitter->lodCount(); ++level) {
+        vertices.push_back(m_clothFitter->lodVertexCount(level));
+        triangles.push_back(m_clothFitter->lodTriangleCount(level));
+    }
+    m_lodSelector.setLevels(std::move(vertices), std::move(triangles));
+}
+
+// The renderer shares the fitter's buffers rather than receiving copies
+void QMLManager::setGarmentRenderer(GarmentRenderer* renderer) {
+    if (m_garmentRenderer == renderer) return;
+    if (m_garmentRenderer) {
+        m_garmentRenderer->clear();
+    }
+    m_garmentRenderer = renderer;
+    if (m_garmentRenderer && m_clothFitter->clothMesh()) {
+        m_garmentRenderer->setSkinnedMesh(m_clothFitter->sharedClothMesh(), m_clothFitter->sharedSkinnedMesh());
+    }
+    emit garmentRendererChanged();
+}
+
 // Try on garment with AR - Fixed connection handling
-void QMLManager::tryOnGarment(const QString& garmentId) {
+void QMLManager::tryOnGarment(const QString& garmentId, const QUrl& modelFile) {
     if (!m_bodyTracker || !m_clothFitter) {
         qWarning() << "Body tracker or cloth fitter not initialized";
+        emit arSessionFailed("AR try-on is not available");
+        return;
+    }
+    if (!modelFile.isLocalFile()) {
+        qWarning() << "Try-on of" << garmentId << "needs a local model file, got" << modelFile;
+        emit arSessionFailed("The 3D model has not been downloaded");
         return;
     }
 
     try {
+        // Load cloth model; without one there is nothing to try on
+        std::string error;
+        if (!m_clothFitter->loadClothModel(modelFile.toLocalFile().toStdString(), &error)) {
+            emit arSessionFailed("Cannot load the 3D model: " + QString::fromStdString(error));
+            return;
+        }
+        updateGarmentLods();
+        if (m_garmentRenderer) {
+            m_garmentRenderer->setSkinnedMesh(m_clothFitter->sharedClothMesh(), m_clothFitter->sharedSkinnedMesh());
+        }
+
         // Initialize body tracking
         m_bodyTracker->initCamera();
-        
-        // Load cloth model
-        m_clothFitter->loadClothModel(garmentId.toStdString());
+        m_poseFilter.reset();
+        m_framePipeline->start();
 
-        // Connect body tracking to cloth fitting - Fixed lambda connection
-        // Disconnect any existing connections first
-        disconnect(m_bodyTracker.get(), &BodyTracker::keypointsUpdated, nullptr, nullptr);
-        
-        // Create new connection with proper error handling
-        connect(m_bodyTracker.get(), &BodyTracker::keypointsUpdated, this, [this]() {
-            try {
-                if (m_clothFitter && m_bodyTracker) {
-                    m_clothFitter->updateTransformation(
-                        m_bodyTracker->getKeypoints()
-                    );
-                }
-            } catch (const std::exception& e) {
-                qWarning() << "Error updating cloth transformation:" << e.what();
-            }
-        });
+        // Predict one display frame ahead of the vsync we are called at
+        const QScreen* screen = QGuiApplication::primaryScreen();
+        const qreal refreshRate = screen ? screen->refreshRate() : 60.0;
+        m_renderLeadNs = qint64(1e9 / (refreshRate > 0 ? refreshRate : 60.0));
+        m_lastSyncNs = 0;
+
+        // The pose is pulled once per rendered frame by syncTrackedPose()
 
         emit arSessionReady();
         
     } catch (const std::exception& e) {
         qWarning() << "Failed to initialize AR try-on:" << e.what();
+        emit arSessionFailed(QString("Failed to start AR try-on: %1").arg(e.what()));
     }
 }
\ No newline at end of file
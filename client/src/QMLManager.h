@@ -11,6 +11,7 @@
 #include <QDateTime>
 #include <QVariantList>
 #include <QVariantMap>
+#include <QUrl>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <memory>
@@ -18,14 +19,34 @@
 #include "ClothFitter.h"
 #include "ClothScanner.h"
 #include "NetworkManager.h"
+#include "FrameEncoder.h"
+#include "FramePipeline.h"
+#include "PoseFilter.h"
+#include "PoseRecording.h"
+#include "LodSelector.h"
+#include "GarmentListModel.h"
+#include "GarmentRenderer.h"
+#include <QPointer>
 
 class QMLManager : public QObject {
     Q_OBJECT
     QML_ELEMENT
 
     Q_PROPERTY(int scanProgress READ scanProgress NOTIFY scanProgressChanged)
-    Q_PROPERTY(QVariantList garments READ garments NOTIFY garmentsChanged)
+    Q_PROPERTY(GarmentListModel* garments READ garments CONSTANT)
     Q_PROPERTY(bool isNetworkConnected READ isNetworkConnected NOTIFY networkStatusChanged)
+    Q_PROPERTY(int encodeQueueDepth READ encodeQueueDepth NOTIFY encodeStatsChanged)
+    Q_PROPERTY(qint64 lastEncodeMs READ lastEncodeMs NOTIFY encodeStatsChanged)
+    Q_PROPERTY(int scanTargetLongEdge READ scanTargetLongEdge WRITE setScanTargetLongEdge NOTIFY scanPreprocessingChanged)
+    Q_PROPERTY(bool cropScansToGarment READ cropScansToGarment WRITE setCropScansToGarment NOTIFY scanPreprocessingChanged)
+    Q_PROPERTY(QVideoSink* scanVideoSink READ scanVideoSink WRITE setScanVideoSink NOTIFY scanVideoSinkChanged)
+    Q_PROPERTY(bool burstActive READ burstActive NOTIFY burstActiveChanged)
+    Q_PROPERTY(QVideoSink* trackingVideoSink READ trackingVideoSink WRITE setTrackingVideoSink NOTIFY trackingVideoSinkChanged)
+    Q_PROPERTY(double trackingLatencyMs READ trackingLatencyMs NOTIFY trackingStatsChanged)
+    Q_PROPERTY(int droppedTrackingFrames READ droppedTrackingFrames NOTIFY trackingStatsChanged)
+    Q_PROPERTY(double trackingRate READ trackingRate WRITE setTrackingRate NOTIFY trackingRateChanged)
+    Q_PROPERTY(bool poseRecording READ poseRecording NOTIFY poseRecordingChanged)
+    Q_PROPERTY(GarmentRenderer* garmentRenderer READ garmentRenderer WRITE setGarmentRenderer NOTIFY garmentRendererChanged)
 
 public:
     explicit QMLManager(QObject* parent = nullptr);
@@ -35,10 +56,24 @@ public:
     // Q_INVOKABLE void uploadNewGarment();
     Q_INVOKABLE void initializeApp();
     Q_INVOKABLE void startScanning();
+    // Scores the next `frames` preview frames and emits burstCaptured with
+    // the best one
+    Q_INVOKABLE void startBurstCapture(int frames = 12);
+    Q_INVOKABLE void cancelBurstCapture();
     Q_INVOKABLE void saveScan();
-    Q_INVOKABLE void tryOnGarment(const QString& garmentId);
+    // Starts AR try-on with the garment mesh at `modelFile`, a local file
+    // (see ModelAssetCache::localUrl())
+    Q_INVOKABLE void tryOnGarment(const QString& garmentId, const QUrl& modelFile);
+    Q_INVOKABLE void syncTrackedPose();
+    // Records camera frames and tracked poses for offline replay (see
+    // PoseReplay); returns the file being written, empty on failure.
+    Q_INVOKABLE QString startPoseRecording(const QString& path = QString());
+    Q_INVOKABLE void stopPoseRecording();
     Q_INVOKABLE void requestCameraPermission();
     Q_INVOKABLE bool hasCameraPermission() const;
+    // Refetches the first catalog page and syncs the local store; the
+    // catalog follows the store (forceRefresh skips HTTP revalidation and
+    // fetches a full snapshot)
     Q_INVOKABLE void fetchGarments(bool forceRefresh = false);
     Q_INVOKABLE void handleCapturedFrame(const QImage& frame, const QString& garmentId);
     // Q_INVOKABLE void fetchGarments();
@@ -53,8 +88,26 @@ public:
                              const QString& category);
     // Property getters
     int scanProgress() const;
-    QVariantList garments() const;
+    GarmentListModel* garments() const;
     bool isNetworkConnected() const { return m_networkConnected; }
+    int encodeQueueDepth() const;
+    qint64 lastEncodeMs() const;
+    int scanTargetLongEdge() const;
+    void setScanTargetLongEdge(int pixels);
+    bool cropScansToGarment() const;
+    void setCropScansToGarment(bool crop);
+    QVideoSink* scanVideoSink() const;
+    void setScanVideoSink(QVideoSink* sink);
+    bool burstActive() const;
+    QVideoSink* trackingVideoSink() const;
+    void setTrackingVideoSink(QVideoSink* sink);
+    double trackingLatencyMs() const { return m_trackingLatencyMs; }
+    int droppedTrackingFrames() const;
+    double trackingRate() const;
+    void setTrackingRate(double hz);
+    bool poseRecording() const { return m_poseRecorder->isRecording(); }
+    GarmentRenderer* garmentRenderer() const { return m_garmentRenderer; }
+    void setGarmentRenderer(GarmentRenderer* renderer);
     
 
 signals:
@@ -67,6 +120,13 @@ signals:
     void scanCompleted();
     void scanFailed(const QString& error);
     void scanProcessingFailed(const QString& error);  // ADDED MISSING SIGNAL
+
+    // Burst capture
+    void scanVideoSinkChanged();
+    void burstActiveChanged();
+    void burstProgressChanged(int progress);
+    void burstCaptured(const QImage& frame);
+    void burstFailed(const QString& error);
     
     // Garment signals
     void garmentsChanged();
@@ -86,39 +146,60 @@ signals:
     void uploadCompleted(const QString& garmentId);
     void uploadFailed(const QString& error);
 
+    // Encoder statistics
+    void encodeStatsChanged();
+    void scanPreprocessingChanged();
+
+    // Body tracking
+    void trackingVideoSinkChanged();
+    void trackingStatsChanged();
+    void trackingRateChanged();
+    void poseRecordingChanged();
+    void garmentRendererChanged();
+
 public slots:
     // Permission handling
     void handlePermissionResult(const QPermission &permission);
     
-    // Frame processing
-    void handleFrame(const QImage& frame);
-    
     // Progress updates
     void updateScanProgress(int progress);
 
 private slots:
     // Network response handlers
-    void handleGarmentsReceived(const QJsonArray& garments);
+    // Applies one page of the local store's catalog; cursors are row offsets
+    void loadCatalogPage(const QString& cursor);
     void handleNetworkStatusChanged(bool connected);
     void handleUploadProgress(int progress);
 
 private:
     // Core components
+    // Outlives the tracker and pipeline that feed it
+    std::unique_ptr<PoseRecorder> m_poseRecorder;
     std::unique_ptr<ClothScanner> m_clothScanner;
     std::unique_ptr<ClothFitter> m_clothFitter;
     std::unique_ptr<BodyTracker> m_bodyTracker;
+    std::unique_ptr<FramePipeline> m_framePipeline;
+    PoseFilter m_poseFilter;
+    LodSelector m_lodSelector;
+    QPointer<GarmentRenderer> m_garmentRenderer;
     std::unique_ptr<NetworkManager> m_networkManager;
+    std::unique_ptr<FrameEncoder> m_frameEncoder;
     
     // Data members
-    QVariantList m_garments;
+    GarmentListModel* m_garments;
     int m_scanProgress = 0;
     bool m_networkConnected = false;
+    double m_trackingLatencyMs = 0.0;
+    qint64 m_renderLeadNs = 0;
+    qint64 m_lastSyncNs = 0;
+    double m_lastSkinningMs = 0.0;
     QString m_currentCategory;
     
     // Helper methods
     void setupConnections();
+    void updateGarmentLods();
+    void selectGarmentLod(double frameMs);
     void resetScanState();
-    QVariantMap createGarmentEntry(const QJsonObject& garmentObj);
 };
 
 #endif // QMLMANAGER_H
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef RETRYBACKOFF_H
+#define RETRYBACKOFF_H
+
+#include <QRandomGenerator>
+#include <QtGlobal>
+#include <cmath>
+
+// Exponential backoff with multiplicative jitter. Each call to nextDelayMs()
+// returns the delay for the upcoming attempt and advances the schedule:
+//   delay = min(initial * multiplier^attempt, max) * (1 +/- jitter)
+// Jitter spreads retries from many clients so they do not hit the server
+// in lockstep after an outage.
+class RetryBackoff {
+public:
+    explicit RetryBackoff(int initialMs = 1000, int maxMs = 30000,
+                          double multiplier = 2.0, double jitter = 0.2)
+        : m_initialMs(qMax(1, initialMs)),
+          m_maxMs(qMax(m_initialMs, maxMs)),
+          m_multiplier(qMax(1.0, multiplier)),
+          m_jitter(qBound(0.0, jitter, 1.0))
+    {}
+
+    int nextDelayMs() {
+        const double base = qMin(static_cast<double>(m_maxMs),
+                                 m_initialMs * std::pow(m_multiplier, m_attempts));
+        ++m_attempts;
+
+        const double spread = (QRandomGenerator::global()->generateDouble() * 2.0 - 1.0) * m_jitter;
+        return qMax(1, static_cast<int>(base * (1.0 + spread)));
+    }
+
+    void reset() { m_attempts = 0; }
+    int attempts() const { return m_attempts; }
+
+private:
+    int m_initialMs;
+    int m_maxMs;
+    double m_multiplier;
+    double m_jitter;
+    int m_attempts = 0;
+};
+
+#endif // RETRYBACKOFF_H
@@ -0,0 +1,199 @@
+#include "ScanPipelineTracer.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaEnum>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr size_t kMaxScans = 50;
+constexpr size_t kMaxSamples = 200;
+
+double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    const size_t rank = size_t(std::ceil(q * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+}
+
+ScanPipelineTracer* ScanPipelineTracer::instance() {
+    static QPointer<ScanPipelineTracer> tracer;
+    if (!tracer) {
+        Q_ASSERT(QCoreApplication::instance());
+        Q_ASSERT(QThread::currentThread() == QCoreApplication::instance()->thread());
+        tracer = new ScanPipelineTracer(QCoreApplication::instance());
+    }
+    return tracer;
+}
+
+ScanPipelineTracer::ScanPipelineTracer(QObject* parent)
+    : QObject(parent),
+      m_samples(StageCount + 1)
+{
+    m_clock.start();
+}
+
+QString ScanPipelineTracer::stageName(Stage stage) {
+    if (stage == StageCount) return QStringLiteral("Total");
+    return QString::fromLatin1(QMetaEnum::fromType<Stage>().valueToKey(stage));
+}
+
+ScanPipelineTracer::Scan* ScanPipelineTracer::findScan(const QString& garmentId) {
+    auto it = std::find_if(m_scans.rbegin(), m_scans.rend(),
+                           [&garmentId](const Scan& scan) { return scan.garmentId == garmentId; });
+    return it == m_scans.rend() ? nullptr : &*it;
+}
+
+void ScanPipelineTracer::addSample(int series, double ms) {
+    std::deque<double>& samples = m_samples[series];
+    samples.push_back(ms);
+    if (samples.size() > kMaxSamples) samples.pop_front();
+}
+
+void ScanPipelineTracer::mark(const QString& garmentId, Stage stage) {
+    if (garmentId.isEmpty() || stage < Capture || stage >= StageCount) return;
+
+    const qint64 now = m_clock.nsecsElapsed();
+    double stageMs = 0.0;
+    double sinceCaptureMs = 0.0;
+    {
+        QMutexLocker locker(&m_mutex);
+        Scan* scan = findScan(garmentId);
+        if (stage == Capture) {
+            m_scans.erase(std::remove_if(m_scans.begin(), m_scans.end(),
+                                         [&garmentId](const Scan& s) { return s.garmentId == garmentId; }),
+                          m_scans.end());
+            m_scans.push_back({garmentId, {{Capture, now}}, QString()});
+            if (m_scans.size() > kMaxScans) m_scans.pop_front();
+            locker.unlock();
+            qDebug() << "Scan" << garmentId << ": capture";
+            emit stageMarked(garmentId, stage, 0.0);
+            return;
+        }
+
+        // Garments opened from the catalog were not scanned in this session
+        if (!scan || !scan->failure.isEmpty()) return;
+        const bool seen = std::any_of(scan->events.begin(), scan->events.end(),
+                                      [stage](const Event& e) { return e.stage == stage; });
+        if (seen) return;
+
+        stageMs = (now - scan->events.back().ns) / 1e6;
+        sinceCaptureMs = (now - scan->events.front().ns) / 1e6;
+        scan->events.push_back({stage, now});
+        addSample(stage, stageMs);
+        if (stage == ModelReady && scan->events.front().stage == Capture) {
+            addSample(StageCount, sinceCaptureMs);
+        }
+    }
+
+    qDebug() << "Scan" << garmentId << ":" << stageName(stage) << "+" << qRound(stageMs) << "ms ("
+             << qRound(sinceCaptureMs) << "ms since capture )";
+    emit stageMarked(garmentId, stage, sinceCaptureMs);
+    emit statsChanged();
+}
+
+void ScanPipelineTracer::fail(const QString& garmentId, const QString& reason) {
+    const qint64 now = m_clock.nsecsElapsed();
+    Stage lastStage = Capture;
+    double sinceCaptureMs = 0.0;
+    {
+        QMutexLocker locker(&m_mutex);
+        Scan* scan = findScan(garmentId);
+        if (!scan || !scan->failure.isEmpty()) return;
+        lastStage = scan->events.back().stage;
+        sinceCaptureMs = (now - scan->events.front().ns) / 1e6;
+        scan->events.push_back({Failed, now});
+        scan->failure = reason.isEmpty() ? QStringLiteral("failed") : reason;
+    }
+    qWarning() << "Scan" << garmentId << ": failed after" << stageName(lastStage) << "-" << reason;
+    emit stageMarked(garmentId, Failed, sinceCaptureMs);
+}
+
+QVariantList ScanPipelineTracer::stats() const {
+    QMutexLocker locker(&m_mutex);
+
+    QVariantList result;
+    for (int series = 0; series <= StageCount; ++series) {
+        const std::deque<double>& samples = m_samples[series];
+        if (samples.empty()) continue;
+
+        std::vector<double> sorted(samples.begin(), samples.end());
+        std::sort(sorted.begin(), sorted.end());
+
+        QVariantMap entry;
+        entry["stage"] = stageName(Stage(series));
+        entry["count"] = int(sorted.size());
+        entry["p50Ms"] = percentile(sorted, 0.5);
+        entry["p90Ms"] = percentile(sorted, 0.9);
+        entry["p99Ms"] = percentile(sorted, 0.99);
+        entry["maxMs"] = sorted.back();
+        result.append(entry);
+    }
+    return result;
+}
+
+QString ScanPipelineTracer::dump(const QString& path) const {
+    QString target = path;
+    if (target.isEmpty()) {
+        target = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+                 + "/traces/scan-pipeline-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".json";
+    }
+
+    QJsonArray scans;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const Scan& scan : m_scans) {
+            QJsonArray stages;
+            qint64 previous = scan.events.front().ns;
+            for (const Event& event : scan.events) {
+                stages.append(QJsonObject{
+                    {"stage", stageName(event.stage)},
+                    {"atMs", (event.ns - scan.events.front().ns) / 1e6},
+                    {"stageMs", (event.ns - previous) / 1e6},
+                });
+                previous = event.ns;
+            }
+            QJsonObject entry{{"garmentId", scan.garmentId}, {"stages", stages}};
+            if (!scan.failure.isEmpty()) entry["failure"] = scan.failure;
+            scans.append(entry);
+        }
+    }
+
+    QJsonObject root;
+    root["generated"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+    root["stats"] = QJsonArray::fromVariantList(stats());
+    root["scans"] = scans;
+
+    QDir().mkpath(QFileInfo(target).absolutePath());
+    QSaveFile file(target);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write scan pipeline dump:" << file.errorString();
+        return QString();
+    }
+    file.write(QJsonDocument(root).toJson());
+    if (!file.commit()) {
+        qWarning() << "Could not write scan pipeline dump:" << file.errorString();
+        return QString();
+    }
+    qDebug() << "Scan pipeline timings written to" << target;
+    return target;
+}
+
+void ScanPipelineTracer::clear() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_scans.clear();
+        for (std::deque<double>& samples : m_samples) samples.clear();
+    }
+    emit statsChanged();
+}
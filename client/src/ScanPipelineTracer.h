@@ -0,0 +1,103 @@
+#pragma once
+#ifndef SCANPIPELINETRACER_H
+#define SCANPIPELINETRACER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVariantList>
+#include <deque>
+#include <vector>
+
+// One timeline per scan, keyed by garmentId, from the capture button to the
+// 3D model on screen. The stages are marked where they happen, in C++
+// (QMLManager, NetworkManager) and QML (CameraPage, GarmentPreviewPage), on
+// a monotonic clock. Each stage's latency is the time since the stage
+// before it, so a regression shows up in the stage that got slower:
+//
+//   Capture            capture button pressed
+//   FrameCaptured      best burst frame picked
+//   EncodeQueued       category confirmed, frame handed to the encoder *
+//   Encoded            JPEG ready, upload starts
+//   Uploaded           server stored the scan
+//   ProcessingRequested
+//   ModelReady         reconstructed model available
+//   PreviewShown       preview image displayed
+//   PreviewOpened      garment page opened *
+//   ModelLoaded        SceneLoader ready
+//
+// (* includes time the user spends in a dialog or on the result page.)
+// Percentiles cover the last samples of each stage plus the end-to-end
+// Capture -> ModelReady time; they are exposed to QML through `stats` and
+// written with the timelines by dump(). Shared by every page, see main.cpp.
+class ScanPipelineTracer : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantList stats READ stats NOTIFY statsChanged)
+
+public:
+    enum Stage {
+        Capture,
+        FrameCaptured,
+        EncodeQueued,
+        Encoded,
+        Uploaded,
+        ProcessingRequested,
+        ModelReady,
+        PreviewShown,
+        PreviewOpened,
+        ModelLoaded,
+        Failed,
+        StageCount
+    };
+    Q_ENUM(Stage)
+
+    // Created on first use, owned by the application object.
+    static ScanPipelineTracer* instance();
+
+    explicit ScanPipelineTracer(QObject* parent = nullptr);
+
+    // Records `stage` for the scan; Capture starts a new timeline. Repeated
+    // stages (retries) keep their first time.
+    Q_INVOKABLE void mark(const QString& garmentId, Stage stage);
+    Q_INVOKABLE void fail(const QString& garmentId, const QString& reason);
+
+    // [{ stage, count, p50Ms, p90Ms, p99Ms, maxMs }], stages in pipeline order
+    // followed by "Total" (Capture -> ModelReady)
+    QVariantList stats() const;
+
+    // Writes stats and the recent timelines as JSON to `path`, or to
+    // <app data>/traces when empty; returns the file written.
+    Q_INVOKABLE QString dump(const QString& path = QString()) const;
+
+    Q_INVOKABLE void clear();
+
+    static QString stageName(Stage stage);
+
+signals:
+    void statsChanged();
+    void stageMarked(const QString& garmentId, ScanPipelineTracer::Stage stage, double sinceCaptureMs);
+
+private:
+    struct Event {
+        Stage stage;
+        qint64 ns;
+    };
+    struct Scan {
+        QString garmentId;
+        std::vector<Event> events;
+        QString failure;
+    };
+
+    Scan* findScan(const QString& garmentId);
+    void addSample(int series, double ms);
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    // Most recent last
+    std::deque<Scan> m_scans;
+    // Latency samples per stage, plus one series for the end-to-end time
+    std::vector<std::deque<double>> m_samples;
+};
+
+#endif // SCANPIPELINETRACER_H
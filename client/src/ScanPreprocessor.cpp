@@ -0,0 +1,192 @@
+#include "ScanPreprocessor.h"
+#include <QBuffer>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+// Region detection runs on a thumbnail this size (longest edge)
+constexpr int kAnalysisEdge = 160;
+// Pixels along the frame edge sampled as background
+constexpr int kBorderWidth = 3;
+// Border colour spread (median absolute deviation) above which the
+// background is too busy to separate the garment from it
+constexpr int kMaxBackgroundSpread = 28;
+// Least colour distance from the background that counts as garment
+constexpr int kMinForegroundDistance = 48;
+// Rows/columns need this share of garment pixels to extend the box, which
+// ignores specks and stray shadows
+constexpr double kMinLineCoverage = 0.02;
+// Crops that keep almost everything are not worth the extra copy
+constexpr double kMaxCropArea = 0.9;
+constexpr double kMinForegroundArea = 0.03;
+
+constexpr int kMaxSearchSteps = 6;
+// Cropping and downscaling already happened; if even minQuality misses the
+// budget, shrink by this factor at most kMaxDownscales times.
+constexpr double kDownscaleStep = 0.75;
+constexpr int kMaxDownscales = 2;
+constexpr int kMinShortEdge = 480;
+
+int median(std::vector<int>& values) {
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+int colorDistance(QRgb a, int r, int g, int b) {
+    return std::abs(qRed(a) - r) + std::abs(qGreen(a) - g) + std::abs(qBlue(a) - b);
+}
+
+QByteArray encodeJpeg(const QImage& image, int quality) {
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "JPEG", quality)) return QByteArray();
+    return data;
+}
+}
+
+QRect ScanPreprocessor::garmentRegion(const QImage& frame, double margin) {
+    const QRect full = frame.rect();
+    if (frame.isNull()) return full;
+
+    const QImage small = frame.scaled(kAnalysisEdge, kAnalysisEdge, Qt::KeepAspectRatio, Qt::FastTransformation)
+                             .convertToFormat(QImage::Format_RGB32);
+    const int w = small.width(), h = small.height();
+    if (w < 4 * kBorderWidth || h < 4 * kBorderWidth) return full;
+
+    auto pixel = [&small](int x, int y) {
+        return reinterpret_cast<const QRgb*>(small.constScanLine(y))[x];
+    };
+
+    // Background colour: per-channel median of the frame border
+    std::vector<QRgb> border;
+    border.reserve(size_t(2 * kBorderWidth * (w + h)));
+    for (int y = 0; y < h; ++y) {
+        const bool edgeRow = y < kBorderWidth || y >= h - kBorderWidth;
+        for (int x = 0; x < w; ++x) {
+            if (edgeRow || x < kBorderWidth || x >= w - kBorderWidth) border.push_back(pixel(x, y));
+        }
+    }
+    std::vector<int> channel(border.size());
+    std::transform(border.begin(), border.end(), channel.begin(), [](QRgb p) { return qRed(p); });
+    const int r = median(channel);
+    std::transform(border.begin(), border.end(), channel.begin(), [](QRgb p) { return qGreen(p); });
+    const int g = median(channel);
+    std::transform(border.begin(), border.end(), channel.begin(), [](QRgb p) { return qBlue(p); });
+    const int b = median(channel);
+
+    std::transform(border.begin(), border.end(), channel.begin(),
+                   [r, g, b](QRgb p) { return colorDistance(p, r, g, b); });
+    const int spread = median(channel);
+    if (spread > kMaxBackgroundSpread) return full;
+    const int threshold = std::max(kMinForegroundDistance, 4 * spread);
+
+    std::vector<int> rowCount(size_t(h), 0), columnCount(size_t(w), 0);
+    int foreground = 0;
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            if (colorDistance(pixel(x, y), r, g, b) > threshold) {
+                ++rowCount[size_t(y)];
+                ++columnCount[size_t(x)];
+                ++foreground;
+            }
+        }
+    }
+    if (foreground < kMinForegroundArea * w * h) return full;
+
+    auto span = [](const std::vector<int>& counts, int minCount, int* first, int* last) {
+        *first = -1;
+        for (int i = 0; i < int(counts.size()); ++i) {
+            if (counts[size_t(i)] < minCount) continue;
+            if (*first < 0) *first = i;
+            *last = i;
+        }
+        return *first >= 0;
+    };
+    int left = 0, right = 0, top = 0, bottom = 0;
+    if (!span(columnCount, std::max(1, int(kMinLineCoverage * h)), &left, &right)
+        || !span(rowCount, std::max(1, int(kMinLineCoverage * w)), &top, &bottom)) {
+        return full;
+    }
+
+    const double boxW = right - left + 1, boxH = bottom - top + 1;
+    if (boxW * boxH > kMaxCropArea * w * h) return full;
+
+    // Back to source pixels, with the margin added
+    const double sx = double(frame.width()) / w, sy = double(frame.height()) / h;
+    const double mx = boxW * margin, my = boxH * margin;
+    const QRect crop(QPoint(int(std::floor((left - mx) * sx)), int(std::floor((top - my) * sy))),
+                     QPoint(int(std::ceil((right + 1 + mx) * sx)) - 1, int(std::ceil((bottom + 1 + my) * sy)) - 1));
+    return crop.intersected(full);
+}
+
+QByteArray ScanPreprocessor::encodeToBudget(const QImage& image, qint64 byteBudget, int minQuality,
+                                            int maxQuality, int* quality, int* encodes) {
+    minQuality = qBound(1, minQuality, 100);
+    maxQuality = qBound(minQuality, maxQuality, 100);
+    int spent = 0;
+    auto encode = [&](int q) {
+        ++spent;
+        return encodeJpeg(image, q);
+    };
+
+    int chosen = maxQuality;
+    QByteArray best = encode(maxQuality);
+    if (byteBudget > 0 && best.size() > byteBudget) {
+        best.clear();
+        int lo = minQuality, hi = maxQuality - 1;
+        for (int step = 0; lo <= hi && step < kMaxSearchSteps; ++step) {
+            const int mid = (lo + hi + 1) / 2;
+            QByteArray data = encode(mid);
+            if (!data.isEmpty() && data.size() <= byteBudget) {
+                best = std::move(data);
+                chosen = mid;
+                lo = mid + 1;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        if (best.isEmpty()) {
+            chosen = minQuality;
+            best = encode(minQuality);
+        }
+    }
+
+    if (quality) *quality = chosen;
+    if (encodes) *encodes += spent;
+    return best;
+}
+
+ScanPreprocessor::Result ScanPreprocessor::process(const QImage& frame, const Options& options) {
+    Result result;
+    result.crop = frame.rect();
+    if (frame.isNull()) return result;
+
+    QImage image = frame;
+    if (options.cropToGarment) {
+        result.crop = garmentRegion(frame, options.cropMargin);
+        if (result.crop != frame.rect()) image = frame.copy(result.crop);
+    }
+
+    const int longEdge = qMax(image.width(), image.height());
+    if (options.targetLongEdge > 0 && longEdge > options.targetLongEdge) {
+        image = image.scaled(options.targetLongEdge, options.targetLongEdge,
+                             Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    for (int downscales = 0;; ++downscales) {
+        result.jpeg = encodeToBudget(image, options.byteBudget, options.minQuality, options.maxQuality,
+                                     &result.quality, &result.encodes);
+        if (options.byteBudget <= 0 || result.jpeg.size() <= options.byteBudget
+            || downscales == kMaxDownscales
+            || qMin(image.width(), image.height()) * kDownscaleStep < kMinShortEdge) {
+            break;
+        }
+        image = image.scaled(image.size() * kDownscaleStep, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    result.size = image.size();
+    return result;
+}
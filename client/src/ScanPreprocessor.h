@@ -0,0 +1,49 @@
+#pragma once
+#ifndef SCANPREPROCESSOR_H
+#define SCANPREPROCESSOR_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QRect>
+#include <QSize>
+
+// Prepares a captured garment photo for upload: crops it to the garment,
+// downscales it to what the server actually uses, and picks the highest
+// JPEG quality that fits a byte budget. Pure functions, safe to call from
+// worker threads.
+namespace ScanPreprocessor {
+    struct Options {
+        // Longest edge after scaling; 0 keeps the (cropped) camera size.
+        int targetLongEdge = 1600;
+        bool cropToGarment = true;
+        // Extra border kept around the detected garment, relative to its size.
+        double cropMargin = 0.06;
+        // Largest encoded size in bytes; 0 encodes at maxQuality.
+        qint64 byteBudget = 0;
+        int maxQuality = 85;
+        int minQuality = 40;
+    };
+
+    struct Result {
+        QByteArray jpeg;
+        QRect crop;         // in source pixels
+        QSize size;         // encoded image size
+        int quality = 0;
+        int encodes = 0;    // JPEG encodes spent on the quality search
+    };
+
+    Result process(const QImage& frame, const Options& options);
+
+    // Bounding box of whatever stands out from a plain background, plus
+    // `margin`. Returns the whole frame when the border is not uniform
+    // enough to call it background, or nothing clearly stands out.
+    QRect garmentRegion(const QImage& frame, double margin);
+
+    // Highest quality in [minQuality, maxQuality] whose encoding fits
+    // byteBudget (binary search; size grows with quality). Falls back to
+    // minQuality when nothing fits.
+    QByteArray encodeToBudget(const QImage& image, qint64 byteBudget, int minQuality, int maxQuality,
+                              int* quality = nullptr, int* encodes = nullptr);
+}
+
+#endif // SCANPREPROCESSOR_H
@@ -0,0 +1,279 @@
+#include "SkinningKernels.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SKINNING_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define SKINNING_NEON 1
+#include <arm_neon.h>
+#endif
+
+// AVX2 is compiled per function so the rest of the binary keeps the
+// baseline instruction set; it is only called after a runtime check.
+#if defined(SKINNING_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SKINNING_AVX2 1
+#define SKINNING_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+namespace Skinning {
+namespace {
+
+void skinScalar(const Job& job, size_t begin, size_t end) {
+    const bool normals = job.hasNormals();
+    for (size_t i = begin; i < end; ++i) {
+        float m[12] = {};
+        for (int j = 0; j < kMaxInfluences; ++j) {
+            const float w = job.boneWeight[j][i];
+            const float* b = job.bones[job.boneIndex[j][i]].m;
+            for (int k = 0; k < 12; ++k) {
+                m[k] += w * b[k];
+            }
+        }
+
+        const float x = job.px[i], y = job.py[i], z = job.pz[i];
+        job.outPx[i] = m[0] * x + m[1] * y + m[2] * z + m[3];
+        job.outPy[i] = m[4] * x + m[5] * y + m[6] * z + m[7];
+        job.outPz[i] = m[8] * x + m[9] * y + m[10] * z + m[11];
+
+        if (normals) {
+            const float nx = job.nx[i], ny = job.ny[i], nz = job.nz[i];
+            const float tx = m[0] * nx + m[1] * ny + m[2] * nz;
+            const float ty = m[4] * nx + m[5] * ny + m[6] * nz;
+            const float tz = m[8] * nx + m[9] * ny + m[10] * nz;
+            const float length = std::sqrt(tx * tx + ty * ty + tz * tz);
+            const float inv = length > 0.0f ? 1.0f / length : 0.0f;
+            job.outNx[i] = tx * inv;
+            job.outNy[i] = ty * inv;
+            job.outNz[i] = tz * inv;
+        }
+    }
+}
+
+#ifdef SKINNING_X86
+void skinSse(const Job& job, size_t begin, size_t end) {
+    const bool normals = job.hasNormals();
+    const float* palette = job.bones[0].m;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 m[12];
+        for (int k = 0; k < 12; ++k) m[k] = _mm_setzero_ps();
+
+        for (int j = 0; j < kMaxInfluences; ++j) {
+            const __m128 w = _mm_loadu_ps(job.boneWeight[j] + i);
+            const uint16_t* idx = job.boneIndex[j] + i;
+            const float* b0 = palette + 12 * idx[0];
+            const float* b1 = palette + 12 * idx[1];
+            const float* b2 = palette + 12 * idx[2];
+            const float* b3 = palette + 12 * idx[3];
+            for (int k = 0; k < 12; ++k) {
+                m[k] = _mm_add_ps(m[k], _mm_mul_ps(w, _mm_set_ps(b3[k], b2[k], b1[k], b0[k])));
+            }
+        }
+
+        const __m128 x = _mm_loadu_ps(job.px + i);
+        const __m128 y = _mm_loadu_ps(job.py + i);
+        const __m128 z = _mm_loadu_ps(job.pz + i);
+        _mm_storeu_ps(job.outPx + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], x), _mm_mul_ps(m[1], y)),
+                                                _mm_add_ps(_mm_mul_ps(m[2], z), m[3])));
+        _mm_storeu_ps(job.outPy + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[4], x), _mm_mul_ps(m[5], y)),
+                                                _mm_add_ps(_mm_mul_ps(m[6], z), m[7])));
+        _mm_storeu_ps(job.outPz + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[8], x), _mm_mul_ps(m[9], y)),
+                                                _mm_add_ps(_mm_mul_ps(m[10], z), m[11])));
+
+        if (normals) {
+            const __m128 nx = _mm_loadu_ps(job.nx + i);
+            const __m128 ny = _mm_loadu_ps(job.ny + i);
+            const __m128 nz = _mm_loadu_ps(job.nz + i);
+            const __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], nx), _mm_mul_ps(m[1], ny)), _mm_mul_ps(m[2], nz));
+            const __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[4], nx), _mm_mul_ps(m[5], ny)), _mm_mul_ps(m[6], nz));
+            const __m128 tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[8], nx), _mm_mul_ps(m[9], ny)), _mm_mul_ps(m[10], nz));
+            const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)),
+                                                         _mm_mul_ps(tz, tz)));
+            // Zero-length normals stay zero instead of turning into NaN.
+            const __m128 valid = _mm_cmpgt_ps(length, _mm_setzero_ps());
+            const __m128 inv = _mm_and_ps(valid, _mm_div_ps(_mm_set1_ps(1.0f), length));
+            _mm_storeu_ps(job.outNx + i, _mm_mul_ps(tx, inv));
+            _mm_storeu_ps(job.outNy + i, _mm_mul_ps(ty, inv));
+            _mm_storeu_ps(job.outNz + i, _mm_mul_ps(tz, inv));
+        }
+    }
+    skinScalar(job, i, end);
+}
+#endif
+
+#ifdef SKINNING_AVX2
+SKINNING_TARGET_AVX2
+void skinAvx2(const Job& job, size_t begin, size_t end) {
+    const bool normals = job.hasNormals();
+    const float* palette = job.bones[0].m;
+    const __m256i stride = _mm256_set1_epi32(12);
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 m[12];
+        for (int k = 0; k < 12; ++k) m[k] = _mm256_setzero_ps();
+
+        for (int j = 0; j < kMaxInfluences; ++j) {
+            const __m256 w = _mm256_loadu_ps(job.boneWeight[j] + i);
+            const __m128i idx16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(job.boneIndex[j] + i));
+            const __m256i base = _mm256_mullo_epi32(_mm256_cvtepu16_epi32(idx16), stride);
+            for (int k = 0; k < 12; ++k) {
+                m[k] = _mm256_fmadd_ps(w, _mm256_i32gather_ps(palette + k, base, 4), m[k]);
+            }
+        }
+
+        const __m256 x = _mm256_loadu_ps(job.px + i);
+        const __m256 y = _mm256_loadu_ps(job.py + i);
+        const __m256 z = _mm256_loadu_ps(job.pz + i);
+        _mm256_storeu_ps(job.outPx + i, _mm256_fmadd_ps(m[0], x, _mm256_fmadd_ps(m[1], y, _mm256_fmadd_ps(m[2], z, m[3]))));
+        _mm256_storeu_ps(job.outPy + i, _mm256_fmadd_ps(m[4], x, _mm256_fmadd_ps(m[5], y, _mm256_fmadd_ps(m[6], z, m[7]))));
+        _mm256_storeu_ps(job.outPz + i, _mm256_fmadd_ps(m[8], x, _mm256_fmadd_ps(m[9], y, _mm256_fmadd_ps(m[10], z, m[11]))));
+
+        if (normals) {
+            const __m256 nx = _mm256_loadu_ps(job.nx + i);
+            const __m256 ny = _mm256_loadu_ps(job.ny + i);
+            const __m256 nz = _mm256_loadu_ps(job.nz + i);
+            const __m256 tx = _mm256_fmadd_ps(m[0], nx, _mm256_fmadd_ps(m[1], ny, _mm256_mul_ps(m[2], nz)));
+            const __m256 ty = _mm256_fmadd_ps(m[4], nx, _mm256_fmadd_ps(m[5], ny, _mm256_mul_ps(m[6], nz)));
+            const __m256 tz = _mm256_fmadd_ps(m[8], nx, _mm256_fmadd_ps(m[9], ny, _mm256_mul_ps(m[10], nz)));
+            const __m256 length = _mm256_sqrt_ps(_mm256_fmadd_ps(tx, tx, _mm256_fmadd_ps(ty, ty, _mm256_mul_ps(tz, tz))));
+            const __m256 valid = _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_GT_OQ);
+            const __m256 inv = _mm256_and_ps(valid, _mm256_div_ps(_mm256_set1_ps(1.0f), length));
+            _mm256_storeu_ps(job.outNx + i, _mm256_mul_ps(tx, inv));
+            _mm256_storeu_ps(job.outNy + i, _mm256_mul_ps(ty, inv));
+            _mm256_storeu_ps(job.outNz + i, _mm256_mul_ps(tz, inv));
+        }
+    }
+    skinSse(job, i, end);
+}
+
+bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+}
+#endif
+
+#ifdef SKINNING_NEON
+void skinNeon(const Job& job, size_t begin, size_t end) {
+    const bool normals = job.hasNormals();
+    const float* palette = job.bones[0].m;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        float32x4_t m[12];
+        for (int k = 0; k < 12; ++k) m[k] = vdupq_n_f32(0.0f);
+
+        for (int j = 0; j < kMaxInfluences; ++j) {
+            const float32x4_t w = vld1q_f32(job.boneWeight[j] + i);
+            const uint16_t* idx = job.boneIndex[j] + i;
+            const float* b0 = palette + 12 * idx[0];
+            const float* b1 = palette + 12 * idx[1];
+            const float* b2 = palette + 12 * idx[2];
+            const float* b3 = palette + 12 * idx[3];
+            for (int k = 0; k < 12; ++k) {
+                float32x4_t column = vdupq_n_f32(b0[k]);
+                column = vsetq_lane_f32(b1[k], column, 1);
+                column = vsetq_lane_f32(b2[k], column, 2);
+                column = vsetq_lane_f32(b3[k], column, 3);
+                m[k] = vfmaq_f32(m[k], w, column);
+            }
+        }
+
+        const float32x4_t x = vld1q_f32(job.px + i);
+        const float32x4_t y = vld1q_f32(job.py + i);
+        const float32x4_t z = vld1q_f32(job.pz + i);
+        vst1q_f32(job.outPx + i, vfmaq_f32(vfmaq_f32(vfmaq_f32(m[3], m[2], z), m[1], y), m[0], x));
+        vst1q_f32(job.outPy + i, vfmaq_f32(vfmaq_f32(vfmaq_f32(m[7], m[6], z), m[5], y), m[4], x));
+        vst1q_f32(job.outPz + i, vfmaq_f32(vfmaq_f32(vfmaq_f32(m[11], m[10], z), m[9], y), m[8], x));
+
+        if (normals) {
+            const float32x4_t nx = vld1q_f32(job.nx + i);
+            const float32x4_t ny = vld1q_f32(job.ny + i);
+            const float32x4_t nz = vld1q_f32(job.nz + i);
+            const float32x4_t tx = vfmaq_f32(vfmaq_f32(vmulq_f32(m[2], nz), m[1], ny), m[0], nx);
+            const float32x4_t ty = vfmaq_f32(vfmaq_f32(vmulq_f32(m[6], nz), m[5], ny), m[4], nx);
+            const float32x4_t tz = vfmaq_f32(vfmaq_f32(vmulq_f32(m[10], nz), m[9], ny), m[8], nx);
+            const float32x4_t length = vsqrtq_f32(vfmaq_f32(vfmaq_f32(vmulq_f32(tz, tz), ty, ty), tx, tx));
+            const uint32x4_t valid = vcgtq_f32(length, vdupq_n_f32(0.0f));
+            const float32x4_t inv = vreinterpretq_f32_u32(
+                vandq_u32(valid, vreinterpretq_u32_f32(vdivq_f32(vdupq_n_f32(1.0f), length))));
+            vst1q_f32(job.outNx + i, vmulq_f32(tx, inv));
+            vst1q_f32(job.outNy + i, vmulq_f32(ty, inv));
+            vst1q_f32(job.outNz + i, vmulq_f32(tz, inv));
+        }
+    }
+    skinScalar(job, i, end);
+}
+#endif
+
+} // namespace
+
+const char* kernelName(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Scalar: return "scalar";
+    case Kernel::SSE:    return "sse";
+    case Kernel::AVX2:   return "avx2";
+    case Kernel::NEON:   return "neon";
+    }
+    return "unknown";
+}
+
+bool isAvailable(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Scalar:
+        return true;
+#ifdef SKINNING_X86
+    case Kernel::SSE:
+        return true;
+#endif
+#ifdef SKINNING_AVX2
+    case Kernel::AVX2:
+        return cpuHasAvx2();
+#endif
+#ifdef SKINNING_NEON
+    case Kernel::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+Kernel bestKernel() {
+    if (isAvailable(Kernel::AVX2)) return Kernel::AVX2;
+    if (isAvailable(Kernel::NEON)) return Kernel::NEON;
+    if (isAvailable(Kernel::SSE)) return Kernel::SSE;
+    return Kernel::Scalar;
+}
+
+void skin(const Job& job, size_t begin, size_t end, Kernel kernel) {
+    if (end > job.vertexCount) end = job.vertexCount;
+    if (begin >= end || !job.bones || job.boneCount == 0) return;
+
+    switch (kernel) {
+#ifdef SKINNING_AVX2
+    case Kernel::AVX2:
+        if (cpuHasAvx2()) {
+            skinAvx2(job, begin, end);
+            return;
+        }
+        break;
+#endif
+#ifdef SKINNING_X86
+    case Kernel::SSE:
+        skinSse(job, begin, end);
+        return;
+#endif
+#ifdef SKINNING_NEON
+    case Kernel::NEON:
+        skinNeon(job, begin, end);
+        return;
+#endif
+    default:
+        break;
+    }
+    skinScalar(job, begin, end);
+}
+
+} // namespace Skinning
@@ -0,0 +1,65 @@
+// SkinningKernels.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Linear blend skinning over structure-of-arrays vertex streams, as laid out
+// by the cooked mesh format. Every vertex has up to four bone influences,
+// also stored as separate arrays, so the SIMD kernels process 4 (SSE, NEON)
+// or 8 (AVX2) vertices per step without shuffling. Bone indices are trusted:
+// callers must keep them below boneCount.
+namespace Skinning {
+
+constexpr int kMaxInfluences = 4;
+
+// Row-major 3x4 affine transform: rotation/scale in columns 0-2,
+// translation in column 3.
+struct BoneMatrix {
+    float m[12];
+};
+
+struct Job {
+    size_t vertexCount = 0;
+
+    const float* px = nullptr;
+    const float* py = nullptr;
+    const float* pz = nullptr;
+    // Optional; normals are skipped when any of these is null.
+    const float* nx = nullptr;
+    const float* ny = nullptr;
+    const float* nz = nullptr;
+
+    // Unused influences carry weight 0.
+    const uint16_t* boneIndex[kMaxInfluences] = {};
+    const float* boneWeight[kMaxInfluences] = {};
+
+    const BoneMatrix* bones = nullptr;
+    size_t boneCount = 0;
+
+    float* outPx = nullptr;
+    float* outPy = nullptr;
+    float* outPz = nullptr;
+    float* outNx = nullptr;
+    float* outNy = nullptr;
+    float* outNz = nullptr;
+
+    bool hasNormals() const { return nx && ny && nz && outNx && outNy && outNz; }
+};
+
+enum class Kernel {
+    Scalar,     // reference implementation, always available
+    SSE,        // x86-64 baseline
+    AVX2,       // x86-64 with AVX2 + FMA, selected at runtime
+    NEON        // AArch64
+};
+
+const char* kernelName(Kernel kernel);
+bool isAvailable(Kernel kernel);
+// Fastest kernel the running CPU supports.
+Kernel bestKernel();
+
+// Skins vertices [begin, end) of `job`. Unavailable kernels fall back to
+// the scalar one.
+void skin(const Job& job, size_t begin, size_t end, Kernel kernel);
+
+} // namespace Skinning
@@ -0,0 +1,329 @@
+#include "ThumbnailProvider.h"
+#include "NetworkClient.h"
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <memory>
+
+namespace {
+constexpr int kSizeBucket = 32;
+constexpr int kThumbnailQuality = 88;
+// Trim the disk cache after this many new thumbnails.
+constexpr int kWritesPerPrune = 64;
+}
+
+// One request from the QML engine. finished() must be emitted exactly once,
+// also after cancel(); the engine deletes the response afterwards, so every
+// pending step finishes through finish() before anything else may touch it.
+class ThumbnailResponse : public QQuickImageResponse {
+public:
+    // Download bookkeeping, only touched on the provider's thread. Shared so
+    // that a queued abort can outlive the response itself.
+    struct Download {
+        QPointer<QNetworkReply> reply;
+        bool cancelled = false;
+    };
+
+    ThumbnailResponse(ThumbnailProvider* provider, const QUrl& source, const QSize& size, const QString& key)
+        : m_provider(provider), m_source(source), m_size(size), m_key(key),
+          m_download(std::make_shared<Download>())
+    {
+    }
+
+    QQuickTextureFactory* textureFactory() const override {
+        return m_image.isNull() ? nullptr : QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+    QString errorString() const override { return m_error; }
+
+    void cancel() override {
+        if (m_cancelled.exchange(true)) return;
+        std::shared_ptr<Download> download = m_download;
+        QMetaObject::invokeMethod(m_provider, [download]() {
+            download->cancelled = true;
+            if (download->reply) {
+                download->reply->abort();
+            }
+        }, Qt::QueuedConnection);
+    }
+
+    bool isCancelled() const { return m_cancelled.load(); }
+
+    // Safe to call from any thread; finished() is delivered on the
+    // response's own thread once the engine has connected to it.
+    void finish(const QImage& image, const QString& error = QString()) {
+        if (m_finished.exchange(true)) return;
+        m_image = image;
+        m_error = (image.isNull() && error.isEmpty()) ? QStringLiteral("Cancelled") : error;
+        QMetaObject::invokeMethod(this, [this]() { emit finished(); }, Qt::QueuedConnection);
+    }
+
+    ThumbnailProvider* const m_provider;
+    const QUrl m_source;
+    const QSize m_size;
+    const QString m_key;
+    const std::shared_ptr<Download> m_download;
+
+private:
+    QImage m_image;
+    QString m_error;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<bool> m_finished{false};
+};
+
+ThumbnailProvider::ThumbnailProvider(const QString& cacheDirectory)
+    : m_directory(cacheDirectory.isEmpty()
+                      ? QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails"
+                      : cacheDirectory),
+      m_network(NetworkClient::instance()->manager())
+{
+    QDir().mkpath(m_directory);
+
+    // Decoding is short and bursty while flinging the grid; two workers keep
+    // up without competing with the render thread.
+    m_pool.setMaxThreadCount(2);
+    m_pool.setObjectName("ThumbnailPool");
+
+    m_memory.setMaxCost(32 * 1024);
+
+    m_pool.start([this]() { pruneDisk(); });
+}
+
+ThumbnailProvider::~ThumbnailProvider() {
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void ThumbnailProvider::setMemoryBudgetBytes(qint64 bytes) {
+    QMutexLocker locker(&m_memoryMutex);
+    m_memory.setMaxCost(qMax<qint64>(1, bytes / 1024));
+}
+
+void ThumbnailProvider::setDiskBudgetBytes(qint64 bytes) {
+    m_diskBudgetBytes = qMax<qint64>(0, bytes);
+}
+
+QSize ThumbnailProvider::bucketSize(const QSize& requested) {
+    auto roundUp = [](int value) {
+        return value <= 0 ? 0 : ((value + kSizeBucket - 1) / kSizeBucket) * kSizeBucket;
+    };
+    return QSize(roundUp(requested.width()), roundUp(requested.height()));
+}
+
+QImage ThumbnailProvider::decodeScaled(QIODevice* device, const QSize& target, QString* error) {
+    QImageReader reader(device);
+    reader.setAutoTransform(true);
+
+    const QSize full = reader.size();
+    if (full.isValid() && (target.width() > 0 || target.height() > 0)) {
+        // The scaled size applies before the EXIF rotation.
+        QSize wanted = target;
+        if (reader.transformation() & QImageIOHandler::TransformationRotate90) {
+            wanted.transpose();
+        }
+
+        QSize scaled;
+        if (wanted.width() > 0 && wanted.height() > 0) {
+            scaled = full.scaled(wanted, Qt::KeepAspectRatioByExpanding);
+        } else if (wanted.width() > 0) {
+            scaled = QSize(wanted.width(), qMax(1, int(qint64(full.height()) * wanted.width() / full.width())));
+        } else {
+            scaled = QSize(qMax(1, int(qint64(full.width()) * wanted.height() / full.height())), wanted.height());
+        }
+
+        // Never upscale; the scene graph does that for free.
+        if (scaled.width() < full.width()) {
+            reader.setScaledSize(scaled);
+        }
+    }
+
+    const QImage image = reader.read();
+    if (image.isNull() && error) {
+        *error = reader.errorString();
+    }
+    return image;
+}
+
+QString ThumbnailProvider::cacheKey(const QUrl& source, const QSize& size) const {
+    return source.toString() + QStringLiteral("@%1x%2").arg(size.width()).arg(size.height());
+}
+
+QString ThumbnailProvider::diskPath(const QString& key) const {
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_directory + "/" + QString::fromLatin1(hash) + ".thumb";
+}
+
+bool ThumbnailProvider::lookupMemory(const QString& key, QImage* image) {
+    QMutexLocker locker(&m_memoryMutex);
+    const QImage* cached = m_memory.object(key);
+    if (!cached) return false;
+    *image = *cached;
+    return true;
+}
+
+void ThumbnailProvider::insertMemory(const QString& key, const QImage& image) {
+    QMutexLocker locker(&m_memoryMutex);
+    m_memory.insert(key, new QImage(image), int(image.sizeInBytes() / 1024) + 1);
+}
+
+QImage ThumbnailProvider::loadFromDisk(const QString& key, const QSize& size) {
+    QFile file(diskPath(key));
+    if (!file.open(QIODevice::ReadOnly)) return QImage();
+
+    const QImage image = decodeScaled(&file, size);
+    if (image.isNull()) {
+        file.close();
+        file.remove();
+        return QImage();
+    }
+    // The modification time doubles as last-used time for pruning.
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return image;
+}
+
+void ThumbnailProvider::storeOnDisk(const QString& key, const QImage& image) {
+    QSaveFile file(diskPath(key));
+    if (!file.open(QIODevice::WriteOnly)) return;
+
+    QImageWriter writer(&file, image.hasAlphaChannel() ? "png" : "jpg");
+    writer.setQuality(kThumbnailQuality);
+    if (!writer.write(image) || !file.commit()) {
+        qWarning() << "Failed to write thumbnail:" << writer.errorString();
+        return;
+    }
+
+    if (++m_writesSincePrune >= kWritesPerPrune) {
+        m_writesSincePrune = 0;
+        pruneDisk();
+    }
+}
+
+void ThumbnailProvider::pruneDisk() {
+    QDir dir(m_directory);
+    // Newest first; everything past the budget goes.
+    const QFileInfoList files = dir.entryInfoList({"*.thumb"}, QDir::Files, QDir::Time);
+    const qint64 budget = m_diskBudgetBytes.load();
+
+    qint64 total = 0;
+    int removed = 0;
+    for (const QFileInfo& info : files) {
+        total += info.size();
+        if (total > budget && QFile::remove(info.absoluteFilePath())) {
+            ++removed;
+        }
+    }
+    if (removed > 0) {
+        qDebug() << "Pruned" << removed << "cached thumbnails";
+    }
+}
+
+QQuickImageResponse* ThumbnailProvider::requestImageResponse(const QString& id, const QSize& requestedSize) {
+    // Ids are base64 so the source URL's own query and escapes survive the
+    // image:// URL untouched; plain URLs are accepted as well.
+    const auto decoded = QByteArray::fromBase64Encoding(id.toLatin1(), QByteArray::AbortOnBase64DecodingErrors);
+    const QUrl source = decoded ? QUrl(QString::fromUtf8(*decoded)) : QUrl(id);
+
+    const QSize size = bucketSize(requestedSize);
+    const QString key = cacheKey(source, size);
+    auto* response = new ThumbnailResponse(this, source, size, key);
+
+    QImage cached;
+    if (lookupMemory(key, &cached)) {
+        response->finish(cached);
+        return response;
+    }
+
+    m_pool.start([this, response]() {
+        if (response->isCancelled()) {
+            response->finish(QImage());
+            return;
+        }
+
+        QImage image = loadFromDisk(response->m_key, response->m_size);
+        if (!image.isNull()) {
+            insertMemory(response->m_key, image);
+            response->finish(image);
+            return;
+        }
+
+        const QUrl& source = response->m_source;
+        if (source.scheme() == "http" || source.scheme() == "https") {
+            QMetaObject::invokeMethod(this, [this, response]() { startDownload(response); },
+                                      Qt::QueuedConnection);
+            return;
+        }
+
+        // Bundled or local previews: no disk copy needed, just decode small.
+        QFile file(source.scheme() == "qrc" ? ":" + source.path() : source.toLocalFile());
+        if (!file.open(QIODevice::ReadOnly)) {
+            response->finish(QImage(), file.errorString());
+            return;
+        }
+        QString error;
+        image = decodeScaled(&file, response->m_size, &error);
+        if (!image.isNull()) {
+            insertMemory(response->m_key, image);
+        }
+        response->finish(image, error);
+    });
+
+    return response;
+}
+
+void ThumbnailProvider::startDownload(ThumbnailResponse* response) {
+    if (response->m_download->cancelled) {
+        response->finish(QImage());
+        return;
+    }
+
+    QNetworkRequest request(response->m_source);
+    NetworkClient::instance()->prepare(request);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    QNetworkReply* reply = m_network->get(request);
+    response->m_download->reply = reply;
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply, response]() {
+        reply->deleteLater();
+
+        if (reply->error() != QNetworkReply::NoError) {
+            if (reply->error() != QNetworkReply::OperationCanceledError) {
+                qDebug() << "Thumbnail download failed:" << reply->url().toString() << reply->errorString();
+            }
+            response->finish(QImage(), reply->errorString());
+            return;
+        }
+
+        const QByteArray data = reply->readAll();
+        m_pool.start([this, response, data]() {
+            if (response->isCancelled()) {
+                response->finish(QImage());
+                return;
+            }
+
+            QByteArray bytes = data;
+            QBuffer buffer(&bytes);
+            buffer.open(QIODevice::ReadOnly);
+
+            QString error;
+            const QImage image = decodeScaled(&buffer, response->m_size, &error);
+            if (image.isNull()) {
+                response->finish(QImage(), error);
+                return;
+            }
+
+            insertMemory(response->m_key, image);
+            storeOnDisk(response->m_key, image);
+            response->finish(image);
+        });
+    });
+}
@@ -0,0 +1,70 @@
+#pragma once
+#ifndef THUMBNAILPROVIDER_H
+#define THUMBNAILPROVIDER_H
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QNetworkAccessManager>
+#include <QQuickAsyncImageProvider>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+#include <QUrl>
+#include <atomic>
+
+class QIODevice;
+class ThumbnailResponse;
+
+// Async image provider for garment previews, registered as "thumbnail".
+// QML asks for "image://thumbnail/" + Qt.btoa(url) with sourceSize set to the
+// delegate's pixel size. Images are decoded straight to that size on a
+// worker pool (JPEG is downscaled inside the decoder), kept in an in-memory
+// LRU keyed by url@WxH, and written as small thumbnails to a disk cache so a
+// later session never downloads or full-decodes the original again.
+// Requests for delegates that scroll out of view are cancelled by the engine,
+// which aborts any download still in flight.
+class ThumbnailProvider : public QQuickAsyncImageProvider {
+public:
+    explicit ThumbnailProvider(const QString& cacheDirectory = QString());
+    ~ThumbnailProvider() override;
+
+    QQuickImageResponse* requestImageResponse(const QString& id, const QSize& requestedSize) override;
+
+    void setMemoryBudgetBytes(qint64 bytes);
+    void setDiskBudgetBytes(qint64 bytes);
+
+    // Rounds a requested size up to a coarse grid so small layout changes
+    // reuse the same cached thumbnail.
+    static QSize bucketSize(const QSize& requested);
+
+    // Decodes `device` so that it covers `target` (aspect kept, as with
+    // Image.PreserveAspectCrop). An empty target decodes at full size.
+    static QImage decodeScaled(QIODevice* device, const QSize& target, QString* error = nullptr);
+
+private:
+    QString cacheKey(const QUrl& source, const QSize& size) const;
+    QString diskPath(const QString& key) const;
+
+    bool lookupMemory(const QString& key, QImage* image);
+    void insertMemory(const QString& key, const QImage& image);
+    QImage loadFromDisk(const QString& key, const QSize& size);
+    void storeOnDisk(const QString& key, const QImage& image);
+    void pruneDisk();
+
+    // Runs on the provider's (GUI) thread, which the shared network access
+    // manager lives on.
+    void startDownload(ThumbnailResponse* response);
+
+    QString m_directory;
+    QThreadPool m_pool;
+    QNetworkAccessManager* m_network;   // shared, see NetworkClient
+
+    QMutex m_memoryMutex;
+    QCache<QString, QImage> m_memory;   // cost in KiB
+
+    std::atomic<qint64> m_diskBudgetBytes{48ll * 1024 * 1024};
+    std::atomic<int> m_writesSincePrune{0};
+};
+
+#endif // THUMBNAILPROVIDER_H
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Wait-free single-producer / single-consumer triple buffer.
+//
+// The producer fills writeBuffer() and publishes it; the consumer calls
+// update() and then reads readBuffer(). Each side owns one slot and the
+// third is swapped through a single atomic, so neither side ever blocks,
+// allocates or sees a torn value: the consumer always gets the most recent
+// complete publication and intermediate ones are simply skipped.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer side
+    T& writeBuffer() { return m_slots[m_write].value; }
+    void publish() {
+        const uint8_t previous = m_middle.exchange(uint8_t(m_write | kFresh), std::memory_order_acq_rel);
+        m_write = previous & kIndexMask;
+    }
+
+    // Consumer side. Returns true when a newer value was taken; the
+    // previous read buffer stays valid otherwise.
+    bool update() {
+        if (!(m_middle.load(std::memory_order_relaxed) & kFresh)) return false;
+        const uint8_t previous = m_middle.exchange(m_read, std::memory_order_acq_rel);
+        m_read = previous & kIndexMask;
+        return true;
+    }
+    const T& readBuffer() const { return m_slots[m_read].value; }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    // Slots on separate cache lines so producer writes do not invalidate
+    // the line the consumer is reading.
+    struct alignas(64) Slot {
+        T value{};
+    };
+
+    Slot m_slots[3];
+    alignas(64) std::atomic<uint8_t> m_middle{1};
+    alignas(64) uint8_t m_write = 0;   // producer-owned
+    alignas(64) uint8_t m_read = 2;    // consumer-owned
+};
@@ -0,0 +1,42 @@
+#include "TryOnPreviewProvider.h"
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace {
+// Shared by every engine; requestImage may run on the engine's loader threads
+QMutex s_mutex;
+QHash<QString, QImage> s_images;
+}
+
+TryOnPreviewProvider::TryOnPreviewProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+}
+
+QImage TryOnPreviewProvider::requestImage(const QString& id, QSize* size, const QSize& requestedSize) {
+    const QString key = id.section('/', 0, 0);
+    QImage image;
+    {
+        QMutexLocker lock(&s_mutex);
+        image = s_images.value(key);
+    }
+    if (image.isNull()) return image;
+
+    if (requestedSize.isValid() && !requestedSize.isEmpty()
+        && (image.width() > requestedSize.width() || image.height() > requestedSize.height())) {
+        image = image.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    if (size) *size = image.size();
+    return image;
+}
+
+void TryOnPreviewProvider::publish(const QString& key, const QImage& image) {
+    QMutexLocker lock(&s_mutex);
+    s_images.insert(key, image);
+}
+
+void TryOnPreviewProvider::remove(const QString& key) {
+    QMutexLocker lock(&s_mutex);
+    s_images.remove(key);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#ifndef TRYONPREVIEWPROVIDER_H
+#define TRYONPREVIEWPROVIDER_H
+
+#include <QImage>
+#include <QQuickImageProvider>
+#include <QString>
+
+// Serves the try-on result while it is still downloading, registered as
+// "tryon". ImageProcessor publishes each partially decoded image under its
+// own key and QML loads "image://tryon/<key>/<revision>"; the revision only
+// exists to make the engine reload, the latest image is always returned.
+class TryOnPreviewProvider : public QQuickImageProvider {
+public:
+    TryOnPreviewProvider();
+
+    QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) override;
+
+    static void publish(const QString& key, const QImage& image);
+    static void remove(const QString& key);
+};
+
+#endif // TRYONPREVIEWPROVIDER_H
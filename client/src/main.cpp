@@ -5,6 +5,12 @@
 #include "QMLManager.h"
 #include "NetworkManager.h"
 #include "ImageProcessor.h"
+#include "GarmentListModel.h"
+#include "GarmentRenderer.h"
+#include "ThumbnailProvider.h"
+#include "TryOnPreviewProvider.h"
+#include "ModelAssetCache.h"
+#include "ScanPipelineTracer.h"
 #include <Qt3DRender/QRenderAspect>
 #include <QSslSocket>
 
@@ -29,7 +35,11 @@ JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* /*reserved*/)
 int main(int argc, char *argv[])
 {
     qputenv("QT3D_RENDERER", "opengl");  // Force OpenGL backend
-    qputenv("QSG_RHI_BACKEND", "opengl"); // Force Qt Quick to use OpenGL
+    // Force Qt Quick to use OpenGL, unless overridden (CI runs the null or
+    // software backends)
+    if (!qEnvironmentVariableIsSet("QSG_RHI_BACKEND") && !qEnvironmentVariableIsSet("QT_QUICK_BACKEND")) {
+        qputenv("QSG_RHI_BACKEND", "opengl");
+    }
     QGuiApplication app(argc, argv);
 
     qDebug() << "SSL support:" << QSslSocket::supportsSsl();
@@ -40,6 +50,15 @@ int main(int argc, char *argv[])
     qmlRegisterType<QMLManager>("ARClothTryOn", 1, 0, "QMLManager");
     qmlRegisterType<NetworkManager>("ARClothTryOn", 1, 0, "NetworkManager");
     qmlRegisterType<ImageProcessor>("ARClothTryOn", 1, 0, "ImageProcessor");
+    qmlRegisterType<GarmentRenderer>("ARClothTryOn", 1, 0, "GarmentRenderer");
+    qmlRegisterUncreatableType<GarmentListModel>("ARClothTryOn", 1, 0, "GarmentListModel",
+                                                 "GarmentListModel is provided by QMLManager.garments");
+
+    // Shared by every page; outlives the engine below
+    ModelAssetCache modelAssetCache;
+    qmlRegisterSingletonInstance("ARClothTryOn", 1, 0, "ModelAssetCache", &modelAssetCache);
+    // Capture-to-preview timings, marked from both C++ and QML
+    qmlRegisterSingletonInstance("ARClothTryOn", 1, 0, "ScanPipeline", ScanPipelineTracer::instance());
 
 #ifdef Q_OS_ANDROID
     // Initialize Qt Android platform integration
@@ -59,6 +78,10 @@ int main(int argc, char *argv[])
 
     // Create QML engine and load main QML file
     QQmlApplicationEngine engine;
+    // Garment previews: image://thumbnail/<base64 url>, owned by the engine
+    engine.addImageProvider("thumbnail", new ThumbnailProvider);
+    // Try-on results while they stream in: image://tryon/<key>/<revision>
+    engine.addImageProvider("tryon", new TryOnPreviewProvider);
     // const QUrl url(QStringLiteral("qrc:/ARClothTryOn/qml/AuthorizationPage.qml"));
     const QUrl url(QStringLiteral("qrc:/ARClothTryOn/qml/Main.qml"));
     QObject::connect(&engine, &QQmlApplicationEngine::objectCreated,
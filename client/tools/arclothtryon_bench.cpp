@@ -0,0 +1,711 @@
+// arclothtryon_bench: timings for the client's hot paths, headless.
+//
+//   arclothtryon_bench [--iterations N] [--filter TEXT]
+//                      [--json results.json] [--baseline baseline.json] [--tolerance 0.15]
+//
+// Runs on the desktop with the offscreen platform plugin (set when
+// QT_QPA_PLATFORM is not), against a stand-in HTTP server on 127.0.0.1:
+//  - scan_encode*:     ScanPreprocessor, the crop/scale/JPEG step behind
+//                      QMLManager::handleCapturedFrame
+//  - garments_page_*:  NetworkManager::fetchGarmentsPage through
+//                      handleGarmentsResponse into GarmentListModel::applyPage
+//  - catalog_*:        LocalStore, which serves the garment grid: loading
+//                      it at startup, applying a /api/sync snapshot, and
+//                      paging it into GarmentListModel as QMLManager does
+//  - cloth_*:          ClothFitter OBJ cook, mapped load, bind and per-frame
+//                      transformation of a synthetic garment
+//  - tryon_roundtrip:  ImageProcessor::handleCapturedImage multipart POST
+//                      until processedImageReceived
+//
+// Each case reports the median, p90 and minimum of its samples. --json
+// writes them in the format --baseline reads, so a stored run can serve as
+// the baseline of later ones; a median more than --tolerance above the
+// baseline's is a regression and makes the exit status 1. A --baseline file
+// that does not exist yet is recorded from this run, with exit status 3 so
+// the missing comparison does not pass unnoticed; one that cannot be read
+// is an error (exit status 2).
+#include "ClothFitter.h"
+#include "CommonTypes.h"
+#include "GarmentListModel.h"
+#include "ImageProcessor.h"
+#include "LocalStore.h"
+#include "NetworkManager.h"
+#include "ScanPreprocessor.h"
+#include "SkinningKernels.h"
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QUrlQuery>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int kTimeoutMs = 10000;
+constexpr double kPi = 3.14159265358979323846;
+
+struct Result {
+    QString name;
+    QString detail;
+    std::vector<double> samplesMs;
+    QString error;
+
+    double quantile(double q) const {
+        std::vector<double> sorted = samplesMs;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t rank = size_t(std::ceil(q * sorted.size()));
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+    double medianMs() const { return quantile(0.5); }
+    double p90Ms() const { return quantile(0.9); }
+    double minMs() const { return *std::min_element(samplesMs.begin(), samplesMs.end()); }
+};
+
+// One sample per call, in milliseconds; setup the sample should not pay for
+// happens inside the callback, outside its own timer. An empty error string
+// means the sample is valid.
+using Sample = std::function<double(QString* error)>;
+
+Result measure(const QString& name, int iterations, const Sample& sample) {
+    Result result;
+    result.name = name;
+
+    // The first call warms caches, thread pools and connections
+    sample(&result.error);
+    for (int i = 0; i < iterations && result.error.isEmpty(); ++i) {
+        const double ms = sample(&result.error);
+        if (result.error.isEmpty()) result.samplesMs.push_back(ms);
+    }
+    if (result.samplesMs.empty() && result.error.isEmpty()) result.error = "no samples";
+    return result;
+}
+
+// Runs the event loop until `quit` is called or the timeout passes
+bool runLoop(QEventLoop& loop) {
+    QTimer::singleShot(kTimeoutMs, &loop, [&loop]() { loop.exit(1); });
+    return loop.exec() == 0;
+}
+
+// Camera-sized frame: a textured garment on a plain, slightly noisy
+// background, so the crop search finds it and JPEG has real detail to code.
+QImage makeScanFrame(int width, int height) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> noise(-4, 4);
+    QImage frame(width, height, QImage::Format_RGB32);
+    const int left = width / 4, right = width * 3 / 4;
+    const int top = height / 8, bottom = height * 7 / 8;
+    for (int y = 0; y < height; ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(frame.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            const bool sleeve = y < top + height / 4 && x > left - width / 8 && x < right + width / 8;
+            const bool garment = y > top && y < bottom && ((x > left && x < right) || sleeve);
+            int r = 228, g = 226, b = 222;
+            if (garment) {
+                const int stripe = ((x + y) / 24) % 2 ? 40 : 0;
+                r = 52 + stripe + (x * 37 / width);
+                g = 84 + stripe / 2;
+                b = 140 + (y * 50 / height);
+            }
+            const int n = noise(rng);
+            line[x] = qRgb(qBound(0, r + n, 255), qBound(0, g + n, 255), qBound(0, b + n, 255));
+        }
+    }
+    return frame;
+}
+
+// Open tube roughly the proportions of a shirt, `rings` x `segments` vertices
+bool writeGarmentObj(const QString& path, int rings, int segments) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QTextStream out(&file);
+    for (int r = 0; r < rings; ++r) {
+        const double y = 0.7 - 0.7 * r / (rings - 1);
+        const double radius = 0.25 + 0.03 * std::sin(3.0 * r / rings);
+        for (int s = 0; s < segments; ++s) {
+            const double a = 2.0 * kPi * s / segments;
+            out << "v " << radius * std::cos(a) << ' ' << y << ' ' << 0.6 * radius * std::sin(a) << '\n';
+        }
+    }
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            const double a = 2.0 * kPi * s / segments;
+            out << "vn " << std::cos(a) << " 0 " << std::sin(a) << '\n';
+        }
+    }
+    for (int r = 0; r + 1 < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            const int a = r * segments + s + 1;
+            const int b = r * segments + (s + 1) % segments + 1;
+            const int c = a + segments, d = b + segments;
+            out << "f " << a << "//" << a << ' ' << c << "//" << c << ' ' << d << "//" << d << '\n';
+            out << "f " << a << "//" << a << ' ' << d << "//" << d << ' ' << b << "//" << b << '\n';
+        }
+    }
+    return out.status() == QTextStream::Ok;
+}
+
+// Standing pose swaying a little from frame to frame, so every
+// updateTransformation() has bones to move.
+PoseKeypoints makePose(int frame) {
+    const float sway = 0.02f * std::sin(0.1f * frame);
+    PoseKeypoints pose{};
+    auto set = [&pose](BodyPart part, float x, float y) { pose[part] = {x, y, 0.95f}; };
+    set(Nose, 0.5f + sway, 0.12f);
+    set(LeftEye, 0.48f + sway, 0.10f);
+    set(RightEye, 0.52f + sway, 0.10f);
+    set(LeftEar, 0.46f + sway, 0.11f);
+    set(RightEar, 0.54f + sway, 0.11f);
+    set(LeftShoulder, 0.40f + sway, 0.25f);
+    set(RightShoulder, 0.60f + sway, 0.25f);
+    set(LeftElbow, 0.35f + 2 * sway, 0.40f);
+    set(RightElbow, 0.65f - 2 * sway, 0.40f);
+    set(LeftWrist, 0.33f + 3 * sway, 0.55f);
+    set(RightWrist, 0.67f - 3 * sway, 0.55f);
+    set(LeftHip, 0.43f, 0.58f);
+    set(RightHip, 0.57f, 0.58f);
+    set(LeftKnee, 0.43f, 0.75f);
+    set(RightKnee, 0.57f, 0.75f);
+    set(LeftAnkle, 0.43f, 0.92f);
+    set(RightAnkle, 0.57f, 0.92f);
+    return pose;
+}
+
+// Garments as the server sends them, presigned URLs included
+QJsonArray makeGarments(int count) {
+    const QString signature = QString("?X-Amz-Algorithm=AWS4-HMAC-SHA256&X-Amz-Credential=AKIAEXAMPLE%2F20250101"
+                                      "%2Feu-central-1%2Fs3%2Faws4_request&X-Amz-Date=20250101T000000Z"
+                                      "&X-Amz-Expires=3600&X-Amz-SignedHeaders=host&X-Amz-Signature=")
+                              + QString(64, 'f');
+    static const char* categories[] = {"shirt", "pants", "jacket", "dress"};
+    QJsonArray items;
+    for (int i = 0; i < count; ++i) {
+        const QString id = QString("garment_1700000000%1_%2").arg(i, 3, 10, QChar('0')).arg(i * 7919 % 100000);
+        items.append(QJsonObject{
+            {"garmentId", id},
+            {"name", QString("Benchmark garment %1").arg(i)},
+            {"category", categories[i % 4]},
+            {"previewKey", "previews/" + id + ".jpg"},
+            {"modelKey", "models/" + id + ".glb"},
+            {"previewUrl", "https://arclothtryon.s3.amazonaws.com/previews/" + id + ".jpg" + signature},
+            {"modelUrl", "https://arclothtryon.s3.amazonaws.com/models/" + id + ".glb" + signature},
+            {"createdBy", "64b7f0c2e4b0a1d2c3f4e5a6"},
+            {"createdAt", "2025-01-01T00:00:00.000Z"},
+            {"updatedAt", "2025-01-01T00:00:00.000Z"},
+            {"_id", QString("%1").arg(i, 24, 16, QChar('0'))},
+        });
+    }
+    return items;
+}
+
+// Catalog page shaped like the server's GET /garments
+QByteArray makeGarmentsPage(int count) {
+    return QJsonDocument(QJsonObject{{"items", makeGarments(count)}, {"nextCursor", "bench-next"}})
+        .toJson(QJsonDocument::Compact);
+}
+
+// Snapshot shaped like the server's GET /sync
+QJsonObject makeSyncPage(int count) {
+    return QJsonObject{
+        {"userId", "64b7f0c2e4b0a1d2c3f4e5a6"},
+        {"reset", true},
+        {"garments", makeGarments(count)},
+        {"scans", QJsonArray()},
+        {"models", QJsonArray()},
+        {"deleted", QJsonArray()},
+        {"cursor", "bench-cursor"},
+        {"hasMore", false},
+    };
+}
+
+// Minimal HTTP/1.1 keep-alive server standing in for the backend:
+//   GET  /api/garments?limit=N  -> a page of N garments
+//   POST /api/tryon             -> the configured JPEG
+// anything else gets a 404.
+class StandInServer {
+public:
+    bool listen() {
+        QObject::connect(&m_server, &QTcpServer::newConnection, &m_server, [this]() {
+            while (QTcpSocket* socket = m_server.nextPendingConnection()) {
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() { serve(socket); });
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, [this, socket]() {
+                    m_buffers.remove(socket);
+                    socket->deleteLater();
+                });
+            }
+        });
+        return m_server.listen(QHostAddress::LocalHost);
+    }
+
+    QString apiUrl() const { return QString("http://127.0.0.1:%1/api").arg(m_server.serverPort()); }
+
+    void setTryOnResult(const QByteArray& jpeg) { m_tryOnResult = jpeg; }
+
+    const QByteArray& garmentsPage(int limit) {
+        auto it = m_pages.find(limit);
+        if (it == m_pages.end()) it = m_pages.insert(limit, makeGarmentsPage(limit));
+        return *it;
+    }
+
+private:
+    void serve(QTcpSocket* socket) {
+        QByteArray& buffer = m_buffers[socket];
+        buffer += socket->readAll();
+        for (;;) {
+            const int headerEnd = buffer.indexOf("\r\n\r\n");
+            if (headerEnd < 0) return;
+
+            const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+            const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+            qint64 contentLength = 0;
+            for (const QByteArray& line : lines) {
+                const int colon = line.indexOf(':');
+                if (colon > 0 && line.left(colon).trimmed().toLower() == "content-length") {
+                    contentLength = line.mid(colon + 1).trimmed().toLongLong();
+                }
+            }
+            if (buffer.size() < headerEnd + 4 + contentLength) return;
+            buffer.remove(0, headerEnd + 4 + contentLength);
+
+            const QByteArray method = requestLine.value(0);
+            const QUrl url(QString::fromLatin1(requestLine.value(1)));
+            if (method == "GET" && url.path() == "/api/garments") {
+                const int limit = qBound(1, QUrlQuery(url).queryItemValue("limit").toInt(), 5000);
+                respond(socket, 200, "application/json", garmentsPage(limit),
+                        "ETag: \"page-" + QByteArray::number(++m_revision) + "\"\r\n");
+            } else if (method == "POST" && url.path() == "/api/tryon") {
+                respond(socket, 200, "image/jpeg", m_tryOnResult);
+            } else {
+                respond(socket, 404, "text/plain", "not found");
+            }
+        }
+    }
+
+    static void respond(QTcpSocket* socket, int status, const QByteArray& contentType,
+                        const QByteArray& body, const QByteArray& extraHeaders = QByteArray()) {
+        QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + (status == 200 ? " OK" : " Not Found")
+                          + "\r\nContent-Type: " + contentType
+                          + "\r\nContent-Length: " + QByteArray::number(body.size())
+                          + "\r\nConnection: keep-alive\r\n" + extraHeaders + "\r\n";
+        socket->write(head + body);
+    }
+
+    QTcpServer m_server;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+    QHash<int, QByteArray> m_pages;
+    QByteArray m_tryOnResult;
+    quint64 m_revision = 0;
+};
+
+QString kib(qint64 bytes) {
+    return QString::number(bytes / 1024.0, 'f', 1) + " KiB";
+}
+
+// ---- Cases ----
+
+void scanEncode(std::vector<Result>& results, int iterations, const QImage& frame) {
+    ScanPreprocessor::Options options;
+    ScanPreprocessor::Result last;
+    results.push_back(measure("scan_encode", iterations, [&](QString* error) {
+        QElapsedTimer timer;
+        timer.start();
+        last = ScanPreprocessor::process(frame, options);
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (last.jpeg.isEmpty()) *error = "JPEG encoding failed";
+        return ms;
+    }));
+    results.back().detail = QString("%1x%2 -> %3x%4, %5")
+                                .arg(frame.width()).arg(frame.height())
+                                .arg(last.size.width()).arg(last.size.height())
+                                .arg(kib(last.jpeg.size()));
+
+    // The quality search FrameEncoder runs once the uplink is measured
+    options.byteBudget = 256 * 1024;
+    results.push_back(measure("scan_encode_budget", iterations, [&](QString* error) {
+        QElapsedTimer timer;
+        timer.start();
+        last = ScanPreprocessor::process(frame, options);
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (last.jpeg.isEmpty()) *error = "JPEG encoding failed";
+        return ms;
+    }));
+    results.back().detail = QString("quality %1 after %2 encodes, %3")
+                                .arg(last.quality).arg(last.encodes).arg(kib(last.jpeg.size()));
+}
+
+void garmentsPage(std::vector<Result>& results, int iterations, StandInServer& server,
+                  NetworkManager& network, int limit) {
+    results.push_back(measure(QString("garments_page_%1").arg(limit), iterations, [&](QString* error) {
+        GarmentListModel model;
+        QEventLoop loop;
+        QObject scope;
+        QObject::connect(&network, &NetworkManager::garmentsPageReceived, &scope,
+                         [&](const QJsonArray& garments, const QString& cursor, const QString& nextCursor) {
+                             model.applyPage(cursor, garments, nextCursor);
+                             loop.quit();
+                         });
+        QObject::connect(&network, &NetworkManager::garmentsPageFailed, &scope,
+                         [&](const QString&) { loop.exit(2); });
+
+        QElapsedTimer timer;
+        timer.start();
+        network.fetchGarmentsPage(QString(), limit, true);
+        const bool ok = runLoop(loop);
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (!ok) *error = "garments page not received";
+        else if (model.rowCount() != limit) *error = QString("expected %1 rows, got %2").arg(limit).arg(model.rowCount());
+        return ms;
+    }));
+    results.back().detail = QString("%1 items, %2").arg(limit).arg(kib(server.garmentsPage(limit).size()));
+}
+
+void catalog(std::vector<Result>& results, int iterations, const QString& directory, int count) {
+    const QJsonObject snapshot = makeSyncPage(count);
+    const QString path = QDir(directory).filePath(QString("catalog-%1.arstore").arg(count));
+    const QString suffix = QString::number(count);
+
+    // Applying a full snapshot to an empty store, log write included
+    results.push_back(measure("catalog_sync_" + suffix, iterations, [&](QString* error) {
+        QFile::remove(path);
+        LocalStore store(path);
+        QElapsedTimer timer;
+        timer.start();
+        store.applySyncPage(snapshot);
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (store.count(LocalStore::Garments) != count) {
+            *error = QString("expected %1 garments, got %2").arg(count).arg(store.count(LocalStore::Garments));
+        }
+        return ms;
+    }));
+    results.back().detail = QString("%1 garments, %2").arg(count).arg(kib(QFileInfo(path).size()));
+
+    // What startup pays before the grid can show anything
+    results.push_back(measure("catalog_load_" + suffix, iterations, [&](QString* error) {
+        QElapsedTimer timer;
+        timer.start();
+        LocalStore store(path);
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (store.count(LocalStore::Garments) != count) *error = "store did not load";
+        return ms;
+    }));
+
+    // First grid page out of the loaded store (QMLManager::loadCatalogPage)
+    constexpr int kPageSize = 30;
+    LocalStore store(path);
+    results.push_back(measure("catalog_page_" + suffix, iterations, [&](QString* error) {
+        GarmentListModel model;
+        QElapsedTimer timer;
+        timer.start();
+        model.applyPage(QString(), store.garments(0, kPageSize), QString::number(kPageSize));
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (model.rowCount() != qMin(count, kPageSize)) *error = "page has the wrong row count";
+        return ms;
+    }));
+}
+
+void clothFitter(std::vector<Result>& results, int iterations, const QString& directory) {
+    const QString objPath = QDir(directory).filePath("model.obj");
+    if (!writeGarmentObj(objPath, 160, 128)) {
+        Result failed;
+        failed.name = "cloth_cook";
+        failed.error = "could not write " + objPath;
+        results.push_back(failed);
+        return;
+    }
+    const std::string path = objPath.toStdString();
+
+    results.push_back(measure("cloth_cook", iterations, [&](QString* error) {
+        // Drop the cooked mesh and its levels so the OBJ is cooked again
+        QDir dir(directory);
+        for (const QString& cooked : dir.entryList({"*.amesh"}, QDir::Files)) dir.remove(cooked);
+        ClothFitter fitter;
+        QElapsedTimer timer;
+        timer.start();
+        // Including the LOD chain, which is built on the fitter's worker
+        const bool ok = fitter.loadClothModel(path);
+        fitter.waitForBackgroundWork();
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (!ok) *error = "cook failed";
+        return ms;
+    }));
+
+    size_t vertices = 0, triangles = 0, levels = 0;
+    results.push_back(measure("cloth_load_mapped", iterations, [&](QString* error) {
+        ClothFitter fitter;
+        QElapsedTimer timer;
+        timer.start();
+        const bool ok = fitter.loadClothModel(path);
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (!ok) *error = "load failed";
+        else {
+            vertices = fitter.lodVertexCount(0);
+            triangles = fitter.lodTriangleCount(0);
+            levels = fitter.lodCount();
+        }
+        return ms;
+    }));
+    const QString meshDetail = QString("%1 vertices, %2 triangles, %3 levels").arg(vertices).arg(triangles).arg(levels);
+    results[results.size() - 2].detail = meshDetail;
+    results.back().detail = meshDetail;
+
+    // First pose after a load: bind plus skinning weights
+    results.push_back(measure("cloth_bind", iterations, [&](QString* error) {
+        ClothFitter fitter;
+        if (!fitter.loadClothModel(path)) {
+            *error = "load failed";
+            return 0.0;
+        }
+        QElapsedTimer timer;
+        timer.start();
+        const bool ok = fitter.updateTransformation(makePose(0));
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (!ok) *error = "bind failed";
+        return ms;
+    }));
+
+    ClothFitter fitter;
+    int frame = 0;
+    if (fitter.loadClothModel(path)) fitter.updateTransformation(makePose(frame++));
+    // Leave the worker's weights out of the per-frame timings
+    fitter.waitForBackgroundWork();
+    results.push_back(measure("cloth_transform", iterations * 10, [&](QString* error) {
+        const PoseKeypoints pose = makePose(frame++);
+        QElapsedTimer timer;
+        timer.start();
+        const bool ok = fitter.updateTransformation(pose);
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (!ok) *error = "transformation not applied";
+        return ms;
+    }));
+    results.back().detail = QString("%1 kernel, %2 vertices")
+                                .arg(Skinning::kernelName(fitter.skinningKernel()))
+                                .arg(fitter.lodVertexCount(fitter.lod()));
+}
+
+void tryOnRoundTrip(std::vector<Result>& results, int iterations, StandInServer& server,
+                    const QByteArray& jpeg) {
+    ImageProcessor processor;
+    processor.setServerUrl(QUrl(server.apiUrl() + "/tryon"));
+    results.push_back(measure("tryon_roundtrip", iterations, [&](QString* error) {
+        QEventLoop loop;
+        QObject scope;
+        QByteArray received;
+        QObject::connect(&processor, &ImageProcessor::processedImageReceived, &scope,
+                         [&](const QByteArray& image) {
+                             received = image;
+                             loop.quit();
+                         });
+        QObject::connect(&processor, &ImageProcessor::processingError, &scope,
+                         [&](const QString& message) {
+                             *error = message;
+                             loop.exit(2);
+                         });
+
+        QElapsedTimer timer;
+        timer.start();
+        processor.handleCapturedImage(jpeg, "garment_bench");
+        const bool ok = runLoop(loop);
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (!ok && error->isEmpty()) *error = "no try-on result";
+        return ms;
+    }));
+    results.back().detail = QString("%1 up, loopback").arg(kib(jpeg.size()));
+}
+
+// ---- Reporting ----
+
+QJsonObject toJson(const std::vector<Result>& results) {
+    QJsonArray cases;
+    for (const Result& result : results) {
+        QJsonObject entry{{"name", result.name}, {"detail", result.detail}};
+        if (!result.error.isEmpty()) {
+            entry["error"] = result.error;
+        } else {
+            entry["iterations"] = int(result.samplesMs.size());
+            entry["medianMs"] = result.medianMs();
+            entry["p90Ms"] = result.p90Ms();
+            entry["minMs"] = result.minMs();
+        }
+        cases.append(entry);
+    }
+    return QJsonObject{
+        {"suite", "arclothtryon_bench"},
+        {"host", QSysInfo::machineHostName()},
+        {"qt", qVersion()},
+        {"abi", QSysInfo::buildAbi()},
+        {"os", QSysInfo::prettyProductName()},
+        {"cpus", QThread::idealThreadCount()},
+        {"results", cases},
+    };
+}
+
+QHash<QString, double> loadBaseline(const QString& path, QString* error, QString* machine) {
+    QHash<QString, double> medians;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = file.errorString();
+        return medians;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        *error = parseError.errorString();
+        return medians;
+    }
+    const QJsonObject root = doc.object();
+    *machine = QString("%1, %2, %3 CPUs, Qt %4")
+                   .arg(root["host"].toString("unknown host"), root["os"].toString())
+                   .arg(root["cpus"].toInt()).arg(root["qt"].toString());
+    for (const QJsonValue& value : root["results"].toArray()) {
+        const QJsonObject entry = value.toObject();
+        if (entry.contains("medianMs")) medians.insert(entry["name"].toString(), entry["medianMs"].toDouble());
+    }
+    return medians;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    app.setOrganizationName("ARClothTryOn");
+    app.setApplicationName("arclothtryon_bench");
+    // Keeps the HTTP cache and settings away from the app's own
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless benchmarks for the ARClothTryOn client hot paths.");
+    parser.addHelpOption();
+    QCommandLineOption iterationsOption("iterations", "Samples per case (cloth_transform takes 10x).", "N", "20");
+    QCommandLineOption filterOption("filter", "Only run cases whose name contains TEXT.", "TEXT");
+    QCommandLineOption jsonOption("json", "Write the results as JSON to FILE.", "FILE");
+    QCommandLineOption baselineOption("baseline", "Compare medians against a stored --json run.", "FILE");
+    QCommandLineOption toleranceOption("tolerance", "Allowed slowdown over the baseline median.", "RATIO", "0.15");
+    parser.addOptions({iterationsOption, filterOption, jsonOption, baselineOption, toleranceOption});
+    parser.process(app);
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    const QString filter = parser.value(filterOption);
+    const double tolerance = qMax(0.0, parser.value(toleranceOption).toDouble());
+    auto enabled = [&filter](const QString& prefix) { return filter.isEmpty() || prefix.contains(filter) || filter.contains(prefix); };
+
+    // The code under test logs every request and load; keep the table readable
+    static const QtMessageHandler defaultHandler = qInstallMessageHandler(nullptr);
+    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext& context, const QString& message) {
+        if (type != QtDebugMsg && type != QtInfoMsg) defaultHandler(type, context, message);
+    });
+
+    // Read before the run, so a broken baseline does not waste one
+    QHash<QString, double> baseline;
+    const QString baselinePath = parser.value(baselineOption);
+    const bool recordBaseline = parser.isSet(baselineOption) && !QFileInfo::exists(baselinePath);
+    if (parser.isSet(baselineOption) && !recordBaseline) {
+        QString error, machine;
+        baseline = loadBaseline(baselinePath, &error, &machine);
+        if (!error.isEmpty()) {
+            std::fprintf(stderr, "could not read baseline %s: %s\n", qPrintable(baselinePath), qPrintable(error));
+            return 2;
+        }
+        std::printf("comparing against %s (recorded on %s)\n", qPrintable(baselinePath), qPrintable(machine));
+    }
+
+    StandInServer server;
+    if (!server.listen()) {
+        std::fprintf(stderr, "could not start the stand-in server\n");
+        return 2;
+    }
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        std::fprintf(stderr, "could not create a temporary directory\n");
+        return 2;
+    }
+
+    const QImage frame = makeScanFrame(1920, 1080);
+    const QByteArray scanJpeg = ScanPreprocessor::process(frame, ScanPreprocessor::Options{}).jpeg;
+    server.setTryOnResult(ScanPreprocessor::process(makeScanFrame(720, 1280), ScanPreprocessor::Options{}).jpeg);
+
+    std::vector<Result> results;
+    if (enabled("scan_encode")) scanEncode(results, iterations, frame);
+    if (enabled("garments_page")) {
+        NetworkManager network;
+        network.setServerUrl(server.apiUrl());
+        for (int limit : {30, 500}) {
+            if (enabled(QString("garments_page_%1").arg(limit))) garmentsPage(results, iterations, server, network, limit);
+        }
+    }
+    if (enabled("catalog_")) catalog(results, iterations, workDir.path(), 500);
+    if (enabled("cloth_")) clothFitter(results, iterations, workDir.path());
+    if (enabled("tryon_roundtrip")) tryOnRoundTrip(results, iterations, server, scanJpeg);
+    if (!filter.isEmpty()) {
+        results.erase(std::remove_if(results.begin(), results.end(),
+                                     [&filter](const Result& r) { return !r.name.contains(filter); }),
+                      results.end());
+    }
+
+    std::printf("%-20s %10s %10s %10s %10s  %s\n", "case", "median ms", "p90 ms", "min ms", "vs base", "");
+    bool failed = false, regressed = false;
+    for (const Result& result : results) {
+        if (!result.error.isEmpty()) {
+            std::printf("%-20s %10s  FAILED: %s\n", qPrintable(result.name), "", qPrintable(result.error));
+            failed = true;
+            continue;
+        }
+        QString versus = "-";
+        QString verdict;
+        if (baseline.contains(result.name) && baseline[result.name] > 0.0) {
+            const double change = result.medianMs() / baseline[result.name] - 1.0;
+            versus = QString("%1%2%").arg(change >= 0 ? "+" : "").arg(change * 100.0, 0, 'f', 1);
+            if (change > tolerance) {
+                verdict = "REGRESSED ";
+                regressed = true;
+            }
+        }
+        std::printf("%-20s %10.3f %10.3f %10.3f %10s  %s%s\n", qPrintable(result.name), result.medianMs(),
+                    result.p90Ms(), result.minMs(), qPrintable(versus), qPrintable(verdict),
+                    qPrintable(result.detail));
+    }
+
+    auto writeResults = [&results](const QString& path) {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)
+            || file.write(QJsonDocument(toJson(results)).toJson()) < 0 || !file.commit()) {
+            std::fprintf(stderr, "could not write %s: %s\n", qPrintable(path), qPrintable(file.errorString()));
+            return false;
+        }
+        return true;
+    };
+    if (parser.isSet(jsonOption) && !writeResults(parser.value(jsonOption))) return 2;
+
+    if (failed) return 2;
+    if (recordBaseline) {
+        if (!writeResults(baselinePath)) return 2;
+        std::fprintf(stderr, "NO BASELINE: %s did not exist, so nothing was compared. This run was recorded "
+                             "there; commit it (it names the machine it came from) and run again.\n",
+                     qPrintable(baselinePath));
+        return 3;
+    }
+    return regressed ? 1 : 0;
+}
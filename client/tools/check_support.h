@@ -0,0 +1,52 @@
+#pragma once
+#ifndef CHECK_SUPPORT_H
+#define CHECK_SUPPORT_H
+
+// Helpers shared by the *_check tools: a check() that prints and counts
+// failures, and event-loop waits for driving Qt code from a plain main().
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QString>
+#include <QTimer>
+#include <cstdio>
+#include <functional>
+
+inline int g_failures = 0;
+
+inline void check(bool ok, const QString& what) {
+    std::printf("  %-4s %s\n", ok ? "ok" : "FAIL", qPrintable(what));
+    if (!ok) ++g_failures;
+}
+
+// Runs the event loop until `done` holds or `timeoutMs` passes.
+inline bool waitFor(const std::function<bool()>& done, int timeoutMs) {
+    QElapsedTimer timer;
+    timer.start();
+    QEventLoop loop;
+    QTimer tick;
+    // Stopped while `done` runs, since it may spin an event loop of its own
+    QObject::connect(&tick, &QTimer::timeout, &loop, [&]() {
+        tick.stop();
+        if (done() || timer.elapsed() >= timeoutMs) {
+            loop.quit();
+            return;
+        }
+        tick.start();
+    });
+    tick.start(10);
+    if (!done()) loop.exec();
+    return done();
+}
+
+inline void idle(int ms) {
+    waitFor([]() { return false; }, ms);
+}
+
+// Prints the verdict; the exit status for main()
+inline int checkSummary() {
+    std::printf("%s\n", g_failures == 0 ? "all checks passed"
+                                        : qPrintable(QString("%1 check(s) failed").arg(g_failures)));
+    return g_failures == 0 ? 0 : 1;
+}
+
+#endif // CHECK_SUPPORT_H
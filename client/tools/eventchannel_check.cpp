@@ -0,0 +1,267 @@
+// eventchannel_check: runs ModelEventChannel and ModelStatusTracker, wired
+// as NetworkManager wires them, against an in-process stand-in server on
+// loopback (a QWebSocketServer for /events and a plain HTTP responder for
+// /3d-models/status), then takes the socket away and brings it back.
+//
+//   eventchannel_check
+//
+// Checks:
+//   connect     garments subscribed before the socket is up are sent on
+//               connect, and the tracker does not poll while it is up
+//   fallback    once the socket drops the tracker polls right away, and the
+//               channel retries on its backoff schedule while the server
+//               refuses it
+//   reconnect   the channel comes back by itself, re-subscribes what is
+//               still subscribed (not what was unsubscribed meanwhile) and
+//               polling stops again
+//   push        a pushed final status resolves the garment and drops its
+//               subscription; the next reconnect starts from the first
+//               backoff step again
+// Takes about 25 s; the exit status is 1 when a check fails.
+#include "ModelEventChannel.h"
+#include "ModelStatusTracker.h"
+#include "check_support.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrlQuery>
+#include <QWebSocket>
+#include <QWebSocketServer>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// Schedule of ModelEventChannel::m_backoff
+constexpr double kBackoffInitialMs = 1000.0;
+constexpr double kBackoffMultiplier = 2.0;
+constexpr double kBackoffJitter = 0.3;
+// Loopback connects and event delivery on top of the schedule
+constexpr double kScheduleSlackMs = 250.0;
+
+QElapsedTimer g_clock;
+
+bool inBackoffRange(qint64 intervalMs, int step) {
+    const double nominal = kBackoffInitialMs * std::pow(kBackoffMultiplier, step);
+    return intervalMs >= nominal * (1.0 - kBackoffJitter) - kScheduleSlackMs
+           && intervalMs <= nominal * (1.0 + kBackoffJitter) + kScheduleSlackMs;
+}
+
+class StandIn : public QObject {
+public:
+    struct Poll {
+        qint64 at = 0;
+        QStringList garmentIds;
+    };
+
+    StandIn() {
+        // Connections are accepted here and only handed to the WebSocket
+        // server while it is "up"; otherwise they are cut, like a server
+        // that is unreachable or restarting.
+        connect(&m_events, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket* socket = m_events.nextPendingConnection()) {
+                attempts.append(g_clock.elapsed());
+                if (m_up) {
+                    m_webSockets.handleConnection(socket);
+                } else {
+                    socket->abort();
+                    socket->deleteLater();
+                }
+            }
+        });
+        connect(&m_webSockets, &QWebSocketServer::newConnection, this, [this]() {
+            while (QWebSocket* socket = m_webSockets.nextPendingConnection()) {
+                m_client = socket;
+                connect(socket, &QWebSocket::disconnected, socket, &QObject::deleteLater);
+                connect(socket, &QWebSocket::textMessageReceived, this, [this](const QString& message) {
+                    const QJsonObject request = QJsonDocument::fromJson(message.toUtf8()).object();
+                    if (request["type"].toString() != "subscribe") return;
+                    QStringList garmentIds;
+                    for (const QJsonValue& id : request["garmentIds"].toArray()) {
+                        garmentIds.append(id.toString());
+                    }
+                    garmentIds.sort();
+                    subscribes.append(garmentIds);
+                });
+            }
+        });
+        connect(&m_http, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket* socket = m_http.nextPendingConnection()) {
+                connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() { servePoll(socket); });
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    bool listen() {
+        return m_events.listen(QHostAddress::LocalHost) && m_http.listen(QHostAddress::LocalHost);
+    }
+
+    QUrl eventsUrl() const { return QUrl(QString("ws://127.0.0.1:%1/events").arg(m_events.serverPort())); }
+    QString apiUrl() const { return QString("http://127.0.0.1:%1/api").arg(m_http.serverPort()); }
+
+    void setUp(bool up) { m_up = up; }
+    // Cuts the live connection without a close handshake
+    void drop() {
+        if (m_client) m_client->abort();
+    }
+    void push(const QJsonObject& event) {
+        if (m_client) m_client->sendTextMessage(QString::fromUtf8(QJsonDocument(event).toJson(QJsonDocument::Compact)));
+    }
+
+    int pollsSince(qint64 at) const {
+        int count = 0;
+        for (const Poll& poll : polls) {
+            if (poll.at >= at) ++count;
+        }
+        return count;
+    }
+
+    QList<qint64> attempts;
+    QList<QStringList> subscribes;
+    QList<Poll> polls;
+
+private:
+    // Every garment is still processing
+    void servePoll(QTcpSocket* socket) {
+        QByteArray& request = m_requests[socket];
+        request += socket->readAll();
+        if (!request.contains("\r\n\r\n")) return;
+
+        const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+        const QUrl url(QString::fromLatin1(requestLine.value(1)));
+        m_requests.remove(socket);
+
+        Poll poll{g_clock.elapsed(), {}};
+        QJsonArray models;
+        const QString ids = QUrlQuery(url).queryItemValue("garmentIds");
+        for (const QString& garmentId : ids.split(',', Qt::SkipEmptyParts)) {
+            poll.garmentIds.append(garmentId);
+            models.append(QJsonObject{{"garmentId", garmentId}, {"status", "processing"}});
+        }
+        polls.append(poll);
+
+        const QByteArray body = QJsonDocument(QJsonObject{{"models", models}}).toJson(QJsonDocument::Compact);
+        socket->write("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: close\r\n"
+                      "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body);
+        socket->disconnectFromHost();
+    }
+
+    QTcpServer m_events;
+    QWebSocketServer m_webSockets{"eventchannel_check", QWebSocketServer::NonSecureMode};
+    QTcpServer m_http;
+    QHash<QTcpSocket*, QByteArray> m_requests;
+    QPointer<QWebSocket> m_client;
+    bool m_up = true;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("eventchannel_check");
+    g_clock.start();
+
+    StandIn standIn;
+    if (!standIn.listen()) {
+        std::fprintf(stderr, "cannot listen on loopback\n");
+        return 2;
+    }
+
+    QNetworkAccessManager manager;
+    ModelStatusTracker tracker(&manager, [](const QUrl& url) { return QNetworkRequest(url); });
+    tracker.setServerUrl(standIn.apiUrl());
+    ModelEventChannel channel;
+    // As in NetworkManager
+    QObject::connect(&channel, &ModelEventChannel::connectedChanged, &tracker, &ModelStatusTracker::setSuspended);
+    QObject::connect(&channel, &ModelEventChannel::modelStatusReceived, &tracker, &ModelStatusTracker::applyStatus);
+    QStringList ready;
+    QObject::connect(&tracker, &ModelStatusTracker::modelReady, &tracker,
+                     [&ready](const QString& garmentId) { ready.append(garmentId); });
+
+    std::printf("connect\n");
+    for (const QString& garmentId : {"g1", "g2", "g3"}) {
+        tracker.track(garmentId);
+        channel.subscribe({garmentId});
+    }
+    channel.open(standIn.eventsUrl(), "token");
+    check(waitFor([&]() { return channel.isConnected(); }, 3000), "channel connects");
+    waitFor([&]() { return !standIn.subscribes.isEmpty(); }, 1000);
+    check(standIn.subscribes.value(0) == QStringList({"g1", "g2", "g3"}),
+          QString("earlier subscriptions sent on connect (%1)").arg(standIn.subscribes.value(0).join(',')));
+    idle(2000);
+    check(standIn.polls.isEmpty(), QString("no polls while connected (%1)").arg(standIn.polls.size()));
+
+    std::printf("fallback\n");
+    standIn.setUp(false);
+    const int attemptsBefore = standIn.attempts.size();
+    standIn.drop();
+    check(waitFor([&]() { return !channel.isConnected(); }, 2000), "drop noticed");
+    const qint64 droppedAt = g_clock.elapsed();
+    check(waitFor([&]() { return standIn.pollsSince(droppedAt) > 0; }, 1000),
+          QString("tracker polls right after the drop (%1 ms)")
+              .arg(standIn.polls.isEmpty() ? -1 : standIn.polls.last().at - droppedAt));
+    channel.unsubscribe("g3");
+
+    // Refused attempts: about 1, 2 and 4 s apart
+    waitFor([&]() { return standIn.attempts.size() >= attemptsBefore + 3; }, 10000);
+    const QList<qint64> refused = standIn.attempts.mid(attemptsBefore);
+    check(refused.size() >= 3, QString("channel keeps retrying while refused (%1 attempts)").arg(refused.size()));
+    if (!refused.isEmpty()) {
+        check(inBackoffRange(refused[0] - droppedAt, 0),
+              QString("first retry after %1 ms (1000 ms +/- 30%)").arg(refused[0] - droppedAt));
+    }
+    for (int i = 1; i < qMin<qsizetype>(refused.size(), 3); ++i) {
+        check(inBackoffRange(refused[i] - refused[i - 1], i),
+              QString("retry %1 after %2 ms (%3 ms +/- 30%)")
+                  .arg(i + 1).arg(refused[i] - refused[i - 1])
+                  .arg(kBackoffInitialMs * std::pow(kBackoffMultiplier, i), 0, 'f', 0));
+    }
+
+    std::printf("reconnect\n");
+    const int subscribesBefore = standIn.subscribes.size();
+    standIn.setUp(true);
+    check(waitFor([&]() { return channel.isConnected(); }, 12000), "channel reconnects by itself");
+    waitFor([&]() { return standIn.subscribes.size() > subscribesBefore; }, 1000);
+    check(standIn.subscribes.value(subscribesBefore) == QStringList({"g1", "g2"}),
+          QString("re-subscribes the remaining garments (%1)").arg(standIn.subscribes.value(subscribesBefore).join(',')));
+    idle(100);
+    const qint64 reconnectedAt = g_clock.elapsed();
+    idle(3000);
+    check(standIn.pollsSince(reconnectedAt) == 0,
+          QString("polling stops once reconnected (%1 polls)").arg(standIn.pollsSince(reconnectedAt)));
+
+    std::printf("push\n");
+    standIn.push(QJsonObject{
+        {"type", "model.status"},
+        {"garmentId", "g1"},
+        {"status", "completed"},
+        {"modelUrl", "http://127.0.0.1/models/g1.glb"},
+        {"modelKey", "models/g1.glb"},
+    });
+    check(waitFor([&]() { return ready.contains("g1"); }, 1000), "pushed status resolves the garment");
+    check(!channel.subscriptions().contains("g1"), "and drops its subscription");
+
+    const int attemptsBeforeSecondDrop = standIn.attempts.size();
+    const int subscribesBeforeSecondDrop = standIn.subscribes.size();
+    standIn.drop();
+    waitFor([&]() { return !channel.isConnected(); }, 2000);
+    const qint64 secondDropAt = g_clock.elapsed();
+    waitFor([&]() { return channel.isConnected(); }, 3000);
+    const qint64 retryAfter = standIn.attempts.value(attemptsBeforeSecondDrop, -1) - secondDropAt;
+    check(inBackoffRange(retryAfter, 0), QString("backoff starts over after a good connection (%1 ms)").arg(retryAfter));
+    waitFor([&]() { return standIn.subscribes.size() > subscribesBeforeSecondDrop; }, 1000);
+    check(standIn.subscribes.value(subscribesBeforeSecondDrop) == QStringList({"g2"}),
+          QString("re-subscribes only the unresolved garment (%1)")
+              .arg(standIn.subscribes.value(subscribesBeforeSecondDrop).join(',')));
+
+    channel.close();
+    tracker.cancelAll();
+    return checkSummary();
+}
@@ -0,0 +1,68 @@
+// meshcook: cooks OBJ and glTF (.glb/.gltf) garment meshes into the mapped
+// *.amesh format.
+//
+//   meshcook model.obj [model.amesh]
+//   meshcook garments/shirt/model.obj garments/pants/model.glb
+//
+// With a single input an explicit output path may be given; otherwise each
+// input is written next to itself with the .amesh suffix. Dense meshes also
+// get their LOD chain (model.lod1.amesh, ...), as ClothFitter would build it.
+#include "MeshCooker.h"
+#include "MeshSimplifier.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s input.obj|.glb [output.amesh]\n       %s input...\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    std::vector<std::pair<std::string, std::string>> jobs;
+    const bool explicitOutput = argc == 3 && MeshCooker::cookedPathFor(argv[2]) == argv[2];
+    if (explicitOutput) {
+        jobs.emplace_back(argv[1], argv[2]);
+    } else {
+        for (int i = 1; i < argc; ++i) {
+            jobs.emplace_back(argv[i], MeshCooker::cookedPathFor(argv[i]));
+        }
+    }
+
+    int failures = 0;
+    for (const auto& [source, output] : jobs) {
+        const auto start = std::chrono::steady_clock::now();
+
+        CookedMesh mesh;
+        std::string error;
+        if (!MeshCooker::parseFile(source, mesh, &error) || !MeshCooker::write(mesh, output, &error)) {
+            std::fprintf(stderr, "meshcook: %s\n", error.c_str());
+            ++failures;
+            continue;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        std::printf("%s -> %s: %zu vertices, %zu triangles%s, bounds [%g %g %g]..[%g %g %g] (%lld ms)\n",
+                    source.c_str(), output.c_str(), mesh.vertexCount(), mesh.indices.size() / 3,
+                    mesh.u.empty() ? ", no UVs" : "",
+                    mesh.boundsMin[0], mesh.boundsMin[1], mesh.boundsMin[2],
+                    mesh.boundsMax[0], mesh.boundsMax[1], mesh.boundsMax[2],
+                    static_cast<long long>(elapsed));
+
+        const std::vector<CookedMesh> lods = MeshSimplifier::buildLodChain(mesh);
+        for (size_t level = 0; level < lods.size(); ++level) {
+            const std::string path = MeshSimplifier::lodPathFor(output, int(level + 1));
+            if (!MeshCooker::write(lods[level], path, &error)) {
+                std::fprintf(stderr, "meshcook: %s\n", error.c_str());
+                ++failures;
+                break;
+            }
+            std::printf("  lod%zu -> %s: %zu vertices, %zu triangles\n", level + 1, path.c_str(),
+                        lods[level].vertexCount(), lods[level].indices.size() / 3);
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
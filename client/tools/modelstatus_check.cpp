@@ -0,0 +1,264 @@
+// modelstatus_check: drives ModelStatusTracker against the scripted status
+// stand-in (server/scripts/status-standin.js) and checks how it polls.
+//
+//   node server/scripts/status-standin.js --port 5001 &
+//   modelstatus_check [--server http://127.0.0.1:5001/api]
+//
+// Each scenario uploads a script to the stand-in, runs the tracker and then
+// reads back the requests the stand-in saw:
+//   batching  garments due together (here: on resuming from suspension)
+//             share one request, at most setMaxBatchSize() ids each
+//   lifecycle ready and error sequences end in one modelReady()/modelFailed()
+//             each, still-pending garments back off on the tracker's
+//             schedule, a cancel()ed garment is never polled or reported
+//             again, and polling stops once nothing is pending
+//   timeout   a garment that stays pending is given up after setTimeoutMs()
+// Takes about 20 s; the exit status is 1 when a check fails, 2 when the
+// stand-in cannot be reached.
+#include "ModelStatusTracker.h"
+#include "check_support.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <cmath>
+#include <cstdio>
+#include <optional>
+
+namespace {
+
+// Schedule of ModelStatusTracker::PendingModel::backoff
+constexpr double kBackoffInitialMs = 1000.0;
+constexpr double kBackoffMultiplier = 1.6;
+constexpr double kBackoffJitter = 0.25;
+// The tracker pulls garments due this soon into the current batch, and a
+// poll can wait for the one in flight; both shift the observed intervals.
+constexpr double kScheduleSlackMs = 300.0 + 250.0;
+
+struct Poll {
+    qint64 at = 0;
+    QStringList garmentIds;
+};
+
+class StandIn {
+public:
+    StandIn(QNetworkAccessManager* manager, const QString& serverUrl)
+        : m_manager(manager), m_serverUrl(serverUrl) {}
+
+    bool setScript(const QJsonObject& script) {
+        QNetworkRequest request(QUrl(m_serverUrl + "/_standin/script"));
+        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+        return finish(m_manager->put(request, QJsonDocument(script).toJson(QJsonDocument::Compact)))
+            .has_value();
+    }
+
+    QList<Poll> polls() {
+        QList<Poll> polls;
+        const auto body = finish(m_manager->get(QNetworkRequest(QUrl(m_serverUrl + "/_standin/requests"))));
+        if (!body) return polls;
+        for (const QJsonValue& value : QJsonDocument::fromJson(*body).array()) {
+            Poll poll;
+            poll.at = value["at"].toInteger();
+            for (const QJsonValue& id : value["garmentIds"].toArray()) {
+                poll.garmentIds.append(id.toString());
+            }
+            polls.append(poll);
+        }
+        return polls;
+    }
+
+private:
+    std::optional<QByteArray> finish(QNetworkReply* reply) {
+        waitFor([reply]() { return reply->isFinished(); }, 5000);
+        reply->deleteLater();
+        if (!reply->isFinished() || reply->error() != QNetworkReply::NoError) {
+            std::fprintf(stderr, "stand-in at %s: %s\n", qPrintable(m_serverUrl), qPrintable(reply->errorString()));
+            return std::nullopt;
+        }
+        return reply->readAll();
+    }
+
+    QNetworkAccessManager* m_manager;
+    QString m_serverUrl;
+};
+
+QJsonObject script(std::initializer_list<std::pair<QString, QStringList>> sequences) {
+    QJsonObject script;
+    for (const auto& [garmentId, sequence] : sequences) {
+        script[garmentId] = QJsonArray::fromStringList(sequence);
+    }
+    return script;
+}
+
+QList<qint64> pollTimes(const QList<Poll>& polls, const QString& garmentId) {
+    QList<qint64> times;
+    for (const Poll& poll : polls) {
+        if (poll.garmentIds.contains(garmentId)) times.append(poll.at);
+    }
+    return times;
+}
+
+struct Outcomes {
+    QHash<QString, int> ready;
+    QHash<QString, int> failed;
+    QHash<QString, QString> modelKeys;
+    QHash<QString, QString> errors;
+
+    void watch(ModelStatusTracker* tracker) {
+        QObject::connect(tracker, &ModelStatusTracker::modelReady, tracker,
+                         [this](const QString& garmentId, const QString&, const QString&,
+                                const QString& modelKey, const QString&) {
+                             ++ready[garmentId];
+                             modelKeys[garmentId] = modelKey;
+                         });
+        QObject::connect(tracker, &ModelStatusTracker::modelFailed, tracker,
+                         [this](const QString& garmentId, const QString& error) {
+                             ++failed[garmentId];
+                             errors[garmentId] = error;
+                         });
+    }
+};
+
+void batching(QNetworkAccessManager* manager, StandIn& standIn, const QString& serverUrl) {
+    std::printf("batching\n");
+    if (!standIn.setScript(QJsonObject())) return;
+
+    ModelStatusTracker tracker(manager, [](const QUrl& url) { return QNetworkRequest(url); });
+    tracker.setServerUrl(serverUrl);
+    tracker.setMaxBatchSize(3);
+    // Resuming makes every garment due at once
+    tracker.setSuspended(true);
+    const QStringList garments{"batch-1", "batch-2", "batch-3", "batch-4", "batch-5"};
+    for (const QString& garmentId : garments) {
+        tracker.track(garmentId);
+    }
+    idle(500);
+    check(standIn.polls().isEmpty(), "no polls while suspended");
+    tracker.setSuspended(false);
+
+    waitFor([&]() { return standIn.polls().size() >= 2; }, 3000);
+    tracker.cancelAll();
+    const QList<Poll> polls = standIn.polls();
+
+    check(polls.size() >= 2, QString("two requests cover five garments due together (saw %1)").arg(polls.size()));
+    if (polls.size() < 2) return;
+    check(polls[0].garmentIds.size() == 3, QString("first request carries the batch limit of 3 (%1)")
+                                               .arg(polls[0].garmentIds.join(',')));
+    QStringList covered = polls[0].garmentIds + polls[1].garmentIds;
+    covered.sort();
+    check(covered == garments, QString("second request carries the rest (%1)").arg(polls[1].garmentIds.join(',')));
+    check(polls[1].at - polls[0].at < 500,
+          QString("the rest goes right after the first reply (%1 ms)").arg(polls[1].at - polls[0].at));
+}
+
+void lifecycle(QNetworkAccessManager* manager, StandIn& standIn, const QString& serverUrl) {
+    std::printf("lifecycle\n");
+    if (!standIn.setScript(script({
+            {"ready", {"pending", "processing", "ready"}},
+            {"error", {"pending", "pending", "pending", "error"}},
+            {"cancelled", {"pending"}},
+        }))) {
+        return;
+    }
+
+    ModelStatusTracker tracker(manager, [](const QUrl& url) { return QNetworkRequest(url); });
+    tracker.setServerUrl(serverUrl);
+    Outcomes outcomes;
+    outcomes.watch(&tracker);
+    tracker.track("ready");
+    tracker.track("error");
+    tracker.track("cancelled");
+
+    // Cancel once it has been polled twice
+    waitFor([&]() { return pollTimes(standIn.polls(), "cancelled").size() >= 2; }, 5000);
+    const int pollsBeforeCancel = standIn.polls().size();
+    tracker.cancel("cancelled");
+    check(!tracker.isTracking("cancelled"), "cancel() stops tracking");
+
+    waitFor([&]() { return tracker.pendingGarments().isEmpty(); }, 20000);
+    check(tracker.pendingGarments().isEmpty(), "nothing pending once every sequence ended");
+    const int pollsAtEnd = standIn.polls().size();
+    idle(2000);
+    const QList<Poll> polls = standIn.polls();
+    check(polls.size() == pollsAtEnd, QString("no polls after the last garment resolved (%1 more)")
+                                          .arg(polls.size() - pollsAtEnd));
+
+    check(outcomes.ready.value("ready") == 1 && outcomes.modelKeys.value("ready") == "models/ready.glb",
+          "ready sequence: one modelReady() with the model key");
+    check(outcomes.failed.value("error") == 1 && outcomes.errors.value("error") == "Scripted failure",
+          "error sequence: one modelFailed() with the server's error");
+    check(pollTimes(polls, "ready").size() == 3, QString("ready garment polled until ready (%1 polls)")
+                                                     .arg(pollTimes(polls, "ready").size()));
+    check(!outcomes.ready.contains("cancelled") && !outcomes.failed.contains("cancelled"),
+          "cancelled garment is never reported");
+    bool polledAfterCancel = false;
+    for (int i = pollsBeforeCancel; i < polls.size(); ++i) {
+        polledAfterCancel = polledAfterCancel || polls[i].garmentIds.contains("cancelled");
+    }
+    check(!polledAfterCancel, "cancelled garment is not polled again");
+
+    // The error garment stayed pending for three polls: each wait is one
+    // step of the tracker's backoff, jitter and batching included.
+    const QList<qint64> times = pollTimes(polls, "error");
+    check(times.size() == 4, QString("error garment polled until it failed (%1 polls)").arg(times.size()));
+    for (int i = 1; i < times.size(); ++i) {
+        const double nominal = kBackoffInitialMs * std::pow(kBackoffMultiplier, i);
+        const qint64 interval = times[i] - times[i - 1];
+        const bool inRange = interval >= nominal * (1.0 - kBackoffJitter) - kScheduleSlackMs
+                             && interval <= nominal * (1.0 + kBackoffJitter) + kScheduleSlackMs;
+        check(inRange, QString("backoff step %1: %2 ms (expected %3 ms +/- %4%)")
+                           .arg(i).arg(interval).arg(nominal, 0, 'f', 0).arg(kBackoffJitter * 100, 0, 'f', 0));
+    }
+}
+
+void timeout(QNetworkAccessManager* manager, StandIn& standIn, const QString& serverUrl) {
+    std::printf("timeout\n");
+    if (!standIn.setScript(QJsonObject())) return;
+
+    ModelStatusTracker tracker(manager, [](const QUrl& url) { return QNetworkRequest(url); });
+    tracker.setServerUrl(serverUrl);
+    tracker.setTimeoutMs(3000);
+    Outcomes outcomes;
+    outcomes.watch(&tracker);
+    QElapsedTimer timer;
+    timer.start();
+    tracker.track("stuck");
+
+    waitFor([&]() { return outcomes.failed.contains("stuck"); }, 6000);
+    const qint64 elapsed = timer.elapsed();
+    check(outcomes.failed.value("stuck") == 1, "garment that stays pending fails once");
+    check(elapsed >= 3000 && elapsed < 4000, QString("given up after the timeout (%1 ms)").arg(elapsed));
+    check(!tracker.isTracking("stuck"), "and is no longer tracked");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("modelstatus_check");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks ModelStatusTracker against server/scripts/status-standin.js.");
+    parser.addHelpOption();
+    QCommandLineOption serverOption("server", "Stand-in API base URL.", "URL", "http://127.0.0.1:5001/api");
+    parser.addOption(serverOption);
+    parser.process(app);
+    const QString serverUrl = parser.value(serverOption);
+
+    QNetworkAccessManager manager;
+    StandIn standIn(&manager, serverUrl);
+    if (!standIn.setScript(QJsonObject())) {
+        std::fprintf(stderr, "start it with: node server/scripts/status-standin.js\n");
+        return 2;
+    }
+
+    batching(&manager, standIn, serverUrl);
+    lifecycle(&manager, standIn, serverUrl);
+    timeout(&manager, standIn, serverUrl);
+
+    return checkSummary();
+}
@@ -0,0 +1,144 @@
+// posereplay: plays a pose recording (*.arrec, see PoseRecording.h) through
+// BodyTracker and ClothFitter without a camera and reports their timings.
+//
+//   posereplay recording.arrec [--realtime] [--garment model.obj] [--frames N]
+//                              [--json results.json] [--budget-ms MS]
+//
+// Recordings come from QMLManager::startPoseRecording() on a device. By
+// default frames are fed as fast as the tracker takes them (throughput);
+// --realtime feeds them at their recorded times and also reports how late
+// each frame started. --garment skins that mesh to every tracked pose.
+// With --budget-ms the exit status is 1 when the p90 of tracking plus
+// skinning time per frame exceeds the budget.
+#include "BodyTracker.h"
+#include "ClothFitter.h"
+#include "PoseReplay.h"
+#include "SkinningKernels.h"
+#include <QCommandLineParser>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <cstdio>
+
+namespace {
+
+QJsonObject distribution(const std::vector<double>& samples) {
+    return QJsonObject{
+        {"count", int(samples.size())},
+        {"p50Ms", PoseReplay::Stats::percentile(samples, 0.5)},
+        {"p90Ms", PoseReplay::Stats::percentile(samples, 0.9)},
+        {"p99Ms", PoseReplay::Stats::percentile(samples, 0.99)},
+    };
+}
+
+void printDistribution(const char* label, const std::vector<double>& samples) {
+    if (samples.empty()) return;
+    std::printf("%-10s p50 %8.3f ms  p90 %8.3f ms  p99 %8.3f ms  (%zu samples)\n", label,
+                PoseReplay::Stats::percentile(samples, 0.5), PoseReplay::Stats::percentile(samples, 0.9),
+                PoseReplay::Stats::percentile(samples, 0.99), samples.size());
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    app.setApplicationName("posereplay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays a camera/pose recording through the tracker and fitter.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("recording", "Recording written by PoseRecorder (*.arrec).");
+    QCommandLineOption realtimeOption("realtime", "Feed frames at their recorded times.");
+    QCommandLineOption garmentOption("garment", "Skin this OBJ or cooked *.amesh to every pose.", "FILE");
+    QCommandLineOption framesOption("frames", "Stop after N frames.", "N", "0");
+    QCommandLineOption leadOption("lead-ms", "Prediction lead for the fitter's pose.", "MS", "16.7");
+    QCommandLineOption jsonOption("json", "Write the results as JSON to FILE.", "FILE");
+    QCommandLineOption budgetOption("budget-ms", "Fail when p90 tracking + skinning exceeds MS.", "MS");
+    parser.addOptions({realtimeOption, garmentOption, framesOption, leadOption, jsonOption, budgetOption});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(2);
+    }
+    const QString recording = parser.positionalArguments().first();
+
+    BodyTracker tracker;
+    ClothFitter fitter;
+    const bool skinning = parser.isSet(garmentOption);
+    if (skinning && !fitter.loadClothModel(parser.value(garmentOption).toStdString())) {
+        std::fprintf(stderr, "could not load %s\n", qPrintable(parser.value(garmentOption)));
+        return 2;
+    }
+    // Replays time every frame, so start with the whole LOD chain in place
+    fitter.waitForBackgroundWork();
+
+    PoseReplay::Options options;
+    options.pacing = parser.isSet(realtimeOption) ? PoseReplay::Pacing::RealTime : PoseReplay::Pacing::MaxSpeed;
+    options.maxFrames = qMax(0, parser.value(framesOption).toInt());
+    options.renderLeadMs = parser.value(leadOption).toDouble();
+
+    PoseReplay replay(&tracker, skinning ? &fitter : nullptr);
+    PoseReplay::Stats stats;
+    QString error;
+    if (!replay.run(recording, options, &stats, &error)) {
+        std::fprintf(stderr, "%s: %s\n", qPrintable(recording), qPrintable(error));
+        return 2;
+    }
+
+    std::printf("%s: %d frames (%.1f s recorded), %d tracked, %d skinned, %s\n", qPrintable(recording),
+                stats.frames, stats.recordedMs / 1000.0, stats.trackedFrames, stats.skinnedFrames,
+                options.pacing == PoseReplay::Pacing::RealTime ? "real time" : "max speed");
+    std::printf("%-10s %.1f frames/s (recorded %.1f)\n", "rate", stats.framesPerSecond(),
+                stats.recordedMs > 0.0 ? (stats.frames - 1) * 1000.0 / stats.recordedMs : 0.0);
+    printDistribution("track", stats.trackMs);
+    printDistribution("skin", stats.skinMs);
+    printDistribution("frame", stats.frameMs);
+    printDistribution("lag", stats.lagMs);
+    if (skinning) {
+        std::printf("%-10s %s, %zu vertices\n", "kernel", Skinning::kernelName(fitter.skinningKernel()),
+                    fitter.lodVertexCount(fitter.lod()));
+    }
+    if (stats.maxKeypointError >= 0.0) {
+        std::printf("%-10s max %.4f from the recorded keypoints\n", "estimator", stats.maxKeypointError);
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QJsonObject root{
+            {"recording", recording},
+            {"pacing", options.pacing == PoseReplay::Pacing::RealTime ? "realtime" : "max"},
+            {"frames", stats.frames},
+            {"trackedFrames", stats.trackedFrames},
+            {"skinnedFrames", stats.skinnedFrames},
+            {"recordedMs", stats.recordedMs},
+            {"wallMs", stats.wallMs},
+            {"framesPerSecond", stats.framesPerSecond()},
+            {"trackMs", distribution(stats.trackMs)},
+            {"skinMs", distribution(stats.skinMs)},
+            {"frameMs", distribution(stats.frameMs)},
+        };
+        if (!stats.lagMs.empty()) root["lagMs"] = distribution(stats.lagMs);
+        if (stats.maxKeypointError >= 0.0) root["maxKeypointError"] = stats.maxKeypointError;
+
+        QSaveFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(root).toJson()) < 0 || !file.commit()) {
+            std::fprintf(stderr, "could not write %s: %s\n", qPrintable(parser.value(jsonOption)),
+                         qPrintable(file.errorString()));
+            return 2;
+        }
+    }
+
+    if (parser.isSet(budgetOption)) {
+        const double budget = parser.value(budgetOption).toDouble();
+        const double p90 = PoseReplay::Stats::percentile(stats.frameMs, 0.9);
+        if (p90 > budget) {
+            std::printf("over budget: p90 %.3f ms > %.3f ms per frame\n", p90, budget);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+// skinning_bench: vertices/second for every skinning kernel the CPU supports.
+//
+//   skinning_bench [vertexCount] [iterations]
+//
+// Also checks each kernel against the scalar reference and reports the
+// multi-threaded throughput of the fastest kernel, split the same way
+// ClothFitter splits large garments.
+#include "SkinningKernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Scene {
+    std::vector<float> px, py, pz, nx, ny, nz;
+    std::vector<uint16_t> index[Skinning::kMaxInfluences];
+    std::vector<float> weight[Skinning::kMaxInfluences];
+    std::vector<Skinning::BoneMatrix> bones;
+    std::vector<float> ox, oy, oz, onx, ony, onz;
+
+    Skinning::Job job() {
+        Skinning::Job job;
+        job.vertexCount = px.size();
+        job.px = px.data(); job.py = py.data(); job.pz = pz.data();
+        job.nx = nx.data(); job.ny = ny.data(); job.nz = nz.data();
+        for (int j = 0; j < Skinning::kMaxInfluences; ++j) {
+            job.boneIndex[j] = index[j].data();
+            job.boneWeight[j] = weight[j].data();
+        }
+        job.bones = bones.data();
+        job.boneCount = bones.size();
+        job.outPx = ox.data(); job.outPy = oy.data(); job.outPz = oz.data();
+        job.outNx = onx.data(); job.outNy = ony.data(); job.outNz = onz.data();
+        return job;
+    }
+};
+
+Scene makeScene(size_t vertexCount, size_t boneCount) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> bone(0, int(boneCount) - 1);
+
+    Scene scene;
+    for (auto* stream : {&scene.px, &scene.py, &scene.pz, &scene.nx, &scene.ny, &scene.nz}) {
+        stream->resize(vertexCount);
+        for (float& value : *stream) value = unit(rng);
+    }
+    for (int j = 0; j < Skinning::kMaxInfluences; ++j) {
+        scene.index[j].resize(vertexCount);
+        scene.weight[j].resize(vertexCount);
+    }
+    for (size_t i = 0; i < vertexCount; ++i) {
+        float total = 0.0f;
+        for (int j = 0; j < Skinning::kMaxInfluences; ++j) {
+            scene.index[j][i] = uint16_t(bone(rng));
+            scene.weight[j][i] = std::abs(unit(rng)) + 0.01f;
+            total += scene.weight[j][i];
+        }
+        for (int j = 0; j < Skinning::kMaxInfluences; ++j) scene.weight[j][i] /= total;
+    }
+
+    scene.bones.resize(boneCount);
+    for (size_t b = 0; b < boneCount; ++b) {
+        const float angle = 0.1f * float(b);
+        const float c = std::cos(angle), s = std::sin(angle);
+        scene.bones[b] = {{c, -s, 0.0f, 0.01f * b,
+                           s,  c, 0.0f, 0.02f,
+                           0.0f, 0.0f, 1.0f, -0.01f * b}};
+    }
+
+    for (auto* stream : {&scene.ox, &scene.oy, &scene.oz, &scene.onx, &scene.ony, &scene.onz}) {
+        stream->assign(vertexCount, 0.0f);
+    }
+    return scene;
+}
+
+template <typename Fn>
+double bestSeconds(int iterations, Fn&& fn) {
+    double best = 1e9;
+    for (int i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+float maxDifference(const Scene& a, const Scene& b) {
+    float worst = 0.0f;
+    const std::vector<float> Scene::* streams[] = {&Scene::ox, &Scene::oy, &Scene::oz,
+                                                   &Scene::onx, &Scene::ony, &Scene::onz};
+    for (auto stream : streams) {
+        for (size_t i = 0; i < (a.*stream).size(); ++i) {
+            worst = std::max(worst, std::abs((a.*stream)[i] - (b.*stream)[i]));
+        }
+    }
+    return worst;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t vertexCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    Scene reference = makeScene(vertexCount, 24);
+    Skinning::skin(reference.job(), 0, vertexCount, Skinning::Kernel::Scalar);
+
+    std::printf("%zu vertices, 4 influences, normals, best of %d\n", vertexCount, iterations);
+    std::printf("%-8s %14s %12s\n", "kernel", "Mverts/s", "max |err|");
+
+    for (Skinning::Kernel kernel : {Skinning::Kernel::Scalar, Skinning::Kernel::SSE,
+                                    Skinning::Kernel::AVX2, Skinning::Kernel::NEON}) {
+        if (!Skinning::isAvailable(kernel)) continue;
+
+        Scene scene = makeScene(vertexCount, 24);
+        const Skinning::Job job = scene.job();
+        const double seconds = bestSeconds(iterations, [&]() {
+            Skinning::skin(job, 0, vertexCount, kernel);
+        });
+        std::printf("%-8s %14.1f %12.2e\n", Skinning::kernelName(kernel),
+                    vertexCount / seconds / 1e6, maxDifference(reference, scene));
+    }
+
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    Scene scene = makeScene(vertexCount, 24);
+    const Skinning::Job job = scene.job();
+    const Skinning::Kernel kernel = Skinning::bestKernel();
+    const double seconds = bestSeconds(iterations, [&]() {
+        std::vector<std::thread> workers;
+        const size_t chunk = ((vertexCount / threads + 63) / 64) * 64;
+        for (size_t begin = 0; begin < vertexCount; begin += chunk) {
+            workers.emplace_back([&job, begin, chunk, kernel]() {
+                Skinning::skin(job, begin, begin + chunk, kernel);
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+    });
+    std::printf("%-8s %14.1f %12s  (%u threads)\n", Skinning::kernelName(kernel),
+                vertexCount / seconds / 1e6, "", threads);
+    return 0;
+}
@@ -0,0 +1,198 @@
+// upload_check: uploads through ChunkedUploader against the flaky upload
+// stand-in (server/scripts/upload-standin.js) and checks that interrupted
+// chunks are resumed rather than the upload started over.
+//
+//   node server/scripts/upload-standin.js --port 5000 --drop-rate 0.3 &
+//   upload_check [--server http://127.0.0.1:5000/api] [--size 1048576]
+//
+// Uploads one image-sized payload in small chunks, then reads back the
+// requests the stand-in saw and the bytes it stored:
+//   resume    the payload arrives byte for byte through a single session;
+//             after a dropped chunk or a lost acknowledgement the uploader
+//             carries on from the server's offset, so chunk offsets never go
+//             back; at least one chunk was interrupted (otherwise rerun with a
+//             higher --drop-rate)
+// Takes 10-30 s depending on the drop rate; the exit status is 1 when a check
+// fails, 2 when the stand-in cannot be reached.
+#include "ChunkedUploader.h"
+#include "check_support.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+#include <cstdio>
+#include <optional>
+
+namespace {
+
+constexpr int kChunkSize = 32 * 1024;
+// Drops come in runs at high drop rates; a run must not end the upload
+constexpr int kMaxAttempts = 20;
+
+struct Request {
+    qint64 at = 0;
+    QString method;
+    QString id;
+    QString garmentId;
+    qint64 offset = -1;
+    QString outcome;
+};
+
+class StandIn {
+public:
+    StandIn(QNetworkAccessManager* manager, const QString& serverUrl)
+        : m_manager(manager), m_serverUrl(serverUrl) {}
+
+    std::optional<QList<Request>> requests() {
+        const auto body = get("/_standin/requests");
+        if (!body) return std::nullopt;
+        QList<Request> requests;
+        for (const QJsonValue& value : QJsonDocument::fromJson(*body).array()) {
+            Request request;
+            request.at = value["at"].toInteger();
+            request.method = value["method"].toString();
+            request.id = value["id"].toString();
+            request.garmentId = value["garmentId"].toString();
+            request.offset = value["offset"].toInteger(-1);
+            // Rejected requests carry their HTTP status
+            request.outcome = value["outcome"].isDouble() ? QString::number(value["outcome"].toInt())
+                                                          : value["outcome"].toString();
+            requests.append(request);
+        }
+        return requests;
+    }
+
+    std::optional<QByteArray> storedBytes(const QString& uploadId) {
+        return get("/_standin/uploads/" + uploadId);
+    }
+
+private:
+    std::optional<QByteArray> get(const QString& path) {
+        QNetworkReply* reply = m_manager->get(QNetworkRequest(QUrl(m_serverUrl + path)));
+        waitFor([reply]() { return reply->isFinished(); }, 5000);
+        reply->deleteLater();
+        if (!reply->isFinished() || reply->error() != QNetworkReply::NoError) {
+            std::fprintf(stderr, "stand-in at %s: %s\n", qPrintable(m_serverUrl), qPrintable(reply->errorString()));
+            return std::nullopt;
+        }
+        return reply->readAll();
+    }
+
+    QNetworkAccessManager* m_manager;
+    QString m_serverUrl;
+};
+
+// Random bytes, so a chunk stored at the wrong offset cannot go unnoticed
+QByteArray payload(int size) {
+    QByteArray data(size, Qt::Uninitialized);
+    QRandomGenerator generator(20240917u);
+    for (char& byte : data) {
+        byte = static_cast<char>(generator.bounded(256));
+    }
+    return data;
+}
+
+void resume(QNetworkAccessManager* manager, StandIn& standIn, const QString& serverUrl, int size) {
+    std::printf("resume\n");
+    ChunkedUploader uploader(manager, [](const QUrl& url) { return QNetworkRequest(url); });
+    uploader.setServerUrl(serverUrl);
+    uploader.setChunkSize(kChunkSize);
+    uploader.setMaxAttempts(kMaxAttempts);
+    uploader.setTransferTimeoutMs(5000);
+
+    // Unique per run, so requests left over from earlier runs are ignored
+    const QString garmentId = QString("upload-check-%1").arg(QDateTime::currentMSecsSinceEpoch());
+    const QByteArray data = payload(size);
+    std::optional<QJsonObject> result;
+    QString error;
+    qint64 lastSent = 0;
+    QObject::connect(&uploader, &ChunkedUploader::uploadFinished, &uploader,
+                     [&](const QString&, const QJsonObject& stored) { result = stored; });
+    QObject::connect(&uploader, &ChunkedUploader::uploadFailed, &uploader,
+                     [&](const QString&, const QString& reason) { error = reason; });
+    QObject::connect(&uploader, &ChunkedUploader::progressChanged, &uploader,
+                     [&](const QString&, qint64 sent, qint64) { lastSent = sent; });
+
+    uploader.upload(data, "image/jpeg", garmentId, "shirt");
+    waitFor([&]() { return !uploader.isUploading(garmentId); }, 120000);
+
+    check(result.has_value(), error.isEmpty() ? QString("upload finished")
+                                              : QString("upload finished (failed: %1)").arg(error));
+    check(lastSent == size, QString("progress reached the full size (%1 of %2 bytes)").arg(lastSent).arg(size));
+    check(uploader.throughput() > 0.0, QString("throughput was sampled (%1 B/s)").arg(uploader.throughput(), 0, 'f', 0));
+
+    const auto requests = standIn.requests();
+    if (!requests) return;
+    QStringList sessions;
+    for (const Request& request : *requests) {
+        if (request.method == "POST" && request.garmentId == garmentId) sessions.append(request.id);
+    }
+    check(sessions.size() == 1, QString("one session for the whole upload (%1 created)").arg(sessions.size()));
+    if (sessions.isEmpty()) return;
+    const QString uploadId = sessions.first();
+
+    int dropped = 0;
+    int lostAcks = 0;
+    int rejected = 0;
+    qint64 previous = 0;
+    QList<qint64> backwards;
+    for (const Request& request : *requests) {
+        if (request.method != "PUT" || request.id != uploadId) continue;
+        if (request.outcome == "dropped") ++dropped;
+        else if (request.outcome == "lost-ack") ++lostAcks;
+        else if (request.outcome != "stored") ++rejected;
+        if (request.offset < previous) backwards.append(request.offset);
+        previous = qMax(previous, request.offset);
+    }
+    check(dropped + lostAcks > 0, QString("chunks were interrupted (%1 dropped, %2 acks lost, %3 rejected)")
+                                      .arg(dropped).arg(lostAcks).arg(rejected));
+    QStringList offsets;
+    for (qint64 offset : backwards) {
+        offsets.append(QString::number(offset));
+    }
+    check(backwards.isEmpty(), backwards.isEmpty() ? QString("chunk offsets never went back")
+                                                   : QString("chunk offsets went back to %1").arg(offsets.join(", ")));
+
+    const auto stored = standIn.storedBytes(uploadId);
+    check(stored.has_value() && stored->size() == size,
+          QString("stand-in stored %1 of %2 bytes").arg(stored ? stored->size() : 0).arg(size));
+    check(stored.has_value()
+              && QCryptographicHash::hash(*stored, QCryptographicHash::Sha256)
+                     == QCryptographicHash::hash(data, QCryptographicHash::Sha256),
+          "stored bytes match the source");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("upload_check");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks ChunkedUploader's resume against server/scripts/upload-standin.js.");
+    parser.addHelpOption();
+    QCommandLineOption serverOption("server", "Stand-in API base URL.", "URL", "http://127.0.0.1:5000/api");
+    QCommandLineOption sizeOption("size", "Bytes to upload.", "bytes", "1048576");
+    parser.addOption(serverOption);
+    parser.addOption(sizeOption);
+    parser.process(app);
+    const QString serverUrl = parser.value(serverOption);
+    const int size = qMax(kChunkSize, parser.value(sizeOption).toInt());
+
+    QNetworkAccessManager manager;
+    StandIn standIn(&manager, serverUrl);
+    if (!standIn.requests()) {
+        std::fprintf(stderr, "start it with: node server/scripts/upload-standin.js --drop-rate 0.3\n");
+        return 2;
+    }
+
+    resume(&manager, standIn, serverUrl, size);
+
+    return checkSummary();
+}
@@ -0,0 +1,127 @@
+// server/scripts/status-standin.js
+// Local stand-in for the batched processing status endpoint
+// (GET /api/3d-models/status?garmentIds=a,b,c) that plays scripted status
+// sequences, for exercising the client's ModelStatusTracker without MongoDB
+// or the processing pipeline:
+//
+//   node scripts/status-standin.js [--port 5001] [--script sequences.json]
+//
+// A script maps garment ids to the statuses their successive polls get, e.g.
+//   { "a": ["pending", "processing", "ready"], "b": ["pending", "error"] }
+// The last status repeats; garments without a script stay pending. "ready"
+// answers with a completed model, "error" with a failed one.
+//
+// Two extra routes drive it from a test:
+//   PUT /api/_standin/script     replace the script (JSON body), clear the log
+//   GET /api/_standin/requests   [{ at, garmentIds }], `at` in ms since start
+// Authentication is not checked.
+const fs = require('fs');
+const http = require('http');
+
+const option = (name, fallback) => {
+  const index = process.argv.indexOf(`--${name}`);
+  return index >= 0 && index + 1 < process.argv.length ? process.argv[index + 1] : fallback;
+};
+
+const PORT = Number(option('port', 5001));
+const SCRIPT_FILE = option('script', null);
+// Same limit as the real route
+const MAX_STATUS_BATCH = 50;
+const STATUSES = ['pending', 'processing', 'ready', 'error'];
+
+const startedAt = Date.now();
+let script = {};
+let polls = {};
+let requests = [];
+
+const setScript = (value) => {
+  if (!value || typeof value !== 'object' || Array.isArray(value)) {
+    throw Object.assign(new Error('Script must be an object of garmentId -> [status]'), { status: 400 });
+  }
+  for (const [garmentId, sequence] of Object.entries(value)) {
+    if (!Array.isArray(sequence) || sequence.length === 0 || sequence.some(s => !STATUSES.includes(s))) {
+      throw Object.assign(new Error(`Bad sequence for ${garmentId}, use ${STATUSES.join('/')}`), { status: 400 });
+    }
+  }
+  script = value;
+  polls = {};
+  requests = [];
+};
+
+const statusFor = (garmentId) => {
+  const sequence = script[garmentId] || ['pending'];
+  const poll = polls[garmentId] || 0;
+  polls[garmentId] = poll + 1;
+
+  switch (sequence[Math.min(poll, sequence.length - 1)]) {
+  case 'ready':
+    return {
+      garmentId,
+      status: 'completed',
+      modelUrl: `http://localhost:${PORT}/models/${garmentId}.glb`,
+      previewUrl: `http://localhost:${PORT}/models/${garmentId}.jpg`,
+      modelKey: `models/${garmentId}.glb`,
+      previewKey: `models/${garmentId}.jpg`
+    };
+  case 'error':
+    return { garmentId, status: 'failed', error: 'Scripted failure' };
+  case 'processing':
+    return { garmentId, status: 'processing' };
+  default:
+    return { garmentId, status: 'pending' };
+  }
+};
+
+const sendJson = (res, status, body) => {
+  res.writeHead(status, { 'Content-Type': 'application/json' });
+  res.end(JSON.stringify(body));
+};
+
+const readBody = (req) => new Promise((resolve, reject) => {
+  const chunks = [];
+  req.on('data', (data) => chunks.push(data));
+  req.on('end', () => resolve(Buffer.concat(chunks)));
+  req.on('error', reject);
+});
+
+const server = http.createServer(async (req, res) => {
+  const url = new URL(req.url, 'http://localhost');
+  try {
+    if (req.method === 'GET' && url.pathname === '/api/3d-models/status') {
+      const garmentIds = String(url.searchParams.get('garmentIds') || '')
+        .split(',')
+        .map(id => id.trim())
+        .filter(id => id.length > 0);
+      if (garmentIds.length === 0) {
+        return sendJson(res, 400, { error: 'garmentIds query parameter is required' });
+      }
+      if (garmentIds.length > MAX_STATUS_BATCH) {
+        return sendJson(res, 400, { error: `At most ${MAX_STATUS_BATCH} garmentIds per request` });
+      }
+
+      requests.push({ at: Date.now() - startedAt, garmentIds });
+      const models = garmentIds.map(statusFor);
+      console.log(`[status] ${models.map(m => `${m.garmentId}=${m.status}`).join(' ')}`);
+      return sendJson(res, 200, { models });
+    }
+    if (req.method === 'PUT' && url.pathname === '/api/_standin/script') {
+      setScript(JSON.parse((await readBody(req)).toString() || '{}'));
+      console.log(`[script] ${Object.keys(script).length} garment(s)`);
+      return sendJson(res, 200, { ok: true });
+    }
+    if (req.method === 'GET' && url.pathname === '/api/_standin/requests') {
+      return sendJson(res, 200, requests);
+    }
+    sendJson(res, 404, { error: 'Route not found', path: url.pathname });
+  } catch (err) {
+    sendJson(res, err.status || 500, { error: err.message });
+  }
+});
+
+if (SCRIPT_FILE) {
+  setScript(JSON.parse(fs.readFileSync(SCRIPT_FILE, 'utf8')));
+}
+
+server.listen(PORT, '0.0.0.0', () => {
+  console.log(`Status stand-in on http://0.0.0.0:${PORT}/api/3d-models/status`);
+});
@@ -0,0 +1,193 @@
+// server/scripts/upload-standin.js
+// Local stand-in for the chunked upload endpoints (/api/uploads) that
+// misbehaves on purpose, for exercising the client's resume logic without
+// MongoDB, S3 or a flaky network:
+//
+//   node scripts/upload-standin.js [--port 5000] [--drop-rate 0.3] [--out ./standin-uploads]
+//                                  [--finalize-ms 0]
+//
+// With probability drop-rate a chunk request is cut off half way through
+// its body, and with half that probability the chunk is stored but the
+// connection is closed before the response (a lost acknowledgement).
+// With --finalize-ms a completed upload is only stored after that delay and
+// the session answers 202 with Retry-After meanwhile, like the real route
+// while S3 is slow.
+// Authentication is not checked. Completed uploads are written to --out.
+//
+// Two extra routes let a test see what happened (tools/upload_check.cpp):
+//   GET /api/_standin/requests       [{ at, method, id, garmentId, offset, outcome }],
+//                                    `at` in ms since start; outcome is
+//                                    created, stored, dropped, lost-ack or the
+//                                    HTTP status of a rejected request
+//   GET /api/_standin/uploads/:id    the bytes a completed upload stored
+const fs = require('fs');
+const http = require('http');
+const os = require('os');
+const path = require('path');
+const { createSessionStore, MAX_CHUNK_SIZE, FINALIZE_RETRY_AFTER_S } = require('../src/utils/uploadSessions');
+
+const option = (name, fallback) => {
+  const index = process.argv.indexOf(`--${name}`);
+  return index >= 0 && index + 1 < process.argv.length ? process.argv[index + 1] : fallback;
+};
+
+const PORT = Number(option('port', 5000));
+const DROP_RATE = Number(option('drop-rate', 0.3));
+const FINALIZE_MS = Number(option('finalize-ms', 0));
+const OUT_DIR = path.resolve(option('out', path.join(os.tmpdir(), 'tryon-standin-uploads')));
+const OWNER = 'standin';
+
+const store = createSessionStore(path.join(OUT_DIR, 'sessions'));
+const stats = { chunks: 0, dropped: 0, lostAcks: 0, completed: 0 };
+const startedAt = Date.now();
+const requests = [];
+const storedFiles = {};
+
+const logRequest = (entry) => requests.push({ at: Date.now() - startedAt, ...entry });
+
+const sendJson = (res, status, body) => {
+  res.writeHead(status, { 'Content-Type': 'application/json' });
+  res.end(JSON.stringify(body));
+};
+
+const sendSession = (res, session) => {
+  if (session.finalizing) {
+    res.writeHead(202, { 'Content-Type': 'application/json', 'Retry-After': String(FINALIZE_RETRY_AFTER_S) });
+    return res.end(JSON.stringify(session));
+  }
+  sendJson(res, 200, session);
+};
+
+const sendError = (res, err) => {
+  if (err.status) return sendJson(res, err.status, { error: err.message, ...err.extra });
+  console.error(err);
+  sendJson(res, 500, { error: err.message });
+};
+
+const readBody = (req, limit, onData) => new Promise((resolve, reject) => {
+  const chunks = [];
+  let length = 0;
+  req.on('data', (data) => {
+    length += data.length;
+    if (length > limit) {
+      reject(Object.assign(new Error('Body too large'), { status: 413 }));
+      req.destroy();
+      return;
+    }
+    chunks.push(data);
+    if (onData) onData(length);
+  });
+  req.on('end', () => resolve(Buffer.concat(chunks)));
+  req.on('error', reject);
+});
+
+const handlePut = async (req, res, id) => {
+  ++stats.chunks;
+  const roll = Math.random();
+  const declared = Number(req.headers['content-length'] || 0);
+  const offset = Number(req.headers['upload-offset']);
+
+  if (roll < DROP_RATE && declared > 1) {
+    // Cut the connection once about half the chunk has arrived
+    ++stats.dropped;
+    await readBody(req, MAX_CHUNK_SIZE, (received) => {
+      if (received >= declared / 2) req.socket.destroy();
+    }).catch(() => {});
+    req.socket.destroy();
+    logRequest({ method: 'PUT', id, offset, outcome: 'dropped' });
+    console.log(`[drop] ${id} at offset ${req.headers['upload-offset']}`);
+    return;
+  }
+
+  const chunk = await readBody(req, MAX_CHUNK_SIZE);
+  let session;
+  try {
+    session = store.append(id, OWNER, req.headers['upload-offset'], chunk);
+  } catch (err) {
+    logRequest({ method: 'PUT', id, offset, outcome: err.status || 500 });
+    throw err;
+  }
+
+  if (!session.complete && !session.finalizing && session.offset === session.size) {
+    const claimed = store.beginFinalize(id, OWNER);
+    if (claimed) {
+      const finalize = () => {
+        const file = path.join(OUT_DIR, `${id}-${claimed.meta.fields.garmentId || 'scan'}.jpg`);
+        fs.writeFileSync(file, claimed.data);
+        storedFiles[id] = file;
+        store.completeFinalize(id, {
+          garmentId: claimed.meta.fields.garmentId,
+          category: claimed.meta.fields.category,
+          imageUrl: `file://${file}`
+        });
+        ++stats.completed;
+        console.log(`[done] ${id} -> ${file}`);
+      };
+      if (FINALIZE_MS > 0) {
+        setTimeout(finalize, FINALIZE_MS);
+      } else {
+        finalize();
+      }
+    }
+  }
+
+  if (roll < DROP_RATE * 1.5) {
+    // Stored, but the client never hears about it
+    ++stats.lostAcks;
+    logRequest({ method: 'PUT', id, offset, outcome: 'lost-ack' });
+    console.log(`[lost ack] ${id} offset now ${session.offset}`);
+    req.socket.destroy();
+    return;
+  }
+  logRequest({ method: 'PUT', id, offset, outcome: 'stored' });
+  sendSession(res, store.status(id, OWNER));
+};
+
+const server = http.createServer(async (req, res) => {
+  const url = new URL(req.url, 'http://localhost');
+  if (req.method === 'GET' && url.pathname === '/api/_standin/requests') {
+    return sendJson(res, 200, requests);
+  }
+  const stored = url.pathname.match(/^\/api\/_standin\/uploads\/([^/]+)$/);
+  if (req.method === 'GET' && stored) {
+    const file = storedFiles[stored[1]];
+    if (!file) return sendJson(res, 404, { error: 'No completed upload with that id' });
+    res.writeHead(200, { 'Content-Type': 'application/octet-stream' });
+    return fs.createReadStream(file).pipe(res);
+  }
+  const match = url.pathname.match(/^\/api\/uploads(?:\/([^/]+))?\/?$/);
+  if (!match) return sendJson(res, 404, { error: 'Route not found', path: url.pathname });
+  const id = match[1];
+
+  try {
+    if (req.method === 'POST' && !id) {
+      const body = JSON.parse((await readBody(req, 64 * 1024)).toString() || '{}');
+      const { garmentId, category, size, sha256, contentType, chunkSize } = body;
+      const session = store.create({
+        ownerId: OWNER, size, sha256, contentType, chunkSize, fields: { garmentId, category }
+      });
+      logRequest({ method: 'POST', id: session.uploadId, garmentId, outcome: 'created' });
+      return sendJson(res, 201, session);
+    }
+    if (req.method === 'GET' && id) return sendSession(res, store.status(id, OWNER));
+    if (req.method === 'PUT' && id) return await handlePut(req, res, id);
+    if (req.method === 'DELETE' && id) {
+      store.remove(id, OWNER);
+      res.writeHead(204);
+      return res.end();
+    }
+    sendJson(res, 405, { error: 'Method not allowed' });
+  } catch (err) {
+    sendError(res, err);
+  }
+});
+
+server.listen(PORT, '0.0.0.0', () => {
+  console.log(`Upload stand-in on http://0.0.0.0:${PORT}/api/uploads`);
+  console.log(`Drop rate ${DROP_RATE}, finalize delay ${FINALIZE_MS} ms, completed uploads go to ${OUT_DIR}`);
+});
+
+process.on('SIGINT', () => {
+  console.log('\n', stats);
+  process.exit(0);
+});
@@ -0,0 +1,29 @@
+const crypto = require('crypto');
+
+// Tags every response with the caller's correlation id (X-Request-Id, made
+// up when the client sent none) and with the time spent in the server as
+// `Server-Timing: app;dur=<ms>`, measured until the headers go out. The
+// client's network tracer uses it to split time-to-first-byte into network
+// and server processing.
+const SLOW_REQUEST_MS = Number(process.env.SLOW_REQUEST_MS || 1000);
+
+module.exports = (req, res, next) => {
+  const started = process.hrtime.bigint();
+  const requestId = (req.get('X-Request-Id') || crypto.randomUUID()).slice(0, 64);
+  req.requestId = requestId;
+  res.setHeader('X-Request-Id', requestId);
+
+  const writeHead = res.writeHead;
+  res.writeHead = function (...args) {
+    const ms = Number(process.hrtime.bigint() - started) / 1e6;
+    if (!res.headersSent) {
+      res.setHeader('Server-Timing', `app;dur=${ms.toFixed(1)}`);
+    }
+    if (ms >= SLOW_REQUEST_MS) {
+      console.log(`Slow request ${requestId}: ${req.method} ${req.originalUrl} took ${ms.toFixed(0)} ms`);
+    }
+    return writeHead.apply(this, args);
+  };
+
+  next();
+};
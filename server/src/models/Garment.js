@@ -35,15 +35,18 @@ const GarmentSchema = new mongoose.Schema({
     type: mongoose.Schema.Types.ObjectId,
     ref: 'User',
     required: true
-  },
-  createdAt: {
-    type: Date,
-    default: Date.now
   }
+}, {
+  // updatedAt drives GET /api/sync deltas
+  timestamps: true
 });
 
 // Add index for efficient querying
 GarmentSchema.index({ garmentId: 1 });
 GarmentSchema.index({ createdBy: 1 });
+// Serves paged catalog queries (createdAt desc, _id desc per user)
+GarmentSchema.index({ createdBy: 1, createdAt: -1, _id: -1 });
+// Serves GET /api/sync (updatedAt asc, _id asc per user)
+GarmentSchema.index({ createdBy: 1, updatedAt: 1, _id: 1 });
 
 module.exports = mongoose.model('Garment', GarmentSchema);
\ No newline at end of file
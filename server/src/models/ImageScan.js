@@ -22,15 +22,16 @@ const ImageScanSchema = new mongoose.Schema({
     type: mongoose.Schema.Types.ObjectId,
     ref: 'User',
     required: true
-  },
-  createdAt: {
-    type: Date,
-    default: Date.now
   }
+}, {
+  // updatedAt drives GET /api/sync deltas
+  timestamps: true
 });
 
 // Add index for efficient querying
 ImageScanSchema.index({ garmentId: 1 });
 ImageScanSchema.index({ createdBy: 1 });
+// Serves GET /api/sync (updatedAt asc, _id asc per user)
+ImageScanSchema.index({ createdBy: 1, updatedAt: 1, _id: 1 });
 
 module.exports = mongoose.model('ImageScan', ImageScanSchema);
\ No newline at end of file
@@ -38,5 +38,7 @@ const ModelProcessedSchema = new mongoose.Schema({
 // Index for better query performance
 ModelProcessedSchema.index({ createdBy: 1, createdAt: -1 });
 ModelProcessedSchema.index({ modelId: 1 });
+// Serves GET /api/sync (updatedAt asc, _id asc per user)
+ModelProcessedSchema.index({ createdBy: 1, updatedAt: 1, _id: 1 });
 
 module.exports = mongoose.model('ModelProcessed', ModelProcessedSchema);
\ No newline at end of file
@@ -0,0 +1,41 @@
+const mongoose = require('mongoose');
+
+// Kept for deleted garments, scans and 3D models so GET /api/sync can tell
+// clients what to drop. Tombstones expire after TOMBSTONE_TTL_DAYS; a client
+// whose cursor is older than that gets a full resync instead of a delta.
+const TOMBSTONE_TTL_DAYS = 30;
+
+const TombstoneSchema = new mongoose.Schema({
+  // Collection the record was deleted from, as named in /api/sync responses
+  kind: {
+    type: String,
+    enum: ['garments', 'scans', 'models'],
+    required: true
+  },
+  garmentId: {
+    type: String,
+    required: true
+  },
+  createdBy: {
+    type: mongoose.Schema.Types.ObjectId,
+    ref: 'User',
+    required: true
+  },
+  deletedAt: {
+    type: Date,
+    default: Date.now
+  }
+});
+
+// Serves GET /api/sync (deletedAt asc, _id asc per user)
+TombstoneSchema.index({ createdBy: 1, deletedAt: 1, _id: 1 });
+TombstoneSchema.index({ deletedAt: 1 }, { expireAfterSeconds: TOMBSTONE_TTL_DAYS * 24 * 60 * 60 });
+
+TombstoneSchema.statics.record = function(kind, doc) {
+  return this.create({ kind, garmentId: doc.garmentId, createdBy: doc.createdBy });
+};
+
+const Tombstone = mongoose.model('Tombstone', TombstoneSchema);
+Tombstone.TTL_DAYS = TOMBSTONE_TTL_DAYS;
+
+module.exports = Tombstone;
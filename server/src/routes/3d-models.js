@@ -4,6 +4,12 @@ const auth = require('../middlewares/auth');
 const multer = require('multer');
 const { uploadFileToS3 } = require('../utils/s3');
 const ModelProcessed = require('../models/ModelProcessed');
+const ImageScan = require('../models/ImageScan');
+const Tombstone = require('../models/Tombstone');
+const { publish, modelReadyEvent } = require('../utils/events');
+
+// Upper bound on garmentIds accepted by a single status request
+const MAX_STATUS_BATCH = 50;
 
 const upload = multer({
   storage: multer.memoryStorage(),
@@ -30,6 +36,61 @@ const upload = multer({
   }
 });
 
+// GET /api/3d-models/status?garmentIds=a,b,c - Batched processing status
+// Returns one entry per requested garmentId:
+//   completed  -> processed model exists (model fields included)
+//   processing -> scan uploaded, model not produced yet
+//   pending    -> nothing known about this garment yet
+router.get('/status', auth, async (req, res) => {
+  try {
+    const garmentIds = String(req.query.garmentIds || '')
+      .split(',')
+      .map(id => id.trim())
+      .filter(id => id.length > 0);
+
+    if (garmentIds.length === 0) {
+      return res.status(400).json({ error: 'garmentIds query parameter is required' });
+    }
+    if (garmentIds.length > MAX_STATUS_BATCH) {
+      return res.status(400).json({ error: `At most ${MAX_STATUS_BATCH} garmentIds per request` });
+    }
+
+    const [models, scans] = await Promise.all([
+      ModelProcessed.find({ garmentId: { $in: garmentIds }, createdBy: req.user.id })
+        .select('-__v'),
+      ImageScan.find({ garmentId: { $in: garmentIds }, createdBy: req.user.id })
+        .select('garmentId')
+    ]);
+
+    const modelsById = new Map(models.map(model => [model.garmentId, model]));
+    const scannedIds = new Set(scans.map(scan => scan.garmentId));
+
+    const statuses = garmentIds.map(garmentId => {
+      const model = modelsById.get(garmentId);
+      if (model) {
+        return {
+          garmentId,
+          status: 'completed',
+          modelUrl: model.modelUrl,
+          previewUrl: model.previewUrl,
+          modelKey: model.modelKey,
+          previewKey: model.previewKey
+        };
+      }
+      return { garmentId, status: scannedIds.has(garmentId) ? 'processing' : 'pending' };
+    });
+
+    res.json({ models: statuses });
+
+  } catch (err) {
+    console.error('Error fetching 3D model status:', err);
+    res.status(500).json({ 
+      error: 'Failed to fetch 3D model status',
+      details: err.message 
+    });
+  }
+});
+
 // GET /api/3d-models/:garmentId - Get 3D model by garmentId for authenticated user
 router.get('/:garmentId', auth, async (req, res) => {
   try {
@@ -86,6 +147,7 @@ router.delete('/', auth, async (req, res) => {
     }
 
     await ModelProcessed.findByIdAndDelete(lastModel._id);
+    await Tombstone.record('models', lastModel);
 
     res.json({ 
       message: 'Last 3D model deleted successfully',
@@ -149,6 +211,7 @@ router.post('/', auth, upload.fields([
     });
     
     const savedModel = await newModel.save();  
+    publish(req.user.id, modelReadyEvent(savedModel));
     res.json(savedModel);
 
   } catch (err) {
@@ -2,6 +2,7 @@ const express = require('express');
 const router = express.Router();
 const auth = require('../middlewares/auth');
 const Garment = require('../models/Garment');
+const Tombstone = require('../models/Tombstone');
 const mongoose = require('mongoose');
 const multer = require('multer');
 const { uploadFileToS3 } = require('../utils/s3');
@@ -110,14 +111,81 @@ router.post('/', auth, upload.fields([
   }
 });
 
-// Get all garments for the authenticated user
+// Paging limits for GET /garments?limit=N&cursor=C
+const DEFAULT_PAGE_SIZE = 30;
+const MAX_PAGE_SIZE = 100;
+
+// Cursors are opaque to clients: base64url of the (createdAt, _id) of the
+// last garment on the previous page. Ordering is createdAt desc, _id desc.
+const encodeCursor = (garment) => Buffer.from(JSON.stringify({
+  createdAt: garment.createdAt.toISOString(),
+  id: garment._id.toString()
+})).toString('base64url');
+
+const decodeCursor = (cursor) => {
+  const parsed = JSON.parse(Buffer.from(cursor, 'base64url').toString('utf8'));
+  const createdAt = new Date(parsed.createdAt);
+  if (isNaN(createdAt.getTime()) || !mongoose.Types.ObjectId.isValid(parsed.id)) {
+    throw new Error('Invalid cursor');
+  }
+  return { createdAt, id: new mongoose.Types.ObjectId(parsed.id) };
+};
+
+// Get garments for the authenticated user
+// Without `limit` the whole catalog is returned as an array (legacy clients).
+// With `limit` a page is returned as { items, nextCursor }; nextCursor is null
+// on the last page.
+// Express sets a body ETag and answers If-None-Match / If-Modified-Since with
+// 304 on its own; we add Last-Modified and force clients to revalidate.
 router.get('/', auth, async (req, res) => {
   try {
-    const garments = await Garment.find({ createdBy: req.user.id })
+    const paged = req.query.limit !== undefined;
+    const filter = { createdBy: req.user.id };
+
+    if (paged && req.query.cursor) {
+      let cursor;
+      try {
+        cursor = decodeCursor(String(req.query.cursor));
+      } catch (err) {
+        return res.status(400).json({ error: 'Invalid cursor' });
+      }
+      filter.$or = [
+        { createdAt: { $lt: cursor.createdAt } },
+        { createdAt: cursor.createdAt, _id: { $lt: cursor.id } }
+      ];
+    }
+
+    let query = Garment.find(filter)
       .select('-__v')
-      .sort({ createdAt: -1 });
-    console.log(garments);
-    res.json(garments);
+      .sort({ createdAt: -1, _id: -1 });
+
+    let limit = 0;
+    if (paged) {
+      limit = Math.min(Math.max(parseInt(req.query.limit, 10) || DEFAULT_PAGE_SIZE, 1), MAX_PAGE_SIZE);
+      // One extra row tells us whether another page exists
+      query = query.limit(limit + 1);
+    }
+
+    const garments = await query;
+    const hasMore = paged && garments.length > limit;
+    const items = hasMore ? garments.slice(0, limit) : garments;
+
+    const newest = items.reduce(
+      (latest, garment) => (garment.createdAt > latest ? garment.createdAt : latest),
+      new Date(0)
+    );
+    res.set('Cache-Control', 'private, no-cache');
+    if (items.length > 0) {
+      res.set('Last-Modified', newest.toUTCString());
+    }
+
+    if (!paged) {
+      return res.json(items);
+    }
+    res.json({
+      items,
+      nextCursor: hasMore ? encodeCursor(items[items.length - 1]) : null
+    });
   } catch (err) {
     console.error(err);
     res.status(500).json({ error: 'Server error' });
@@ -157,6 +225,7 @@ router.delete('/:garmentId', auth, async (req, res) => {
 
     // Delete the garment document
     await Garment.deleteOne({ _id: garment._id });
+    await Tombstone.record('garments', garment);
     
     res.json({ message: 'Garment deleted successfully' });
   } catch (err) {
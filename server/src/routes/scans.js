@@ -4,6 +4,8 @@ const auth = require('../middlewares/auth');
 const multer = require('multer');
 const { uploadFileToS3 } = require('../utils/s3');
 const ImageScan = require('../models/ImageScan');
+const Tombstone = require('../models/Tombstone');
+const { publish } = require('../utils/events');
 
 const upload = multer({
   storage: multer.memoryStorage(),
@@ -52,6 +54,7 @@ router.delete('/', auth, async (req, res) => {
     }
 
     await ImageScan.findByIdAndDelete(lastScan._id);
+    await Tombstone.record('scans', lastScan);
 
     res.json({ 
       message: 'Last scan deleted successfully',
@@ -95,6 +98,12 @@ router.post('/', auth, upload.single('image'), async (req, res) => {
       });
       
       const scan = await newScan.save();  
+      publish(req.user.id, {
+        type: 'scan.status',
+        garmentId: scan.garmentId,
+        status: 'uploaded',
+        imageUrl: scan.imageUrl
+      });
       res.json(scan);
   
     } catch (err) {
@@ -0,0 +1,147 @@
+const express = require('express');
+const router = express.Router();
+const mongoose = require('mongoose');
+const auth = require('../middlewares/auth');
+const Garment = require('../models/Garment');
+const ImageScan = require('../models/ImageScan');
+const ModelProcessed = require('../models/ModelProcessed');
+const Tombstone = require('../models/Tombstone');
+
+// Per-collection page size for GET /sync?limit=N
+const DEFAULT_PAGE_SIZE = 200;
+const MAX_PAGE_SIZE = 500;
+
+// Writes stamp updatedAt before they commit, so a change can become visible
+// after a sync already moved past its timestamp. The last page of a sync
+// therefore leaves its cursor this far behind the clock; the overlap is
+// sent again next time and the client drops it as unchanged.
+const SETTLE_MS = 5000;
+
+// Collections in the order they appear in a response
+const STREAMS = [
+  { key: 'garments', model: Garment, field: 'updatedAt' },
+  { key: 'scans', model: ImageScan, field: 'updatedAt' },
+  { key: 'models', model: ModelProcessed, field: 'updatedAt' },
+  { key: 'deleted', model: Tombstone, field: 'deletedAt' }
+];
+
+const MIN_OBJECT_ID = '000000000000000000000000';
+
+// Cursors are opaque to clients: base64url of when they were issued and,
+// per collection, the (timestamp, _id) of the last record sent.
+const encodeCursor = (cursor) => Buffer.from(JSON.stringify(cursor)).toString('base64url');
+
+const decodeCursor = (value) => {
+  const parsed = JSON.parse(Buffer.from(value, 'base64url').toString('utf8'));
+  const at = new Date(parsed.at);
+  if (isNaN(at.getTime())) {
+    throw new Error('Invalid cursor');
+  }
+  const cursor = { at: parsed.at };
+  for (const { key } of STREAMS) {
+    const [time, id] = parsed[key] || [];
+    if (isNaN(new Date(time).getTime()) || !mongoose.Types.ObjectId.isValid(id)) {
+      throw new Error('Invalid cursor');
+    }
+    cursor[key] = [time, id];
+  }
+  return cursor;
+};
+
+// Documents written before timestamps were enabled have no updatedAt and
+// would never be picked up; give them their createdAt once per process.
+let backfill = null;
+const backfillUpdatedAt = () => {
+  if (!backfill) {
+    backfill = Promise.all([Garment, ImageScan].map(model => model.updateMany(
+      { updatedAt: { $exists: false } },
+      [{ $set: { updatedAt: { $ifNull: ['$createdAt', '$$NOW'] } } }],
+      { timestamps: false }
+    ))).catch(err => {
+      backfill = null;
+      throw err;
+    });
+  }
+  return backfill;
+};
+
+// GET /api/sync?since=C&limit=N - Changes to the user's garments, scans and
+// 3D models since cursor C:
+//   { userId, reset, garments, scans, models,
+//     deleted: [{ kind, garmentId, deletedAt }], cursor, hasMore }
+// Without `since` (or with a cursor older than the tombstones are kept) the
+// response starts a full snapshot and sets `reset`, and the client replaces
+// what it has. While `hasMore` is set the client asks again with `cursor`.
+router.get('/', auth, async (req, res) => {
+  try {
+    await backfillUpdatedAt();
+
+    const now = new Date();
+    const limit = Math.min(Math.max(parseInt(req.query.limit, 10) || DEFAULT_PAGE_SIZE, 1), MAX_PAGE_SIZE);
+
+    let since = null;
+    if (req.query.since) {
+      try {
+        since = decodeCursor(String(req.query.since));
+      } catch (err) {
+        console.warn('Sync with an unreadable cursor, starting over');
+      }
+    }
+    const horizon = now.getTime() - (Tombstone.TTL_DAYS - 1) * 24 * 60 * 60 * 1000;
+    const reset = !since || new Date(since.at).getTime() < horizon;
+    if (reset) {
+      // A snapshot needs no tombstones from before it started
+      since = { at: now.toISOString(), deleted: [now.toISOString(), MIN_OBJECT_ID] };
+    }
+
+    const pages = await Promise.all(STREAMS.map(({ key, model, field }) => {
+      const filter = { createdBy: req.user.id };
+      if (since[key]) {
+        const [time, id] = since[key];
+        const after = new Date(time);
+        filter.$or = [
+          { [field]: { $gt: after } },
+          { [field]: after, _id: { $gt: new mongoose.Types.ObjectId(id) } }
+        ];
+      }
+      // One extra row tells us whether another page exists
+      return model.find(filter)
+        .select('-__v')
+        .sort({ [field]: 1, _id: 1 })
+        .limit(limit + 1);
+    }));
+
+    const response = { userId: req.user.id, reset, hasMore: false };
+    const next = { at: now.toISOString() };
+    const settled = new Date(now.getTime() - SETTLE_MS);
+    STREAMS.forEach(({ key, field }, i) => {
+      const more = pages[i].length > limit;
+      const items = more ? pages[i].slice(0, limit) : pages[i];
+      response.hasMore = response.hasMore || more;
+
+      let position = since[key] || [new Date(0).toISOString(), MIN_OBJECT_ID];
+      if (items.length > 0) {
+        const last = items[items.length - 1];
+        position = [last[field].toISOString(), last._id.toString()];
+      }
+      // Mid-snapshot pages must move on; only the last one holds back
+      if (!more && new Date(position[0]) > settled) {
+        position = [settled.toISOString(), MIN_OBJECT_ID];
+      }
+      next[key] = position;
+
+      response[key] = key === 'deleted'
+        ? items.map(({ kind, garmentId, deletedAt }) => ({ kind, garmentId, deletedAt }))
+        : items;
+    });
+    response.cursor = encodeCursor(next);
+
+    res.set('Cache-Control', 'private, no-store');
+    res.json(response);
+  } catch (err) {
+    console.error('Sync error:', err);
+    res.status(500).json({ error: 'Sync failed' });
+  }
+});
+
+module.exports = router;
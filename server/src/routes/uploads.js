@@ -0,0 +1,143 @@
+const express = require('express');
+const path = require('path');
+const router = express.Router();
+const auth = require('../middlewares/auth');
+const { uploadFileToS3 } = require('../utils/s3');
+const ImageScan = require('../models/ImageScan');
+const { publish } = require('../utils/events');
+const { createSessionStore, MAX_CHUNK_SIZE, FINALIZE_RETRY_AFTER_S } = require('../utils/uploadSessions');
+
+// Chunked, resumable scan uploads:
+//   POST   /api/uploads        { garmentId, category, size, sha256, contentType } -> session
+//   GET    /api/uploads/:id    -> { offset, size, complete, result? }
+//   PUT    /api/uploads/:id    raw chunk, "Upload-Offset: <n>" header -> session
+//   DELETE /api/uploads/:id
+// After a dropped connection the client asks for the offset and carries on
+// from there. The PUT that completes the upload stores the scan exactly like
+// POST /api/scans and returns it as `result`. While another request is still
+// storing the scan (the client retried after losing the final response) the
+// session is answered with 202 and Retry-After.
+// Kept outside the statically served uploads directory.
+const store = createSessionStore(
+  process.env.UPLOAD_SESSION_DIR || path.join(__dirname, '..', '..', 'upload-sessions')
+);
+
+const sendError = (res, err) => {
+  if (err.status) {
+    return res.status(err.status).json({ error: err.message, ...err.extra });
+  }
+  console.error('Chunked upload error:', err);
+  res.status(500).json({ error: err.message || 'Upload failed' });
+};
+
+const sendSession = (res, session) => {
+  if (session.finalizing) {
+    res.set('Retry-After', String(FINALIZE_RETRY_AFTER_S));
+    return res.status(202).json(session);
+  }
+  res.json(session);
+};
+
+const storeScan = async (meta, data, userId) => {
+  const s3Data = await uploadFileToS3({
+    buffer: data,
+    originalname: 'scan.jpg',
+    mimetype: meta.contentType
+  });
+  if (!s3Data?.url || !s3Data?.key) {
+    throw new Error('Failed to retrieve image URL or key from S3');
+  }
+
+  const scan = await new ImageScan({
+    garmentId: meta.fields.garmentId,
+    imageUrl: s3Data.url,
+    imageKey: s3Data.key,
+    category: meta.fields.category,
+    createdBy: userId
+  }).save();
+
+  publish(userId, {
+    type: 'scan.status',
+    garmentId: scan.garmentId,
+    status: 'uploaded',
+    imageUrl: scan.imageUrl
+  });
+  return scan.toJSON();
+};
+
+// POST /api/uploads - Open an upload session
+router.post('/', auth, (req, res) => {
+  try {
+    const { garmentId, category, size, sha256, contentType, chunkSize } = req.body || {};
+    if (!garmentId || !category) {
+      return res.status(400).json({ error: 'garmentId and category required' });
+    }
+    if (contentType && !contentType.startsWith('image/')) {
+      return res.status(400).json({ error: 'Only image files are allowed', invalidField: 'image' });
+    }
+
+    const session = store.create({
+      ownerId: req.user.id,
+      size,
+      sha256,
+      contentType: contentType || 'image/jpeg',
+      chunkSize,
+      fields: { garmentId, category }
+    });
+    res.status(201).json(session);
+  } catch (err) {
+    sendError(res, err);
+  }
+});
+
+// GET /api/uploads/:id - Where to resume from
+router.get('/:id', auth, (req, res) => {
+  try {
+    sendSession(res, store.status(req.params.id, req.user.id));
+  } catch (err) {
+    sendError(res, err);
+  }
+});
+
+// PUT /api/uploads/:id - Append one chunk
+router.put('/:id',
+  auth,
+  express.raw({ type: 'application/octet-stream', limit: MAX_CHUNK_SIZE }),
+  async (req, res) => {
+    const id = req.params.id;
+    try {
+      const chunk = Buffer.isBuffer(req.body) ? req.body : Buffer.alloc(0);
+      const session = store.append(id, req.user.id, req.header('Upload-Offset'), chunk);
+      if (session.complete || session.finalizing || session.offset < session.size) {
+        return sendSession(res, session);
+      }
+
+      const claimed = store.beginFinalize(id, req.user.id);
+      if (!claimed) return sendSession(res, store.status(id, req.user.id));
+
+      let result;
+      try {
+        result = await storeScan(claimed.meta, claimed.data, req.user.id);
+      } catch (err) {
+        // Keep the data; re-sending an empty chunk at the end retries
+        store.failFinalize(id);
+        throw err;
+      }
+      store.completeFinalize(id, result);
+      res.json(store.status(id, req.user.id));
+    } catch (err) {
+      sendError(res, err);
+    }
+  });
+
+// DELETE /api/uploads/:id - Abandon an upload
+router.delete('/:id', auth, (req, res) => {
+  try {
+    store.remove(req.params.id, req.user.id);
+    res.status(204).end();
+  } catch (err) {
+    sendError(res, err);
+  }
+});
+
+module.exports = router;
@@ -6,7 +6,11 @@ const authRoutes = require('./routes/auth');
 const garmentRoutes = require('./routes/garments');
 const userRoutes = require('./routes/users');
 const scanRoutes = require('./routes/scans');
+const uploadRoutes = require('./routes/uploads');
 const modelProcessedRoutes = require('./routes/3d-models');
+const syncRoutes = require('./routes/sync');
+const { attachEventServer } = require('./utils/events');
+const requestTiming = require('./middlewares/requestTiming');
 const cors = require('cors');
 const fs = require('fs');
 
@@ -15,6 +19,9 @@ const app = express();
 // Connect Database
 connectDB();
 
+// Correlation id + Server-Timing on every response
+app.use(requestTiming);
+
 const allowedOrigins = [
     'http://192.168.1.23:5000', // home wi-fi
     // 'http://10.1.247.79:5000', // Server IP eduroam
@@ -27,8 +34,9 @@ const allowedOrigins = [
 
     app.use(cors({
     origin: allowedOrigins,
-    methods: ['GET', 'POST', 'DELETE', 'OPTIONS'],
-    allowedHeaders: ['Content-Type', 'Authorization']
+    methods: ['GET', 'POST', 'PUT', 'DELETE', 'OPTIONS'],
+    allowedHeaders: ['Content-Type', 'Authorization', 'Upload-Offset', 'X-Request-Id'],
+    exposedHeaders: ['X-Request-Id', 'Server-Timing']
 }));
 
 const uploadsDir = path.join(__dirname, 'uploads');
@@ -52,8 +60,9 @@ app.use('/uploads', express.static(uploadsDir));
 app.use(express.json());
 app.use(cors({
     origin: '*', // Allow all origins for development
-    methods: ['GET', 'POST', 'DELETE', 'OPTIONS'],
-    allowedHeaders: ['Content-Type', 'Authorization']
+    methods: ['GET', 'POST', 'PUT', 'DELETE', 'OPTIONS'],
+    allowedHeaders: ['Content-Type', 'Authorization', 'Upload-Offset', 'X-Request-Id'],
+    exposedHeaders: ['X-Request-Id', 'Server-Timing']
 }));
 
 // Serve static files (for uploaded images and models)
@@ -74,7 +83,9 @@ app.use('/api/auth', authRoutes);
 app.use('/api/garments', garmentRoutes);
 app.use('/api/users', userRoutes);
 app.use('/api/scans', scanRoutes);
+app.use('/api/uploads', uploadRoutes);
 app.use('/api/3d-models', modelProcessedRoutes);
+app.use('/api/sync', syncRoutes);
 
 // Database connection test endpoint
 app.get('/api/database/health', async (req, res) => {
@@ -115,7 +126,7 @@ app.use('*', (req, res) => {
 const PORT = process.env.PORT || 5000;
 
 // IMPORTANT: Bind to 0.0.0.0 to accept connections from Android devices
-app.listen(PORT, '0.0.0.0', () => {
+const server = app.listen(PORT, '0.0.0.0', () => {
     console.log(`Server started on port ${PORT}`);
     console.log(`Server running on http://0.0.0.0:${PORT}`);
     
@@ -130,4 +141,7 @@ app.listen(PORT, '0.0.0.0', () => {
             }
         });
     });
-});
\ No newline at end of file
+});
+
+// Push channel for scan/model status events (ws://<host>:<port>/api/events)
+attachEventServer(server);
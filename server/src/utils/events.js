@@ -0,0 +1,251 @@
+// server/src/utils/events.js
+// Minimal RFC 6455 WebSocket endpoint used to push scan and 3D model status
+// events to connected clients. Implemented on Node's built-in http upgrade
+// handling so the server needs no extra dependency.
+const crypto = require('crypto');
+const jwt = require('jsonwebtoken');
+const ModelProcessed = require('../models/ModelProcessed');
+const ImageScan = require('../models/ImageScan');
+
+const EVENTS_PATH = '/api/events';
+const WS_GUID = '258EAFA5-E914-47DA-95CA-C5AB0DC85B11';
+const HEARTBEAT_INTERVAL_MS = 30000;
+const MAX_MESSAGE_BYTES = 64 * 1024;
+
+const OPCODE_CONTINUATION = 0x0;
+const OPCODE_TEXT = 0x1;
+const OPCODE_CLOSE = 0x8;
+const OPCODE_PING = 0x9;
+const OPCODE_PONG = 0xA;
+
+// userId -> Set of connected clients
+const clientsByUser = new Map();
+
+const encodeFrame = (opcode, payload) => {
+  const body = Buffer.isBuffer(payload) ? payload : Buffer.from(payload || '');
+  let header;
+  if (body.length < 126) {
+    header = Buffer.alloc(2);
+    header[1] = body.length;
+  } else if (body.length < 65536) {
+    header = Buffer.alloc(4);
+    header[1] = 126;
+    header.writeUInt16BE(body.length, 2);
+  } else {
+    header = Buffer.alloc(10);
+    header[1] = 127;
+    header.writeBigUInt64BE(BigInt(body.length), 2);
+  }
+  header[0] = 0x80 | opcode; // FIN + opcode, server frames are never masked
+  return Buffer.concat([header, body]);
+};
+
+class EventClient {
+  constructor(socket, userId) {
+    this.socket = socket;
+    this.userId = userId;
+    this.buffer = Buffer.alloc(0);
+    this.fragments = [];
+    this.alive = true;
+    this.closed = false;
+  }
+
+  send(event) {
+    if (this.closed) return;
+    this.socket.write(encodeFrame(OPCODE_TEXT, JSON.stringify(event)));
+  }
+
+  close(code = 1000) {
+    if (this.closed) return;
+    this.closed = true;
+    const payload = Buffer.alloc(2);
+    payload.writeUInt16BE(code, 0);
+    this.socket.end(encodeFrame(OPCODE_CLOSE, payload));
+  }
+
+  // Parse as many complete client frames as the buffer holds
+  handleData(chunk, onMessage) {
+    this.buffer = Buffer.concat([this.buffer, chunk]);
+
+    while (this.buffer.length >= 2) {
+      const fin = (this.buffer[0] & 0x80) !== 0;
+      const opcode = this.buffer[0] & 0x0f;
+      const masked = (this.buffer[1] & 0x80) !== 0;
+      let length = this.buffer[1] & 0x7f;
+      let offset = 2;
+
+      if (length === 126) {
+        if (this.buffer.length < 4) return;
+        length = this.buffer.readUInt16BE(2);
+        offset = 4;
+      } else if (length === 127) {
+        if (this.buffer.length < 10) return;
+        length = Number(this.buffer.readBigUInt64BE(2));
+        offset = 10;
+      }
+
+      if (!masked || length > MAX_MESSAGE_BYTES) {
+        // Clients must mask their frames (RFC 6455 5.1)
+        this.close(1002);
+        return;
+      }
+
+      if (this.buffer.length < offset + 4 + length) return;
+
+      const mask = this.buffer.subarray(offset, offset + 4);
+      const payload = Buffer.from(this.buffer.subarray(offset + 4, offset + 4 + length));
+      for (let i = 0; i < payload.length; i++) {
+        payload[i] ^= mask[i % 4];
+      }
+      this.buffer = this.buffer.subarray(offset + 4 + length);
+
+      switch (opcode) {
+        case OPCODE_TEXT:
+        case OPCODE_CONTINUATION:
+          this.fragments.push(payload);
+          if (fin) {
+            const message = Buffer.concat(this.fragments).toString('utf8');
+            this.fragments = [];
+            onMessage(message);
+          }
+          break;
+        case OPCODE_PING:
+          this.socket.write(encodeFrame(OPCODE_PONG, payload));
+          break;
+        case OPCODE_PONG:
+          this.alive = true;
+          break;
+        case OPCODE_CLOSE:
+          this.close(1000);
+          return;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+const addClient = (client) => {
+  if (!clientsByUser.has(client.userId)) {
+    clientsByUser.set(client.userId, new Set());
+  }
+  clientsByUser.get(client.userId).add(client);
+};
+
+const removeClient = (client) => {
+  const clients = clientsByUser.get(client.userId);
+  if (!clients) return;
+  clients.delete(client);
+  if (clients.size === 0) {
+    clientsByUser.delete(client.userId);
+  }
+};
+
+// Reply to a subscribe request with the current state of each garment, so a
+// client that (re)connects after a model finished does not miss it.
+const sendCurrentStatus = async (client, garmentIds) => {
+  const ids = garmentIds.filter(id => typeof id === 'string' && id.length > 0).slice(0, 50);
+  if (ids.length === 0) return;
+
+  const [models, scans] = await Promise.all([
+    ModelProcessed.find({ garmentId: { $in: ids }, createdBy: client.userId }),
+    ImageScan.find({ garmentId: { $in: ids }, createdBy: client.userId }).select('garmentId imageUrl')
+  ]);
+
+  scans.forEach(scan => client.send({
+    type: 'scan.status',
+    garmentId: scan.garmentId,
+    status: 'uploaded',
+    imageUrl: scan.imageUrl
+  }));
+  models.forEach(model => client.send(modelReadyEvent(model)));
+};
+
+const handleClientMessage = (client, message) => {
+  let request;
+  try {
+    request = JSON.parse(message);
+  } catch (err) {
+    return;
+  }
+
+  if (request.type === 'subscribe' && Array.isArray(request.garmentIds)) {
+    sendCurrentStatus(client, request.garmentIds).catch(err => {
+      console.error('Failed to send current status:', err.message);
+    });
+  }
+};
+
+const attachEventServer = (httpServer) => {
+  httpServer.on('upgrade', (req, socket) => {
+    const path = req.url.split('?')[0];
+    if (path !== EVENTS_PATH || (req.headers.upgrade || '').toLowerCase() !== 'websocket') {
+      socket.destroy();
+      return;
+    }
+
+    let userId;
+    try {
+      const authHeader = req.headers.authorization || '';
+      const token = authHeader.replace('Bearer ', '');
+      userId = jwt.verify(token, process.env.JWT_SECRET).id;
+    } catch (err) {
+      socket.end('HTTP/1.1 401 Unauthorized\r\n\r\n');
+      return;
+    }
+
+    const accept = crypto.createHash('sha1')
+      .update(req.headers['sec-websocket-key'] + WS_GUID)
+      .digest('base64');
+
+    socket.write(
+      'HTTP/1.1 101 Switching Protocols\r\n' +
+      'Upgrade: websocket\r\n' +
+      'Connection: Upgrade\r\n' +
+      `Sec-WebSocket-Accept: ${accept}\r\n\r\n`
+    );
+    socket.setNoDelay(true);
+
+    const client = new EventClient(socket, String(userId));
+    addClient(client);
+
+    socket.on('data', chunk => client.handleData(chunk, message => handleClientMessage(client, message)));
+    socket.on('close', () => removeClient(client));
+    socket.on('error', () => removeClient(client));
+  });
+
+  // Drop clients that stopped answering pings
+  const heartbeat = setInterval(() => {
+    clientsByUser.forEach(clients => clients.forEach(client => {
+      if (!client.alive) {
+        client.socket.destroy();
+        removeClient(client);
+        return;
+      }
+      client.alive = false;
+      client.socket.write(encodeFrame(OPCODE_PING));
+    }));
+  }, HEARTBEAT_INTERVAL_MS);
+  heartbeat.unref();
+
+  console.log(`Event channel listening on ${EVENTS_PATH}`);
+};
+
+const modelReadyEvent = (model) => ({
+  type: 'model.status',
+  garmentId: model.garmentId,
+  status: 'completed',
+  modelUrl: model.modelUrl,
+  previewUrl: model.previewUrl,
+  modelKey: model.modelKey,
+  previewKey: model.previewKey
+});
+
+// Push an event to every connection of the given user
+const publish = (userId, event) => {
+  const clients = clientsByUser.get(String(userId));
+  if (!clients) return;
+  clients.forEach(client => client.send(event));
+};
+
+module.exports = { attachEventServer, publish, modelReadyEvent };
@@ -1,5 +1,6 @@
 const { S3Client, PutObjectCommand } = require('@aws-sdk/client-s3');
 const { v4: uuidv4 } = require('uuid');
+const crypto = require('crypto');
 
 const s3 = new S3Client({
     region: process.env.AWS_REGION,
@@ -16,12 +17,15 @@ if (!process.env.AWS_S3_BUCKET_NAME) {
 }
 
 const key = `${Date.now()}-${file.originalname}`;
+// Served back as x-amz-meta-sha256 so clients can verify cached downloads
+const sha256 = crypto.createHash('sha256').update(file.buffer).digest('hex');
 
 const uploadParams = {
     Bucket: process.env.AWS_S3_BUCKET_NAME,
     Key: key,
     Body: file.buffer,
     ContentType: file.mimetype,
+    Metadata: { sha256 },
 };
 
 try {
@@ -31,7 +35,8 @@ try {
     // Return both URL and key with proper formatting
     return {
     url: `https://${process.env.AWS_S3_BUCKET_NAME}.s3.${process.env.AWS_REGION}.amazonaws.com/${key}`,
-    key: key
+    key: key,
+    sha256
     };
 } catch (error) {
     console.error('S3 Upload Error:', error);
@@ -0,0 +1,231 @@
+// server/src/utils/uploadSessions.js
+// On-disk sessions for chunked, resumable uploads. Each session is a JSON
+// metadata file plus a .part file the chunks are appended to; the size of
+// the .part file is the authoritative offset, so a session survives both a
+// dropped connection and a server restart. Only Node built-ins are used so
+// the same store backs the real route and the local stand-in server.
+const crypto = require('crypto');
+const fs = require('fs');
+const path = require('path');
+
+const DEFAULT_CHUNK_SIZE = 256 * 1024;
+const MAX_CHUNK_SIZE = 4 * 1024 * 1024;
+const MAX_UPLOAD_SIZE = 50 * 1024 * 1024; // same limit as the multipart route
+const SESSION_TTL_MS = 24 * 60 * 60 * 1000;
+// A session still finalizing after this long belongs to a request that died
+// (crash, restart) while storing it; it goes back to receiving so the
+// client's next final chunk stores it again.
+const FINALIZE_TIMEOUT_MS = 2 * 60 * 1000;
+// How long clients are told to wait before asking about a finalizing session
+const FINALIZE_RETRY_AFTER_S = 2;
+
+class UploadError extends Error {
+  constructor(status, message, extra = {}) {
+    super(message);
+    this.status = status;
+    this.extra = extra;
+  }
+}
+
+const createSessionStore = (directory) => {
+  fs.mkdirSync(directory, { recursive: true });
+
+  const metaPath = (id) => path.join(directory, `${id}.json`);
+  const partPath = (id) => path.join(directory, `${id}.part`);
+  const validId = (id) => /^[0-9a-f]{32}$/.test(id);
+
+  const readMeta = (id) => {
+    if (!validId(id)) return null;
+    try {
+      return JSON.parse(fs.readFileSync(metaPath(id), 'utf8'));
+    } catch (err) {
+      return null;
+    }
+  };
+
+  const writeMeta = (meta) => {
+    // Write-then-rename so a crash never leaves half a metadata file
+    const tmp = `${metaPath(meta.id)}.tmp`;
+    fs.writeFileSync(tmp, JSON.stringify(meta));
+    fs.renameSync(tmp, metaPath(meta.id));
+  };
+
+  const currentOffset = (id) => {
+    try {
+      return fs.statSync(partPath(id)).size;
+    } catch (err) {
+      return 0;
+    }
+  };
+
+  const describe = (meta) => ({
+    uploadId: meta.id,
+    // The .part file is dropped once the upload has been stored
+    offset: meta.state === 'complete' ? meta.size : currentOffset(meta.id),
+    size: meta.size,
+    chunkSize: meta.chunkSize,
+    complete: meta.state === 'complete',
+    // Everything arrived and another request is storing it
+    finalizing: meta.state === 'finalizing',
+    ...(meta.result && { result: meta.result })
+  });
+
+  // Fetches a session owned by `ownerId`, or throws 404 without revealing
+  // whether somebody else's session exists.
+  const load = (id, ownerId) => {
+    const meta = readMeta(id);
+    if (!meta || String(meta.ownerId) !== String(ownerId)) {
+      throw new UploadError(404, 'Upload session not found');
+    }
+    if (meta.state === 'finalizing' && Date.now() - meta.updatedAt > FINALIZE_TIMEOUT_MS) {
+      console.warn(`Upload session ${id} stuck finalizing, accepting the final chunk again`);
+      meta.state = 'receiving';
+      meta.updatedAt = Date.now();
+      writeMeta(meta);
+    }
+    return meta;
+  };
+
+  const remove = (id) => {
+    for (const file of [metaPath(id), partPath(id)]) {
+      fs.rmSync(file, { force: true });
+    }
+  };
+
+  const pruneExpired = (now = Date.now()) => {
+    for (const name of fs.readdirSync(directory)) {
+      if (!name.endsWith('.json')) continue;
+      const id = name.slice(0, -5);
+      const meta = readMeta(id);
+      if (!meta || now - meta.updatedAt > SESSION_TTL_MS) remove(id);
+    }
+  };
+
+  const create = ({ ownerId, size, sha256, contentType, chunkSize, fields }) => {
+    size = Number(size);
+    if (!Number.isInteger(size) || size <= 0) {
+      throw new UploadError(400, 'Upload size required');
+    }
+    if (size > MAX_UPLOAD_SIZE) {
+      throw new UploadError(413, 'Upload too large');
+    }
+    if (sha256 && !/^[0-9a-f]{64}$/i.test(sha256)) {
+      throw new UploadError(400, 'Invalid sha256');
+    }
+
+    pruneExpired();
+
+    const requested = Number(chunkSize) || DEFAULT_CHUNK_SIZE;
+    const now = Date.now();
+    const meta = {
+      id: crypto.randomBytes(16).toString('hex'),
+      ownerId: String(ownerId),
+      size,
+      sha256: sha256 ? sha256.toLowerCase() : null,
+      contentType: contentType || 'application/octet-stream',
+      chunkSize: Math.min(Math.max(requested, 16 * 1024), MAX_CHUNK_SIZE),
+      fields: fields || {},
+      state: 'receiving',
+      createdAt: now,
+      updatedAt: now
+    };
+    fs.writeFileSync(partPath(meta.id), Buffer.alloc(0));
+    writeMeta(meta);
+    return describe(meta);
+  };
+
+  const status = (id, ownerId) => describe(load(id, ownerId));
+
+  // Appends `chunk` at `offset`. A mismatching offset (a retried chunk that
+  // did arrive, or one that never did) is answered with 409 and the offset
+  // to resume from instead of corrupting the file.
+  const append = (id, ownerId, offset, chunk) => {
+    const meta = load(id, ownerId);
+    // A retry after the final response was lost, or while it is being stored
+    if (meta.state !== 'receiving') return describe(meta);
+
+    const current = currentOffset(id);
+    offset = Number(offset);
+
+    if (!Number.isInteger(offset) || offset !== current) {
+      throw new UploadError(409, 'Offset mismatch', { offset: current });
+    }
+    if (chunk.length > meta.chunkSize) {
+      throw new UploadError(413, 'Chunk larger than the session chunk size');
+    }
+    if (current + chunk.length > meta.size) {
+      throw new UploadError(400, 'Chunk exceeds declared upload size');
+    }
+
+    // Synchronous on purpose: the check above and the append cannot
+    // interleave with another request for the same session.
+    fs.appendFileSync(partPath(id), chunk);
+    meta.updatedAt = Date.now();
+    writeMeta(meta);
+    return describe(meta);
+  };
+
+  // Claims a fully received session for finalization and returns its data.
+  // Returns null when the session is not complete yet or already claimed.
+  const beginFinalize = (id, ownerId) => {
+    const meta = load(id, ownerId);
+    if (meta.state !== 'receiving' || currentOffset(id) !== meta.size) return null;
+
+    const data = fs.readFileSync(partPath(id));
+    if (meta.sha256) {
+      const digest = crypto.createHash('sha256').update(data).digest('hex');
+      if (digest !== meta.sha256) {
+        // Nothing salvageable: the client has to start over
+        remove(id);
+        throw new UploadError(422, 'Checksum mismatch, upload discarded');
+      }
+    }
+
+    meta.state = 'finalizing';
+    meta.updatedAt = Date.now();
+    writeMeta(meta);
+    return { meta, data };
+  };
+
+  // Records the outcome so a client that lost the final response can fetch
+  // it with status() instead of uploading again.
+  const completeFinalize = (id, result) => {
+    const meta = readMeta(id);
+    if (!meta) return;
+    meta.state = 'complete';
+    meta.result = result;
+    meta.updatedAt = Date.now();
+    writeMeta(meta);
+    fs.rmSync(partPath(id), { force: true });
+  };
+
+  const failFinalize = (id) => {
+    const meta = readMeta(id);
+    if (!meta) return;
+    meta.state = 'receiving';
+    meta.updatedAt = Date.now();
+    writeMeta(meta);
+  };
+
+  return {
+    create,
+    status,
+    append,
+    beginFinalize,
+    completeFinalize,
+    failFinalize,
+    remove: (id, ownerId) => {
+      load(id, ownerId);
+      remove(id);
+    },
+    pruneExpired
+  };
+};
+
+module.exports = {
+  createSessionStore,
+  UploadError,
+  DEFAULT_CHUNK_SIZE,
+  MAX_CHUNK_SIZE,
+  FINALIZE_RETRY_AFTER_S
+};